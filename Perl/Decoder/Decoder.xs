@@ -343,6 +343,11 @@ BOOT:
         SRL_INIT_OPTION( SRL_DEC_OPT_IDX_USE_UNDEF,                  SRL_DEC_OPT_STR_USE_UNDEF                  );
         SRL_INIT_OPTION( SRL_DEC_OPT_IDX_VALIDATE_UTF8,              SRL_DEC_OPT_STR_VALIDATE_UTF8              );
         SRL_INIT_OPTION( SRL_DEC_OPT_IDX_REFUSE_ZSTD,                SRL_DEC_OPT_STR_REFUSE_ZSTD                );
+        SRL_INIT_OPTION( SRL_DEC_OPT_IDX_CACHE_DOCUMENTS,            SRL_DEC_OPT_STR_CACHE_DOCUMENTS            );
+        SRL_INIT_OPTION( SRL_DEC_OPT_IDX_CACHE_MAX_BYTES,            SRL_DEC_OPT_STR_CACHE_MAX_BYTES            );
+        SRL_INIT_OPTION( SRL_DEC_OPT_IDX_ALIAS_COPIED_STRINGS,       SRL_DEC_OPT_STR_ALIAS_COPIED_STRINGS       );
+        SRL_INIT_OPTION( SRL_DEC_OPT_IDX_ALIAS_STRINGS_UNDER,        SRL_DEC_OPT_STR_ALIAS_STRINGS_UNDER        );
+        SRL_INIT_OPTION( SRL_DEC_OPT_IDX_COLLECT_STATS,              SRL_DEC_OPT_STR_COLLECT_STATS              );
     }
 #if USE_CUSTOM_OPS
     {
@@ -521,6 +526,17 @@ decode_sereal_with_header_data(src, opt = NULL, body_into = NULL, header_into =
     av_store(RETVAL, 1, SvREFCNT_inc(body_into));
   OUTPUT: RETVAL
 
+IV
+_document_length(src)
+    SV *src;
+  PREINIT:
+    STRLEN len;
+    const char *pv;
+  CODE:
+    pv = SvPV(src, len);
+    RETVAL = srl_decoder_document_length(aTHX_ (const unsigned char *)pv, len);
+  OUTPUT: RETVAL
+
 UV
 bytes_consumed(dec)
     srl_decoder_t *dec;
@@ -535,6 +551,38 @@ flags(dec)
     RETVAL = dec->flags;
   OUTPUT: RETVAL
 
+void
+cache_stats(dec)
+    srl_decoder_t *dec;
+  PREINIT:
+    HV *stats;
+  PPCODE:
+    stats = srl_decoder_cache_stats(aTHX_ dec);
+    ST(0) = stats ? sv_2mortal(newRV_inc((SV *)stats)) : &PL_sv_undef;
+    XSRETURN(1);
+
+void
+clear_cache(dec)
+    srl_decoder_t *dec;
+  CODE:
+    srl_decoder_cache_reset(aTHX_ dec);
+
+void
+stats(dec)
+    srl_decoder_t *dec;
+  PREINIT:
+    HV *stats;
+  PPCODE:
+    stats = srl_decoder_stats_hv(aTHX_ dec);
+    ST(0) = stats ? sv_2mortal(newRV_inc((SV *)stats)) : &PL_sv_undef;
+    XSRETURN(1);
+
+void
+reset_stats(dec)
+    srl_decoder_t *dec;
+  CODE:
+    srl_decoder_stats_reset(aTHX_ dec);
+
 SV*
 regexp_internals_type()
   CODE:
@@ -37,6 +37,7 @@ XSLoader::load( 'Sereal::Decoder', $XS_VERSION );
 use constant #begin generated
 {
   'SRL_F_DECODER_ALIAS_CHECK_FLAGS' => 28672,
+  'SRL_F_DECODER_ALIAS_COPIED_STRINGS' => 524288,
   'SRL_F_DECODER_ALIAS_SMALLINT' => 4096,
   'SRL_F_DECODER_ALIAS_VARINT' => 8192,
   'SRL_F_DECODER_DECOMPRESS_SNAPPY' => 8,
@@ -77,7 +78,8 @@ use constant #begin generated
                     'SET_READONLY',
                     'SET_READONLY_SCALARS',
                     'DECOMPRESS_ZSTD',
-                    'REFUSE_ZSTD'
+                    'REFUSE_ZSTD',
+                    'ALIAS_COPIED_STRINGS'
                   ],
   '_FLAG_NAME_STATIC' => [
                            'REUSE',
@@ -98,7 +100,8 @@ use constant #begin generated
                            'SET_READONLY',
                            'SET_READONLY_SCALARS',
                            undef,
-                           'REFUSE_ZSTD'
+                           'REFUSE_ZSTD',
+                           'ALIAS_COPIED_STRINGS'
                          ],
   '_FLAG_NAME_VOLATILE' => [
                              undef,
@@ -119,6 +122,7 @@ use constant #begin generated
                              undef,
                              undef,
                              'DECOMPRESS_ZSTD',
+                             undef,
                              undef
                            ]
 }; #end generated
@@ -142,6 +146,78 @@ sub decode_from_file {
     return $self->decode( $buf, @_ > 2 ? $_[2] : () );
 }
 
+sub decode_from_fh {
+    my ( $self, $fh, $callback, $opt )= @_;
+    $self= $self->new() unless ref $self;
+    croak("decode_from_fh() needs a callback") if ref($callback) ne 'CODE';
+    my $read_size= ( $opt && $opt->{read_size} ) || 64 * 1024;
+    my $framed= $opt && $opt->{framed};
+
+    my $buf= "";
+    my $eof= 0;
+    my $count= 0;
+    my $fill= sub {
+        my $want= shift;
+        while ( !$eof && $want > 0 ) {
+            my $got= read( $fh, $buf, $want > $read_size ? $want : $read_size, length $buf );
+            croak("Failed to read from filehandle: $!") if !defined $got;
+            $eof= 1 if !$got;
+            $want -= $got;
+        }
+    };
+
+    $fill->(1);
+    while ( length $buf ) {
+        my ( $skip, $len )= ( 0, -1 );
+        if ($framed) {
+            ( $skip, $len )= _frame_length($buf);
+        }
+        else {
+            $len= _document_length($buf);
+        }
+
+        if ( $len < 0 or length($buf) < $skip + $len ) {
+            croak("Truncated Sereal document at end of input") if $eof;
+            # when the length is not known yet the buffer is scanned again
+            # after reading, doubling it keeps that linear
+            $fill->( $len < 0 ? length $buf : $skip + $len - length $buf );
+            next;
+        }
+
+        # decode exactly one document: plain Snappy bodies run up to the
+        # end of the string and the incremental option chops the string
+        my $doc= substr( $buf, 0, $skip + $len, "" );
+        my $data= $self->decode_with_offset( $doc, $skip );
+        $count++;
+        $callback->($data);
+        $fill->(1) if !length $buf;
+    }
+    return $count;
+}
+
+# parse the varint length prefix written by frame_document()
+sub _frame_length {
+    my $len= 0;
+    for my $i ( 0 .. 9 ) {
+        return ( 0, -1 ) if $i >= length $_[0];
+        my $byte= ord substr( $_[0], $i, 1 );
+        $len |= ( $byte & 0x7f ) << ( 7 * $i );
+        return ( $i + 1, $len ) if !( $byte & 0x80 );
+    }
+    croak("Bad frame length prefix in Sereal stream");
+}
+
+sub frame_document {
+    my ( undef, $doc )= @_;
+    my $len= length $doc;
+    my $prefix= "";
+    while ( $len >= 0x80 ) {
+        $prefix .= chr( ( $len & 0x7f ) | 0x80 );
+        $len >>= 7;
+    }
+    return $prefix . chr($len) . $doc;
+}
+
 my $flags= sub {
     my ( $int, $ary )= @_;
     return map { ( $ary->[$_] and $int & ( 1 << $_ ) ) ? $ary->[$_] : () } ( 0 .. $#$ary );
@@ -319,6 +395,35 @@ and a very modest speed penalty when deserializing.
 
 Note this option changes the structure of the dumped data. Use with caution.
 
+=head3 alias_copied_strings
+
+If set to a true value then strings inside hashes and arrays which the
+encoder emitted as a COPY of an earlier string (see the C<dedupe_strings>
+option of L<Sereal::Encoder>) will all share one read-only SV per copied
+string, instead of each getting their own.
+
+This can cut the number of SVs, and the memory used, by a large factor for
+documents full of repeated enum-like values such as status codes or country
+names. Note that the first occurrence of a string is not part of the shared
+set, only the copies are.
+
+Note this option changes the structure of the dumped data. Use with caution.
+
+See also the "alias_strings_under" option.
+
+=head3 alias_strings_under
+
+If set to a positive integer, then every string inside a hash or array
+that is shorter than that many bytes is shared as a read-only alias with
+all other occurrences of the same string in the document, whether or not
+the encoder deduplicated it. Implies C<alias_copied_strings>.
+
+Strings are only shared within one document, so this costs a hash lookup
+per short string and some memory in the decoder that is released after
+every document.
+
+Note this option changes the structure of the dumped data. Use with caution.
+
 =head3 use_undef
 
 If set to a true value then this any undef value to be deserialized as
@@ -334,6 +439,41 @@ If set to a true value then the output will be completely readonly (deeply).
 If set to a true value then scalars in the output will be readonly (deeply).
 References won't be readonly.
 
+=head3 cache_documents
+
+If set to a positive integer, the decoder keeps a cache of up to that many
+decoded documents, evicting the least recently used one when it is full.
+The cache is keyed by the raw bytes of the document (an XXH64 hash of them,
+confirmed by a comparison against a stored copy), so decoding a document
+that was seen before costs one pass over its bytes instead of a full decode.
+
+Since the same structure is handed out to every caller decoding the same
+bytes, this option implies C<set_readonly>. The cache is only used by
+C<decode> and C<decode_with_offset> (and the corresponding exportable
+functions), and never in C<incremental> mode.
+
+This is useful for services that decode the same small set of documents
+over and over, like configuration or feature-flag blobs. It is a waste of
+memory for anything else. See also C<cache_stats> and C<clear_cache>.
+
+=head3 cache_max_bytes
+
+If set together with C<cache_documents>, limits the total size of the
+cached documents. The size accounted for is the length of the encoded
+document plus a small per-entry overhead; the decoded structures
+themselves are not measured. Documents that would not fit into an empty
+cache are never cached.
+
+=head3 collect_stats
+
+If set to a true value, the decoder keeps counters about the work it
+does: values and bytes per tag type, hash and array preallocation sizes,
+time spent hashing keys, decompression volume and time, objects blessed
+and C<THAW> callbacks. The counters are cumulative and can be read with
+C<stats> and zeroed with C<reset_stats>. Collecting them costs a branch
+per value plus a clock read per hash key, so this is meant for profiling
+workloads, not for production decoders.
+
 =head1 INSTANCE METHODS
 
 =head2 decode
@@ -452,6 +592,74 @@ following example is correct, as only the header is deserialized:
   my $count = $decoder->bytes_consumed;
   # $count is 0
 
+=head2 cache_stats
+
+Returns a hash reference with the counters and limits of the document
+cache (see the C<cache_documents> option), or undef if the decoder has
+no cache:
+
+  {
+    hits        => 1234,  # decodes served from the cache
+    misses      => 56,    # decodes that had to do the full work
+    hit_rate    => 0.956, # hits / (hits + misses)
+    evictions   => 12,    # entries dropped to respect the limits
+    entries     => 44,    # documents currently cached
+    bytes       => 18123, # accounted size of the cached documents
+    max_entries => 50,
+    max_bytes   => 0,     # 0 means no limit
+  }
+
+=head2 clear_cache
+
+Drops all entries from the document cache and resets its counters.
+Does nothing if the decoder has no cache.
+
+=head2 stats
+
+Returns a hash reference with the counters collected since the decoder
+was created or since the last C<reset_stats> call, or undef if the
+decoder was not constructed with the C<collect_stats> option:
+
+  {
+    documents              => 10,
+    cache_hits             => 0,
+    values                 => { HASHREF => 10, SHORT_BINARY => 240, ... },
+    bytes_copied           => { SHORT_BINARY => 1480, STR_UTF8 => 64 },
+    hash_keys              => 120,
+    hash_key_bytes         => 790,
+    hash_key_ns            => 31200,  # time spent storing hash keys
+    hv_ksplit_calls        => 10,     # hashes presized, summed and
+    hv_ksplit_keys         => 120,    # largest number of keys
+    hv_ksplit_max          => 12,
+    av_extend_calls        => 10,     # same for arrays
+    av_extend_elems        => 50,
+    av_extend_max          => 5,
+    decompressed_documents => 10,
+    decompress_bytes_in    => 2100,
+    decompress_bytes_out   => 4800,
+    decompress_ns          => 20500,
+    objects_blessed        => 0,
+    thaw_calls             => 0,
+    thaw_ns                => 0,
+  }
+
+The C<values> and C<bytes_copied> hashes are keyed by tag name, with
+tags that encode a value in their low bits (C<POS_0> to C<POS_15>,
+C<SHORT_BINARY_0> to C<SHORT_BINARY_31>, ...) folded into one key.
+C<bytes_copied> only counts string payloads. The C<_ns> values are
+nanoseconds of monotonic clock time and are always 0 on platforms
+without C<clock_gettime>.
+
+Documents decoded from a C<THAW> callback that calls back into the same
+decoder are counted as well. Documents served from the C<cache_documents>
+cache are not decoded again, so they only increment C<cache_hits> and
+not C<documents> or any of the per value counters.
+
+=head2 reset_stats
+
+Zeroes the counters returned by C<stats>. Call it before a decode to
+get a profile of just that document.
+
 =head2 decode_from_file
 
     Sereal::Decoder->decode_from_file($file);
@@ -463,6 +671,51 @@ contained in the file and returns a list, otherwise decodes
 the first (or only) packet in the file. Accepts an optinal
 "target" variable as a second argument.
 
+=head2 decode_from_fh
+
+    my $count = $decoder->decode_from_fh($fh, sub { my $data = shift; ... });
+    Sereal::Decoder->decode_from_fh($fh, \&callback, { framed => 1 });
+
+Reads a stream of Sereal documents from the filehandle and calls the
+callback with each decoded document as soon as it is complete. Returns
+the number of documents decoded. Only the document currently being read
+is kept in memory, so this can be used to process (or tail) Sereal log
+files of any size.
+
+Every document is decoded exactly once, after it has been read
+completely. The length of documents compressed with C<SRL_ZLIB>,
+C<SRL_ZSTD> or incremental Snappy is known from their header. Raw
+(uncompressed) and plain Snappy documents do not record their length,
+so C<decode_from_fh> finds their end by walking the tags (or the Snappy
+stream) of what it has read so far, without building any values, and
+reads more when it runs out. To avoid that scan, write documents with a
+length prefix from C<frame_document> and pass the C<framed> option.
+
+Options, passed in a hash reference as the third argument:
+
+=over 4
+
+=item framed
+
+Every document in the stream is preceded by the length prefix written by
+C<frame_document>.
+
+=item read_size
+
+How many bytes to ask for per read, defaults to 64KiB. Documents larger
+than this are read with one larger read.
+
+=back
+
+Dies if the stream ends in the middle of a document.
+
+=head2 frame_document
+
+    print $fh Sereal::Decoder->frame_document($encoder->encode($data));
+
+Returns the document with a varint length prefix, as expected by
+C<decode_from_fh> with the C<framed> option.
+
 =head2 looks_like_sereal
 
 Performs some rudimentary check to determine if the argument
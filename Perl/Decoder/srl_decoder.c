@@ -55,7 +55,9 @@ extern "C" {
 #include "srl_decoder.h"
 
 #include "srl_common.h"
-#include "ptable.h"
+#include "srl_decoder_otable.h"
+#include "srl_decoder_cache.h"
+#include "srl_decoder_bless.h"
 #include "srl_reader.h"
 #include "srl_reader_error.h"
 #include "srl_reader_varint.h"
@@ -108,6 +110,7 @@ SRL_STATIC_INLINE void srl_clear_decoder(pTHX_ srl_decoder_t *dec);
 
 /* the internal routines to handle each kind of object we have to deserialize */
 SRL_STATIC_INLINE void srl_read_copy(pTHX_ srl_decoder_t *dec, SV* into);
+SRL_STATIC_INLINE int srl_read_copy_alias(pTHX_ srl_decoder_t *dec, SV* into, SV** container, const U8 *track_it);
 
 SRL_STATIC_INLINE void srl_read_hash(pTHX_ srl_decoder_t *dec, SV* into, U8 tag);
 SRL_STATIC_INLINE void srl_read_array(pTHX_ srl_decoder_t *dec, SV* into, U8 tag);
@@ -119,7 +122,7 @@ SRL_STATIC_INLINE void srl_read_weaken(pTHX_ srl_decoder_t *dec, SV* into);
 SRL_STATIC_INLINE void srl_read_long_double(pTHX_ srl_decoder_t *dec, SV* into);
 SRL_STATIC_INLINE void srl_read_double(pTHX_ srl_decoder_t *dec, SV* into);
 SRL_STATIC_INLINE void srl_read_float(pTHX_ srl_decoder_t *dec, SV* into);
-SRL_STATIC_INLINE void srl_read_string(pTHX_ srl_decoder_t *dec, int is_utf8, SV* into);
+SRL_STATIC_INLINE int srl_read_string(pTHX_ srl_decoder_t *dec, int is_utf8, SV* into, SV** container, const U8 *track_it);
 SRL_STATIC_INLINE void srl_read_varint_into(pTHX_ srl_decoder_t *dec, SV* into, SV** container, const U8 *track_it);
 SRL_STATIC_INLINE void srl_read_zigzag_into(pTHX_ srl_decoder_t *dec, SV* into, SV** container, const U8 *track_it);
 SRL_STATIC_INLINE void srl_read_reserved(pTHX_ srl_decoder_t *dec, U8 tag, SV* into);
@@ -129,7 +132,7 @@ SRL_STATIC_INLINE void srl_read_objectv(pTHX_ srl_decoder_t *dec, SV* into, U8 o
 SRL_STATIC_INLINE void srl_track_sv(pTHX_ srl_decoder_t *dec, const U8 *track_pos, SV *sv);
 SRL_STATIC_INLINE void srl_read_frozen_object(pTHX_ srl_decoder_t *dec, HV *class_stash, SV *into);
 SRL_STATIC_INLINE SV * srl_follow_refp_alias_reference(pTHX_ srl_decoder_t *dec, UV offset);
-SRL_STATIC_INLINE AV * srl_follow_objectv_reference(pTHX_ srl_decoder_t *dec, UV offset);
+SRL_STATIC_INLINE UV srl_follow_objectv_reference(pTHX_ srl_decoder_t *dec, UV offset);
 
 /* FIXME unimplemented!!! */
 SRL_STATIC_INLINE SV *srl_read_extend(pTHX_ srl_decoder_t *dec, SV* into);
@@ -143,17 +146,34 @@ SRL_STATIC_INLINE SV *srl_read_extend(pTHX_ srl_decoder_t *dec, SV* into);
 
 #define DEPTH_DECREMENT(dec) dec->recursion_depth--
 
+/* instrumentation, see the "collect_stats" option */
+#define SRL_DEC_STATS(dec) expect_false((dec)->stats != NULL)
+
+/* Monotonic time in nanoseconds for the instrumentation counters, or 0
+ * if the platform lacks a suitable clock. NV so it works on 32 bit perls. */
+SRL_STATIC_INLINE NV
+srl_dec_stats_now(void)
+{
+#if defined(CLOCK_MONOTONIC) && !defined(WIN32)
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+        return (NV)ts.tv_sec * 1e9 + (NV)ts.tv_nsec;
+#endif
+    return 0;
+}
+
 #define IS_SRL_HDR_ARRAYREF(tag) (((tag) & SRL_HDR_ARRAYREF) == SRL_HDR_ARRAYREF)
 #define IS_SRL_HDR_HASHREF(tag) (((tag) & SRL_HDR_HASHREF) == SRL_HDR_HASHREF)
 #define IS_SRL_HDR_SHORT_BINARY(tag) (((tag) & SRL_HDR_SHORT_BINARY_LOW) == SRL_HDR_SHORT_BINARY_LOW)
 #define SRL_HDR_SHORT_BINARY_LEN_FROM_TAG(tag) ((tag) & SRL_MASK_SHORT_BINARY_LEN)
 
 
-#define SRL_ASSERT_REF_PTR_TABLES(dec) STMT_START {     \
-            if (expect_false( !(dec)->ref_stashes )) {  \
-                (dec)->ref_stashes = PTABLE_new();      \
-                (dec)->ref_bless_av = PTABLE_new();     \
-            }                                           \
+#define SRL_ASSERT_REF_PTR_TABLES(dec) STMT_START {                 \
+            if (expect_false( !(dec)->ref_stashes )) {              \
+                (dec)->ref_stashes = srl_otable_new();              \
+                (dec)->ref_bless_batch = srl_otable_new();          \
+                Newxz((dec)->bless_batches, 1, srl_bless_batches_t);\
+            }                                                       \
         } STMT_END
 
 #define SRL_sv_set_rv_to(into,referent)             \
@@ -164,19 +184,17 @@ SRL_STATIC_INLINE SV *srl_read_extend(pTHX_ srl_decoder_t *dec, SV* into);
         SvROK_on(into);                             \
     } STMT_END
 
-STATIC void
-srl_ptable_debug_callback(PTABLE_ENTRY_t *e)
-{
-    dTHX;
-    printf("KEY=%"UVuf"\nVALUE:\n", (UV)e->key);
-    sv_dump((SV *)e->value);
-    printf("\n");
-}
-
 SRL_STATIC_INLINE void
-srl_ptable_debug_dump(pTHX_ PTABLE_t *tbl)
+srl_otable_debug_dump(pTHX_ srl_otable_t *tbl)
 {
-    PTABLE_debug_dump(tbl, srl_ptable_debug_callback);
+    UV i;
+    for (i= 0; i <= tbl->mask; i++) {
+        if (tbl->ary[i].gen != tbl->gen)
+            continue;
+        printf("KEY=%"UVuf"\nVALUE:\n", tbl->ary[i].key);
+        sv_dump((SV *)tbl->ary[i].value);
+        printf("\n");
+    }
 }
 
 #define my_hv_fetchs(he,val,opt,idx) STMT_START {                   \
@@ -216,7 +234,7 @@ srl_build_decoder_struct(pTHX_ HV *opt, sv_with_hash *options)
 
     Newxz(dec, 1, srl_decoder_t);
 
-    dec->ref_seenhash = PTABLE_new();
+    dec->ref_seenhash = srl_otable_new();
     dec->max_recursion_depth = DEFAULT_MAX_RECUR_DEPTH;
     dec->max_num_hash_entries = 0; /* 0 == any number */
 
@@ -304,6 +322,22 @@ srl_build_decoder_struct(pTHX_ HV *opt, sv_with_hash *options)
             AvFILLp(dec->alias_cache)= 16 + dec->alias_varint_under - 1; /* remove 1 as this is $#ary */
         }
 
+        /* see if they want us to alias short strings, value is an unsigned
+         * integer: any string in a hash or array that is shorter than it will
+         * be shared as a readonly SV with all other occurrences of the same
+         * string in the document. This implies "alias_copied_strings". */
+        my_hv_fetchs(he,val,opt, SRL_DEC_OPT_IDX_ALIAS_STRINGS_UNDER);
+        if ( val && SvTRUE(val)) {
+            SRL_DEC_SET_OPTION(dec,SRL_F_DECODER_ALIAS_COPIED_STRINGS);
+            dec->alias_strings_under= SvUV(val);
+        }
+        /* they can enable aliasing of COPY targets alone */
+        if ( !SRL_DEC_HAVE_OPTION(dec,SRL_F_DECODER_ALIAS_COPIED_STRINGS) ) {
+            my_hv_fetchs(he,val,opt, SRL_DEC_OPT_IDX_ALIAS_COPIED_STRINGS);
+            if ( val && SvTRUE(val))
+                SRL_DEC_SET_OPTION(dec,SRL_F_DECODER_ALIAS_COPIED_STRINGS);
+        }
+
         /* check if they want us to use &PL_sv_undef for SRL_HEADER_UNDEF
          * even if this might break referential integrity. */
         my_hv_fetchs(he,val,opt, SRL_DEC_OPT_IDX_USE_UNDEF);
@@ -320,6 +354,26 @@ srl_build_decoder_struct(pTHX_ HV *opt, sv_with_hash *options)
         if ( val && SvTRUE(val))
             SRL_DEC_SET_OPTION(dec, SRL_F_DECODER_SET_READONLY_SCALARS);
 
+        /* check if they want us to cache whole decoded documents. The cached
+         * structures are handed out to every caller decoding the same bytes,
+         * so they are always built readonly. */
+        my_hv_fetchs(he,val,opt, SRL_DEC_OPT_IDX_CACHE_DOCUMENTS);
+        if ( val && SvTRUE(val)) {
+            UV max_entries= SvUV(val);
+            UV max_bytes= 0;
+
+            my_hv_fetchs(he,val,opt, SRL_DEC_OPT_IDX_CACHE_MAX_BYTES);
+            if ( val && SvTRUE(val))
+                max_bytes= SvUV(val);
+
+            SRL_DEC_SET_OPTION(dec, SRL_F_DECODER_SET_READONLY);
+            dec->doc_cache= srl_decoder_cache_new(max_entries, max_bytes);
+        }
+
+        /* check if they want us to collect instrumentation counters */
+        my_hv_fetchs(he,val,opt, SRL_DEC_OPT_IDX_COLLECT_STATS);
+        if ( val && SvTRUE(val))
+            Newxz(dec->stats, 1, srl_decoder_stats_t);
     }
     dec->flags_readonly= SRL_DEC_HAVE_OPTION(dec, SRL_F_DECODER_SET_READONLY ) ? 1 :
                          SRL_DEC_HAVE_OPTION(dec, SRL_F_DECODER_SET_READONLY_SCALARS) ? 2 :
@@ -335,9 +389,10 @@ srl_build_decoder_struct_alike(pTHX_ srl_decoder_t *proto)
 
     Newxz(dec, 1, srl_decoder_t);
 
-    dec->ref_seenhash = PTABLE_new();
+    dec->ref_seenhash = srl_otable_new();
     dec->max_recursion_depth = proto->max_recursion_depth;
     dec->max_num_hash_entries = proto->max_num_hash_entries;
+    dec->alias_strings_under = proto->alias_strings_under;
 
     if (proto->alias_cache) {
         dec->alias_cache = proto->alias_cache;
@@ -349,6 +404,13 @@ srl_build_decoder_struct_alike(pTHX_ srl_decoder_t *proto)
     dec->flags = proto->flags;
     SRL_DEC_RESET_VOLATILE_FLAGS(dec);
 
+    /* reentrant decodes count towards the counters of the decoder the
+     * user holds, the clone never frees them */
+    if (proto->stats) {
+        dec->stats = proto->stats;
+        SRL_DEC_SET_OPTION(dec, SRL_F_DECODER_STATS_BORROWED);
+    }
+
     return dec;
 }
 
@@ -356,19 +418,31 @@ srl_build_decoder_struct_alike(pTHX_ srl_decoder_t *proto)
 void
 srl_destroy_decoder(pTHX_ srl_decoder_t *dec)
 {
-    PTABLE_free(dec->ref_seenhash);
+    srl_otable_free(dec->ref_seenhash);
     if (dec->ref_stashes) {
-        PTABLE_free(dec->ref_stashes);
-        PTABLE_free(dec->ref_bless_av);
+        srl_otable_free(dec->ref_stashes);
+        srl_otable_free(dec->ref_bless_batch);
+        srl_bless_batches_free(aTHX_ dec->bless_batches);
+        Safefree(dec->bless_batches);
     }
     if (dec->weakref_av) {
         SvREFCNT_dec(dec->weakref_av);
         dec->weakref_av = NULL;
     }
     if (dec->ref_thawhash)
-        PTABLE_free(dec->ref_thawhash);
+        srl_otable_free(dec->ref_thawhash);
     if (dec->alias_cache)
         SvREFCNT_dec(dec->alias_cache);
+    if (dec->doc_cache)
+        srl_decoder_cache_free(aTHX_ dec->doc_cache);
+    if (dec->stats && !SRL_DEC_HAVE_OPTION(dec, SRL_F_DECODER_STATS_BORROWED))
+        Safefree(dec->stats);
+    if (dec->ref_copy_alias)
+        srl_otable_free(dec->ref_copy_alias);
+    if (dec->alias_strings_hv)
+        SvREFCNT_dec(dec->alias_strings_hv);
+    if (dec->alias_utf8_strings_hv)
+        SvREFCNT_dec(dec->alias_utf8_strings_hv);
     Safefree(dec);
 }
 
@@ -397,20 +471,32 @@ SRL_STATIC_INLINE void
 srl_decode_into_internal(pTHX_ srl_decoder_t *origdec, SV *src, SV *header_into, SV *body_into, UV start_offset)
 {
     srl_decoder_t *dec;
+    NV t0= 0;
 
     assert(origdec != NULL);
     dec = srl_begin_decoding(aTHX_ origdec, src, start_offset);
     srl_read_header(aTHX_ dec, header_into);
+    if (SRL_DEC_STATS(dec)) {
+        dec->stats->documents++;
+        t0= srl_dec_stats_now();
+    }
     if (expect_false( SRL_DEC_HAVE_OPTION(dec, SRL_F_DECODER_DECOMPRESS_SNAPPY) )) {
         dec->bytes_consumed = srl_decompress_body_snappy(aTHX_ dec->pbuf, dec->encoding_flags, NULL);
         origdec->bytes_consumed = dec->bytes_consumed;
     } else if (expect_false( SRL_DEC_HAVE_OPTION(dec, SRL_F_DECODER_DECOMPRESS_ZLIB) )) {
-        dec->bytes_consumed = srl_decompress_body_zlib(aTHX_ dec->pbuf, NULL);
+        dec->bytes_consumed = srl_decompress_body_zlib(aTHX_ dec->pbuf, NULL, NULL);
         origdec->bytes_consumed = dec->bytes_consumed;
     } else if (expect_false( SRL_DEC_HAVE_OPTION(dec, SRL_F_DECODER_DECOMPRESS_ZSTD) )) {
-        dec->bytes_consumed = srl_decompress_body_zstd(aTHX_ dec->pbuf, NULL);
+        dec->bytes_consumed = srl_decompress_body_zstd(aTHX_ dec->pbuf, NULL, NULL);
         origdec->bytes_consumed = dec->bytes_consumed;
     }
+    /* bytes_consumed is only set this early if we decompressed */
+    if (SRL_DEC_STATS(dec) && dec->bytes_consumed) {
+        dec->stats->decompressed_documents++;
+        dec->stats->decompress_bytes_in += dec->bytes_consumed;
+        dec->stats->decompress_bytes_out += dec->buf.end - dec->buf.pos;
+        dec->stats->decompress_ns += srl_dec_stats_now() - t0;
+    }
 
     /* this function *MUST* be called right after srl_decompress* functions */
     SRL_RDR_UPDATE_BODY_POS(dec->pbuf, dec->proto_version);
@@ -458,6 +544,64 @@ srl_decode_header_into(pTHX_ srl_decoder_t *origdec, SV *src, SV* header_into, U
 #define FRESH_SV() newSV_type(SVt_NULL);
 #endif
 
+/* Decode a document through the document cache: hash the raw bytes and
+ * hand out the shared readonly structure on a hit, do a normal decode and
+ * remember its result on a miss. */
+SRL_STATIC_INLINE void
+srl_decode_into_cached(pTHX_ srl_decoder_t *dec, SV *src, SV *body_into, UV start_offset)
+{
+    srl_decoder_cache_t *cache= dec->doc_cache;
+    srl_decoder_cache_entry_t *ent;
+    XXH64_hash_t hash;
+    STRLEN len;
+    const char *doc;
+
+    /* Incremental mode consumes the source, UTF8-on input must be downgraded
+     * first and a reentrant call (from a THAW hook) clones the decoder. None
+     * of these are worth caching, so let the normal path deal with them. */
+    if (   SRL_DEC_HAVE_OPTION(dec, (SRL_F_DECODER_DESTRUCTIVE_INCREMENTAL|SRL_F_DECODER_DIRTY))
+        || SvUTF8(src) )
+    {
+        srl_decode_into_internal(aTHX_ dec, src, NULL, body_into, start_offset);
+        return;
+    }
+
+    doc= SvPV(src, len);
+    if (expect_false( start_offset > len )) {
+        /* let the normal path produce the error */
+        srl_decode_into_internal(aTHX_ dec, src, NULL, body_into, start_offset);
+        return;
+    }
+    doc += start_offset;
+    len -= start_offset;
+
+    hash= srl_xxh64(doc, len);
+    ent= srl_decoder_cache_fetch(cache, hash, doc, len);
+    if (ent) {
+        if (SRL_DEC_STATS(dec))
+            dec->stats->cache_hits++;
+        sv_setsv(body_into, ent->value);
+        SvREADONLY_on(body_into);
+        dec->bytes_consumed= ent->bytes_consumed;
+        return;
+    }
+
+    srl_decode_into_internal(aTHX_ dec, src, NULL, body_into, start_offset);
+
+    /* decoding may have run arbitrary code (THAW), so refetch the buffer
+     * and only remember the result if the source still looks the same */
+    {
+        STRLEN new_len;
+        const char *new_doc= SvPV(src, new_len);
+        if (expect_true( new_len == len + start_offset )) {
+            SV *value= newSVsv(body_into);
+            SvREADONLY_on(value);
+            srl_decoder_cache_store(aTHX_ cache, hash, new_doc + start_offset, len,
+                                    dec->bytes_consumed, value);
+        }
+    }
+}
+
 /* This is the main routine to deserialize a Sereal document
  * w/o data in header. */
 SV *
@@ -465,10 +609,122 @@ srl_decode_into(pTHX_ srl_decoder_t *dec, SV *src, SV* body_into, UV start_offse
 {
     if (expect_true(!body_into))
         body_into= sv_2mortal(FRESH_SV());
-    srl_decode_into_internal(aTHX_ dec, src, NULL, body_into, start_offset);
+    if (expect_false(dec->doc_cache != NULL))
+        srl_decode_into_cached(aTHX_ dec, src, body_into, start_offset);
+    else
+        srl_decode_into_internal(aTHX_ dec, src, NULL, body_into, start_offset);
     return body_into;
 }
 
+/* Report the counters and limits of the document cache as a new mortal hash,
+ * or return NULL if the decoder was built without one. */
+HV *
+srl_decoder_cache_stats(pTHX_ srl_decoder_t *dec)
+{
+    srl_decoder_cache_t *cache= dec->doc_cache;
+    HV *stats;
+
+    if (!cache)
+        return NULL;
+
+    stats= (HV *)sv_2mortal((SV *)newHV());
+    hv_stores(stats, "hits",        newSVuv(cache->hits));
+    hv_stores(stats, "misses",      newSVuv(cache->misses));
+    hv_stores(stats, "evictions",   newSVuv(cache->evictions));
+    hv_stores(stats, "entries",     newSVuv(cache->entries));
+    hv_stores(stats, "bytes",       newSVuv(cache->bytes));
+    hv_stores(stats, "max_entries", newSVuv(cache->max_entries));
+    hv_stores(stats, "max_bytes",   newSVuv(cache->max_bytes));
+    hv_stores(stats, "hit_rate",    newSVnv(cache->hits + cache->misses
+                                            ? (NV)cache->hits / (NV)(cache->hits + cache->misses)
+                                            : 0.0));
+    return stats;
+}
+
+/* Empty the document cache and reset its counters. */
+void
+srl_decoder_cache_reset(pTHX_ srl_decoder_t *dec)
+{
+    srl_decoder_cache_t *cache= dec->doc_cache;
+
+    if (!cache)
+        return;
+    srl_decoder_cache_clear(aTHX_ cache);
+    cache->hits= cache->misses= cache->evictions= 0;
+}
+
+/* Add per-tag counters to a hash, folding the tags that carry a value in
+ * their low bits (POS_3, SHORT_BINARY_7, ...) into one key per family. */
+SRL_STATIC_INLINE HV *
+srl_decoder_stats_by_tag(pTHX_ const UV *counts)
+{
+    HV *hv= newHV();
+    int tag;
+
+    for (tag= 0; tag < 128; tag++) {
+        const char *name= SRL_TAG_NAME(tag);
+        STRLEN len= strlen(name);
+        SV **svp;
+
+        if (!counts[tag])
+            continue;
+        /* strip a trailing _<digits> */
+        if (len && isDIGIT(name[len - 1])) {
+            STRLEN l= len;
+            while (l && isDIGIT(name[l - 1]))
+                l--;
+            if (l > 1 && name[l - 1] == '_')
+                len= l - 1;
+        }
+        svp= hv_fetch(hv, name, len, 1);
+        sv_setuv(*svp, (SvOK(*svp) ? SvUV(*svp) : 0) + counts[tag]);
+    }
+    return hv;
+}
+
+/* Report the instrumentation counters as a new mortal hash, or return NULL
+ * if the decoder was built without "collect_stats". */
+HV *
+srl_decoder_stats_hv(pTHX_ srl_decoder_t *dec)
+{
+    srl_decoder_stats_t *st= dec->stats;
+    HV *stats;
+
+    if (!st)
+        return NULL;
+
+    stats= (HV *)sv_2mortal((SV *)newHV());
+    hv_stores(stats, "documents",              newSVuv(st->documents));
+    hv_stores(stats, "cache_hits",             newSVuv(st->cache_hits));
+    hv_stores(stats, "values",                 newRV_noinc((SV *)srl_decoder_stats_by_tag(aTHX_ st->tag_count)));
+    hv_stores(stats, "bytes_copied",           newRV_noinc((SV *)srl_decoder_stats_by_tag(aTHX_ st->tag_bytes)));
+    hv_stores(stats, "hash_keys",              newSVuv(st->hash_keys));
+    hv_stores(stats, "hash_key_bytes",         newSVuv(st->hash_key_bytes));
+    hv_stores(stats, "hash_key_ns",            newSVnv(st->hash_key_ns));
+    hv_stores(stats, "hv_ksplit_calls",        newSVuv(st->hv_ksplit_calls));
+    hv_stores(stats, "hv_ksplit_keys",         newSVuv(st->hv_ksplit_keys));
+    hv_stores(stats, "hv_ksplit_max",          newSVuv(st->hv_ksplit_max));
+    hv_stores(stats, "av_extend_calls",        newSVuv(st->av_extend_calls));
+    hv_stores(stats, "av_extend_elems",        newSVuv(st->av_extend_elems));
+    hv_stores(stats, "av_extend_max",          newSVuv(st->av_extend_max));
+    hv_stores(stats, "decompressed_documents", newSVuv(st->decompressed_documents));
+    hv_stores(stats, "decompress_bytes_in",    newSVuv(st->decompress_bytes_in));
+    hv_stores(stats, "decompress_bytes_out",   newSVuv(st->decompress_bytes_out));
+    hv_stores(stats, "decompress_ns",          newSVnv(st->decompress_ns));
+    hv_stores(stats, "objects_blessed",        newSVuv(st->objects_blessed));
+    hv_stores(stats, "thaw_calls",             newSVuv(st->thaw_calls));
+    hv_stores(stats, "thaw_ns",                newSVnv(st->thaw_ns));
+    return stats;
+}
+
+/* Zero the instrumentation counters. */
+void
+srl_decoder_stats_reset(pTHX_ srl_decoder_t *dec)
+{
+    if (dec->stats)
+        Zero(dec->stats, 1, srl_decoder_stats_t);
+}
+
 /* This is the main routine to deserialize Sereal document body
  * and header all at once. */
 void
@@ -501,11 +757,18 @@ srl_clear_decoder_body_state(pTHX_ srl_decoder_t *dec)
     if (dec->weakref_av)
         av_clear(dec->weakref_av);
 
-    PTABLE_clear(dec->ref_seenhash);
+    srl_otable_clear(dec->ref_seenhash);
     if (dec->ref_stashes) {
-        PTABLE_clear(dec->ref_stashes);
-        PTABLE_clear(dec->ref_bless_av);
+        srl_otable_clear(dec->ref_stashes);
+        srl_otable_clear(dec->ref_bless_batch);
+        srl_bless_batches_clear(aTHX_ dec->bless_batches);
     }
+    if (dec->ref_copy_alias)
+        srl_otable_clear(dec->ref_copy_alias);
+    if (dec->alias_strings_hv)
+        hv_clear(dec->alias_strings_hv);
+    if (dec->alias_utf8_strings_hv)
+        hv_clear(dec->alias_utf8_strings_hv);
 
     dec->recursion_depth = 0;
 }
@@ -567,6 +830,230 @@ srl_validate_header_version_pv_len(pTHX_ char *strdata, STRLEN len)
     return srl_validate_header_version(aTHX_ (srl_reader_char_ptr) strdata, len);
 }
 
+/* Read a varint from a buffer that may end early. Returns the number of
+ * bytes it took, or 0 if the buffer ended first. */
+SRL_STATIC_INLINE STRLEN
+srl_peek_varint(pTHX_ const unsigned char *p, const unsigned char *end, UV *uv)
+{
+    const unsigned char *start= p;
+    unsigned int shift= 0;
+
+    *uv= 0;
+    while (p < end) {
+        if (expect_false( shift > sizeof(UV) * 8 - 7 ))
+            croak("Sereal: Error: varint too big while looking for the document length");
+        *uv |= ((UV)(*p & 0x7f)) << shift;
+        if (!(*p++ & 0x80))
+            return (STRLEN)(p - start);
+        shift += 7;
+    }
+    return 0;
+}
+
+/* Find the end of the raw body starting at p by walking its tags without
+ * building any values. Only the number of values still to be read is
+ * needed for that, not the shape of the structure. Returns the offset of
+ * the end of the body from pv or SRL_DOC_LEN_NEED_MORE. A tag that is not
+ * valid ends the walk early, decoding up to there produces the error. */
+SRL_STATIC_INLINE IV
+srl_raw_body_end(pTHX_ const unsigned char *pv, const unsigned char *p, const unsigned char *end)
+{
+    UV pending= 1;
+    STRLEN used;
+    UV value;
+
+    while (pending) {
+        U8 tag;
+
+        if (p >= end)
+            return SRL_DOC_LEN_NEED_MORE;
+        tag= *p++ & ~SRL_HDR_TRACK_FLAG;
+
+        if (tag == SRL_HDR_PAD)
+            continue;
+        pending--;
+
+        if (tag >= SRL_HDR_SHORT_BINARY_LOW) {
+            p += SRL_HDR_SHORT_BINARY_LEN_FROM_TAG(tag);
+        }
+        else if (tag >= SRL_HDR_HASHREF_LOW) {
+            pending += 2 * SRL_HDR_HASHREF_LEN_FROM_TAG(tag);
+        }
+        else if (tag >= SRL_HDR_ARRAYREF_LOW) {
+            pending += SRL_HDR_ARRAYREF_LEN_FROM_TAG(tag);
+        }
+        else if (tag <= SRL_HDR_NEG_HIGH) {
+            /* value in the tag */
+        }
+        else {
+            switch (tag) {
+                case SRL_HDR_UNDEF:
+                case SRL_HDR_CANONICAL_UNDEF:
+                case SRL_HDR_TRUE:
+                case SRL_HDR_FALSE:
+                    break;
+                case SRL_HDR_FLOAT:         p += 4;  break;
+                case SRL_HDR_DOUBLE:        p += 8;  break;
+                case SRL_HDR_LONG_DOUBLE:   p += 16; break;
+                case SRL_HDR_REFN:
+                case SRL_HDR_WEAKEN:
+                    pending += 1;
+                    break;
+                case SRL_HDR_OBJECT:
+                case SRL_HDR_OBJECT_FREEZE:
+                case SRL_HDR_REGEXP:
+                    pending += 2;
+                    break;
+                case SRL_HDR_VARINT:
+                case SRL_HDR_ZIGZAG:
+                case SRL_HDR_REFP:
+                case SRL_HDR_ALIAS:
+                case SRL_HDR_COPY:
+                case SRL_HDR_OBJECTV:
+                case SRL_HDR_OBJECTV_FREEZE:
+                case SRL_HDR_BINARY:
+                case SRL_HDR_STR_UTF8:
+                case SRL_HDR_HASH:
+                case SRL_HDR_ARRAY:
+                    if (!(used= srl_peek_varint(aTHX_ p, end, &value)))
+                        return SRL_DOC_LEN_NEED_MORE;
+                    p += used;
+                    if (tag == SRL_HDR_BINARY || tag == SRL_HDR_STR_UTF8) {
+                        if (value > (UV)(end - p))
+                            return SRL_DOC_LEN_NEED_MORE;
+                        p += value;
+                    }
+                    else if (tag == SRL_HDR_HASH || tag == SRL_HDR_ARRAY) {
+                        if (value > (UV)I32_MAX)
+                            return (IV)(p - pv);
+                        pending += tag == SRL_HDR_HASH ? 2 * value : value;
+                    }
+                    else if (tag == SRL_HDR_OBJECTV || tag == SRL_HDR_OBJECTV_FREEZE) {
+                        pending += 1;
+                    }
+                    break;
+                default:
+                    return (IV)(p - pv);
+            }
+        }
+    }
+    if (p > end)
+        return SRL_DOC_LEN_NEED_MORE;
+    return (IV)(p - pv);
+}
+
+/* Find the end of a Snappy stream (without the incremental length prefix)
+ * starting at p by adding up the output of its elements until it reaches
+ * the uncompressed length recorded in front of them. Returns the offset of
+ * the end from pv or SRL_DOC_LEN_NEED_MORE. */
+SRL_STATIC_INLINE IV
+srl_snappy_stream_end(pTHX_ const unsigned char *pv, const unsigned char *p, const unsigned char *end)
+{
+    UV want;
+    UV have= 0;
+    STRLEN used;
+
+    if (!(used= srl_peek_varint(aTHX_ p, end, &want)))
+        return SRL_DOC_LEN_NEED_MORE;
+    p += used;
+
+    while (have < want) {
+        U8 tag;
+        UV len;
+
+        if (p >= end)
+            return SRL_DOC_LEN_NEED_MORE;
+        tag= *p++;
+        switch (tag & 3) {
+            case 0: /* literal, long lengths follow the tag */
+                len= tag >> 2;
+                if (len >= 60) {
+                    unsigned int i, nbytes= (unsigned int)len - 59;
+                    if ((UV)(end - p) < nbytes)
+                        return SRL_DOC_LEN_NEED_MORE;
+                    len= 0;
+                    for (i= 0; i < nbytes; i++)
+                        len |= (UV)p[i] << (8 * i);
+                    p += nbytes;
+                }
+                len++;
+                if (len > (UV)(end - p))
+                    return SRL_DOC_LEN_NEED_MORE;
+                p += len;
+                break;
+            case 1: len= ((tag >> 2) & 7) + 4; p += 1; break;
+            case 2: len= (tag >> 2) + 1;       p += 2; break;
+            default: len= (tag >> 2) + 1;      p += 4; break;
+        }
+        have += len;
+    }
+    if (p > end)
+        return SRL_DOC_LEN_NEED_MORE;
+    return (IV)(p - pv);
+}
+
+/* Work out the total length of the document at the start of the buffer,
+ * without decoding it. The compressed encodings other than plain Snappy
+ * record the length of the body in front of it, for the others the body
+ * (or the Snappy stream) is walked to find its end. Returns the length or
+ * SRL_DOC_LEN_NEED_MORE if more bytes are required to tell. Croaks if this
+ * is no Sereal document. */
+IV
+srl_decoder_document_length(pTHX_ const unsigned char *pv, STRLEN len)
+{
+    const unsigned char *end= pv + len;
+    const unsigned char *p;
+    IV version_encoding;
+    U8 encoding;
+    UV header_len;
+    UV body_len;
+    STRLEN used;
+
+    if (len < SRL_MAGIC_STRLEN + 3)
+        return SRL_DOC_LEN_NEED_MORE;
+
+    version_encoding= srl_validate_header_version(aTHX_ pv, len);
+    if (version_encoding < 1)
+        croak("Sereal: Error: Bad Sereal header: Not a valid Sereal document");
+    encoding= (U8)(version_encoding & SRL_PROTOCOL_ENCODING_MASK);
+
+    p= pv + SRL_MAGIC_STRLEN + 1;
+    if (!(used= srl_peek_varint(aTHX_ p, end, &header_len)))
+        return SRL_DOC_LEN_NEED_MORE;
+    p += used;
+    if (header_len > (UV)(end - p))
+        return SRL_DOC_LEN_NEED_MORE;
+    p += header_len;
+
+    if (encoding == SRL_PROTOCOL_ENCODING_RAW)
+        return srl_raw_body_end(aTHX_ pv, p, end);
+    if (encoding == SRL_PROTOCOL_ENCODING_SNAPPY)
+        return srl_snappy_stream_end(aTHX_ pv, p, end);
+
+    if (encoding == SRL_PROTOCOL_ENCODING_ZLIB) {
+        /* the uncompressed length comes first */
+        UV ignored;
+        if (!(used= srl_peek_varint(aTHX_ p, end, &ignored)))
+            return SRL_DOC_LEN_NEED_MORE;
+        p += used;
+    }
+    else
+    if (   encoding != SRL_PROTOCOL_ENCODING_SNAPPY_INCREMENTAL
+        && encoding != SRL_PROTOCOL_ENCODING_ZSTD)
+    {
+        croak("Sereal: Error: Sereal document encoded in an unknown format '%d'",
+              encoding >> SRL_PROTOCOL_VERSION_BITS);
+    }
+
+    if (!(used= srl_peek_varint(aTHX_ p, end, &body_len)))
+        return SRL_DOC_LEN_NEED_MORE;
+    p += used;
+
+    if (body_len > (UV)(IV_MAX - (p - pv)))
+        croak("Sereal: Error: compressed body length %"UVuf" is too big", body_len);
+    return (IV)(p - pv) + (IV)body_len;
+}
+
 SRL_STATIC_INLINE void
 srl_read_header(pTHX_ srl_decoder_t *dec, SV *header_user_data)
 {
@@ -664,6 +1151,91 @@ srl_read_header(pTHX_ srl_decoder_t *dec, SV *header_user_data)
     }
 }
 
+/* Can we bless the referent of obj by just setting its stash? This mirrors
+ * what sv_bless() does for a referent that is not an object yet, is not
+ * readonly and carries no set magic. Before 5.18 sv_bless() also had to
+ * maintain the per-reference overload flag, so there we always use it. */
+#ifndef SVf_PROTECT
+#  define SVf_PROTECT 0
+#endif
+#if PERL_VERSION >= 18
+#  ifdef HvSTASH_IS_CLASS
+#    define SRL_CAN_BLESS_FAST(obj, stash)                                          \
+        ( SvROK(obj) && !SvGMAGICAL(obj) && !HvSTASH_IS_CLASS(stash)                 \
+          && !(SvFLAGS(SvRV(obj)) & (SVs_OBJECT|SVf_READONLY|SVf_PROTECT|SVs_SMG))  \
+          && !SvIMMORTAL(SvRV(obj)) )
+#  else
+#    define SRL_CAN_BLESS_FAST(obj, stash)                                          \
+        ( SvROK(obj) && !SvGMAGICAL(obj)                                            \
+          && !(SvFLAGS(SvRV(obj)) & (SVs_OBJECT|SVf_READONLY|SVf_PROTECT|SVs_SMG))  \
+          && !SvIMMORTAL(SvRV(obj)) )
+#  endif
+#else
+#  define SRL_CAN_BLESS_FAST(obj, stash) 0
+#endif
+
+/* Bless (or, with no_bless_objects, just release) all objects of one batch.
+ * Objects that qualify get their stash set directly and the stash refcount
+ * is bumped once for all of them; we settle that debt before anything that
+ * might croak or run perl code, so the refcount is always right. */
+SRL_STATIC_INLINE void
+srl_bless_batch(pTHX_ srl_decoder_t *dec, srl_bless_batch_t *batch, int nobless)
+{
+    HV *stash= batch->stash;
+    UV blessed_fast= 0;
+
+    while (batch->len) {
+        /* pop first so a croak leaves no dangling entry for the cleanup */
+        SV *obj= batch->objs[--batch->len];
+
+        if (expect_false( SvREFCNT(obj) <= 1 )) {
+            /* It is possible that someone handcrafts a hash with a key collision,
+             * which could trick us into effectively blessing an object and then
+             * calling DESTROY on it. So we only bless objects that are still
+             * referenced from somewhere other than our batch. */
+            if (blessed_fast) {
+                SvREFCNT(stash) += blessed_fast;
+                blessed_fast= 0;
+            }
+            warn("serialization contains a duplicated key, ignoring");
+        }
+#if USE_588_WORKAROUND
+        /* was blessed early, don't rebless */
+#else
+        else
+        if (!nobless) {
+            SV *referent= SvRV(obj);
+            if (SRL_CAN_BLESS_FAST(obj, stash)) {
+                SvOBJECT_on(referent);
+                SvUPGRADE(referent, SVt_PVMG);
+                SvSTASH_set(referent, stash);
+                blessed_fast++;
+            }
+            else {
+                if (blessed_fast) {
+                    SvREFCNT(stash) += blessed_fast;
+                    blessed_fast= 0;
+                }
+                if ( SRL_DEC_HAVE_OPTION(dec, SRL_F_DECODER_READONLY_FLAGS) && SvROK(obj) && SvREADONLY(referent)) {
+                    /* the referenced scalar was readonly, temporary
+                       set it rw to bless its reference */
+                    SvREADONLY_off(referent);
+                    sv_bless(obj, stash);
+                    SvREADONLY_on(referent);
+                } else {
+                    sv_bless(obj, stash);
+                }
+            }
+            if (SRL_DEC_STATS(dec))
+                dec->stats->objects_blessed++;
+        }
+#endif
+        SvREFCNT_dec(obj);
+    }
+    if (blessed_fast)
+        SvREFCNT(stash) += blessed_fast;
+}
+
 SRL_STATIC_INLINE void
 srl_finalize_structure(pTHX_ srl_decoder_t *dec)
 {
@@ -672,58 +1244,17 @@ srl_finalize_structure(pTHX_ srl_decoder_t *dec)
     if (dec->weakref_av)
         av_clear(dec->weakref_av);
     if (dec->ref_stashes) {
-        /* The iterator could be leaked on exceptions if not for PTABLE_FLAG_AUTOCLEAN. */
-        PTABLE_ITER_t *it = PTABLE_iter_new_flags(dec->ref_stashes, PTABLE_FLAG_AUTOCLEAN);
-        PTABLE_ENTRY_t *ent;
+        srl_bless_batches_t *batches= dec->bless_batches;
+        UV i;
 
         /* We have gotten here without error, so bless all the objects.
          * We defer to the end like this so that we only bless data structures
          * if the entire deserialization completes. */
-        while ( NULL != (ent = PTABLE_iter_next(it)) ) {
-            HV *stash = (HV* )ent->value;
-            AV *ref_bless_av  = (AV *) PTABLE_fetch(dec->ref_bless_av, ent->key);
-            I32 len;
-            if (expect_false( !stash || !ref_bless_av )) {
-                PTABLE_iter_free(it);
-                SRL_RDR_ERROR(dec->pbuf, "missing stash or ref_bless_av!");
-            }
-            for( len= av_len(ref_bless_av) + 1 ; len > 0 ; len-- ) {
-                SV* obj= av_pop(ref_bless_av); /*note that av_pop does NOT refcnt dec the sv*/
-                if (SvREFCNT(obj)>1) {
-                    /* It is possible that someone handcrafts a hash with a key collision,
-                     * which could trick us into effectively blessing an object and then
-                     * calling DESTROY on it. So we track the refcount of the objects
-                     * popped off the ref_bless_av, and only bless if their refcount *before*
-                     * we refcount dec is higher than 1. If it is 1 then we just destroy the 
-                     * object.
-                     * */
-                    if (expect_true( obj )) {
-#if USE_588_WORKAROUND
-                        /* was blessed early, don't rebless */
-#else
-                        if (!nobless) {
-                            if ( SRL_DEC_HAVE_OPTION(dec, SRL_F_DECODER_READONLY_FLAGS) && SvREADONLY(SvRV(obj))) {
-                                /* the referenced scalar was readonly, temporary 
-                                   set it rw to bless its reference */
-                                SvREADONLY_off(SvRV(obj));
-                                sv_bless(obj, stash);
-                                SvREADONLY_on(SvRV(obj));
-                            } else {
-                                sv_bless(obj, stash);
-                            }
-                        }
-#endif
-                    } else {
-                        PTABLE_iter_free(it);
-                        SRL_RDR_ERROR(dec->pbuf, "object missing from ref_bless_av array?");
-                    }
-                } else {
-                    warn("serialization contains a duplicated key, ignoring");
-                }
-                SvREFCNT_dec(obj);
-            }
+        for (i= 0; i < batches->count; i++) {
+            if (expect_false( !batches->batch[i].stash ))
+                SRL_RDR_ERROR(dec->pbuf, "missing stash for pending objects!");
+            srl_bless_batch(aTHX_ dec, &batches->batch[i], nobless);
         }
-        PTABLE_iter_free(it);
     }
 }
 
@@ -734,8 +1265,8 @@ SRL_STATIC_INLINE void
 srl_track_thawed(srl_decoder_t *dec, const U8 *track_pos, SV *sv)
 {
     if (!dec->ref_thawhash)
-        dec->ref_thawhash = PTABLE_new();
-    PTABLE_store(dec->ref_thawhash, (void *)(track_pos - dec->buf.body_pos), (void *)sv);
+        dec->ref_thawhash = srl_otable_new();
+    srl_otable_store(dec->ref_thawhash, (UV)(track_pos - dec->buf.body_pos), (void *)sv);
 }
 
 
@@ -743,7 +1274,7 @@ SRL_STATIC_INLINE SV *
 srl_fetch_thawed(srl_decoder_t *dec, UV item)
 {
     if (dec->ref_thawhash) {
-        SV *sv= (SV *)PTABLE_fetch(dec->ref_thawhash, (void *)item);
+        SV *sv= (SV *)srl_otable_fetch(dec->ref_thawhash, item);
         return sv;
     } else {
         return NULL;
@@ -753,17 +1284,17 @@ srl_fetch_thawed(srl_decoder_t *dec, UV item)
 SRL_STATIC_INLINE void
 srl_track_sv(pTHX_ srl_decoder_t *dec, const U8 *track_pos, SV *sv)
 {
-    PTABLE_store(dec->ref_seenhash, (void *)(track_pos - dec->buf.body_pos), (void *)sv);
+    srl_otable_store(dec->ref_seenhash, (UV)(track_pos - dec->buf.body_pos), (void *)sv);
 }
 
 
 SRL_STATIC_INLINE SV *
 srl_fetch_item(pTHX_ srl_decoder_t *dec, UV item, const char * const tag_name)
 {
-    SV *sv= (SV *)PTABLE_fetch(dec->ref_seenhash, (void *)item);
+    SV *sv= (SV *)srl_otable_fetch(dec->ref_seenhash, item);
 #ifndef FOLLOW_REFERENCES_IF_NOT_STASHED
     if (expect_false( !sv )) {
-        /*srl_ptable_debug_dump(aTHX_ dec->ref_seenhash);*/
+        /*srl_otable_debug_dump(aTHX_ dec->ref_seenhash);*/
         SRL_RDR_ERRORf2(dec->pbuf, "%s(%"UVuf") references an unknown item", tag_name, item);
     }
 #endif
@@ -865,8 +1396,46 @@ srl_read_zigzag_into(pTHX_ srl_decoder_t *dec, SV* into, SV **container, const U
 }
 
 
+/* Replace the SV in a container slot with a shared readonly SV for the
+ * string of length len at the current position, see "alias_strings_under".
+ * The shared SVs are owned by a per-document hash keyed by the string. */
 SRL_STATIC_INLINE void
-srl_read_string(pTHX_ srl_decoder_t *dec, int is_utf8, SV* into)
+srl_alias_string(pTHX_ srl_decoder_t *dec, SV *into, SV **container, const U8 *track_it, STRLEN len, int is_utf8)
+{
+    HV **hvp= is_utf8 ? &dec->alias_utf8_strings_hv : &dec->alias_strings_hv;
+    SV **svp;
+    SV *alias;
+
+    if (expect_false( !*hvp ))
+        *hvp= newHV();
+
+    /* the key is always passed as bytes, which is why utf8 and binary
+     * strings go to different hashes */
+    svp= hv_fetch(*hvp, (char *)dec->buf.pos, len, 1);
+    if (expect_false( !svp ))
+        SRL_RDR_ERROR_PANIC(dec->pbuf, "failed to hv_store");
+    alias= *svp;
+
+    if (!SvREADONLY(alias)) {
+        /* first time we see this string in this document */
+        sv_setpvn(alias, (char *)dec->buf.pos, len);
+        if (is_utf8)
+            SvUTF8_on(alias);
+        SvREADONLY_on(alias);
+    }
+    dec->buf.pos += len;
+
+    SvREFCNT_inc(alias);
+    SvREFCNT_dec(into);
+    *container= alias;
+    if (track_it)
+        srl_track_sv(aTHX_ dec, track_it, alias);
+}
+
+/* Returns true if the string was aliased into the container, in which case
+ * into has been freed and must not be touched anymore. */
+SRL_STATIC_INLINE int
+srl_read_string(pTHX_ srl_decoder_t *dec, int is_utf8, SV* into, SV** container, const U8 *track_it)
 {
     UV len= srl_read_varint_uv_length(aTHX_ dec->pbuf, " while reading string");
     if (expect_false(is_utf8 && SRL_DEC_HAVE_OPTION(dec, SRL_F_DECODER_VALIDATE_UTF8))) {
@@ -875,6 +1444,12 @@ srl_read_string(pTHX_ srl_decoder_t *dec, int is_utf8, SV* into)
             SRL_RDR_ERROR(dec->pbuf, "Invalid UTF8 byte sequence");
         }
     }
+    if (SRL_DEC_STATS(dec))
+        dec->stats->tag_bytes[is_utf8 ? SRL_HDR_STR_UTF8 : SRL_HDR_BINARY] += len;
+    if (expect_false( container && len < dec->alias_strings_under )) {
+        srl_alias_string(aTHX_ dec, into, container, track_it, len, is_utf8);
+        return 1;
+    }
     sv_setpvn(into,(char *)dec->buf.pos,len);
     if (is_utf8) {
         SvUTF8_on(into);
@@ -882,6 +1457,7 @@ srl_read_string(pTHX_ srl_decoder_t *dec, int is_utf8, SV* into)
         SvUTF8_off(into);
     }
     dec->buf.pos+= len;
+    return 0;
 }
 
 /* declare a union so that we are guaranteed the right alignment
@@ -962,6 +1538,13 @@ srl_read_array(pTHX_ srl_decoder_t *dec, SV *into, U8 tag) {
 
         SRL_RDR_ASSERT_SPACE(dec->pbuf,len," while reading array contents, insufficient remaining tags for specified array size");
 
+        if (SRL_DEC_STATS(dec)) {
+            dec->stats->av_extend_calls++;
+            dec->stats->av_extend_elems += len;
+            if (len > dec->stats->av_extend_max)
+                dec->stats->av_extend_max= len;
+        }
+
         /* make sure the array has room */
         av_extend((AV*)into, len-1);
         /* set the size */
@@ -1020,6 +1603,13 @@ srl_read_hash(pTHX_ srl_decoder_t *dec, SV* into, U8 tag) {
 
     HvSHAREKEYS_on(into); /* apparently required on older perls */
 
+    if (SRL_DEC_STATS(dec)) {
+        dec->stats->hv_ksplit_calls++;
+        dec->stats->hv_ksplit_keys += num_keys;
+        if (num_keys > dec->stats->hv_ksplit_max)
+            dec->stats->hv_ksplit_max= num_keys;
+    }
+
     hv_ksplit((HV *)into, num_keys); /* make sure we have enough room */
     /* NOTE: contents of hash are stored VALUE/KEY, reverse from normal perl
      * storage, this is because it simplifies the hash storage logic somewhat */
@@ -1027,6 +1617,7 @@ srl_read_hash(pTHX_ srl_decoder_t *dec, SV* into, U8 tag) {
         const U8 *from;
         U8 tag;
         SV **fetched_sv;
+        NV t0= 0;
 #ifndef OLDHASH
         U32 flags= 0;
 #endif
@@ -1091,11 +1682,21 @@ srl_read_hash(pTHX_ srl_decoder_t *dec, SV* into, U8 tag) {
         if (SvREADONLY(into)) {
             SvREADONLY_off(into);
         }
+        if (SRL_DEC_STATS(dec))
+            t0= srl_dec_stats_now();
 #ifdef OLDHASH
         fetched_sv= hv_fetch((HV *)into, (char *)from, key_len, IS_LVALUE);
+        if (SRL_DEC_STATS(dec))
+            dec->stats->hash_key_bytes += key_len < 0 ? -key_len : key_len;
 #else
         fetched_sv= (SV **) hv_common((HV *)into, NULL, (char *)from, key_len, flags, HV_FETCH_LVALUE|HV_FETCH_JUST_SV, NULL, 0);
+        if (SRL_DEC_STATS(dec))
+            dec->stats->hash_key_bytes += key_len;
 #endif
+        if (SRL_DEC_STATS(dec)) {
+            dec->stats->hash_key_ns += srl_dec_stats_now() - t0;
+            dec->stats->hash_keys++;
+        }
         if (expect_false( !fetched_sv )) {
             SRL_RDR_ERROR_PANIC(dec->pbuf, "failed to hv_store");
         }
@@ -1173,10 +1774,10 @@ srl_follow_refp_alias_reference(pTHX_ srl_decoder_t *dec, UV offset)
     return into;
 }
 
-SRL_STATIC_INLINE AV *
+SRL_STATIC_INLINE UV
 srl_follow_objectv_reference(pTHX_ srl_decoder_t *dec, UV offset)
 {
-    AV *av= NULL;
+    UV batch_idx;
     srl_reader_char_ptr orig_pos = dec->buf.pos;
     srl_reader_char_ptr new_pos = dec->buf.body_pos + offset;
 
@@ -1184,15 +1785,15 @@ srl_follow_objectv_reference(pTHX_ srl_decoder_t *dec, UV offset)
         SRL_RDR_ERROR(dec->pbuf, "Corrupted packed. Reference offset points forward!");
     }
 
-    SRL_ASSERT_REF_PTR_TABLES(dec); /* init dec->ref_stashes and dec->ref_bless_av */
+    SRL_ASSERT_REF_PTR_TABLES(dec); /* init dec->ref_stashes and dec->ref_bless_batch */
 
     dec->buf.pos = new_pos;
     /* call srl_read_object() with read_class_name_only=1 */
     /* into and obj_tag are not used in this case */
     srl_read_object(aTHX_ dec, NULL, 0, 1);
-    av= (AV *)PTABLE_fetch(dec->ref_bless_av, (void *)offset);
+    batch_idx= PTR2UV(srl_otable_fetch(dec->ref_bless_batch, offset));
     dec->buf.pos = orig_pos;
-    return av;
+    return batch_idx;
 }
 
 SRL_STATIC_INLINE void
@@ -1267,7 +1868,7 @@ srl_read_weaken(pTHX_ srl_decoder_t *dec, SV* into)
 SRL_STATIC_INLINE void
 srl_read_objectv(pTHX_ srl_decoder_t *dec, SV* into, U8 obj_tag)
 {
-    AV *av= NULL;
+    UV batch_idx;
     STRLEN ofs;
 
     if (expect_false( SRL_DEC_HAVE_OPTION(dec, SRL_F_DECODER_REFUSE_OBJECTS) ))
@@ -1275,27 +1876,27 @@ srl_read_objectv(pTHX_ srl_decoder_t *dec, SV* into, U8 obj_tag)
 
     ofs= srl_read_varint_uv_offset(aTHX_ dec->pbuf, " while reading OBJECTV(_FREEZE) classname");
 
-    if (expect_false( !dec->ref_bless_av )) {
+    if (expect_false( !dec->ref_bless_batch )) {
 #ifdef FOLLOW_REFERENCES_IF_NOT_STASHED
-        SRL_ASSERT_REF_PTR_TABLES(dec); /* init dec->ref_stashes and dec->ref_bless_av */
+        SRL_ASSERT_REF_PTR_TABLES(dec); /* init dec->ref_stashes and dec->ref_bless_batch */
 #else
         SRL_RDR_ERROR(dec->pbuf, "Corrupted packet. OBJECTV(_FREEZE) used without "
                       "preceding OBJECT(_FREEZE) to define classname");
 #endif
     }
 
-    av= (AV *)PTABLE_fetch(dec->ref_bless_av, (void *)ofs);
-    if (expect_false( NULL == av )) {
+    batch_idx= PTR2UV(srl_otable_fetch(dec->ref_bless_batch, ofs));
+    if (expect_false( 0 == batch_idx )) {
 #ifdef FOLLOW_REFERENCES_IF_NOT_STASHED
-        av = srl_follow_objectv_reference(aTHX_ dec, (UV) ofs);
-        if (expect_false( NULL == av ))
+        batch_idx = srl_follow_objectv_reference(aTHX_ dec, (UV) ofs);
+        if (expect_false( 0 == batch_idx ))
 #endif
             SRL_RDR_ERRORf1(dec->pbuf, "Corrupted packet. OBJECTV(_FREEZE) references unknown classname offset: %"UVuf, (UV)ofs);
     }
 
     /* checking tag: SRL_HDR_OBJECTV_FREEZE or SRL_HDR_OBJECTV? */
     if (expect_false( obj_tag == SRL_HDR_OBJECTV_FREEZE )) {
-        HV *class_stash= (HV *) PTABLE_fetch(dec->ref_stashes, (void *)ofs);
+        HV *class_stash= (HV *) srl_otable_fetch(dec->ref_stashes, ofs);
         if (expect_false( class_stash == NULL ))
             SRL_RDR_ERROR(dec->pbuf, "Corrupted packet. OBJECTV(_FREEZE) used without "
                       "preceding OBJECT(_FREEZE) to define classname");
@@ -1305,13 +1906,13 @@ srl_read_objectv(pTHX_ srl_decoder_t *dec, SV* into, U8 obj_tag)
         /* now deparse the thing we are going to bless */
         srl_read_single_value(aTHX_ dec, into, NULL);
 
-        /* and also stuff it into the av - we dont have to do any more book-keeping */
-        av_push(av, SvREFCNT_inc(into));
+        /* and also queue it for blessing - we dont have to do any more book-keeping */
+        srl_bless_batch_push(dec->bless_batches, batch_idx - 1, SvREFCNT_inc(into));
 
 #if USE_588_WORKAROUND
         {
             /* See 'define USE_588_WORKAROUND' above for a discussion of what this does. */
-            HV *class_stash= PTABLE_fetch(dec->ref_stashes, (void *)ofs);
+            HV *class_stash= (HV *) srl_otable_fetch(dec->ref_stashes, ofs);
             if (expect_false( class_stash == NULL ))
                 SRL_RDR_ERROR(dec->pbuf, "Corrupted packet. OBJECTV(_FREEZE) used without "
                               "preceding OBJECT(_FREEZE) to define classname");
@@ -1326,7 +1927,7 @@ SRL_STATIC_INLINE void
 srl_read_object(pTHX_ srl_decoder_t *dec, SV* into, U8 obj_tag, int read_class_name_only)
 {
     HV *class_stash= NULL;
-    AV *av= NULL;
+    UV batch_idx= 0;
     STRLEN storepos= 0;
     UV ofs= 0;
     I32 flags= GV_ADD;
@@ -1379,7 +1980,7 @@ srl_read_object(pTHX_ srl_decoder_t *dec, SV* into, U8 obj_tag, int read_class_n
          * anymore. So first we check if we have a stash. If we do, then we can avoid
          * some work. */
         if (expect_true( dec->ref_stashes != NULL )) {
-            class_stash= (HV *) PTABLE_fetch(dec->ref_stashes, (void *)ofs);
+            class_stash= (HV *) srl_otable_fetch(dec->ref_stashes, ofs);
         }
         /* Check if we actually got a class_stash back. If we didn't then we need
          * to deserialize the class name */
@@ -1423,23 +2024,22 @@ srl_read_object(pTHX_ srl_decoder_t *dec, SV* into, U8 obj_tag, int read_class_n
     if (!class_stash) {
         /* no class stash - so we need to look it up and then store it away for future use */
         class_stash= gv_stashpvn((char *)from, key_len, flags);
-        PTABLE_store(dec->ref_stashes, (void *)storepos, (void *)class_stash);
+        srl_otable_store(dec->ref_stashes, storepos, (void *)class_stash);
         /* Since this is the first time we have seen this stash then it is the first time
-         * that we have stored an item in the ref_bless_av hash as well. So create a new one
-         * and store it away. */
-        av= newAV();
-        sv_2mortal((SV*)av);
-        PTABLE_store(dec->ref_bless_av, (void *)storepos, (void *)av);
+         * that we have needed a bless batch for it as well. So start a new one and
+         * remember its index (plus one, so that 0 means "none"). */
+        batch_idx= srl_bless_batch_new(dec->bless_batches, class_stash) + 1;
+        srl_otable_store(dec->ref_bless_batch, storepos, INT2PTR(void *, batch_idx));
     } else {
-        /* we have a class stash so we should have a ref_bless_av as well. */
-        av= (AV *)PTABLE_fetch(dec->ref_bless_av, (void *)storepos);
-        if ( !av )
-            SRL_RDR_ERRORf1(dec->pbuf, "Panic, no ref_bless_av for %"UVuf, (UV)storepos);
+        /* we have a class stash so we should have a bless batch as well. */
+        batch_idx= PTR2UV(srl_otable_fetch(dec->ref_bless_batch, storepos));
+        if ( !batch_idx )
+            SRL_RDR_ERRORf1(dec->pbuf, "Panic, no bless batch for %"UVuf, (UV)storepos);
     }
 
 #ifdef FOLLOW_REFERENCES_IF_NOT_STASHED
     /* at this point we have class name read and have coressponding records in
-     * dec->dec->ref_stashes and dec->ref_bless_av. So, we can simply fetch
+     * dec->dec->ref_stashes and dec->ref_bless_batch. So, we can simply fetch
      * from hashes outside this function. The code */
     if (read_class_name_only) return;
 #else
@@ -1456,7 +2056,7 @@ srl_read_object(pTHX_ srl_decoder_t *dec, SV* into, U8 obj_tag, int read_class_n
          * we really dont want to trigger DESTROY methods from a partial
          * deparse. So we insert the item into an array to be blessed later. */
         SRL_DEC_SET_OPTION(dec, SRL_F_DECODER_NEEDS_FINALIZE);
-        av_push(av, SvREFCNT_inc(into));
+        srl_bless_batch_push(dec->bless_batches, batch_idx - 1, SvREFCNT_inc(into));
 
         /* now deparse the thing we are going to bless */
         srl_read_single_value(aTHX_ dec, into, NULL);
@@ -1507,6 +2107,7 @@ srl_read_frozen_object(pTHX_ srl_decoder_t *dec, HV *class_stash, SV *into)
         int count;
         AV *arg_av= (AV*)SvRV(into);
         int arg_av_len = av_len(arg_av)+1;
+        NV t0= 0;
         dSP;
 
         ENTER;
@@ -1524,7 +2125,13 @@ srl_read_frozen_object(pTHX_ srl_decoder_t *dec, HV *class_stash, SV *into)
         }
 
         PUTBACK;
+        if (SRL_DEC_STATS(dec))
+            t0= srl_dec_stats_now();
         count = call_sv((SV *)GvCV(method), G_SCALAR);
+        if (SRL_DEC_STATS(dec)) {
+            dec->stats->thaw_ns += srl_dec_stats_now() - t0;
+            dec->stats->thaw_calls++;
+        }
         /* TODO explore method lookup caching */
         SPAGAIN;
 
@@ -1685,6 +2292,51 @@ srl_read_extend(pTHX_ srl_decoder_t *dec, SV* into)
     return into;
 }
 
+/* Handle a COPY tag in a container when "alias_copied_strings" is on: all
+ * COPYs of the same string share one readonly SV. Returns false without
+ * consuming any input if the COPY does not point at a string, in which
+ * case the caller should fall back to srl_read_copy(). */
+SRL_STATIC_INLINE int
+srl_read_copy_alias(pTHX_ srl_decoder_t *dec, SV* into, SV** container, const U8 *track_it)
+{
+    const U8 *orig_pos= dec->buf.pos;
+    UV item= srl_read_varint_uv_offset(aTHX_ dec->pbuf, " while reading COPY tag");
+    SV *alias;
+    U8 tag;
+
+    if (expect_false( (IV)item >= dec->buf.end - dec->buf.body_pos )) {
+        /* let srl_read_copy() complain about it */
+        dec->buf.pos= orig_pos;
+        return 0;
+    }
+    tag= dec->buf.body_pos[item] & ~SRL_HDR_TRACK_FLAG;
+    if (!( IS_SRL_HDR_SHORT_BINARY(tag) || tag == SRL_HDR_BINARY || tag == SRL_HDR_STR_UTF8 )) {
+        dec->buf.pos= orig_pos;
+        return 0;
+    }
+
+    if (expect_false( !dec->ref_copy_alias ))
+        dec->ref_copy_alias= srl_otable_new();
+
+    alias= (SV *)srl_otable_fetch(dec->ref_copy_alias, item);
+    if (!alias) {
+        /* Mortal, so that it goes away with
+         * the current statement even if we croak before using it. */
+        alias= sv_2mortal(FRESH_SV());
+        dec->buf.pos= orig_pos;
+        srl_read_copy(aTHX_ dec, alias);
+        SvREADONLY_on(alias);
+        srl_otable_store(dec->ref_copy_alias, item, (void *)alias);
+    }
+
+    SvREFCNT_inc(alias);
+    SvREFCNT_dec(into);
+    *container= alias;
+    if (track_it)
+        srl_track_sv(aTHX_ dec, track_it, alias);
+    return 1;
+}
+
 SRL_STATIC_INLINE void
 srl_read_copy(pTHX_ srl_decoder_t *dec, SV* into)
 {
@@ -1729,6 +2381,8 @@ srl_read_single_value(pTHX_ srl_decoder_t *dec, SV* into, SV** container)
     tag= *dec->buf.pos++;
 
   read_tag:
+    if (SRL_DEC_STATS(dec) && !(tag & SRL_HDR_TRACK_FLAG))
+        dec->stats->tag_count[tag]++;
     switch (tag) {
         CASE_SRL_HDR_POS:
             srl_setiv(aTHX_ dec, into, container, track_it, (IV)tag);
@@ -1739,6 +2393,12 @@ srl_read_single_value(pTHX_ srl_decoder_t *dec, SV* into, SV** container)
         CASE_SRL_HDR_SHORT_BINARY:
             len= (STRLEN)SRL_HDR_SHORT_BINARY_LEN_FROM_TAG(tag);
             SRL_RDR_ASSERT_SPACE(dec->pbuf, len, " while reading ascii string");
+            if (SRL_DEC_STATS(dec))
+                dec->stats->tag_bytes[tag] += len;
+            if (expect_false( container && len < dec->alias_strings_under )) {
+                srl_alias_string(aTHX_ dec, into, container, track_it, len, 0);
+                return;
+            }
             sv_setpvn(into,(char*)dec->buf.pos,len);
             dec->buf.pos += len;
             break;
@@ -1768,8 +2428,14 @@ srl_read_single_value(pTHX_ srl_decoder_t *dec, SV* into, SV** container)
         }
         break;
 
-        case SRL_HDR_BINARY:        srl_read_string(aTHX_ dec, 0, into);              break;
-        case SRL_HDR_STR_UTF8:      srl_read_string(aTHX_ dec, 1, into);              break;
+        case SRL_HDR_BINARY:
+            if (srl_read_string(aTHX_ dec, 0, into, container, track_it))
+                return;
+            break;
+        case SRL_HDR_STR_UTF8:
+            if (srl_read_string(aTHX_ dec, 1, into, container, track_it))
+                return;
+            break;
 
         case SRL_HDR_WEAKEN:        srl_read_weaken(aTHX_ dec, into);       is_ref=1; break;
         case SRL_HDR_REFN:          srl_read_refn(aTHX_ dec, into);         is_ref=1; break;
@@ -1778,7 +2444,12 @@ srl_read_single_value(pTHX_ srl_decoder_t *dec, SV* into, SV** container)
         case SRL_HDR_OBJECT:        srl_read_object(aTHX_ dec, into, tag, 0); is_ref=1; break;
         case SRL_HDR_OBJECTV_FREEZE:
         case SRL_HDR_OBJECTV:       srl_read_objectv(aTHX_ dec, into, tag); is_ref=1; break;
-        case SRL_HDR_COPY:          srl_read_copy(aTHX_ dec, into);                   break;
+        case SRL_HDR_COPY:
+            if (expect_false( container && SRL_DEC_HAVE_OPTION(dec, SRL_F_DECODER_ALIAS_COPIED_STRINGS) )
+                && srl_read_copy_alias(aTHX_ dec, into, container, track_it))
+                return;
+            srl_read_copy(aTHX_ dec, into);
+            break;
         case SRL_HDR_EXTEND:        srl_read_extend(aTHX_ dec, into);                 break;
         case SRL_HDR_HASH:          srl_read_hash(aTHX_ dec, into, 0);                break;
         case SRL_HDR_ARRAY:         srl_read_array(aTHX_ dec, into, 0);               break;
@@ -6,8 +6,39 @@
 #include "assert.h"
 #include "srl_reader_types.h"
 
-typedef struct PTABLE * ptable_ptr;
+typedef struct srl_otable * srl_otable_ptr;
 typedef struct srl_decoder srl_decoder_t;
+typedef struct srl_decoder_cache * srl_decoder_cache_ptr;
+typedef struct srl_bless_batches * srl_bless_batches_ptr;
+typedef struct srl_decoder_stats srl_decoder_stats_t;
+
+/* Opt-in counters, see the "collect_stats" option. Times are in nanoseconds
+ * and stay zero on platforms without a monotonic clock. */
+struct srl_decoder_stats {
+    UV documents;                       /* documents (bodies and headers) decoded */
+    UV cache_hits;                      /* documents served from the document cache */
+    UV tag_count[128];                  /* values decoded, by tag without the track bit */
+    UV tag_bytes[128];                  /* string payload bytes copied, by tag */
+
+    UV hash_keys;                       /* hash keys stored */
+    UV hash_key_bytes;                  /* hash key bytes stored */
+    NV hash_key_ns;                     /* time spent hashing and storing keys */
+    UV hv_ksplit_calls;                 /* hashes presized */
+    UV hv_ksplit_keys;                  /* sum of the presized key counts */
+    UV hv_ksplit_max;                   /* largest presized key count */
+    UV av_extend_calls;                 /* arrays presized */
+    UV av_extend_elems;                 /* sum of the presized element counts */
+    UV av_extend_max;                   /* largest presized element count */
+
+    UV decompressed_documents;          /* compressed documents seen */
+    UV decompress_bytes_in;             /* compressed bytes consumed */
+    UV decompress_bytes_out;            /* decompressed body bytes produced */
+    NV decompress_ns;                   /* time spent decompressing */
+
+    UV objects_blessed;                 /* objects blessed in srl_finalize_structure */
+    UV thaw_calls;                      /* THAW callbacks invoked */
+    NV thaw_ns;                         /* time spent in THAW callbacks */
+};
 
 struct srl_decoder {
     srl_reader_buffer_t buf;
@@ -17,14 +48,22 @@ struct srl_decoder {
     U32 flags;                          /* flag-like options: See SRL_F_DECODER_* defines in srl_decoder.c */
     UV max_recursion_depth;             /* Configurable limit on the number of recursive calls we're willing to make */
     UV max_num_hash_entries;            /* Configured maximum number of acceptable entries in a hash */
-    ptable_ptr ref_seenhash;            /* ptr table for avoiding circular refs */
-    ptable_ptr ref_thawhash;          /* ptr table for dealing with non ref thawed items */
-    ptable_ptr ref_stashes;             /* ptr table for tracking stashes we will bless into - key: ofs, value: stash */
-    ptable_ptr ref_bless_av;            /* ptr table for tracking which objects need to be bless - key: ofs, value: mortal AV (of refs)  */
+    srl_otable_ptr ref_seenhash;        /* offset table for avoiding circular refs, see srl_decoder_otable.h */
+    srl_otable_ptr ref_thawhash;        /* offset table for dealing with non ref thawed items */
+    srl_otable_ptr ref_stashes;         /* offset table for tracking stashes we will bless into - key: ofs, value: stash */
+    srl_otable_ptr ref_bless_batch;     /* offset table for tracking which objects need to be bless - key: ofs, value: batch index + 1 */
+    srl_bless_batches_ptr bless_batches; /* objects pending blessing, see srl_decoder_bless.h */
     AV* weakref_av;
 
     AV* alias_cache; /* used to cache integers of different sizes. */
     IV alias_varint_under;
+    srl_otable_ptr ref_copy_alias;      /* offset table for sharing COPY targets - key: ofs, value: mortal readonly SV */
+    HV* alias_strings_hv;               /* shared readonly SVs for short binary strings, per document */
+    HV* alias_utf8_strings_hv;          /* shared readonly SVs for short utf8 strings, per document */
+    UV alias_strings_under;             /* strings shorter than this are aliased, 0 == off */
+
+    srl_decoder_cache_ptr doc_cache;    /* LRU cache of whole decoded documents, see srl_decoder_cache.h */
+    srl_decoder_stats_t *stats;         /* opt-in instrumentation counters, NULL if off */
 
     UV bytes_consumed;
     UV recursion_depth;                 /* Recursion depth of current decoder */
@@ -57,6 +96,18 @@ void srl_decode_single_value(pTHX_ srl_decoder_t *dec, SV* into, SV** container)
 /* Explicit destructor */
 void srl_destroy_decoder(pTHX_ srl_decoder_t *dec);
 
+/* length of the document at the start of a buffer, see decode_from_fh */
+#define SRL_DOC_LEN_NEED_MORE -1
+IV srl_decoder_document_length(pTHX_ const unsigned char *pv, STRLEN len);
+
+/* document cache introspection - see the "cache_documents" option */
+HV *srl_decoder_cache_stats(pTHX_ srl_decoder_t *dec);
+void srl_decoder_cache_reset(pTHX_ srl_decoder_t *dec);
+
+/* instrumentation introspection - see the "collect_stats" option */
+HV *srl_decoder_stats_hv(pTHX_ srl_decoder_t *dec);
+void srl_decoder_stats_reset(pTHX_ srl_decoder_t *dec);
+
 /* clean up after each document body */
 void srl_clear_decoder_body_state(pTHX_ srl_decoder_t *dec);
 
@@ -126,6 +177,10 @@ void srl_decoder_destructor_hook(pTHX_ void *p);
 #define SRL_F_DECODER_DECOMPRESS_ZSTD           0x00020000UL
 /* Persistent flag: Make the decoder REFUSE zstd-compressed documents */
 #define SRL_F_DECODER_REFUSE_ZSTD               0x00040000UL
+/* Persistent flag: alias strings reached via COPY in Hashes and Arrays */
+#define SRL_F_DECODER_ALIAS_COPIED_STRINGS      0x00080000UL
+/* Persistent flag: the stats counters belong to the decoder this one was cloned from */
+#define SRL_F_DECODER_STATS_BORROWED            0x00100000UL
 
 
 #define SRL_F_DECODER_ALIAS_CHECK_FLAGS   ( SRL_F_DECODER_ALIAS_SMALLINT | SRL_F_DECODER_ALIAS_VARINT | SRL_F_DECODER_USE_UNDEF )
@@ -196,10 +251,25 @@ void srl_decoder_destructor_hook(pTHX_ void *p);
 #define SRL_DEC_OPT_STR_REFUSE_ZSTD                 "refuse_zstd"
 #define SRL_DEC_OPT_IDX_REFUSE_ZSTD                 13
 
+#define SRL_DEC_OPT_STR_CACHE_DOCUMENTS             "cache_documents"
+#define SRL_DEC_OPT_IDX_CACHE_DOCUMENTS             14
+
+#define SRL_DEC_OPT_STR_CACHE_MAX_BYTES             "cache_max_bytes"
+#define SRL_DEC_OPT_IDX_CACHE_MAX_BYTES             15
+
+#define SRL_DEC_OPT_STR_ALIAS_COPIED_STRINGS        "alias_copied_strings"
+#define SRL_DEC_OPT_IDX_ALIAS_COPIED_STRINGS        16
+
+#define SRL_DEC_OPT_STR_ALIAS_STRINGS_UNDER         "alias_strings_under"
+#define SRL_DEC_OPT_IDX_ALIAS_STRINGS_UNDER         17
+
+#define SRL_DEC_OPT_STR_COLLECT_STATS               "collect_stats"
+#define SRL_DEC_OPT_IDX_COLLECT_STATS               18
+
 /* NOTE WELL: WHEN YOU ADD AN OPTION YOU **MUST** ADD A
  * CORRESPONDING CALL TO SRL_INIT_OPTION() to Decoder.xs */
 
-#define SRL_DEC_OPT_COUNT                           14
+#define SRL_DEC_OPT_COUNT                           19
 
 #if ((PERL_VERSION > 10) || (PERL_VERSION == 10 && PERL_SUBVERSION > 1 ))
 #   define MODERN_REGEXP
@@ -0,0 +1,108 @@
+#ifndef SRL_DECODER_BLESS_H_
+#define SRL_DECODER_BLESS_H_
+
+/* Objects waiting to be blessed at the end of a decode.
+ *
+ * We defer blessing until the whole document has been read so that no
+ * DESTROY method can run on a partially deserialized structure. Every
+ * class name seen in the document gets one batch: the stash plus a plain
+ * C vector of the RVs to bless into it, each holding one refcount.
+ *
+ * The batches and their vectors belong to the decoder and are reused from
+ * one document to the next, so a long running decoder stops allocating
+ * for them once it has seen its largest document. Vectors that grew past
+ * SRL_BLESS_BATCH_KEEP_MAX are released again after the document so that
+ * one huge document does not pin its memory forever.
+ *
+ * Batches are referred to by index, not by pointer, because the batch
+ * array itself may be reallocated while the document is being read.
+ */
+
+typedef struct srl_bless_batch srl_bless_batch_t;
+typedef struct srl_bless_batches srl_bless_batches_t;
+
+struct srl_bless_batch {
+    HV *stash;                          /* stash to bless into, not refcounted */
+    SV **objs;                          /* RVs to bless, one refcount each */
+    UV len;                             /* number of RVs pending */
+    UV size;                            /* allocated size of objs */
+};
+
+struct srl_bless_batches {
+    srl_bless_batch_t *batch;
+    UV count;                           /* batches in use for this document */
+    UV size;                            /* batches allocated */
+};
+
+#define SRL_BLESS_BATCH_KEEP_MAX (64 * 1024)
+
+/* Start a new batch for stash, returns its index. */
+SRL_STATIC_INLINE UV
+srl_bless_batch_new(srl_bless_batches_t *batches, HV *stash)
+{
+    srl_bless_batch_t *batch;
+
+    if (batches->count == batches->size) {
+        UV new_size= batches->size ? batches->size * 2 : 8;
+        Renew(batches->batch, new_size, srl_bless_batch_t);
+        Zero(batches->batch + batches->size, new_size - batches->size, srl_bless_batch_t);
+        batches->size= new_size;
+    }
+    batch= &batches->batch[batches->count];
+    batch->stash= stash;
+    batch->len= 0;
+    return batches->count++;
+}
+
+/* Queue obj for blessing, takes over one refcount of it. */
+SRL_STATIC_INLINE void
+srl_bless_batch_push(srl_bless_batches_t *batches, UV idx, SV *obj)
+{
+    srl_bless_batch_t *batch= &batches->batch[idx];
+
+    if (expect_false( batch->len == batch->size )) {
+        batch->size= batch->size ? batch->size * 2 : 16;
+        Renew(batch->objs, batch->size, SV *);
+    }
+    batch->objs[batch->len++]= obj;
+}
+
+/* Release whatever is still pending (after an exception, or when the
+ * objects were never blessed) and make the batches ready for the next
+ * document. */
+SRL_STATIC_INLINE void
+srl_bless_batches_clear(pTHX_ srl_bless_batches_t *batches)
+{
+    UV i;
+
+    for (i= 0; i < batches->count; i++) {
+        srl_bless_batch_t *batch= &batches->batch[i];
+
+        while (batch->len) {
+            SV *obj= batch->objs[--batch->len];
+            SvREFCNT_dec(obj);
+        }
+        if (batch->size > SRL_BLESS_BATCH_KEEP_MAX) {
+            Safefree(batch->objs);
+            batch->objs= NULL;
+            batch->size= 0;
+        }
+        batch->stash= NULL;
+    }
+    batches->count= 0;
+}
+
+SRL_STATIC_INLINE void
+srl_bless_batches_free(pTHX_ srl_bless_batches_t *batches)
+{
+    UV i;
+
+    srl_bless_batches_clear(aTHX_ batches);
+    for (i= 0; i < batches->size; i++)
+        Safefree(batches->batch[i].objs);
+    Safefree(batches->batch);
+    batches->batch= NULL;
+    batches->size= 0;
+}
+
+#endif
@@ -0,0 +1,211 @@
+#ifndef SRL_DECODER_CACHE_H_
+#define SRL_DECODER_CACHE_H_
+
+/* Bounded LRU cache of decoded documents, keyed by the raw bytes of the
+ * document. Used by the "cache_documents" decoder option.
+ *
+ * Entries are found through a chained hash table indexed by the XXH64
+ * hash of the document, and kept in a doubly linked list ordered from
+ * most to least recently used. Every entry keeps a private copy of the
+ * raw document so that a hash collision can never hand out the wrong
+ * structure - the memcmp() on a hit runs at memory bandwidth, which is
+ * still far cheaper than a full decode.
+ *
+ * The cached values are built with set_readonly semantics and are shared
+ * between all callers that get a hit.
+ */
+
+#include "srl_xxhash.h"
+
+typedef struct srl_decoder_cache_entry srl_decoder_cache_entry_t;
+typedef struct srl_decoder_cache srl_decoder_cache_t;
+
+struct srl_decoder_cache_entry {
+    srl_decoder_cache_entry_t *bucket_next; /* next entry in the same hash bucket */
+    srl_decoder_cache_entry_t *lru_prev;    /* more recently used entry */
+    srl_decoder_cache_entry_t *lru_next;    /* less recently used entry */
+    XXH64_hash_t hash;                      /* XXH64 of the raw document */
+    STRLEN len;                             /* length of the raw document */
+    char *doc;                              /* private copy of the raw document */
+    UV bytes_consumed;                      /* what bytes_consumed reported for it */
+    SV *value;                              /* the (readonly) decoded structure */
+};
+
+struct srl_decoder_cache {
+    srl_decoder_cache_entry_t **buckets;
+    UV bucket_mask;                         /* number of buckets - 1, power of two */
+    srl_decoder_cache_entry_t *lru_head;    /* most recently used */
+    srl_decoder_cache_entry_t *lru_tail;    /* least recently used, evicted first */
+
+    UV max_entries;                         /* hard limit on the number of entries */
+    UV max_bytes;                           /* limit on the summed size of cached documents, 0 == none */
+    UV entries;
+    UV bytes;
+
+    UV hits;
+    UV misses;
+    UV evictions;
+};
+
+/* size we account for per entry on top of the raw document itself */
+#define SRL_DEC_CACHE_ENTRY_OVERHEAD (sizeof(srl_decoder_cache_entry_t))
+#define SRL_DEC_CACHE_MAX_BUCKETS (1 << 20)
+
+SRL_STATIC_INLINE srl_decoder_cache_t *
+srl_decoder_cache_new(UV max_entries, UV max_bytes)
+{
+    srl_decoder_cache_t *cache;
+    UV nbuckets= 8;
+
+    /* aim for a load factor of at most 1, but don't go overboard
+     * preallocating buckets for absurd limits */
+    while (nbuckets < max_entries && nbuckets < SRL_DEC_CACHE_MAX_BUCKETS)
+        nbuckets <<= 1;
+
+    Newxz(cache, 1, srl_decoder_cache_t);
+    Newxz(cache->buckets, nbuckets, srl_decoder_cache_entry_t *);
+    cache->bucket_mask= nbuckets - 1;
+    cache->max_entries= max_entries;
+    cache->max_bytes= max_bytes;
+    return cache;
+}
+
+SRL_STATIC_INLINE void
+srl_decoder_cache_lru_unlink(srl_decoder_cache_t *cache, srl_decoder_cache_entry_t *ent)
+{
+    if (ent->lru_prev)
+        ent->lru_prev->lru_next= ent->lru_next;
+    else
+        cache->lru_head= ent->lru_next;
+
+    if (ent->lru_next)
+        ent->lru_next->lru_prev= ent->lru_prev;
+    else
+        cache->lru_tail= ent->lru_prev;
+
+    ent->lru_prev= ent->lru_next= NULL;
+}
+
+SRL_STATIC_INLINE void
+srl_decoder_cache_lru_push_front(srl_decoder_cache_t *cache, srl_decoder_cache_entry_t *ent)
+{
+    ent->lru_prev= NULL;
+    ent->lru_next= cache->lru_head;
+    if (cache->lru_head)
+        cache->lru_head->lru_prev= ent;
+    else
+        cache->lru_tail= ent;
+    cache->lru_head= ent;
+}
+
+SRL_STATIC_INLINE void
+srl_decoder_cache_entry_free(pTHX_ srl_decoder_cache_entry_t *ent)
+{
+    SvREFCNT_dec(ent->value);
+    Safefree(ent->doc);
+    Safefree(ent);
+}
+
+/* Remove an entry from the bucket chain and the LRU list and free it. */
+SRL_STATIC_INLINE void
+srl_decoder_cache_delete(pTHX_ srl_decoder_cache_t *cache, srl_decoder_cache_entry_t *ent)
+{
+    srl_decoder_cache_entry_t **link= &cache->buckets[ent->hash & cache->bucket_mask];
+
+    while (*link != ent)
+        link= &(*link)->bucket_next;
+    *link= ent->bucket_next;
+
+    srl_decoder_cache_lru_unlink(cache, ent);
+    cache->entries--;
+    cache->bytes -= ent->len + SRL_DEC_CACHE_ENTRY_OVERHEAD;
+    srl_decoder_cache_entry_free(aTHX_ ent);
+}
+
+/* Look up a document. On a hit the entry becomes the most recently used one. */
+SRL_STATIC_INLINE srl_decoder_cache_entry_t *
+srl_decoder_cache_fetch(srl_decoder_cache_t *cache, XXH64_hash_t hash, const char *doc, STRLEN len)
+{
+    srl_decoder_cache_entry_t *ent= cache->buckets[hash & cache->bucket_mask];
+
+    for ( ; ent ; ent= ent->bucket_next) {
+        if (ent->hash == hash && ent->len == len && memEQ(ent->doc, doc, len)) {
+            if (ent != cache->lru_head) {
+                srl_decoder_cache_lru_unlink(cache, ent);
+                srl_decoder_cache_lru_push_front(cache, ent);
+            }
+            cache->hits++;
+            return ent;
+        }
+    }
+    cache->misses++;
+    return NULL;
+}
+
+/* Store a freshly decoded document, evicting least recently used entries
+ * until it fits. Takes over ownership of one refcount of value. Documents
+ * that would not fit into an empty cache are not stored at all. */
+SRL_STATIC_INLINE void
+srl_decoder_cache_store(pTHX_ srl_decoder_cache_t *cache, XXH64_hash_t hash,
+                        const char *doc, STRLEN len, UV bytes_consumed, SV *value)
+{
+    srl_decoder_cache_entry_t *ent;
+    srl_decoder_cache_entry_t **bucket;
+    const UV size= len + SRL_DEC_CACHE_ENTRY_OVERHEAD;
+
+    if (cache->max_entries == 0 || (cache->max_bytes && size > cache->max_bytes)) {
+        SvREFCNT_dec(value);
+        return;
+    }
+
+    while (cache->lru_tail &&
+           ( cache->entries >= cache->max_entries
+             || (cache->max_bytes && cache->bytes + size > cache->max_bytes) ))
+    {
+        srl_decoder_cache_delete(aTHX_ cache, cache->lru_tail);
+        cache->evictions++;
+    }
+
+    Newxz(ent, 1, srl_decoder_cache_entry_t);
+    Newx(ent->doc, len ? len : 1, char);
+    Copy(doc, ent->doc, len, char);
+    ent->hash= hash;
+    ent->len= len;
+    ent->bytes_consumed= bytes_consumed;
+    ent->value= value;
+
+    bucket= &cache->buckets[hash & cache->bucket_mask];
+    ent->bucket_next= *bucket;
+    *bucket= ent;
+    srl_decoder_cache_lru_push_front(cache, ent);
+
+    cache->entries++;
+    cache->bytes += size;
+}
+
+/* Drop all entries, keep the configuration and the counters. */
+SRL_STATIC_INLINE void
+srl_decoder_cache_clear(pTHX_ srl_decoder_cache_t *cache)
+{
+    srl_decoder_cache_entry_t *ent= cache->lru_head;
+
+    while (ent) {
+        srl_decoder_cache_entry_t *next= ent->lru_next;
+        srl_decoder_cache_entry_free(aTHX_ ent);
+        ent= next;
+    }
+    Zero(cache->buckets, cache->bucket_mask + 1, srl_decoder_cache_entry_t *);
+    cache->lru_head= cache->lru_tail= NULL;
+    cache->entries= 0;
+    cache->bytes= 0;
+}
+
+SRL_STATIC_INLINE void
+srl_decoder_cache_free(pTHX_ srl_decoder_cache_t *cache)
+{
+    srl_decoder_cache_clear(aTHX_ cache);
+    Safefree(cache->buckets);
+    Safefree(cache);
+}
+
+#endif
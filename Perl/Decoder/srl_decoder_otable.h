@@ -0,0 +1,166 @@
+#ifndef SRL_DECODER_OTABLE_H_
+#define SRL_DECODER_OTABLE_H_
+
+/* Offset table: maps body offsets of tracked items to pointers.
+ *
+ * This replaces the PTABLEs the decoder used for its per-document tracking
+ * (ref_seenhash, ref_thawhash, ...). The keys are body offsets, so they
+ * are dense, never 0 and bounded by the body length, and the table gets
+ * thrown away after every document. That makes an open addressing table
+ * with linear probing a better fit than the chained PTABLE:
+ *
+ *  - no per-entry allocation: all slots live in one array that the decoder
+ *    keeps from one document to the next,
+ *  - resetting is O(1): every slot carries the generation it was written
+ *    in, and clearing the table just bumps the current generation. Slots
+ *    from an older generation count as empty.
+ *
+ * Tables that grew past SRL_OTABLE_KEEP_MAX slots for one unusually big
+ * document are shrunk back on reset so they don't pin that memory forever.
+ */
+
+typedef struct srl_otable_entry srl_otable_entry_t;
+typedef struct srl_otable srl_otable_t;
+
+struct srl_otable_entry {
+    UV key;
+    void *value;
+    U32 gen;                            /* generation this slot was stored in */
+};
+
+struct srl_otable {
+    srl_otable_entry_t *ary;
+    UV mask;                            /* number of slots - 1, power of two */
+    UV items;                           /* items stored in the current generation */
+    U32 gen;                            /* current generation, never 0 */
+};
+
+#define SRL_OTABLE_INIT_EXPONENT 6
+#define SRL_OTABLE_KEEP_MAX (1 << 16)
+
+/* Fibonacci hashing: the offsets are dense, a multiplicative hash spreads
+ * runs of neighbouring offsets evenly over the table. */
+#if UVSIZE == 8
+#   define SRL_OTABLE_HASH(key) ((UV)(key) * (UV)0x9E3779B97F4A7C15ULL)
+#   define SRL_OTABLE_HASH_BITS 64
+#else
+#   define SRL_OTABLE_HASH(key) ((UV)(key) * (UV)0x9E3779B9UL)
+#   define SRL_OTABLE_HASH_BITS 32
+#endif
+
+SRL_STATIC_INLINE UV
+srl_otable_slot(UV key)
+{
+    /* fold the well mixed high bits of the product into the low bits we index with */
+    UV h= SRL_OTABLE_HASH(key);
+    return (h >> (SRL_OTABLE_HASH_BITS / 2)) ^ h;
+}
+
+SRL_STATIC_INLINE void
+srl_otable_alloc(srl_otable_t *tbl, UV size)
+{
+    Newxz(tbl->ary, size, srl_otable_entry_t);
+    tbl->mask= size - 1;
+    tbl->items= 0;
+    tbl->gen= 1;
+}
+
+SRL_STATIC_INLINE srl_otable_t *
+srl_otable_new(void)
+{
+    srl_otable_t *tbl;
+    Newxz(tbl, 1, srl_otable_t);
+    srl_otable_alloc(tbl, (UV)1 << SRL_OTABLE_INIT_EXPONENT);
+    return tbl;
+}
+
+SRL_STATIC_INLINE void *
+srl_otable_fetch(srl_otable_t *tbl, UV key)
+{
+    UV i= srl_otable_slot(key);
+
+    for (;; i++) {
+        srl_otable_entry_t *ent= &tbl->ary[i & tbl->mask];
+        if (ent->gen != tbl->gen)
+            return NULL;
+        if (ent->key == key)
+            return ent->value;
+    }
+}
+
+SRL_STATIC_INLINE void srl_otable_store(srl_otable_t *tbl, UV key, void *value);
+
+/* double the number of slots, keeping the current generation's items */
+SRL_STATIC_INLINE void
+srl_otable_grow(srl_otable_t *tbl)
+{
+    srl_otable_entry_t *old= tbl->ary;
+    const UV old_size= tbl->mask + 1;
+    const U32 old_gen= tbl->gen;
+    UV i;
+
+    srl_otable_alloc(tbl, old_size * 2);
+    for (i= 0; i < old_size; i++) {
+        if (old[i].gen == old_gen)
+            srl_otable_store(tbl, old[i].key, old[i].value);
+    }
+    Safefree(old);
+}
+
+/* store value under key, replacing whatever was stored there before */
+SRL_STATIC_INLINE void
+srl_otable_store(srl_otable_t *tbl, UV key, void *value)
+{
+    UV i;
+
+    /* keep the load factor at or below 1/2 */
+    if (expect_false( (tbl->items + 1) * 2 > tbl->mask + 1 ))
+        srl_otable_grow(tbl);
+
+    for (i= srl_otable_slot(key);; i++) {
+        srl_otable_entry_t *ent= &tbl->ary[i & tbl->mask];
+        if (ent->gen != tbl->gen) {
+            ent->gen= tbl->gen;
+            ent->key= key;
+            ent->value= value;
+            tbl->items++;
+            return;
+        }
+        if (ent->key == key) {
+            ent->value= value;
+            return;
+        }
+    }
+}
+
+/* forget all items */
+SRL_STATIC_INLINE void
+srl_otable_clear(srl_otable_t *tbl)
+{
+    if (!tbl->items)
+        return;
+
+    if (expect_false( tbl->mask + 1 > SRL_OTABLE_KEEP_MAX )) {
+        Safefree(tbl->ary);
+        srl_otable_alloc(tbl, (UV)1 << SRL_OTABLE_INIT_EXPONENT);
+        return;
+    }
+
+    tbl->items= 0;
+    if (expect_false( ++tbl->gen == 0 )) {
+        /* wrapped around: stale slots could look current again */
+        Zero(tbl->ary, tbl->mask + 1, srl_otable_entry_t);
+        tbl->gen= 1;
+    }
+}
+
+SRL_STATIC_INLINE void
+srl_otable_free(srl_otable_t *tbl)
+{
+    if (!tbl)
+        return;
+    Safefree(tbl->ary);
+    Safefree(tbl);
+}
+
+#endif
@@ -0,0 +1,141 @@
+use strict;
+use warnings;
+
+use Test::More;
+use File::Spec;
+use lib File::Spec->catdir(qw(t lib));
+
+BEGIN {
+    lib->import('lib')
+        if !-d 't';
+}
+use Sereal::TestSet qw(:all);
+use Sereal::Decoder;
+use Scalar::Util ();
+
+if ( have_encoder_and_decoder() ) {
+    plan tests => 26;
+}
+else {
+    plan skip_all => 'Did not find right version of encoder';
+}
+
+my @data= ( { id => 1, list => [ 1 .. 10 ] }, "plain string", [ ("x" x 300) x 50 ], undef, { id => 5 } );
+
+sub stream_of {
+    my ( $enc, $framed )= @_;
+    return join "", map {
+        my $doc= $enc->encode($_);
+        $framed ? Sereal::Decoder->frame_document($doc) : $doc
+    } @data;
+}
+
+sub decode_stream {
+    my ( $stream, $opt )= @_;
+    open my $fh, "<", \$stream or die $!;
+    my @got;
+    my $count= Sereal::Decoder->new->decode_from_fh( $fh, sub { push @got, $_[0] }, $opt );
+    return ( $count, \@got );
+}
+
+for my $compress (
+    [ snappy => Sereal::Encoder::SRL_SNAPPY() ],
+    [ zlib   => Sereal::Encoder::SRL_ZLIB() ],
+    [ zstd   => Sereal::Encoder::SRL_ZSTD() ] )
+{
+    my ( $name, $type )= @$compress;
+    my $enc= Sereal::Encoder->new( { compress => $type, compress_threshold => 0 } );
+    my ( $count, $got )= decode_stream( stream_of($enc), { read_size => 7 } );
+    is( $count, scalar @data, "$name: all documents decoded" );
+    is_deeply( $got, \@data, "$name: documents decoded correctly with tiny reads" );
+}
+
+{
+    my $enc= Sereal::Encoder->new;
+    my ( $count, $got )= decode_stream( stream_of( $enc, 1 ), { framed => 1, read_size => 5 } );
+    is( $count, scalar @data, "framed raw: all documents decoded" );
+    is_deeply( $got, \@data, "framed raw: documents decoded correctly" );
+
+    ( $count, $got )= decode_stream( stream_of($enc), { read_size => 3 } );
+    is( $count, scalar @data, "unframed raw: all documents decoded" );
+    is_deeply( $got, \@data, "unframed raw: documents decoded correctly" );
+
+    ( $count, $got )= decode_stream( stream_of($enc) );
+    is_deeply( $got, \@data, "unframed raw: default read size" );
+
+    my $doc= Sereal::Decoder->frame_document( "x" x 300 );
+    is( length($doc), 302, "frame_document: two byte varint prefix" );
+    is( substr( $doc, 0, 2 ), "\xac\x02", "frame_document: varint of 300" );
+
+    ( $count, $got )= decode_stream("");
+    is( $count, 0, "empty stream" );
+}
+
+{
+    my $enc= Sereal::Encoder->new( { compress => Sereal::Encoder::SRL_ZLIB(), compress_threshold => 0 } );
+    # ends in a compressed document, so we know it is cut short
+    my $stream= stream_of($enc) . $enc->encode( [ ("x" x 300) x 50 ] );
+    chop $stream;
+    ok( !eval { decode_stream($stream); 1 }, "truncated stream dies" );
+    like( $@, qr/Truncated Sereal document/, "truncated stream error" );
+
+    ok( !eval { decode_stream("not sereal at all"); 1 }, "garbage dies" );
+    like( $@, qr/Bad Sereal header/, "garbage error" );
+
+    open my $fh, "<", \$stream or die $!;
+    ok( !eval { Sereal::Decoder->new->decode_from_fh($fh); 1 }, "callback is required" );
+}
+
+{
+    # plain Snappy documents don't record their compressed length
+    my $enc= Sereal::Encoder->new( { snappy => 1, protocol_version => 1, compress_threshold => 0 } );
+    my ( $count, $got )= decode_stream( stream_of($enc), { read_size => 3 } );
+    is( $count, scalar @data, "plain snappy: all documents decoded" );
+    is_deeply( $got, \@data, "plain snappy: documents decoded correctly" );
+}
+
+package Counted;
+our $thaws= 0;
+sub FREEZE { return $_[0]{v} }
+sub THAW   { $thaws++; return bless { v => $_[2] }, $_[0] }
+
+package main;
+
+{
+    # every tag type that records its own length, all in raw documents
+    my $str= "shared string";
+    my $ref= [ 1, 2 ];
+    my $weak= { a => 1 };
+    my $rich= {
+        float  => 1.5,
+        neg    => -5,
+        big    => 2**40,
+        negbig => -( 2**40 ),
+        utf8   => "\x{263a}" x 40,
+        long   => "z" x 70000,
+        re     => qr/ab+c/i,
+        obj1   => bless( [ 1, 2 ], "Some::Class" ),
+        obj2   => bless( [ 3 ], "Some::Class" ),
+        copy1  => $str,
+        copy2  => $str,
+        ref1   => $ref,
+        ref2   => $ref,
+        weak   => $weak,
+        thawed => bless( { v => [ 42, "x" ] }, "Counted" ),
+        true   => !!1,
+        empty  => [],
+        hash   => { map { $_ => $_ } 1 .. 20 },
+    };
+    $rich->{weakref}= $weak;
+    Scalar::Util::weaken( $rich->{weakref} );
+    my $enc= Sereal::Encoder->new( { freeze_callbacks => 1, dedupe_strings => 1 } );
+    my $stream= join "", map { $enc->encode($_) } $rich, "tail";
+    open my $fh, "<", \$stream or die $!;
+    my @got;
+    my $count= Sereal::Decoder->new->decode_from_fh( $fh, sub { push @got, $_[0] }, { read_size => 2 } );
+    is( $count, 2, "rich raw: all documents decoded" );
+    is( $got[1], "tail", "rich raw: found the end of the first document" );
+    is_deeply( $got[0]{thawed}, bless( { v => [ 42, "x" ] }, "Counted" ), "rich raw: THAW result" );
+    is( $Counted::thaws, 1, "THAW called once per document" );
+    is( $got[0]{long}, $rich->{long}, "rich raw: long string" );
+}
@@ -0,0 +1,73 @@
+use strict;
+use warnings;
+
+use Test::More;
+use File::Spec;
+use lib File::Spec->catdir(qw(t lib));
+
+BEGIN {
+    lib->import('lib')
+        if !-d 't';
+}
+use Sereal::TestSet qw(:all);
+
+if ( have_encoder_and_decoder() ) {
+    plan tests => 20;
+}
+else {
+    plan skip_all => 'Did not find right version of encoder';
+}
+
+my @records= map { { status => "active", country => "US", id => $_, note => "x" x 40 } } 1 .. 5;
+my $utf8= "\x{263A}ok";
+push @records, { status => $utf8 }, { status => $utf8 }, { status => $utf8 };
+
+{
+    # dedupe_strings makes the encoder emit COPY tags for repeated strings
+    my $enc= Sereal::Encoder->new( { dedupe_strings => 1 } );
+    my $doc= $enc->encode( \@records );
+
+    my $plain= Sereal::Decoder->new->decode($doc);
+    ok( \$plain->[1]{status} != \$plain->[2]{status}, "no aliasing by default" );
+
+    my $dec= Sereal::Decoder->new( { alias_copied_strings => 1 } );
+    my $got= $dec->decode($doc);
+    undef $dec;
+
+    is_deeply( $got, \@records, "alias_copied_strings: same data" );
+    ok( \$got->[1]{status} == \$got->[2]{status}, "alias_copied_strings: COPYs share one SV" );
+    ok( \$got->[2]{note} == \$got->[4]{note},     "alias_copied_strings: long strings are shared too" );
+    ok( \$got->[6]{status} == \$got->[7]{status}, "alias_copied_strings: utf8 COPYs share one SV" );
+    ok( utf8::is_utf8( $got->[6]{status} ), "alias_copied_strings: utf8 flag kept" );
+    ok( !eval { $got->[2]{status}= "gone"; 1 }, "alias_copied_strings: alias is readonly" );
+    like( $@, qr/read-only/, "alias_copied_strings: expect an error about read-only values" );
+    is( $got->[3]{status}, "active", "alias_copied_strings: other records untouched by failed store" );
+}
+
+{
+    my $enc= Sereal::Encoder->new;
+    my $doc= $enc->encode( \@records );
+    my $dec= Sereal::Decoder->new( { alias_strings_under => 8 } );
+    my $got= $dec->decode($doc);
+
+    is_deeply( $got, \@records, "alias_strings_under: same data" );
+    ok( \$got->[0]{status} == \$got->[4]{status},   "alias_strings_under: short strings are shared" );
+    ok( \$got->[0]{country} == \$got->[1]{country}, "alias_strings_under: short strings are shared (2)" );
+    ok( \$got->[0]{note} != \$got->[1]{note},       "alias_strings_under: long strings are not shared" );
+    ok( \$got->[5]{status} == \$got->[6]{status},   "alias_strings_under: utf8 strings are shared" );
+    ok( \$got->[5]{status} != \$got->[0]{status},   "alias_strings_under: different strings are different" );
+    ok( Internals::SvREADONLY( $got->[0]{status} ), "alias_strings_under: alias is readonly" );
+    ok( !Internals::SvREADONLY( $got->[0]{note} ),  "alias_strings_under: long string is not readonly" );
+
+    # the aliases must not leak from one document into the next
+    my $got2= $dec->decode($doc);
+    ok( \$got2->[0]{status} != \$got->[0]{status}, "alias_strings_under: per document" );
+    is_deeply( $got2, \@records, "alias_strings_under: reused decoder, same data" );
+
+    my $bin= "\xe2\x98\xbaok";
+    is_deeply(
+        $dec->decode( $enc->encode( [ $bin, $utf8, $bin ] ) ),
+        [ $bin, $utf8, $bin ],
+        "alias_strings_under: binary and utf8 strings with the same bytes are kept apart"
+    );
+}
@@ -0,0 +1,90 @@
+use strict;
+use warnings;
+
+use Test::More;
+use File::Spec;
+use lib File::Spec->catdir(qw(t lib));
+
+BEGIN {
+    lib->import('lib')
+        if !-d 't';
+}
+use Sereal::TestSet qw(:all);
+use Sereal::Decoder;
+use Scalar::Util qw(refaddr);
+
+if ( have_encoder_and_decoder() ) {
+    plan tests => 27;
+}
+else {
+    plan skip_all => 'Did not find right version of encoder';
+}
+
+my $enc= Sereal::Encoder->new;
+my $doc_a= $enc->encode( { status => "active", list => [ 1 .. 5 ] } );
+my $doc_b= $enc->encode( [ "pending", "US" ] );
+my $doc_c= $enc->encode("just a string");
+
+{
+    my $dec= Sereal::Decoder->new;
+    is( $dec->cache_stats, undef, "no cache stats without cache_documents" );
+}
+
+{
+    my $dec= Sereal::Decoder->new( { cache_documents => 2 } );
+
+    my $first= $dec->decode($doc_a);
+    my $second= $dec->decode($doc_a);
+    is_deeply( $first, { status => "active", list => [ 1 .. 5 ] }, "first decode is correct" );
+    is_deeply( $second, $first, "cached decode is correct" );
+    is( refaddr($second), refaddr($first), "cache hit shares the structure" );
+    ok( Internals::SvREADONLY( %$second ), "cached structure is readonly" );
+    ok( !eval { $second->{status}= "gone"; 1 }, "cannot modify cached structure" );
+    is( $dec->bytes_consumed, length($doc_a), "bytes_consumed set on a hit" );
+
+    my $stats= $dec->cache_stats;
+    is( $stats->{hits},    1, "one hit" );
+    is( $stats->{misses},  1, "one miss" );
+    is( $stats->{entries}, 1, "one entry" );
+    is( $stats->{hit_rate}, 0.5, "hit rate" );
+    ok( $stats->{bytes} >= length($doc_a), "bytes accounts for the document" );
+
+    $dec->decode($doc_b);
+    $dec->decode($doc_a);    # a is now most recently used
+    $dec->decode($doc_c);    # evicts b
+    $stats= $dec->cache_stats;
+    is( $stats->{entries},   2, "bounded by cache_documents" );
+    is( $stats->{evictions}, 1, "one eviction" );
+
+    my $hits= $stats->{hits};
+    $dec->decode($doc_a);
+    is( $dec->cache_stats->{hits}, $hits + 1, "most recently used document survived" );
+    is_deeply( $dec->decode($doc_b), [ "pending", "US" ], "evicted document decodes again" );
+    is( $dec->cache_stats->{misses}, $stats->{misses} + 1, "evicted document was a miss" );
+
+    is( $dec->decode($doc_c), "just a string", "cached plain scalar" );
+    is( $dec->decode($doc_c), "just a string", "cached plain scalar, hit" );
+
+    my $prefix= "garbage";
+    is_deeply( $dec->decode_with_offset( $prefix . $doc_b, length $prefix ),
+        [ "pending", "US" ], "decode_with_offset goes through the cache" );
+
+    $dec->clear_cache;
+    $stats= $dec->cache_stats;
+    is( $stats->{entries}, 0, "clear_cache drops entries" );
+    is( $stats->{hits},    0, "clear_cache resets counters" );
+    is( $stats->{max_entries}, 2, "clear_cache keeps limits" );
+}
+
+{
+    my $dec= Sereal::Decoder->new( { cache_documents => 100, cache_max_bytes => length($doc_a) + 100 } );
+    $dec->decode($doc_a);
+    $dec->decode($doc_b);
+    my $stats= $dec->cache_stats;
+    ok( $stats->{bytes} <= $stats->{max_bytes}, "bounded by cache_max_bytes" );
+    is( $stats->{entries}, 1, "older document evicted to stay under cache_max_bytes" );
+
+    my $big= $enc->encode( "x" x 1000 );
+    is( $dec->decode($big), "x" x 1000, "oversized document decodes" );
+    is( $dec->cache_stats->{entries}, 1, "oversized document is not cached" );
+}
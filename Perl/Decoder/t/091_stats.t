@@ -0,0 +1,107 @@
+use strict;
+use warnings;
+
+use Test::More;
+use File::Spec;
+use lib File::Spec->catdir(qw(t lib));
+
+BEGIN {
+    lib->import('lib')
+        if !-d 't';
+}
+use Sereal::TestSet qw(:all);
+use Sereal::Decoder;
+
+if ( have_encoder_and_decoder() ) {
+    plan tests => 28;
+}
+else {
+    plan skip_all => 'Did not find right version of encoder';
+}
+
+package Thawed;
+sub FREEZE { return $_[0]{v} }
+sub THAW   { my ( $class, $serializer, $v )= @_; return bless { v => $v }, $class }
+
+package main;
+
+my $data= {
+    name    => "alice",
+    tags    => [ "a", "bb", "ccc" ],
+    count   => 3,
+    obj     => bless( {}, "Some::Class" ),
+    thawed  => bless( { v => 42 }, "Thawed" ),
+    long    => "y" x 100,
+};
+
+{
+    my $dec= Sereal::Decoder->new;
+    is( $dec->stats, undef, "no stats without collect_stats" );
+}
+
+{
+    my $enc= Sereal::Encoder->new( { freeze_callbacks => 1 } );
+    my $doc= $enc->encode($data);
+    my $dec= Sereal::Decoder->new( { collect_stats => 1 } );
+    my $got= $dec->decode($doc);
+    is( $got->{thawed}{v}, 42, "decoded fine with collect_stats" );
+
+    my $s= $dec->stats;
+    is( $s->{documents}, 1, "documents" );
+    is( ( $s->{values}{HASHREF} || 0 ) + ( $s->{values}{HASH} || 0 ), 2, "hashes counted" );
+    # hash keys are read directly and don't show up as values
+    is( $s->{values}{SHORT_BINARY}, 4, "short binaries folded into one key" );
+    ok( !grep( /_\d+\z/, keys %{ $s->{values} } ), "no per-length tag names" );
+    is( $s->{values}{BINARY}, 1, "long string counted as BINARY" );
+    is( $s->{bytes_copied}{BINARY}, 100, "bytes copied for BINARY" );
+    is( $s->{hash_keys}, 6, "hash keys" );
+    is( $s->{hash_key_bytes}, length( join "", keys %$data ), "hash key bytes" );
+    is( $s->{hv_ksplit_calls}, 2, "hv_ksplit calls" );
+    is( $s->{hv_ksplit_max},   6, "hv_ksplit max" );
+    # the THAW arguments travel as an array of their own
+    is( $s->{av_extend_calls}, 2, "av_extend calls" );
+    is( $s->{av_extend_elems}, 4, "av_extend elements" );
+    is( $s->{objects_blessed}, 1, "objects blessed" );
+    is( $s->{thaw_calls},      1, "THAW calls" );
+    ok( $s->{thaw_ns} >= 0, "THAW time" );
+    is( $s->{decompressed_documents}, 0, "nothing decompressed" );
+
+    $dec->decode($doc);
+    is( $dec->stats->{documents}, 2, "counters are cumulative" );
+    is( $dec->stats->{hash_keys}, 12, "counters are cumulative (2)" );
+
+    $dec->reset_stats;
+    is( $dec->stats->{documents}, 0, "reset_stats" );
+    is_deeply( $dec->stats->{values}, {}, "reset_stats clears the tag counters" );
+}
+
+{
+    my $doc= Sereal::Encoder->new( { compress => Sereal::Encoder::SRL_ZLIB(), compress_threshold => 0 } )
+        ->encode( [ ("abc") x 100 ] );
+    my $dec= Sereal::Decoder->new( { collect_stats => 1 } );
+    $dec->decode($doc);
+    my $s= $dec->stats;
+    is( $s->{decompressed_documents}, 1, "decompressed documents" );
+    ok( $s->{decompress_bytes_out} > $s->{decompress_bytes_in}, "decompressed bytes" );
+}
+
+{
+    # a THAW callback decoding with the same decoder runs on a clone
+    my $inner= Sereal::Encoder->new->encode( [ 1, 2 ] );
+    my $dec= Sereal::Decoder->new( { collect_stats => 1 } );
+    no warnings 'once';
+    local *Reentrant::THAW= sub { return bless { v => $dec->decode( $_[2] ) }, $_[0] };
+    local *Reentrant::FREEZE= sub { return $inner };
+    my $doc= Sereal::Encoder->new( { freeze_callbacks => 1 } )->encode( bless( {}, "Reentrant" ) );
+    my $got= $dec->decode($doc);
+    is_deeply( $got->{v}, [ 1, 2 ], "reentrant decode" );
+    is( $dec->stats->{documents}, 2, "reentrant decode counted" );
+}
+
+{
+    my $doc= Sereal::Encoder->new->encode( { a => 1 } );
+    my $dec= Sereal::Decoder->new( { collect_stats => 1, cache_documents => 4 } );
+    $dec->decode($doc) for 1 .. 3;
+    is( $dec->stats->{documents},  1, "cache hits are not decoded" );
+    is( $dec->stats->{cache_hits}, 2, "cache hits counted" );
+}
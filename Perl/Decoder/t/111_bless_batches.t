@@ -0,0 +1,59 @@
+use strict;
+use warnings;
+
+use Test::More;
+use File::Spec;
+use lib File::Spec->catdir(qw(t lib));
+
+BEGIN {
+    lib->import('lib')
+        if !-d 't';
+}
+use Sereal::TestSet qw(:all);
+use Sereal::Decoder;
+
+if ( have_encoder_and_decoder() ) {
+    plan tests => 14;
+}
+else {
+    plan skip_all => 'Did not find right version of encoder';
+}
+
+my $enc= Sereal::Encoder->new;
+my @classes= map { "Batch::Class$_" } 0 .. 2;
+my $data= [
+    ( map { bless( { id => $_ }, $classes[ $_ % 3 ] ) } 1 .. 300 ),
+    bless( [ 1, 2 ], "Batch::Array" ),
+    bless( \do { my $x= "s" }, "Batch::Scalar" ),
+    bless( qr/foo/, "Batch::Regexp" ),
+];
+my $doc= $enc->encode($data);
+
+sub stash_refcnt { no strict 'refs'; Internals::SvREFCNT( %{ $_[0] . "::" } ) }
+
+my %before= map { $_ => stash_refcnt($_) } @classes;
+
+{
+    my $got= Sereal::Decoder->new->decode($doc);
+    is_deeply( $got, $data, "objects of several classes roundtrip" );
+    is( ref( $got->[$_] ), $classes[ ( $_ + 1 ) % 3 ], "object $_ has the right class" )
+        for 0, 1, 299;
+    is( ref( $got->[300] ), "Batch::Array",  "blessed array" );
+    is( ref( $got->[301] ), "Batch::Scalar", "blessed scalar" );
+    ok( "foo" =~ $got->[302], "blessed regexp still matches" );
+    is( stash_refcnt("Batch::Class0"), $before{"Batch::Class0"} + 100, "stash refcount accounts for every object" );
+}
+is( stash_refcnt($_), $before{$_}, "stash refcount back to normal for $_" ) for @classes;
+
+{
+    my $got= Sereal::Decoder->new( { set_readonly => 1 } )->decode($doc);
+    is( ref( $got->[0] ), $classes[1], "set_readonly: blessed" );
+    ok( Internals::SvREADONLY( %{ $got->[0] } ), "set_readonly: object stays readonly" );
+}
+
+{
+    # decoding the same document twice with one decoder reuses the batches
+    my $dec= Sereal::Decoder->new;
+    $dec->decode($doc);
+    is_deeply( $dec->decode($doc), $data, "reused decoder" );
+}
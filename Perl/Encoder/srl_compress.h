@@ -131,15 +131,18 @@ srl_reset_compression_header_flag(srl_buffer_t *buf)
                               (*flags_and_version_byte & SRL_PROTOCOL_VERSION_MASK);
 }
 
-/* Compress body with one of available compressors (zlib, snappy).
+/* Compress body with one of available compressors (zlib, snappy, zstd).
  * The function sets/resets compression bits at version byte.
  * The caller has to adjust buf->body_pos by calling SRL_UPDATE_BODY_POS
  * right after exiting from srl_compress_body.
+ * If zstd_cctx is not NULL it is used for zstd compression, this saves
+ * setting up a fresh context for callers which compress many bodies.
  */
 
 SRL_STATIC_INLINE void
 srl_compress_body(pTHX_ srl_buffer_t *buf, STRLEN sereal_header_length,
-                  const U32 compress_flags, const int compress_level, void **workmem)
+                  const U32 compress_flags, const int compress_level, void **workmem,
+                  ZSTD_CCtx *zstd_cctx)
 {
     const int is_traditional_snappy = compress_flags & SRL_F_COMPRESS_SNAPPY;
     const int is_incremental_snappy = compress_flags & SRL_F_COMPRESS_SNAPPY_INCREMENTAL;
@@ -196,7 +199,11 @@ srl_compress_body(pTHX_ srl_buffer_t *buf, STRLEN sereal_header_length,
 
         compressed_body_length = (size_t) len;
     } else if (is_zstd) {
-        size_t code = ZSTD_compress((void*) buf->pos, compressed_body_length,
+        size_t code = zstd_cctx
+                    ? ZSTD_compressCCtx(zstd_cctx, (void*) buf->pos, compressed_body_length,
+                                        (void*) (old_buf.start + sereal_header_length), uncompressed_body_length,
+                                        compress_level)
+                    : ZSTD_compress((void*) buf->pos, compressed_body_length,
                                     (void*) (old_buf.start + sereal_header_length), uncompressed_body_length,
                                     compress_level);
 
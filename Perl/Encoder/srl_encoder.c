@@ -1032,7 +1032,7 @@ srl_dump_data_structure(pTHX_ srl_encoder_t *enc, SV *src, SV *user_header_src)
         else { /* Do Snappy or zlib compression of body */
             srl_compress_body(aTHX_ &enc->buf, sereal_header_len,
                               compress_flags, enc->compress_level,
-                              &enc->snappy_workmem);
+                              &enc->snappy_workmem, NULL);
 
             SRL_ENC_UPDATE_BODY_POS(enc);
             DEBUG_ASSERT_BUF_SANE(&enc->buf);
@@ -42,6 +42,20 @@ append_all(mrg, src)
   PPCODE:
     srl_merger_append_all(aTHX_ mrg, src);
 
+void
+append_file(mrg, path)
+    srl_merger_t *mrg;
+    SV *path
+  PPCODE:
+    srl_merger_append_file(aTHX_ mrg, path);
+
+void
+append_files(mrg, paths)
+    srl_merger_t *mrg;
+    AV *paths
+  PPCODE:
+    srl_merger_append_files(aTHX_ mrg, paths);
+
 SV*
 finish(mrg, user_header = NULL)
     srl_merger_t *mrg;
@@ -50,6 +64,14 @@ finish(mrg, user_header = NULL)
     RETVAL = srl_merger_finish(aTHX_ mrg, user_header);
   OUTPUT: RETVAL
 
+SV*
+snapshot(mrg, user_header = NULL)
+    srl_merger_t *mrg;
+    SV *user_header;
+  CODE:
+    RETVAL = srl_merger_snapshot(aTHX_ mrg, user_header);
+  OUTPUT: RETVAL
+
 UV
 elements_merged(mrg)
     srl_merger_t *mrg;
@@ -57,6 +79,13 @@ elements_merged(mrg)
     RETVAL = (UV) mrg->cnt_of_merged_elements;
   OUTPUT: RETVAL
 
+HV *
+dedupe_stats(mrg)
+    srl_merger_t *mrg;
+  CODE:
+    RETVAL = srl_merger_dedupe_stats(aTHX_ mrg);
+  OUTPUT: RETVAL
+
 MODULE = Sereal::Merger        PACKAGE = Sereal::Merger::_strtabletest
 
 void
@@ -158,3 +187,76 @@ test_purge()
 
     STRTABLE_free(tbl);
     srl_buf_free_buffer(aTHX_ &buf);
+
+#define INSERT_STRTABLE(num)                                        \
+    STMT_START {                                                    \
+        len = sprintf((char*) b, "%d", (int) (num));                \
+        Copy(b, buf.pos, len, char);                                \
+        buf.pos += len;                                             \
+                                                                    \
+        ent = STRTABLE_insert(tbl, b, len, &found);                 \
+        if (!found) ent->offset = BODY_POS_OFS(&buf) - len;         \
+    } STMT_END
+
+void
+test_evict()
+  PREINIT:
+    STRTABLE_t *tbl;
+    STRTABLE_ENTRY_t *ent;
+    srl_buffer_t buf;
+    UV i, len, items, offset = 0;
+    unsigned char b[128];
+    int found, all_found = 1, purged = 1;
+  CODE:
+    srl_buf_init_buffer(aTHX_ &buf, 1024 * 1024);
+    tbl = STRTABLE_new(&buf);
+    STRTABLE_set_memory_limit(tbl, 10 * STRTABLE_ENTRY_COST);
+
+    for (i = 0; i < 10; ++i)
+        INSERT_STRTABLE(i);
+    printf("%sok - STRTABLE filled to limit\n", tbl->tbl_items == 10 && tbl->tbl_evictions == 0 ? "" : "not ");
+
+    /* reference all but 9 */
+    for (i = 0; i < 9; ++i) {
+        INSERT_STRTABLE(i);
+        all_found &= found;
+    }
+    printf("%sok - STRTABLE found 0 to 8\n", all_found ? "" : "not ");
+
+    INSERT_STRTABLE(10);
+    printf("%sok - STRTABLE evicted one entry\n", !found && tbl->tbl_items == 10 && tbl->tbl_evictions == 1 ? "" : "not ");
+
+    for (i = 0; i < 9; ++i) {
+        INSERT_STRTABLE(i);
+        all_found &= found;
+    }
+    printf("%sok - STRTABLE referenced entries survived eviction\n", all_found && tbl->tbl_evictions == 1 ? "" : "not ");
+
+    INSERT_STRTABLE(9);
+    printf("%sok - STRTABLE unreferenced entry was evicted\n", !found && tbl->tbl_evictions == 2 ? "" : "not ");
+
+    for (i = 100; i < 200; ++i) {
+        if (i == 195) offset = BODY_POS_OFS(&buf);
+        INSERT_STRTABLE(i);
+    }
+    printf("%sok - STRTABLE stays at limit\n", tbl->tbl_items == 10 && tbl->tbl_evictions == 102 ? "" : "not ");
+
+    STRTABLE_purge(tbl, offset);
+    for (i = 0, items = 0; i <= tbl->tbl_max; ++i) {
+        if (tbl->tbl_ary[i].length) {
+            items++;
+            if (tbl->tbl_ary[i].offset >= offset)
+                purged = 0;
+        }
+    }
+    printf("%sok - STRTABLE purged after eviction\n", purged && items == tbl->tbl_items && items < 10 ? "" : "not ");
+
+    for (i = 200; tbl->tbl_items < 10; ++i)
+        INSERT_STRTABLE(i);
+    printf("%sok - STRTABLE refilled without eviction\n", tbl->tbl_evictions == 102 ? "" : "not ");
+
+    INSERT_STRTABLE(i);
+    printf("%sok - STRTABLE evicts again when full\n", tbl->tbl_items == 10 && tbl->tbl_evictions == 103 ? "" : "not ");
+
+    STRTABLE_free(tbl);
+    srl_buf_free_buffer(aTHX_ &buf);
@@ -18,11 +18,28 @@ use constant SRL_TOP_LEVEL_SCALAR => 0;
 use constant SRL_TOP_LEVEL_ARRAY  => 1;
 use constant SRL_TOP_LEVEL_HASH   => 2;
 
+use constant SRL_FIRST_WINS => 0;
+use constant SRL_LAST_WINS  => 1;
+
+# Same values as the compression constants of Sereal::Encoder.
+use constant {
+    SRL_UNCOMPRESSED => 0,
+    SRL_SNAPPY       => 1,
+    SRL_ZLIB         => 2,
+    SRL_ZSTD         => 3,
+};
+
 use Exporter 'import';
 our @EXPORT_OK = qw(
     SRL_TOP_LEVEL_SCALAR
     SRL_TOP_LEVEL_ARRAY
     SRL_TOP_LEVEL_HASH
+    SRL_FIRST_WINS
+    SRL_LAST_WINS
+    SRL_UNCOMPRESSED
+    SRL_SNAPPY
+    SRL_ZLIB
+    SRL_ZSTD
 );
 
 our %EXPORT_TAGS = (all => \@EXPORT_OK);
@@ -76,13 +93,33 @@ by default.
 =head3 compress
 
 If this option provided and true, compression of the document body is enabled.
-As of Sereal version 3, two different compression techniques are supported
+As of Sereal version 3, three different compression techniques are supported
 and can be enabled by setting C<compress> to the respective named
 constants (exportable from the C<Sereal::Merger> module):
-Snappy (named constant: C<SRL_SNAPPY>),
-and Zlib (C<SRL_ZLIB>).
+Snappy (named constant: C<SRL_SNAPPY>), Zlib (C<SRL_ZLIB>) and Zstd (C<SRL_ZSTD>).
 For your convenience, there is also a C<SRL_UNCOMPRESSED>
-constant.
+constant. The values are the same as those of C<Sereal::Encoder>.
+
+Zlib and Zstd compression require protocol version 3 or higher.
+The compression is applied once, to the merged output in C<finish>.
+If it does not make the document smaller, the document is emitted
+uncompressed.
+
+The input documents may be compressed with any of the supported
+techniques, independently of this option.
+
+=head3 compress_level
+
+If Zlib or Zstd compression is used, then this option will set a compression
+level: Zlib uses range from 1 (fastest) to 9 (best) and defaults to 6;
+Zstd uses range from 1 (fastest) to 22 (best) and defaults to 3.
+
+=head3 expected_header_size
+
+Number of bytes to reserve in front of the merged body for the user header
+passed to C<finish>. A header that doesn't fit is still accepted, but then
+the whole merged body has to be moved once to make room for it. Defaults to
+a small reservation which fits short headers.
 
 =head3 max_recursion_depth
 
@@ -106,12 +143,43 @@ many duplicated strings will see a significant reduction in the size of the
 encoded form. Currently only strings longer than 3 characters will be deduped,
 however this may change in the future.
 
+=head3 dedupe_memory_limit
+
+With C<dedupe_strings>, the merger remembers every distinct string it has
+written, which adds up when merging many documents. This option limits the
+memory used for that to about the given number of bytes for strings, and
+as much again for class names. Once the limit is reached, strings which
+haven't been seen again for the longest time are forgotten and written out
+in full the next time they show up. Defaults to 0, which means no limit.
+See C<dedupe_stats> for tuning it. With a limit, the strings are hashed
+with a fixed seed instead of perl's hash seed, so which ones are forgotten,
+and thus the output, is the same in every process.
+
 =head3 protocol_version
 
 Specifies the version of the Sereal protocol to emit. Valid are integers
 between 1 and the current version. If not specified, the most recent protocol
 version will be used.
 
+=head3 stream_to
+
+A filehandle opened for writing. Instead of collecting the whole merged
+document in memory, C<Sereal::Merger> writes it out to this filehandle
+whenever the buffered output grows past C<stream_threshold> bytes, so that
+merging many big documents needs little more memory than the largest of them.
+C<finish> writes the rest and returns the number of bytes written.
+
+The element count of the top level container is only known in the end, so
+unless C<top_level_element> is SRL_TOP_LEVEL_SCALAR the filehandle must be
+seekable. Streaming can't be combined with C<dedupe_strings>, C<compress>,
+a top level hash, protocol version 1 or a user header passed to C<finish>.
+
+=head3 stream_threshold
+
+Number of buffered bytes after which the output is written to C<stream_to>.
+Defaults to 1 MiB. The output is only written out between documents, so
+the buffer can grow past this size while merging a big one.
+
 =head3 top_level_element
 
 This option specifies what objects will be used as top level container for merged documents. There are three available options:
@@ -134,6 +202,45 @@ Exported as SRL_TOP_LEVEL_ARRAY.
 
 =back
 
+=over 4
+
+HASH - every document has to be a hash, and its key/value pairs are merged
+into one hash without decoding the values:
+
+    my %data = map { %$_ } (...documents...);
+    my $encoded = encoder_sereal({ %data });
+
+If the same key comes again, C<duplicate_keys> decides which value is kept.
+Exported as SRL_TOP_LEVEL_HASH.
+
+=back
+
+=head3 duplicate_keys
+
+What to do about a key which is merged into the top level hash more than once,
+only used with the SRL_TOP_LEVEL_HASH C<top_level_element>:
+
+=over 4
+
+=item SRL_LAST_WINS
+
+The value merged last is kept, like in the example above. This is the
+default. Pairs which are overridden stay in the merged data until
+C<finish> or C<snapshot> drop them, which costs one more pass over the
+merged data if any key came again.
+
+=item SRL_FIRST_WINS
+
+The value merged first is kept, later values for the same key are skipped
+while merging.
+
+=back
+
+Keys are compared the way Perl compares hash keys: a key which is a UTF-8
+string in one document and a byte string in another is the same key if
+the UTF-8 string only has characters up to 0xff. Such keys are written
+out as byte strings.
+
 =head1 INSTANCE METHODS
 
 =head2 append
@@ -150,14 +257,78 @@ C<Sereal::Merger> preserves consistent internal state. Merging operation can be
 continued. The index where merging failed to be obtained via
 C<elements_merged>.
 
+=head2 append_file
+
+    $mrg->append_file($path);
+
+Same as C<append>, but merges the Sereal document stored in the file at
+C<$path>. The file is mapped into memory rather than read into a Perl
+string.
+
+=head2 append_files
+
+    $mrg->append_files(\@paths);
+
+Same as C<append_file> for each of the files in C<@paths>. As with
+C<append_all>, the number of the files merged before an invalid one can be
+obtained via C<elements_merged>.
+
 =head2 finish
 
+    my $doc = $mrg->finish;
+    my $doc = $mrg->finish($user_header);
+
 Finalize merging operation. The output of this function is valid Sereal document.
+The optional user header is a Sereal document itself, its body is embedded
+into the header of the output, see C<expected_header_size>.
+With the C<stream_to> option, the document is written to that filehandle
+instead and the number of bytes written is returned.
+
+=head2 snapshot
+
+    my $doc = $mrg->snapshot;
+    my $doc = $mrg->snapshot($user_header);
+
+Returns the same document C<finish> would return for everything merged so
+far, but doesn't finish the merger: further documents can be appended
+afterwards, and strings already seen are still deduplicated. The merged
+data is copied once for every snapshot (and compressed if C<compress> is
+set), nothing is merged again. Takes an optional user header like C<finish>.
+Not available with C<stream_to> or protocol version 1.
 
 =head2 elements_merged
 
 Return number of merged documents.
 
+=head2 dedupe_stats
+
+Returns a hash reference with counters for C<dedupe_strings>:
+
+=over 4
+
+=item hits
+
+Number of strings and class names which were written as references to an
+earlier copy.
+
+=item bytes_saved
+
+Number of bytes saved that way.
+
+=item entries
+
+Number of strings and class names currently remembered.
+
+=item evictions
+
+Number of strings and class names forgotten because of
+C<dedupe_memory_limit>.
+
+=back
+
+Documents which failed to merge are not counted, except for the
+evictions they caused.
+
 =head1 BUGS, CONTACT AND SUPPORT
 
 For reporting bugs, please use the github bug tracker at
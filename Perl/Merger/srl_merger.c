@@ -14,6 +14,10 @@ extern "C" {
 
 #include <stdlib.h>
 
+#ifdef HAS_MMAP
+#   include <sys/mman.h>
+#endif
+
 #ifndef PERL_VERSION
 #    include <patchlevel.h>
 #    if !(defined(PERL_VERSION) || (PERL_SUBVERSION > 0 && defined(PATCHLEVEL)))
@@ -53,13 +57,9 @@ extern "C" {
                                            ? srl_init_classname_deduper_tbl(aTHX_ mrg)          \
                                            : (mrg)->classname_deduper_tbl)
 
-#define SRL_GET_TRACKED_OFFSETS_TBL(mrg) (expect_false((mrg)->tracked_offsets_tbl == NULL) \
-                                         ? srl_init_tracked_offsets_tbl(aTHX_ mrg)         \
-                                         : (mrg)->tracked_offsets_tbl)
-
-#define SRL_GET_TRACKED_OFFSETS(mrg)     (expect_false((mrg)->tracked_offsets == NULL)    \
-                                         ? srl_init_tracked_offsets(aTHX_ mrg)            \
-                                         : (mrg)->tracked_offsets)
+#define SRL_GET_KEY_TBL(mrg) (expect_false((mrg)->key_tbl == NULL)    \
+                             ? ((mrg)->key_tbl = STRTABLE_new(&(mrg)->obuf)) \
+                             : (mrg)->key_tbl)
 
 /*#define SRL_MERGER_TRACE(msg, args...) warn((msg), args) */
 #define SRL_MERGER_TRACE(msg, args...)
@@ -103,26 +103,36 @@ extern "C" {
 #define SRL_MRG_SET_OPTION(mrg, flag_num) ((mrg)->flags |= (flag_num))
 #define SRL_MRG_HAVE_OPTION(mrg, flag_num) ((mrg)->flags & (flag_num))
 
+/* Body offsets in the merged document, and the other way around. When
+ * streaming, the start of the body may already have been written out and
+ * dropped from obuf, see srl_merger_flush() */
+#define SRL_MRG_BODY_OFS(mrg) ((UV) BODY_POS_OFS(&(mrg)->obuf) + (mrg)->obuf_flushed)
+#define SRL_MRG_BODY_PTR(mrg, ofs) ((mrg)->obuf.body_pos + ((ofs) - (mrg)->obuf_flushed))
+
+/* Number of elements in the top level container */
+#define SRL_MRG_TOP_LEVEL_COUNT(mrg) (SRL_MRG_HAVE_OPTION((mrg), SRL_F_TOPLEVEL_KEY_HASH) \
+                                      ? (mrg)->cnt_of_merged_keys                       \
+                                      : (mrg)->cnt_of_merged_elements)
+
+/* tracked_offsets target of an item which was merged as part of a dropped
+ * value, see srl_drop_merged() */
+#define SRL_MRG_DROPPED ((UV) -1)
+
 #define SRL_MAX_VARINT_LENGTH_U32 5
 #define DEFAULT_MAX_RECUR_DEPTH 10000
 #define SRL_PREALLOCATE_FOR_USER_HEADER 1024
+#define SRL_DEFAULT_STREAM_THRESHOLD (1024 * 1024)
 #define SRL_MINIMALISTIC_HEADER_SIZE 6 /* =srl + 1 byte for version + 1 byte for header */
 
 #if !defined(HAVE_CSNAPPY)
 # include "snappy/csnappy_decompress.c"
 #endif
 
-#define srl_stack_type_t UV
-#define SRL_SRL_STACK_TYPE_GT(a, b) ((*a) > (*b))
-
-#include "qsort.h"
 #include "srl_merger.h"
 #include "srl_common.h"
-#include "ptable.h"
 #include "strtable.h"
 #include "srl_protocol.h"
 #include "srl_inline.h"
-#include "srl_stack.h"
 #include "srl_reader.h"
 #include "srl_reader_error.h"
 #include "srl_reader_misc.h"
@@ -131,48 +141,51 @@ extern "C" {
 #include "srl_buffer.h"
 #include "srl_compress.h"
 
-typedef struct PTABLE * ptable_ptr;
-typedef PTABLE_ENTRY_t *ptable_entry_ptr;
-
 SRL_STATIC_INLINE void srl_buf_copy_content_nocheck(pTHX_ srl_merger_t *mrg, size_t len);
 SRL_STATIC_INLINE void srl_copy_varint(pTHX_ srl_merger_t *mrg);
-SRL_STATIC_INLINE void srl_stack_rsort(pTHX_ srl_stack_t *stack);
-SRL_STATIC_INLINE void srl_stack_dedupe(pTHX_ srl_stack_t *stack);
 
-SRL_STATIC_INLINE ptable_ptr   srl_init_tracked_offsets_tbl(pTHX_ srl_merger_t *mrg);
 SRL_STATIC_INLINE strtable_ptr srl_init_string_deduper_tbl(pTHX_ srl_merger_t *mrg);
 SRL_STATIC_INLINE strtable_ptr srl_init_classname_deduper_tbl(pTHX_ srl_merger_t *mrg);
-SRL_STATIC_INLINE srl_stack_t * srl_init_tracked_offsets(pTHX_ srl_merger_t *mrg);
 
 SRL_STATIC_INLINE srl_merger_t * srl_empty_merger_struct(pTHX);                         /* allocate an empty merger struct - flags still to be set up */
-SRL_STATIC_INLINE void srl_set_input_buffer(pTHX_ srl_merger_t *mrg, SV *src);        /* reset input buffer (ibuf) */
-SRL_STATIC_INLINE void srl_build_track_table(pTHX_ srl_merger_t *mrg);
+SRL_STATIC_INLINE void srl_set_input_buffer(pTHX_ srl_merger_t *mrg, srl_reader_char_ptr src, STRLEN len); /* reset input buffer (ibuf) */
+SRL_STATIC_INLINE void srl_merger_flush(pTHX_ srl_merger_t *mrg);                     /* write obuf out to stream_to */
+SRL_STATIC_INLINE SV * srl_merger_finish_stream(pTHX_ srl_merger_t *mrg, SV *user_header_src);
+SRL_STATIC_INLINE void srl_merger_grow_header_space(pTHX_ srl_merger_t *mrg, UV header_space);
+SRL_STATIC_INLINE void srl_merger_fill_count(pTHX_ srl_merger_t *mrg, srl_buffer_char *count);
+SRL_STATIC_INLINE void srl_merger_begin_body(pTHX_ srl_merger_t *mrg);                 /* write everything in front of the first document */
+SRL_STATIC_INLINE void srl_merger_compact(pTHX_ srl_merger_t *mrg);                    /* drop overridden top level pairs */
 SRL_STATIC_INLINE void srl_merge_single_value(pTHX_ srl_merger_t *mrg);
-SRL_STATIC_INLINE void srl_merge_stringish(pTHX_ srl_merger_t *mrg);
+SRL_STATIC_INLINE UV srl_merge_stringish(pTHX_ srl_merger_t *mrg);
+SRL_STATIC_INLINE UV srl_merge_top_level_hash(pTHX_ srl_merger_t *mrg);
+SRL_STATIC_INLINE int srl_merge_hash_pair(pTHX_ srl_merger_t *mrg, int drop);
+SRL_STATIC_INLINE void srl_merge_top_level_key(pTHX_ srl_merger_t *mrg);
+SRL_STATIC_INLINE void srl_merge_dropped_item(pTHX_ srl_merger_t *mrg, const U8 tag, UV offset);
+SRL_STATIC_INLINE UV srl_merge_dropped_string(pTHX_ srl_merger_t *mrg, UV offset);
+SRL_STATIC_INLINE void srl_drop_merged(pTHX_ srl_merger_t *mrg, UV offset, UV tracked_len);
 SRL_STATIC_INLINE void srl_merge_hash(pTHX_ srl_merger_t *mrg, const U8 tag, UV length);
 SRL_STATIC_INLINE void srl_merge_array(pTHX_ srl_merger_t *mrg, const U8 tag, UV length);
-SRL_STATIC_INLINE void srl_merge_binary_utf8(pTHX_ srl_merger_t *mrg, ptable_entry_ptr ptable_entry);
-SRL_STATIC_INLINE void srl_merge_short_binary(pTHX_ srl_merger_t *mrg, const U8 tag, ptable_entry_ptr ptable_entry);
+SRL_STATIC_INLINE UV srl_merge_binary_utf8(pTHX_ srl_merger_t *mrg);
+SRL_STATIC_INLINE UV srl_merge_short_binary(pTHX_ srl_merger_t *mrg, const U8 tag);
 SRL_STATIC_INLINE void srl_merge_object(pTHX_ srl_merger_t *mrg, const U8 objtag);
 SRL_STATIC_INLINE void srl_fill_header(pTHX_ srl_merger_t *mrg, const char *user_header, STRLEN user_header_len);
+SRL_STATIC_INLINE void srl_buf_fill_header(pTHX_ srl_buffer_t *buf, U32 protocol_version, const char *user_header, STRLEN user_header_len);
+SRL_STATIC_INLINE const char * srl_merger_user_header(pTHX_ srl_merger_t *mrg, SV *user_header_src, STRLEN *user_header_len);
 
-SRL_STATIC_INLINE ptable_entry_ptr srl_store_tracked_offset(pTHX_ srl_merger_t *mrg, UV from, UV to);
+SRL_STATIC_INLINE void srl_store_tracked_offset(pTHX_ srl_merger_t *mrg, UV from, UV to);
 SRL_STATIC_INLINE UV srl_lookup_tracked_offset(pTHX_ srl_merger_t *mrg, UV offset);
 SRL_STATIC_INLINE strtable_entry_ptr srl_lookup_string(pTHX_ srl_merger_t *mrg, const unsigned char *src, STRLEN len, int *ok);
 SRL_STATIC_INLINE strtable_entry_ptr srl_lookup_classname(pTHX_ srl_merger_t *mrg, const unsigned char *src, STRLEN len, int *ok);
 SRL_STATIC_INLINE void srl_cleanup_dedup_tlbs(pTHX_ srl_merger_t *mrg, UV offset);
-
-SRL_STATIC_INLINE ptable_ptr
-srl_init_tracked_offsets_tbl(pTHX_ srl_merger_t *mrg)
-{
-    mrg->tracked_offsets_tbl = PTABLE_new();
-    return mrg->tracked_offsets_tbl;
-}
+SRL_STATIC_INLINE void srl_cleanup_key_tbl(pTHX_ srl_merger_t *mrg, UV offset);
+SRL_STATIC_INLINE STRLEN srl_merger_string_length(const srl_buffer_char *str);
+SRL_STATIC_INLINE void srl_merger_emit_copy(pTHX_ srl_merger_t *mrg, const U8 tag, UV offset, UV replaced_len);
 
 SRL_STATIC_INLINE strtable_ptr
 srl_init_string_deduper_tbl(pTHX_ srl_merger_t *mrg)
 {
     mrg->string_deduper_tbl = STRTABLE_new(&mrg->obuf);
+    STRTABLE_set_memory_limit(mrg->string_deduper_tbl, mrg->dedupe_memory_limit);
     return mrg->string_deduper_tbl;
 }
 
@@ -180,33 +193,15 @@ SRL_STATIC_INLINE strtable_ptr
 srl_init_classname_deduper_tbl(pTHX_ srl_merger_t *mrg)
 {
     mrg->classname_deduper_tbl = STRTABLE_new(&mrg->obuf);
+    STRTABLE_set_memory_limit(mrg->classname_deduper_tbl, mrg->dedupe_memory_limit);
     return mrg->classname_deduper_tbl;
 }
 
-SRL_STATIC_INLINE srl_stack_t *
-srl_init_tracked_offsets(pTHX_ srl_merger_t *mrg)
-{
-    mrg->tracked_offsets = NULL;
-    Newx(mrg->tracked_offsets, 1, srl_stack_t);
-
-    if (expect_false(mrg->tracked_offsets == NULL))
-        croak("Out of memory");
-
-    if (expect_false(srl_stack_init(aTHX_ mrg->tracked_offsets, 16) != 0)) {
-        Safefree(mrg->tracked_offsets);
-        mrg->tracked_offsets = NULL;
-        croak("Out of memory");
-    }
-
-    return mrg->tracked_offsets;
-}
-
 srl_merger_t *
 srl_build_merger_struct(pTHX_ HV *opt)
 {
     srl_merger_t *mrg;
     SV **svp;
-    int i;
 
     mrg = srl_empty_merger_struct(aTHX);
 
@@ -243,10 +238,29 @@ srl_build_merger_struct(pTHX_ HV *opt)
             }
         }
 
+        svp = hv_fetchs(opt, "duplicate_keys", 0);
+        if (svp && SvOK(*svp)) {
+            switch (SvUV(*svp)) {
+                case 0: /* first wins */
+                    SRL_MRG_SET_OPTION(mrg, SRL_F_FIRST_KEY_WINS);
+                    break;
+
+                case 1: /* last wins */
+                    break;
+
+                default:
+                    croak("Invalid Sereal::Merger duplicate_keys policy");
+            }
+        }
+
         svp = hv_fetchs(opt, "dedupe_strings", 0);
         if (svp && SvTRUE(*svp))
             SRL_MRG_SET_OPTION(mrg, SRL_F_DEDUPE_STRINGS);
 
+        svp = hv_fetchs(opt, "dedupe_memory_limit", 0);
+        if (svp && SvOK(*svp))
+            mrg->dedupe_memory_limit = SvUV(*svp);
+
         svp = hv_fetchs(opt, "compress", 0);
         if (svp && SvOK(*svp)) {
             switch (SvIV(*svp)) {
@@ -257,6 +271,41 @@ srl_build_merger_struct(pTHX_ HV *opt)
                     SRL_MRG_SET_OPTION(mrg, SRL_F_COMPRESS_SNAPPY_INCREMENTAL);
                     break;
 
+                case 2: /* zlib */
+                    SRL_MRG_SET_OPTION(mrg, SRL_F_COMPRESS_ZLIB);
+                    if (mrg->protocol_version < 3)
+                        croak("Zlib compression was introduced in protocol version 3 and you are asking for only version %i", (int)mrg->protocol_version);
+
+                    mrg->compress_level = MZ_DEFAULT_COMPRESSION;
+                    svp = hv_fetchs(opt, "compress_level", 0);
+                    if (svp && SvTRUE(*svp)) {
+                        IV lvl = SvIV(*svp);
+                        if (expect_false( lvl < 1 || lvl > 10 )) /* Sekrit: compression lvl 10 is a miniz thing that doesn't exist in normal zlib */
+                            croak("'compress_level' needs to be between 1 and 9");
+                        mrg->compress_level = lvl;
+                    }
+                    break;
+
+                case 3: /* zstd */
+                    SRL_MRG_SET_OPTION(mrg, SRL_F_COMPRESS_ZSTD);
+                    if (mrg->protocol_version < 3)
+                        croak("zstd compression was introduced in protocol version 3 and you are asking for only version %i", (int)mrg->protocol_version);
+
+                    mrg->compress_level = 3; /* default compression level */
+                    svp = hv_fetchs(opt, "compress_level", 0);
+                    if (svp && SvTRUE(*svp)) {
+                        IV lvl = SvIV(*svp);
+                        const int max_lvl = ZSTD_maxCLevel();
+                        if (expect_false( lvl < 1 || lvl > max_lvl ))
+                            croak("'compress_level' needs to be between 1 and %d", max_lvl);
+                        mrg->compress_level = lvl;
+                    }
+
+                    mrg->zstd_cctx = ZSTD_createCCtx();
+                    if (mrg->zstd_cctx == NULL)
+                        croak("Out of memory");
+                    break;
+
                 default:
                     croak("Invalid Sereal compression format");
             }
@@ -265,15 +314,57 @@ srl_build_merger_struct(pTHX_ HV *opt)
         svp = hv_fetchs(opt, "max_recursion_depth", 0);
         if (svp && SvOK(*svp))
             mrg->max_recursion_depth = SvUV(*svp);
+
+        svp = hv_fetchs(opt, "expected_header_size", 0);
+        if (svp && SvOK(*svp)) {
+            /* The user header is passed as a Sereal document. Its own
+             * header makes room for ours, but not for its length varint */
+            mrg->header_space = SvUV(*svp) + SRL_MAX_VARINT_LENGTH;
+        }
+
+        svp = hv_fetchs(opt, "stream_to", 0);
+        if (svp && SvOK(*svp)) {
+            IO *io = sv_2io(*svp);
+            if (IoOFP(io) == NULL)
+                croak("The stream_to filehandle is not open for writing");
+
+            /* dropping what was written out from obuf is only fine
+             * as long as nothing refers back to it */
+            if (SRL_MRG_HAVE_OPTION(mrg, SRL_F_DEDUPE_STRINGS))
+                croak("The stream_to and dedupe_strings options are mutually exclusive");
+            if (SRL_MRG_HAVE_OPTION(mrg, SRL_F_COMPRESS_FLAGS_MASK))
+                croak("The stream_to and compress options are mutually exclusive");
+            if (mrg->protocol_version < 2)
+                croak("The stream_to option needs protocol version 2 or higher");
+            /* duplicate keys are found in what was merged before */
+            if (SRL_MRG_HAVE_OPTION(mrg, SRL_F_TOPLEVEL_KEY_HASH))
+                croak("The stream_to option can't be used with a top level hash");
+
+            mrg->stream_to = SvREFCNT_inc_simple_NN(*svp);
+
+            svp = hv_fetchs(opt, "stream_threshold", 0);
+            if (svp && SvOK(*svp))
+                mrg->stream_threshold = SvUV(*svp);
+        }
     }
 
+    srl_merger_begin_body(aTHX_ mrg);
+    return mrg;
+}
+
+/* Write the start of the merged document into the empty obuf */
+SRL_STATIC_INLINE void
+srl_merger_begin_body(pTHX_ srl_merger_t *mrg)
+{
+    int i;
+
     if (mrg->protocol_version == 1) {
         srl_fill_header(aTHX_ mrg, NULL, 0);
     } else {
         /* Preallocate memory for buffer.
-         * SRL_PREALLOCATE_FOR_USER_HEADER for potential user header + 100 bytes for body */
-        GROW_BUF(&mrg->obuf, SRL_PREALLOCATE_FOR_USER_HEADER + 100);
-        mrg->obuf.pos = mrg->obuf.start + SRL_PREALLOCATE_FOR_USER_HEADER;
+         * header_space for Sereal and potential user header + 100 bytes for body */
+        GROW_BUF(&mrg->obuf, mrg->header_space + 100);
+        mrg->obuf.pos = mrg->obuf.start + mrg->header_space;
         SRL_UPDATE_BODY_POS(&mrg->obuf, mrg->protocol_version);
     }
 
@@ -286,8 +377,6 @@ srl_build_merger_struct(pTHX_ HV *opt)
             srl_buf_cat_char_nocheck(&mrg->obuf, SRL_HDR_PAD);
         }
     }
-
-    return mrg;
 }
 
 SRL_STATIC_INLINE void
@@ -297,28 +386,66 @@ srl_fill_header(pTHX_ srl_merger_t *mrg, const char *user_header, STRLEN user_he
      * + potentially uncompressed size varint
      * +  1 byte varint that indicates zero-length header */
     GROW_BUF(&mrg->obuf, 128);
+    srl_buf_fill_header(aTHX_ &mrg->obuf, mrg->protocol_version, user_header, user_header_len);
+}
 
-    if (expect_true(mrg->protocol_version > 2)) {
-        srl_buf_cat_str_s_nocheck(&mrg->obuf, SRL_MAGIC_STRING_HIGHBIT);
+/* Write the Sereal header to buf which must have enough space for it */
+SRL_STATIC_INLINE void
+srl_buf_fill_header(pTHX_ srl_buffer_t *buf, U32 protocol_version, const char *user_header, STRLEN user_header_len)
+{
+    if (expect_true(protocol_version > 2)) {
+        srl_buf_cat_str_s_nocheck(buf, SRL_MAGIC_STRING_HIGHBIT);
     } else {
-        srl_buf_cat_str_s_nocheck(&mrg->obuf, SRL_MAGIC_STRING);
+        srl_buf_cat_str_s_nocheck(buf, SRL_MAGIC_STRING);
     }
 
-    srl_buf_cat_char_nocheck(&mrg->obuf, (U8) mrg->protocol_version);
+    srl_buf_cat_char_nocheck(buf, (U8) protocol_version);
 
     if (user_header == NULL) {
-        srl_buf_cat_char_nocheck(&mrg->obuf, '\0');
+        srl_buf_cat_char_nocheck(buf, '\0');
     } else {
-        if (expect_false(mrg->protocol_version < 2))
+        if (expect_false(protocol_version < 2))
             croak("Cannot serialize user header data in Sereal protocol V1 mode!"); /* TODO */
 
-        srl_buf_cat_varint_nocheck(aTHX_ &mrg->obuf, 0, (UV) (user_header_len + 1)); /* Encode header length, +1 for bit field */
-        srl_buf_cat_char_nocheck(&mrg->obuf, '\1');                                  /* Encode bitfield */
-        Copy(user_header, mrg->obuf.pos, user_header_len, char);                     /* Copy user header data */
-        mrg->obuf.pos += user_header_len;
+        srl_buf_cat_varint_nocheck(aTHX_ buf, 0, (UV) (user_header_len + 1)); /* Encode header length, +1 for bit field */
+        srl_buf_cat_char_nocheck(buf, '\1');                                  /* Encode bitfield */
+        Copy(user_header, buf->pos, user_header_len, char);                   /* Copy user header data */
+        buf->pos += user_header_len;
     }
 
-    SRL_UPDATE_BODY_POS(&mrg->obuf, mrg->protocol_version);
+    SRL_UPDATE_BODY_POS(buf, protocol_version);
+}
+
+/* Check that user_header_src is a plain Sereal document of the right
+ * version and return the encoded user header data inside it */
+SRL_STATIC_INLINE const char *
+srl_merger_user_header(pTHX_ srl_merger_t *mrg, SV *user_header_src, STRLEN *user_header_len)
+{
+    const char *user_header;
+    U8 encoding_flags, protocol_version;
+    IV proto_version_and_encoding_flags_int;
+
+    if (mrg->protocol_version < 2)
+        croak("Sereal version does not support headers");
+
+    user_header = (char*) SvPV(user_header_src, *user_header_len);
+    proto_version_and_encoding_flags_int = srl_validate_header_version(aTHX_ (srl_reader_char_ptr) user_header, *user_header_len);
+    if (expect_false(proto_version_and_encoding_flags_int < 1))
+        croak("Bad Sereal header: Not a valid Sereal document.");
+
+    protocol_version = (U8) (proto_version_and_encoding_flags_int & SRL_PROTOCOL_VERSION_MASK);
+    if (expect_false(protocol_version != mrg->protocol_version))
+        croak("The versions of body and header do not match");
+
+    encoding_flags = (U8) (proto_version_and_encoding_flags_int & SRL_PROTOCOL_ENCODING_MASK);
+    if (expect_false(encoding_flags != SRL_PROTOCOL_ENCODING_RAW))
+        croak("The header has unsupported format.");
+
+    if (expect_false(*user_header_len < SRL_MINIMALISTIC_HEADER_SIZE))
+        croak("Provided user header is too short");
+
+    *user_header_len -= SRL_MINIMALISTIC_HEADER_SIZE;
+    return user_header + SRL_MINIMALISTIC_HEADER_SIZE;
 }
 
 void
@@ -328,17 +455,22 @@ srl_destroy_merger(pTHX_ srl_merger_t *mrg)
 
     srl_destroy_snappy_workmem(aTHX_ mrg->snappy_workmem);
 
-    if (mrg->tracked_offsets) {
-        srl_stack_deinit(aTHX_ mrg->tracked_offsets);
-        Safefree(mrg->tracked_offsets);
-        mrg->tracked_offsets = NULL;
+    if (mrg->zstd_cctx) {
+        ZSTD_freeCCtx(mrg->zstd_cctx);
+        mrg->zstd_cctx = NULL;
     }
 
-    if (mrg->tracked_offsets_tbl) {
-        PTABLE_free(mrg->tracked_offsets_tbl);
-        mrg->tracked_offsets_tbl = NULL;
+    if (mrg->zstd_dctx) {
+        ZSTD_freeDCtx(mrg->zstd_dctx);
+        mrg->zstd_dctx = NULL;
     }
 
+    SvREFCNT_dec(mrg->zstd_ibuf);
+    srl_buf_free_buffer(aTHX_ &mrg->snapshot_buf);
+
+    Safefree(mrg->tracked_offsets);
+    SvREFCNT_dec(mrg->stream_to);
+
     if (mrg->string_deduper_tbl) {
         STRTABLE_free(mrg->string_deduper_tbl);
         mrg->string_deduper_tbl = NULL;
@@ -349,17 +481,19 @@ srl_destroy_merger(pTHX_ srl_merger_t *mrg)
         mrg->classname_deduper_tbl = NULL;
     }
 
+    if (mrg->key_tbl) {
+        STRTABLE_free(mrg->key_tbl);
+        mrg->key_tbl = NULL;
+    }
+
+    Safefree(mrg->overridden_pairs);
     Safefree(mrg);
 }
 
-void
-srl_merger_append(pTHX_ srl_merger_t *mrg, SV *src)
+/* If the last merge operation has failed, drop whatever it left in obuf */
+SRL_STATIC_INLINE void
+srl_merger_recover(pTHX_ srl_merger_t *mrg)
 {
-    assert(mrg != NULL);
-
-    srl_set_input_buffer(aTHX_ mrg, src);
-    srl_build_track_table(aTHX_ mrg);
-
     if (mrg->obuf_last_successfull_offset) {
         /* If obuf_last_successfull_offset is true then last merge
          * operation has failed. It means that some cleanup operation needs to
@@ -368,25 +502,67 @@ srl_merger_append(pTHX_ srl_merger_t *mrg, SV *src)
         SRL_MERGER_TRACE("last merge operation has failed, need to do some cleanup (offset %"UVuf")",
                           mrg->obuf_last_successfull_offset);
 
-        mrg->obuf.pos = mrg->obuf.body_pos + mrg->obuf_last_successfull_offset;
+        mrg->obuf.pos = SRL_MRG_BODY_PTR(mrg, mrg->obuf_last_successfull_offset);
         srl_cleanup_dedup_tlbs(aTHX_ mrg, mrg->obuf_last_successfull_offset);
+        srl_cleanup_key_tbl(aTHX_ mrg, mrg->obuf_last_successfull_offset);
+        mrg->dedupe_hits = mrg->dedupe_hits_committed;
+        mrg->dedupe_bytes_saved = mrg->dedupe_bytes_saved_committed;
+        mrg->obuf_last_successfull_offset = 0;
         DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
     }
+}
 
-    /* preallocate space in obuf,
-     * but this is still not enough because due to
-     * varint we might need more space in obug then size of ibuf */
-    GROW_BUF(&mrg->obuf, (size_t) SRL_RDR_SIZE(mrg->pibuf));
-
+/* Merge the document in ibuf */
+SRL_STATIC_INLINE void
+srl_merger_merge_document(pTHX_ srl_merger_t *mrg)
+{
     /* save current offset as last successfull */
-    mrg->obuf_last_successfull_offset = BODY_POS_OFS(&mrg->obuf);
+    mrg->obuf_last_successfull_offset = SRL_MRG_BODY_OFS(mrg);
 
     mrg->recursion_depth = 0;
+    mrg->dropping = 0;
     mrg->ibuf.pos = mrg->ibuf.body_pos + 1;
-    srl_merge_single_value(aTHX_ mrg);
+
+    if (SRL_MRG_HAVE_OPTION(mrg, SRL_F_TOPLEVEL_KEY_HASH)) {
+        mrg->cnt_of_merged_keys += srl_merge_top_level_hash(aTHX_ mrg);
+    } else {
+        srl_merge_single_value(aTHX_ mrg);
+    }
 
     mrg->cnt_of_merged_elements++;
+    mrg->overridden_committed = mrg->overridden_len;
+    mrg->dedupe_hits_committed = mrg->dedupe_hits;
+    mrg->dedupe_bytes_saved_committed = mrg->dedupe_bytes_saved;
     mrg->obuf_last_successfull_offset = 0;
+
+    if (mrg->stream_to && (UV) BUF_POS_OFS(&mrg->obuf) >= mrg->stream_threshold)
+        srl_merger_flush(aTHX_ mrg);
+}
+
+SRL_STATIC_INLINE void
+srl_merger_append_buffer(pTHX_ srl_merger_t *mrg, srl_reader_char_ptr src, STRLEN len)
+{
+    srl_set_input_buffer(aTHX_ mrg, src, len);
+    srl_merger_recover(aTHX_ mrg);
+
+    /* preallocate space in obuf,
+     * but this is still not enough because due to
+     * varint we might need more space in obug then size of ibuf */
+    GROW_BUF(&mrg->obuf, (size_t) SRL_RDR_SIZE(mrg->pibuf));
+
+    srl_merger_merge_document(aTHX_ mrg);
+}
+
+void
+srl_merger_append(pTHX_ srl_merger_t *mrg, SV *src)
+{
+    STRLEN len;
+    srl_reader_char_ptr tmp;
+
+    assert(mrg != NULL);
+
+    tmp = (srl_reader_char_ptr) SvPV(src, len);
+    srl_merger_append_buffer(aTHX_ mrg, tmp, len);
 }
 
 void
@@ -394,21 +570,12 @@ srl_merger_append_all(pTHX_ srl_merger_t *mrg, AV *src)
 {
     SSize_t i;
     SV **svptr;
+    STRLEN len;
     STRLEN size = 0;
+    srl_reader_char_ptr tmp;
     SSize_t tidx = av_len(src);
 
-    if (mrg->obuf_last_successfull_offset) {
-        /* If obuf_last_successfull_offset is true then last merge
-         * operation has failed. It means that some cleanup operation needs to
-         * be done. */
-
-        SRL_MERGER_TRACE("last merge operation has failed, need to do some cleanup (offset %"UVuf")",
-                          mrg->obuf_last_successfull_offset);
-
-        mrg->obuf.pos = mrg->obuf.body_pos + mrg->obuf_last_successfull_offset;
-        srl_cleanup_dedup_tlbs(aTHX_ mrg, mrg->obuf_last_successfull_offset);
-        DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
-    }
+    srl_merger_recover(aTHX_ mrg);
 
     for (i = 0; i <= tidx; ++i) {
         svptr = av_fetch(src, i, 0);
@@ -419,23 +586,339 @@ srl_merger_append_all(pTHX_ srl_merger_t *mrg, AV *src)
     }
 
     /* preallocate space in obuf in one go,
-     * of course this's is very rough estimation */
-    GROW_BUF(&mrg->obuf, size);
+     * of course this's is very rough estimation.
+     * When streaming obuf is kept small instead */
+    if (!mrg->stream_to)
+        GROW_BUF(&mrg->obuf, size);
 
     for (i = 0; i <= tidx; ++i) {
-        srl_set_input_buffer(aTHX_ mrg, *av_fetch(src, i, 0));
-        srl_build_track_table(aTHX_ mrg);
+        tmp = (srl_reader_char_ptr) SvPV(*av_fetch(src, i, 0), len);
+        srl_set_input_buffer(aTHX_ mrg, tmp, len);
 
-        /* save current offset as last successfull */
-        mrg->obuf_last_successfull_offset = BODY_POS_OFS(&mrg->obuf);
+        if (mrg->stream_to)
+            GROW_BUF(&mrg->obuf, (size_t) SRL_RDR_SIZE(mrg->pibuf));
 
-        mrg->recursion_depth = 0;
-        mrg->ibuf.pos = mrg->ibuf.body_pos + 1;
-        srl_merge_single_value(aTHX_ mrg);
+        srl_merger_merge_document(aTHX_ mrg);
+    }
+}
 
-        mrg->cnt_of_merged_elements++;
-        mrg->obuf_last_successfull_offset = 0;
+/* A read-only view of a file's content, see srl_map_file() */
+typedef struct {
+    srl_reader_char_ptr start;
+    STRLEN len;
+    SV *owner;                            /* holds the content if mmap() is not available */
+} srl_merger_file_t;
+
+SRL_STATIC_INLINE void
+srl_unmap_file(pTHX_ void *ptr)
+{
+    srl_merger_file_t *file = (srl_merger_file_t *) ptr;
+
+#ifdef HAS_MMAP
+    if (file->start && !file->owner)
+        munmap((Mmap_t) file->start, file->len);
+#endif
+    SvREFCNT_dec(file->owner);
+    file->start = NULL;
+    file->owner = NULL;
+}
+
+/* Make the content of the file at path available in file. Uses mmap() if
+ * perl has it, so that the merger reads straight from the page cache and
+ * the file is never copied into a perl scalar. */
+SRL_STATIC_INLINE void
+srl_map_file(pTHX_ srl_merger_file_t *file, const char *path)
+{
+    int fd;
+    Stat_t st;
+
+    fd = PerlLIO_open(path, O_RDONLY);
+    if (expect_false(fd < 0))
+        croak("Failed to open '%s': %s", path, Strerror(errno));
+
+    if (expect_false(PerlLIO_fstat(fd, &st) < 0)) {
+        const int err = errno;
+        PerlLIO_close(fd);
+        croak("Failed to stat '%s': %s", path, Strerror(err));
     }
+
+    file->len = (STRLEN) st.st_size;
+    if (file->len == 0) {
+        /* mmap() refuses empty mappings, an empty buffer is rejected
+         * by srl_set_input_buffer() anyway */
+        PerlLIO_close(fd);
+        file->start = (srl_reader_char_ptr) "";
+        file->owner = newSVpvs("");
+        return;
+    }
+
+#ifdef HAS_MMAP
+    {
+        Mmap_t addr = (Mmap_t) mmap(NULL, file->len, PROT_READ, MAP_PRIVATE, fd, 0);
+        const int err = errno;
+        PerlLIO_close(fd);
+
+        if (expect_false(addr == (Mmap_t) MAP_FAILED))
+            croak("Failed to mmap '%s': %s", path, Strerror(err));
+
+# ifdef MADV_SEQUENTIAL
+        /* the document is merged front to back */
+        (void) madvise(addr, file->len, MADV_SEQUENTIAL);
+# endif
+        file->start = (srl_reader_char_ptr) addr;
+    }
+#else
+    {
+        STRLEN done = 0;
+        char *buf;
+
+        file->owner = newSV(file->len + 1);
+        buf = SvPVX(file->owner);
+
+        while (done < file->len) {
+            SSize_t got = PerlLIO_read(fd, buf + done, file->len - done);
+            if (got <= 0) {
+                const int err = got < 0 ? errno : EIO;
+                PerlLIO_close(fd);
+                croak("Failed to read '%s': %s", path, Strerror(err));
+            }
+            done += got;
+        }
+
+        PerlLIO_close(fd);
+        file->start = (srl_reader_char_ptr) buf;
+    }
+#endif
+}
+
+void
+srl_merger_append_file(pTHX_ srl_merger_t *mrg, SV *path)
+{
+    srl_merger_file_t *file;
+
+    ENTER;
+    Newxz(file, 1, srl_merger_file_t);
+    SAVEFREEPV(file);
+    /* unmap even if the document turns out to be broken */
+    SAVEDESTRUCTOR_X(srl_unmap_file, file);
+    srl_map_file(aTHX_ file, SvPV_nolen(path));
+
+    srl_merger_append_buffer(aTHX_ mrg, file->start, file->len);
+    LEAVE;
+}
+
+void
+srl_merger_append_files(pTHX_ srl_merger_t *mrg, AV *paths)
+{
+    SSize_t i;
+    SV **svptr;
+    SSize_t tidx = av_len(paths);
+
+    for (i = 0; i <= tidx; ++i) {
+        svptr = av_fetch(paths, i, 0);
+        if (expect_false(svptr == NULL))
+            croak("av_fetch returned NULL");
+
+        srl_merger_append_file(aTHX_ mrg, *svptr);
+    }
+}
+
+/* Write obuf out to stream_to and empty it. The first call also writes the
+ * Sereal header, which is why streaming doesn't support user headers. */
+SRL_STATIC_INLINE void
+srl_merger_flush(pTHX_ srl_merger_t *mrg)
+{
+    PerlIO *io = IoOFP(sv_2io(mrg->stream_to));
+    srl_buffer_char *from = mrg->obuf.start;
+    STRLEN len;
+
+    DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
+
+    if (mrg->stream_written == 0 && mrg->obuf_flushed == 0) {
+        /* same as srl_merger_finish() without user header */
+        const UV srl_start_offset = mrg->header_space - SRL_MINIMALISTIC_HEADER_SIZE;
+        const UV end_offset = BODY_POS_OFS(&mrg->obuf);
+
+        mrg->obuf.pos = mrg->obuf.start + srl_start_offset;
+        srl_fill_header(aTHX_ mrg, NULL, 0);
+        mrg->obuf.pos = mrg->obuf.body_pos + end_offset;
+        DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
+
+        from = mrg->obuf.start + srl_start_offset;
+        if (!SRL_MRG_HAVE_OPTION(mrg, SRL_F_TOPLEVEL_KEY_SCALAR)) {
+            const Off_t here = PerlIO_tell(io);
+            if (expect_false(here < 0))
+                croak("Failed to get the position in the stream_to filehandle: %s", Strerror(errno));
+            mrg->stream_count_pos = here + (Off_t) (mrg->obuf_padding_bytes_offset - srl_start_offset);
+        }
+    }
+
+    len = mrg->obuf.pos - from;
+    if (expect_false(len && (STRLEN) PerlIO_write(io, from, len) != len))
+        croak("Failed to write merged Sereal document: %s", Strerror(errno));
+
+    mrg->stream_written += len;
+    mrg->obuf_flushed = SRL_MRG_BODY_OFS(mrg);
+    mrg->obuf.pos = mrg->obuf.start;
+    mrg->obuf.body_pos = mrg->obuf.start;
+}
+
+/* srl_merger_finish() for merged documents which are streamed to a filehandle:
+ * writes out the rest of the document, then goes back to fill in the
+ * number of elements. Returns the number of bytes written. */
+SRL_STATIC_INLINE SV *
+srl_merger_finish_stream(pTHX_ srl_merger_t *mrg, SV *user_header_src)
+{
+    PerlIO *io;
+
+    if (user_header_src)
+        croak("Sereal::Merger can not write a user header when streaming to a filehandle");
+
+    srl_merger_flush(aTHX_ mrg);
+    io = IoOFP(sv_2io(mrg->stream_to));
+
+    if (!SRL_MRG_HAVE_OPTION(mrg, SRL_F_TOPLEVEL_KEY_SCALAR)) {
+        U8 count[SRL_MAX_VARINT_LENGTH_U32];
+        const Off_t end = PerlIO_tell(io);
+
+        srl_merger_fill_count(aTHX_ mrg, count);
+        if (expect_false(   end < 0
+                         || PerlIO_seek(io, mrg->stream_count_pos, SEEK_SET) < 0
+                         || PerlIO_write(io, count, sizeof(count)) != sizeof(count)
+                         || PerlIO_seek(io, end, SEEK_SET) < 0))
+        {
+            croak("Failed to write the number of merged documents to the stream_to filehandle: %s", Strerror(errno));
+        }
+    }
+
+    if (expect_false(PerlIO_flush(io) != 0))
+        croak("Failed to write merged Sereal document: %s", Strerror(errno));
+
+    return newSVuv(mrg->stream_written);
+}
+
+/* Write the number of elements of the top level container into the
+ * SRL_MAX_VARINT_LENGTH_U32 bytes reserved for it. Arrays get PAD bytes after
+ * the varint, but a hash key can't be preceded by PAD, so the varint of a hash
+ * is padded with continuation bytes instead. */
+SRL_STATIC_INLINE void
+srl_merger_fill_count(pTHX_ srl_merger_t *mrg, srl_buffer_char *count)
+{
+    const int pad_varint = SRL_MRG_HAVE_OPTION(mrg, SRL_F_TOPLEVEL_KEY_HASH) != 0;
+    UV n = SRL_MRG_TOP_LEVEL_COUNT(mrg);
+    int i;
+
+    memset(count, SRL_HDR_PAD, SRL_MAX_VARINT_LENGTH_U32);
+    for (i = 0; n >= 0x80 || (pad_varint && i < SRL_MAX_VARINT_LENGTH_U32 - 1); ++i) {
+        count[i] = (srl_buffer_char) ((n & 0x7f) | 0x80);
+        n >>= 7;
+    }
+
+    count[i] = (srl_buffer_char) n;
+}
+
+/* Make room for a header of header_space bytes in front of the body.
+ * Offsets in the body are relative to body_pos, so moving the body
+ * doesn't change them. */
+SRL_STATIC_INLINE void
+srl_merger_grow_header_space(pTHX_ srl_merger_t *mrg, UV header_space)
+{
+    const UV delta = header_space - mrg->header_space;
+    const STRLEN body_len = mrg->obuf.pos - (mrg->obuf.start + mrg->header_space);
+
+    assert(header_space > mrg->header_space);
+    SRL_MERGER_TRACE("grow header space from %"UVuf" to %"UVuf, mrg->header_space, header_space);
+
+    GROW_BUF(&mrg->obuf, delta);
+    Move(mrg->obuf.start + mrg->header_space, mrg->obuf.start + header_space, body_len, srl_buffer_char);
+
+    mrg->obuf.pos += delta;
+    mrg->obuf.body_pos += delta;
+    mrg->obuf_padding_bytes_offset += delta;
+    mrg->header_space = header_space;
+    DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
+}
+
+static int
+srl_merger_cmp_offsets(const void *a, const void *b)
+{
+    const UV x = *(const UV *) a;
+    const UV y = *(const UV *) b;
+    return x < y ? -1 : x > y;
+}
+
+/* Rewrite the merged body without the top level pairs whose key came again
+ * later. The old body is merged again like one big input document, which
+ * takes care of every offset which changes, and fills the deduper tables
+ * anew. */
+SRL_STATIC_INLINE void
+srl_merger_compact(pTHX_ srl_merger_t *mrg)
+{
+    srl_buffer_t old;
+    UV *dropped = mrg->overridden_pairs;
+    const UV dropped_len = mrg->overridden_len;
+    const UV old_keys = mrg->cnt_of_merged_keys;
+    const UV old_padding_bytes_offset = mrg->obuf_padding_bytes_offset;
+    UV i, next = 0, keys = 0;
+
+    if (dropped_len == 0)
+        return;
+
+    assert(mrg->overridden_committed == dropped_len);
+    assert(mrg->obuf_last_successfull_offset == 0);
+    SRL_MERGER_TRACE("compact: drop %lu of %lu pairs", (unsigned long) dropped_len, (unsigned long) old_keys);
+
+    qsort(dropped, dropped_len, sizeof(UV), srl_merger_cmp_offsets);
+    mrg->overridden_pairs = NULL;
+    mrg->overridden_len = mrg->overridden_size = mrg->overridden_committed = 0;
+
+    old = mrg->obuf;
+    if (expect_false(srl_buf_init_buffer(aTHX_ &mrg->obuf, BUF_SIZE(&old)) != 0)) {
+        mrg->obuf = old;
+        Safefree(dropped);
+        croak("Out of memory");
+    }
+
+    if (mrg->string_deduper_tbl) {
+        STRTABLE_free(mrg->string_deduper_tbl);
+        mrg->string_deduper_tbl = NULL;
+    }
+
+    if (mrg->classname_deduper_tbl) {
+        STRTABLE_free(mrg->classname_deduper_tbl);
+        mrg->classname_deduper_tbl = NULL;
+    }
+
+    if (mrg->key_tbl) {
+        STRTABLE_free(mrg->key_tbl);
+        mrg->key_tbl = NULL;
+    }
+
+    srl_merger_begin_body(aTHX_ mrg);
+
+    SRL_RDR_CLEAR(&mrg->ibuf);
+    mrg->ibuf.start = old.start;
+    mrg->ibuf.end = old.pos;
+    mrg->ibuf.body_pos = old.body_pos;
+    mrg->ibuf.pos = old.start + old_padding_bytes_offset + SRL_MAX_VARINT_LENGTH_U32;
+    mrg->tracked_offsets_len = 0;
+    mrg->recursion_depth = 0;
+    mrg->dropping = 0;
+
+    for (i = 0; i < old_keys; ++i) {
+        const int drop = next < dropped_len && dropped[next] == (UV) SRL_RDR_BODY_POS_OFS(mrg->pibuf);
+        next += drop;
+        keys += srl_merge_hash_pair(aTHX_ mrg, drop);
+    }
+
+    assert(next == dropped_len);
+    assert(mrg->overridden_len == 0);
+
+    mrg->cnt_of_merged_keys = keys;
+    SRL_RDR_CLEAR(&mrg->ibuf);
+    mrg->tracked_offsets_len = 0;
+    srl_buf_free_buffer(aTHX_ &old);
+    Safefree(dropped);
 }
 
 SV *
@@ -446,63 +929,32 @@ srl_merger_finish(pTHX_ srl_merger_t *mrg, SV *user_header_src)
     UV srl_start_offset = 0;
 
     DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
+    srl_merger_recover(aTHX_ mrg);
+    srl_merger_compact(aTHX_ mrg);
 
-    if (mrg->obuf_last_successfull_offset) {
-        SRL_MERGER_TRACE("last merge operation has failed, reset to offset %"UVuf"",
-                          mrg->obuf_last_successfull_offset);
-
-        mrg->obuf.pos = mrg->obuf.body_pos + mrg->obuf_last_successfull_offset;
-        DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
-    }
+    if (mrg->stream_to)
+        return srl_merger_finish_stream(aTHX_ mrg, user_header_src);
 
     /* store offset to the end of the document */
     end_offset = BODY_POS_OFS(&mrg->obuf);
     body_offset = mrg->obuf.body_pos - mrg->obuf.start;
 
     if (!SRL_MRG_HAVE_OPTION(mrg, SRL_F_TOPLEVEL_KEY_SCALAR)) {
-        mrg->obuf.pos = mrg->obuf.start + mrg->obuf_padding_bytes_offset;
-        DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
-
-        srl_buf_cat_varint_nocheck(aTHX_ &mrg->obuf, 0, mrg->cnt_of_merged_elements);
-        DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
-
-        mrg->obuf.pos = mrg->obuf.body_pos + end_offset;
+        srl_merger_fill_count(aTHX_ mrg, mrg->obuf.start + mrg->obuf_padding_bytes_offset);
         DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
     }
 
     if (user_header_src) {
-        char *user_header;
+        const char *user_header;
         STRLEN user_header_len;
-        U8 encoding_flags, protocol_version;
-        IV proto_version_and_encoding_flags_int;
         UV need_space_for_sereal_and_user_headers = 0;
 
-        if (mrg->protocol_version < 2)
-            croak("Sereal version does not support headers");
-
-        user_header = (char*) SvPV(user_header_src, user_header_len);
-        proto_version_and_encoding_flags_int = srl_validate_header_version(aTHX_ (srl_reader_char_ptr) user_header, user_header_len);
-        if (expect_false(proto_version_and_encoding_flags_int < 1))
-            croak("Bad Sereal header: Not a valid Sereal document.");
-
-        protocol_version = (U8) (proto_version_and_encoding_flags_int & SRL_PROTOCOL_VERSION_MASK);
-        if (expect_false(protocol_version != mrg->protocol_version))
-            croak("The versions of body and header do not match");
-
-        encoding_flags = (U8) (proto_version_and_encoding_flags_int & SRL_PROTOCOL_ENCODING_MASK);
-        if (expect_false(encoding_flags != SRL_PROTOCOL_ENCODING_RAW))
-            croak("The header has unsupported format.");
-
-        if (expect_false(user_header_len < SRL_MINIMALISTIC_HEADER_SIZE))
-            croak("Provided user header is too short");
+        user_header = srl_merger_user_header(aTHX_ mrg, user_header_src, &user_header_len);
 
         /* here some byte magic goes. The main idea is to fix user_header
          * inside preallocated space. However, due to varint it becomes quite
          * tricky */
 
-        user_header     += SRL_MINIMALISTIC_HEADER_SIZE;
-        user_header_len -= SRL_MINIMALISTIC_HEADER_SIZE;
-
         /* =srl + 1 byte for version + 1 byte for header */
         need_space_for_sereal_and_user_headers
             = 4                                             /* srl magic */ 
@@ -511,12 +963,13 @@ srl_merger_finish(pTHX_ srl_merger_t *mrg, SV *user_header_src)
             + srl_varint_length(aTHX_ user_header_len + 1)  /* user_header_len in varint representation, add one because of bit field */
             + user_header_len;
 
-        if (SRL_PREALLOCATE_FOR_USER_HEADER < need_space_for_sereal_and_user_headers) {
-            croak("User header excided SRL_PREALLOCATE_FOR_USER_HEADER. Need to reallocate memory but too lazy to implement this"); /* TODO */
+        if (mrg->header_space < need_space_for_sereal_and_user_headers) {
+            srl_merger_grow_header_space(aTHX_ mrg, need_space_for_sereal_and_user_headers);
+            body_offset = mrg->obuf.body_pos - mrg->obuf.start;
         }
 
         /* move position to where Sereal and user headers should start with * / */
-        srl_start_offset = SRL_PREALLOCATE_FOR_USER_HEADER - need_space_for_sereal_and_user_headers;
+        srl_start_offset = mrg->header_space - need_space_for_sereal_and_user_headers;
         mrg->obuf.pos = mrg->obuf.start + srl_start_offset;
 
         srl_fill_header(aTHX_ mrg, user_header, user_header_len);
@@ -527,35 +980,151 @@ srl_merger_finish(pTHX_ srl_merger_t *mrg, SV *user_header_src)
                   (UV) (mrg->obuf.pos - mrg->obuf.start), body_offset);
         }
 
-        mrg->obuf.pos += end_offset;
+        mrg->obuf.pos = mrg->obuf.body_pos + end_offset;
     } else if (mrg->protocol_version > 1) {
-        assert(SRL_PREALLOCATE_FOR_USER_HEADER > SRL_MINIMALISTIC_HEADER_SIZE);
+        assert(mrg->header_space >= SRL_MINIMALISTIC_HEADER_SIZE);
 
         /* move position to where Sereal and user headers should start with * / */
-        srl_start_offset = SRL_PREALLOCATE_FOR_USER_HEADER - SRL_MINIMALISTIC_HEADER_SIZE;
+        srl_start_offset = mrg->header_space - SRL_MINIMALISTIC_HEADER_SIZE;
         mrg->obuf.pos = mrg->obuf.start + srl_start_offset;
 
         srl_fill_header(aTHX_ mrg, NULL, 0);
         DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
 
-        if (expect_false(body_offset != (UV) (mrg->obuf.pos - mrg->obuf.start - 1))) {
-            croak("Bizare! Body pointer has different offset after writing Sereal header!");
-        }
+        if (expect_false(body_offset != (UV) (mrg->obuf.pos - mrg->obuf.start - 1))) {
+            croak("Bizare! Body pointer has different offset after writing Sereal header!");
+        }
+
+        mrg->obuf.pos = mrg->obuf.body_pos + end_offset;
+    }
+
+    DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
+
+    assert(srl_start_offset <= (UV) BUF_POS_OFS(&mrg->obuf));
+    DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
+
+    if (SRL_MRG_HAVE_OPTION(mrg, SRL_F_COMPRESS_FLAGS_MASK)) {
+        /* srl_compress_body() expects the Sereal header at the very start
+         * of the buffer, so move the document over the unused part of the
+         * space preallocated for the user header first */
+        const STRLEN document_len = BUF_POS_OFS(&mrg->obuf) - srl_start_offset;
+        const STRLEN header_len = mrg->protocol_version > 1
+                                ? body_offset + 1 - srl_start_offset
+                                : SRL_MINIMALISTIC_HEADER_SIZE;
+
+        Move(mrg->obuf.start + srl_start_offset, mrg->obuf.start, document_len, srl_buffer_char);
+        mrg->obuf.pos = mrg->obuf.start + document_len;
+
+        srl_compress_body(aTHX_ &mrg->obuf, header_len, SRL_MRG_HAVE_OPTION(mrg, SRL_F_COMPRESS_FLAGS_MASK),
+                          (int) mrg->compress_level, &mrg->snappy_workmem, mrg->zstd_cctx);
+        SRL_UPDATE_BODY_POS(&mrg->obuf, mrg->protocol_version);
+        DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
+
+        return newSVpvn((char *) mrg->obuf.start, BUF_POS_OFS(&mrg->obuf));
+    }
+
+    return newSVpvn((char *) mrg->obuf.start + srl_start_offset, BUF_POS_OFS(&mrg->obuf) - srl_start_offset);
+}
+
+SV *
+srl_merger_snapshot(pTHX_ srl_merger_t *mrg, SV *user_header_src)
+{
+    srl_buffer_t local_doc;
+    srl_buffer_t *doc;
+    const char *user_header = NULL;
+    STRLEN user_header_len = 0;
+    STRLEN header_len, body_len;
+    SV *out = NULL;
+
+    DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
+
+    if (mrg->stream_to)
+        croak("Sereal::Merger can not take a snapshot when streaming to a filehandle");
+    if (mrg->protocol_version < 2)
+        croak("Sereal::Merger snapshots need protocol version 2 or higher");
+
+    srl_merger_recover(aTHX_ mrg);
+    srl_merger_compact(aTHX_ mrg);
+
+    if (user_header_src)
+        user_header = srl_merger_user_header(aTHX_ mrg, user_header_src, &user_header_len);
+
+    header_len = SRL_MAGIC_STRLEN + 1                                /* magic and version */
+               + (user_header
+                  ? srl_varint_length(aTHX_ user_header_len + 1) + 1 + user_header_len
+                  : 1);
+    body_len = mrg->obuf.pos - (mrg->obuf.body_pos + 1);
+
+    /* Build the document in a copy, straight in the result unless it gets
+     * compressed, and leave obuf alone so that merging can go on. The copy
+     * to compress belongs to the merger, so nothing leaks if compressing
+     * croaks, and it is reused by the next snapshot. */
+    if (SRL_MRG_HAVE_OPTION(mrg, SRL_F_COMPRESS_FLAGS_MASK)) {
+        doc = &mrg->snapshot_buf;
+        if (doc->start == NULL) {
+            if (expect_false(srl_buf_init_buffer(aTHX_ doc, header_len + body_len + 1) != 0))
+                croak("Out of memory");
+        } else {
+            doc->pos = doc->body_pos = doc->start;
+            if (BUF_NEED_GROW_TOTAL(doc, header_len + body_len + 1))
+                srl_buf_grow_nocheck(aTHX_ doc, header_len + body_len + 1);
+        }
+    } else {
+        out = newSV(header_len + body_len + 1);
+        doc = &local_doc;
+        doc->start = doc->pos = doc->body_pos = (srl_buffer_char *) SvPVX(out);
+        doc->end = doc->start + header_len + body_len + 1;
+    }
+
+    srl_buf_fill_header(aTHX_ doc, mrg->protocol_version, user_header, user_header_len);
+    assert(BUF_POS_OFS(doc) == header_len);
+
+    Copy(mrg->obuf.body_pos + 1, doc->pos, body_len, srl_buffer_char);
 
-        mrg->obuf.pos += end_offset;
+    if (!SRL_MRG_HAVE_OPTION(mrg, SRL_F_TOPLEVEL_KEY_SCALAR)) {
+        /* obuf_padding_bytes_offset counts from the start of obuf */
+        srl_merger_fill_count(aTHX_ mrg, doc->body_pos + (mrg->obuf.start + mrg->obuf_padding_bytes_offset - mrg->obuf.body_pos));
     }
 
-    DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
+    doc->pos = doc->start + header_len + body_len;
+    DEBUG_ASSERT_BUF_SANE(doc);
 
-    if (SRL_MRG_HAVE_OPTION(mrg, SRL_F_COMPRESS_SNAPPY_INCREMENTAL)) {
-        srl_compress_body(aTHX_ &mrg->obuf, body_offset, mrg->flags, 0, &mrg->snappy_workmem);
-        SRL_UPDATE_BODY_POS(&mrg->obuf, mrg->protocol_version);
+    if (out == NULL) {
+        srl_compress_body(aTHX_ doc, header_len, SRL_MRG_HAVE_OPTION(mrg, SRL_F_COMPRESS_FLAGS_MASK),
+                          (int) mrg->compress_level, &mrg->snappy_workmem, mrg->zstd_cctx);
+        return newSVpvn((char *) doc->start, BUF_POS_OFS(doc));
     }
 
-    assert(srl_start_offset <= (UV) BUF_POS_OFS(&mrg->obuf));
-    DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
+    SvPOK_on(out);
+    SvCUR_set(out, header_len + body_len);
+    *SvEND(out) = '\0';
+    return out;
+}
+
+/* Drops what a failed document left behind first, so that only merged
+ * documents are counted. Evictions can't be undone and stay counted. */
+HV *
+srl_merger_dedupe_stats(pTHX_ srl_merger_t *mrg)
+{
+    HV *stats = (HV *) sv_2mortal((SV *) newHV());
+    UV entries = 0, evictions = 0;
+
+    srl_merger_recover(aTHX_ mrg);
+
+    if (mrg->string_deduper_tbl) {
+        entries += mrg->string_deduper_tbl->tbl_items;
+        evictions += mrg->string_deduper_tbl->tbl_evictions;
+    }
+    if (mrg->classname_deduper_tbl) {
+        entries += mrg->classname_deduper_tbl->tbl_items;
+        evictions += mrg->classname_deduper_tbl->tbl_evictions;
+    }
 
-    return newSVpvn((char *) mrg->obuf.start + srl_start_offset, BUF_POS_OFS(&mrg->obuf) - srl_start_offset - 1);
+    hv_stores(stats, "hits", newSVuv(mrg->dedupe_hits));
+    hv_stores(stats, "bytes_saved", newSVuv(mrg->dedupe_bytes_saved));
+    hv_stores(stats, "entries", newSVuv(entries));
+    hv_stores(stats, "evictions", newSVuv(evictions));
+    return stats;
 }
 
 SRL_STATIC_INLINE srl_merger_t *
@@ -581,31 +1150,54 @@ srl_empty_merger_struct(pTHX)
     /* Zero fields */
     mrg->cnt_of_merged_elements = 0;
     mrg->obuf_padding_bytes_offset = 0;
+    mrg->header_space = SRL_PREALLOCATE_FOR_USER_HEADER;
     mrg->obuf_last_successfull_offset = 0;
     mrg->protocol_version = SRL_PROTOCOL_VERSION;
     mrg->classname_deduper_tbl = NULL;
     mrg->string_deduper_tbl = NULL;
-    mrg->tracked_offsets_tbl = NULL;
+    mrg->dedupe_memory_limit = 0;
+    mrg->dedupe_hits = 0;
+    mrg->dedupe_bytes_saved = 0;
+    mrg->dedupe_hits_committed = 0;
+    mrg->dedupe_bytes_saved_committed = 0;
     mrg->tracked_offsets = NULL;
+    mrg->tracked_offsets_len = 0;
+    mrg->tracked_offsets_size = 0;
+    mrg->tracked_offsets_low = 0;
+    mrg->key_tbl = NULL;
+    mrg->overridden_pairs = NULL;
+    mrg->overridden_len = 0;
+    mrg->overridden_size = 0;
+    mrg->overridden_committed = 0;
+    mrg->dropping = 0;
+    mrg->cnt_of_merged_keys = 0;
+    mrg->obuf_flushed = 0;
+    mrg->stream_to = NULL;
+    mrg->stream_threshold = SRL_DEFAULT_STREAM_THRESHOLD;
+    mrg->stream_written = 0;
+    mrg->stream_count_pos = 0;
     mrg->snappy_workmem = NULL;
+    mrg->compress_level = 0;
+    mrg->zstd_cctx = NULL;
+    mrg->zstd_dctx = NULL;
+    mrg->zstd_ibuf = NULL;
+    mrg->snapshot_buf.start = NULL;
     mrg->flags = 0;
     return mrg;
 }
 
 SRL_STATIC_INLINE void
-srl_set_input_buffer(pTHX_ srl_merger_t *mrg, SV *src)
+srl_set_input_buffer(pTHX_ srl_merger_t *mrg, srl_reader_char_ptr src, STRLEN len)
 {
-    STRLEN len;
     UV header_len;
     U8 encoding_flags;
     U8 protocol_version;
-    srl_buffer_char *tmp;
     IV proto_version_and_encoding_flags_int;
 
     SRL_RDR_CLEAR(&mrg->ibuf);
+    mrg->tracked_offsets_len = 0;
 
-    tmp = (srl_buffer_char*) SvPV(src, len);
-    mrg->ibuf.start = mrg->ibuf.pos = tmp;
+    mrg->ibuf.start = mrg->ibuf.pos = src;
     mrg->ibuf.end = mrg->ibuf.start + len;
 
     proto_version_and_encoding_flags_int = srl_validate_header_version(aTHX_ (srl_reader_char_ptr) mrg->ibuf.start, len);
@@ -636,7 +1228,16 @@ srl_set_input_buffer(pTHX_ srl_merger_t *mrg, SV *src)
     {
         srl_decompress_body_snappy(aTHX_ mrg->pibuf, encoding_flags, NULL);
     } else if (encoding_flags == SRL_PROTOCOL_ENCODING_ZLIB) {
-        srl_decompress_body_zlib(aTHX_ mrg->pibuf, NULL);
+        srl_decompress_body_zlib(aTHX_ mrg->pibuf, NULL, NULL);
+    } else if (encoding_flags == SRL_PROTOCOL_ENCODING_ZSTD) {
+        if (expect_false(mrg->zstd_dctx == NULL)) {
+            mrg->zstd_dctx = ZSTD_createDCtx();
+            if (mrg->zstd_dctx == NULL)
+                croak("Out of memory");
+            mrg->zstd_ibuf = newSV(0);
+        }
+
+        srl_decompress_body_zstd(aTHX_ mrg->pibuf, mrg->zstd_dctx, &mrg->zstd_ibuf);
     } else {
         SRL_RDR_ERROR(mrg->pibuf, "Sereal document encoded in an unknown format");
     }
@@ -646,133 +1247,38 @@ srl_set_input_buffer(pTHX_ srl_merger_t *mrg, SV *src)
     DEBUG_ASSERT_RDR_SANE(mrg->pibuf);
 }
 
-SRL_STATIC_INLINE void
-srl_build_track_table(pTHX_ srl_merger_t *mrg)
-{
-    U8 tag;
-    UV offset, length;
-
-    DEBUG_ASSERT_RDR_SANE(mrg->pibuf);
-
-    if (mrg->tracked_offsets)
-        srl_stack_clear(mrg->tracked_offsets);
-
-    while (expect_true(BUF_NOT_DONE(mrg->pibuf))) {
-        /* since we're doing full pass, it's not necessary to
-         * add items into tracked_offsets here. They will be added
-         * by corresponding REFP/ALIAS/COPY and other tags */
-
-        tag = *mrg->ibuf.pos & ~SRL_HDR_TRACK_FLAG;
-        SRL_REPORT_CURRENT_TAG(mrg, tag);
-        mrg->ibuf.pos++;
-
-        if (tag >= SRL_HDR_SHORT_BINARY_LOW) {
-            mrg->ibuf.pos += SRL_HDR_SHORT_BINARY_LEN_FROM_TAG(tag);
-        } else if (tag > SRL_HDR_NEG_HIGH && tag < SRL_HDR_ARRAYREF_LOW) {
-            switch (tag) {
-                case SRL_HDR_VARINT:
-                case SRL_HDR_ZIGZAG:
-                    srl_read_varint_uv(aTHX_ mrg->pibuf); /* TODO test/implement srl_skip_varint() */
-                    break;
-
-                case SRL_HDR_FLOAT:         mrg->ibuf.pos += 4;     break;
-                case SRL_HDR_DOUBLE:        mrg->ibuf.pos += 8;     break;
-                case SRL_HDR_LONG_DOUBLE:   mrg->ibuf.pos += 16;    break;
-
-                case SRL_HDR_BINARY:
-                case SRL_HDR_STR_UTF8:
-                    length = srl_read_varint_uv_length(aTHX_ mrg->pibuf, " while reading BINARY or STR_UTF8");
-                    mrg->ibuf.pos += length;
-                    break;
-
-                case SRL_HDR_HASH:
-                case SRL_HDR_ARRAY:
-                    srl_read_varint_uv_count(aTHX_ mrg->pibuf, " while reading ARRAY or HASH");
-                    break;
-
-                case SRL_HDR_TRUE:
-                case SRL_HDR_FALSE:
-                case SRL_HDR_UNDEF:
-                case SRL_HDR_CANONICAL_UNDEF:
-                    /* noop */
-                    break;
-
-                default:
-                    switch (tag) {
-                        case SRL_HDR_COPY:
-                        case SRL_HDR_REFP:
-                        case SRL_HDR_ALIAS:
-                        case SRL_HDR_OBJECTV:
-                        case SRL_HDR_OBJECTV_FREEZE:
-                            offset = srl_read_varint_uv_offset(aTHX_ mrg->pibuf, " while reading COPY, OBJECTV or OBJECTV_FREEZE");
-                            srl_stack_push_val(SRL_GET_TRACKED_OFFSETS(mrg), offset);
-                            break;
-
-                        case SRL_HDR_PAD:
-                        case SRL_HDR_REFN:
-                        case SRL_HDR_WEAKEN:
-                        case SRL_HDR_EXTEND:
-                        case SRL_HDR_REGEXP:
-                        case SRL_HDR_OBJECT:
-                        case SRL_HDR_OBJECT_FREEZE:
-                            /* noop */
-                            break;
-
-                        default:
-                            SRL_RDR_ERROR_UNIMPLEMENTED(mrg->pibuf, tag, "");
-                            break;
-                    }
-            }
-        }
-    }
-
-    if (mrg->tracked_offsets && !srl_stack_empty(mrg->tracked_offsets)) {
-        srl_stack_rsort(aTHX_ mrg->tracked_offsets);
-        srl_stack_dedupe(aTHX_ mrg->tracked_offsets);
-
-        /*int i = 0; */
-        /*SRL_STACK_TYPE *ptr = mrg->tracked_offsets->begin; */
-        /*while (ptr <= mrg->tracked_offsets->ptr) { */
-        /*    warn("tracked_offsets: offset dedups idx %d offset %d\n", i, (int) *ptr); */
-        /*    i++; ptr++; */
-        /*} */
-    }
-
-    DEBUG_ASSERT_RDR_SANE(mrg->pibuf);
-}
-
 SRL_STATIC_INLINE void
 srl_merge_single_value(pTHX_ srl_merger_t *mrg)
 {
     U8 tag;
     UV length, offset;
-    ptable_entry_ptr ptable_entry;
 
+    /* tags which prefix another value jump back to read_again,
+     * they count as one level together with it */
+    if (expect_false(++mrg->recursion_depth > mrg->max_recursion_depth))
+        SRL_RDR_ERRORf1(mrg->pibuf, "Reached recursion limit (%lu) during merging", mrg->max_recursion_depth);
 
 read_again:
     assert(mrg->recursion_depth >= 0);
     DEBUG_ASSERT_RDR_SANE(mrg->pibuf);
     DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
 
-    if (expect_false(++mrg->recursion_depth > mrg->max_recursion_depth))
-        SRL_RDR_ERRORf1(mrg->pibuf, "Reached recursion limit (%lu) during merging", mrg->max_recursion_depth);
-
-    ptable_entry = NULL;
     if (expect_false(SRL_RDR_DONE(mrg->pibuf)))
         SRL_RDR_ERROR(mrg->pibuf, "Unexpected termination of input buffer");
 
-    tag = *mrg->ibuf.pos & ~SRL_HDR_TRACK_FLAG;
-    SRL_REPORT_CURRENT_TAG(mrg, tag);
-
-    if (mrg->tracked_offsets && !srl_stack_empty(mrg->tracked_offsets)) {
-        UV itag_offset = SRL_RDR_BODY_POS_OFS(mrg->pibuf);
-        if (expect_false(itag_offset == srl_stack_peek_nocheck(aTHX_ mrg->tracked_offsets))) {
-            /* trackme case */
-            srl_stack_pop_nocheck(mrg->tracked_offsets);
-            ptable_entry = srl_store_tracked_offset(aTHX_ mrg, itag_offset, BODY_POS_OFS(&mrg->obuf));
-        }
+    tag = *mrg->ibuf.pos;
+    if (expect_false(tag & SRL_HDR_TRACK_FLAG)) {
+        tag &= ~SRL_HDR_TRACK_FLAG;
+
+        /* REFP or ALIAS may refer to this item later on, possibly from
+         * inside of it, so remember where it goes before merging it.
+         * Strings take care of themselves, see srl_merge_short_binary() */
+        if (tag < SRL_HDR_SHORT_BINARY_LOW && tag != SRL_HDR_BINARY && tag != SRL_HDR_STR_UTF8)
+            srl_store_tracked_offset(aTHX_ mrg, SRL_RDR_BODY_POS_OFS(mrg->pibuf), SRL_MRG_BODY_OFS(mrg));
     }
 
+    SRL_REPORT_CURRENT_TAG(mrg, tag);
+
     if (tag <= SRL_HDR_NEG_HIGH) {
         srl_buf_cat_tag_nocheck(mrg, tag);
     } else if (tag >= SRL_HDR_ARRAYREF_LOW && tag <= SRL_HDR_ARRAYREF_HIGH) {
@@ -780,7 +1286,7 @@ read_again:
     } else if (tag >= SRL_HDR_HASHREF_LOW && tag <= SRL_HDR_HASHREF_HIGH) {
         srl_merge_hash(aTHX_ mrg, tag, SRL_HDR_HASHREF_LEN_FROM_TAG(tag));
     } else if (tag >= SRL_HDR_SHORT_BINARY_LOW) {
-        srl_merge_short_binary(aTHX_ mrg, tag, ptable_entry);
+        srl_merge_short_binary(aTHX_ mrg, tag);
     } else {
         switch (tag) {
             case SRL_HDR_VARINT:
@@ -802,7 +1308,7 @@ read_again:
 
             case SRL_HDR_BINARY:
             case SRL_HDR_STR_UTF8:
-                srl_merge_binary_utf8(aTHX_ mrg, ptable_entry);
+                srl_merge_binary_utf8(aTHX_ mrg);
                 break;
 
             case SRL_HDR_HASH:
@@ -823,12 +1329,17 @@ read_again:
                     case SRL_HDR_REFP:
                     case SRL_HDR_ALIAS:
                         mrg->ibuf.pos++; /* skip tag in input buffer */
-                        offset = srl_read_varint_uv_offset(aTHX_ mrg->pibuf, " while reading COPY/ALIAS/REFP");
-                        offset = srl_lookup_tracked_offset(aTHX_ mrg, offset); /* convert ibuf offset to obuf offset */
+                        length = srl_read_varint_uv_offset(aTHX_ mrg->pibuf, " while reading COPY/ALIAS/REFP");
+                        offset = srl_lookup_tracked_offset(aTHX_ mrg, length); /* convert ibuf offset to obuf offset */
+                        if (expect_false(offset == SRL_MRG_DROPPED)) {
+                            srl_merge_dropped_item(aTHX_ mrg, tag, length);
+                            break;
+                        }
+
                         srl_buf_cat_varint(aTHX_ &mrg->obuf, tag, offset);
 
                         if (tag == SRL_HDR_REFP || tag == SRL_HDR_ALIAS) {
-                            SRL_SET_TRACK_FLAG(*(mrg->obuf.body_pos + offset));
+                            SRL_SET_TRACK_FLAG(*SRL_MRG_BODY_PTR(mrg, offset));
                         }
 
                         break;
@@ -848,18 +1359,30 @@ read_again:
                         srl_buf_cat_tag_nocheck(mrg, tag);
                         srl_merge_stringish(aTHX_ mrg);
 
+                        if (expect_false(SRL_RDR_DONE(mrg->pibuf)))
+                            SRL_RDR_ERROR(mrg->pibuf, "Unexpected termination of input buffer");
+
                         tag = *mrg->ibuf.pos;
                         if (expect_false(tag < SRL_HDR_SHORT_BINARY_LOW))
                             SRL_RDR_ERROR_UNEXPECTED(mrg->pibuf, tag, "SRL_HDR_SHORT_BINARY");
 
+                        srl_store_tracked_offset(aTHX_ mrg, SRL_RDR_BODY_POS_OFS(mrg->pibuf), SRL_MRG_BODY_OFS(mrg));
                         srl_buf_copy_content_nocheck(aTHX_ mrg, SRL_HDR_SHORT_BINARY_LEN_FROM_TAG(tag) + 1);
                         break;
 
                     case SRL_HDR_OBJECTV:
                     case SRL_HDR_OBJECTV_FREEZE:
                         mrg->ibuf.pos++; /* skip tag in input buffer */
-                        offset = srl_read_varint_uv_offset(aTHX_ mrg->pibuf, " while reading OBJECTV/OBJECTV_FREEZE");
-                        offset = srl_lookup_tracked_offset(aTHX_ mrg, offset); /* convert ibuf offset to obuf offset */
+                        length = srl_read_varint_uv_offset(aTHX_ mrg->pibuf, " while reading OBJECTV/OBJECTV_FREEZE");
+                        offset = srl_lookup_tracked_offset(aTHX_ mrg, length); /* convert ibuf offset to obuf offset */
+                        if (expect_false(offset == SRL_MRG_DROPPED)) {
+                            /* write the class name again */
+                            GROW_BUF(&mrg->obuf, 1);
+                            srl_buf_cat_char_nocheck(&mrg->obuf, tag == SRL_HDR_OBJECTV ? SRL_HDR_OBJECT : SRL_HDR_OBJECT_FREEZE);
+                            srl_merge_dropped_string(aTHX_ mrg, length);
+                            goto read_again;
+                        }
+
                         srl_buf_cat_varint(aTHX_ &mrg->obuf, tag, offset);
                         goto read_again;
 
@@ -925,11 +1448,265 @@ srl_merge_hash(pTHX_ srl_merger_t *mrg, const U8 tag, UV length)
     DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
 }
 
+/* Merge the key/value pairs of the hash at the top of the input document into
+ * the top level hash. Returns the number of pairs which were added. */
+SRL_STATIC_INLINE UV
+srl_merge_top_level_hash(pTHX_ srl_merger_t *mrg)
+{
+    U8 tag;
+    UV i, length;
+    UV keys = 0;
+    int refn = 0;
+
+read_again:
+    if (expect_false(SRL_RDR_DONE(mrg->pibuf)))
+        SRL_RDR_ERROR(mrg->pibuf, "Unexpected termination of input buffer");
+
+    tag = *mrg->ibuf.pos;
+    if (expect_false(tag & SRL_HDR_TRACK_FLAG))
+        SRL_RDR_ERROR(mrg->pibuf, "Can't merge the keys of a hash which is referenced from inside the document");
+
+    if (tag == SRL_HDR_PAD || (tag == SRL_HDR_REFN && !refn)) {
+        refn |= tag == SRL_HDR_REFN;
+        mrg->ibuf.pos++;
+        goto read_again;
+    }
+
+    if (tag >= SRL_HDR_HASHREF_LOW && tag <= SRL_HDR_HASHREF_HIGH && !refn) {
+        mrg->ibuf.pos++;
+        length = SRL_HDR_HASHREF_LEN_FROM_TAG(tag);
+    } else if (tag == SRL_HDR_HASH) {
+        mrg->ibuf.pos++;
+        length = srl_read_varint_uv_count(aTHX_ mrg->pibuf, " while reading HASH");
+    } else {
+        SRL_RDR_ERROR_UNEXPECTED(mrg->pibuf, tag, "a hash at the top of the document");
+    }
+
+    for (i = 0; i < length; ++i)
+        keys += srl_merge_hash_pair(aTHX_ mrg, 0);
+
+    return keys;
+}
+
+/* Merge one pair of the top level hash. If its key was merged before, the
+ * pair is dropped again with SRL_F_FIRST_KEY_WINS, otherwise the earlier
+ * pair is recorded in overridden_pairs and dropped by srl_merger_compact().
+ * Pairs are dropped without looking up the key if drop is true.
+ * Returns whether the pair was kept. */
+SRL_STATIC_INLINE int
+srl_merge_hash_pair(pTHX_ srl_merger_t *mrg, int drop)
+{
+    const UV pair_offset = SRL_MRG_BODY_OFS(mrg);
+    const UV tracked_len = mrg->tracked_offsets_len;
+
+    mrg->tracked_offsets_low = tracked_len;
+    srl_merge_top_level_key(aTHX_ mrg);
+
+    if (!drop) {
+        int ok;
+        const srl_buffer_char *key = SRL_MRG_BODY_PTR(mrg, pair_offset);
+        const STRLEN key_len = mrg->obuf.pos - key;
+        strtable_entry_ptr ent;
+
+        if (expect_false(key_len > STRTABLE_MAX_STR_SIZE))
+            SRL_RDR_ERROR(mrg->pibuf, "Hash key too long");
+
+        ent = STRTABLE_insert(SRL_GET_KEY_TBL(mrg), key, (U32) key_len, &ok);
+        if (!ok) {
+            ent->offset = pair_offset;
+        } else if (SRL_MRG_HAVE_OPTION(mrg, SRL_F_FIRST_KEY_WINS)) {
+            drop = 1;
+        } else {
+            if (expect_false(mrg->overridden_len == mrg->overridden_size)) {
+                mrg->overridden_size = mrg->overridden_size ? mrg->overridden_size * 2 : 64;
+                Renew(mrg->overridden_pairs, mrg->overridden_size, UV);
+            }
+
+            mrg->overridden_pairs[mrg->overridden_len++] = ent->offset;
+            ent->offset = pair_offset;
+        }
+    }
+
+    if (!drop) {
+        srl_merge_single_value(aTHX_ mrg);
+        return 1;
+    }
+
+    /* The value still has to be merged to get to the next pair,
+     * and to know what later items which refer to it are about */
+    mrg->dropping++;
+    srl_merge_single_value(aTHX_ mrg);
+    mrg->dropping--;
+
+    srl_drop_merged(aTHX_ mrg, pair_offset, tracked_len);
+    return 0;
+}
+
+/* Merge a key of the top level hash. Unlike other strings it is always
+ * written out in full, without track flag, so that the key of a pair is
+ * found at the offset of the pair. The key is also written in one
+ * canonical encoding, with UTF-8 downgraded to latin1 where possible,
+ * so that keys which are the same Perl hash key compare equal in the
+ * key table whichever way the documents encoded them. */
+SRL_STATIC_INLINE void
+srl_merge_top_level_key(pTHX_ srl_merger_t *mrg)
+{
+    U8 tag, out_tag;
+    UV length, out_length, i;
+    UV tracked_from = 0;
+    const UV key_offset = SRL_MRG_BODY_OFS(mrg);
+    srl_reader_char_ptr tag_ptr, str;
+    srl_reader_char_ptr copy_end = NULL;
+    srl_buffer_char *key;
+
+    if (expect_false(SRL_RDR_DONE(mrg->pibuf)))
+        SRL_RDR_ERROR(mrg->pibuf, "Unexpected termination of input buffer");
+
+    tag = *mrg->ibuf.pos & ~SRL_HDR_TRACK_FLAG;
+    SRL_REPORT_CURRENT_TAG(mrg, tag);
+
+    if (tag == SRL_HDR_COPY) {
+        UV offset;
+
+        mrg->ibuf.pos++; /* skip tag in input buffer */
+        offset = srl_read_varint_uv_offset(aTHX_ mrg->pibuf, " while reading COPY");
+        (void) srl_lookup_tracked_offset(aTHX_ mrg, offset); /* strings are always tracked */
+
+        copy_end = mrg->ibuf.pos;
+        mrg->ibuf.pos = mrg->ibuf.body_pos + offset;
+        tag = *mrg->ibuf.pos & ~SRL_HDR_TRACK_FLAG;
+        if (expect_false(tag != SRL_HDR_BINARY && tag != SRL_HDR_STR_UTF8 && tag < SRL_HDR_SHORT_BINARY_LOW))
+            SRL_RDR_ERROR_BAD_COPY(mrg->pibuf, tag);
+    } else if (tag == SRL_HDR_BINARY || tag == SRL_HDR_STR_UTF8 || tag >= SRL_HDR_SHORT_BINARY_LOW) {
+        tracked_from = SRL_RDR_BODY_POS_OFS(mrg->pibuf);
+    } else {
+        SRL_RDR_ERROR_UNEXPECTED(mrg->pibuf, tag, "stringish");
+    }
+
+    tag_ptr = mrg->ibuf.pos++;
+    if (tag >= SRL_HDR_SHORT_BINARY_LOW) {
+        length = SRL_HDR_SHORT_BINARY_LEN_FROM_TAG(tag);
+    } else {
+        length = srl_read_varint_uv_length(aTHX_ mrg->pibuf, " while reading BINARY or STR_UTF8");
+    }
+
+    SRL_RDR_ASSERT_SPACE(mrg->pibuf, length, " while reading hash key");
+    str = mrg->ibuf.pos;
+    mrg->ibuf.pos += length;
+
+    /* characters up to 0xff are encoded as 0xc2 or 0xc3 and one
+     * continuation byte, everything else keeps the key UTF-8 */
+    out_tag = SRL_HDR_BINARY;
+    out_length = length;
+    if (tag == SRL_HDR_STR_UTF8) {
+        for (i = 0; i < length; ++i) {
+            if (str[i] < 0x80)
+                continue;
+            if ((str[i] & 0xfe) != 0xc2 || i + 1 == length || (str[i + 1] & 0xc0) != 0x80) {
+                out_tag = SRL_HDR_STR_UTF8;
+                out_length = length;
+                break;
+            }
+            ++i;
+            --out_length;
+        }
+    }
+
+    GROW_BUF(&mrg->obuf, SRL_MAX_VARINT_LENGTH + 1 + out_length);
+    if (out_tag == SRL_HDR_BINARY && out_length <= SRL_MASK_SHORT_BINARY_LEN) {
+        srl_buf_cat_char_nocheck(&mrg->obuf, SRL_HDR_SHORT_BINARY_LOW | (U8) out_length);
+    } else {
+        srl_buf_cat_varint_nocheck(aTHX_ &mrg->obuf, out_tag, out_length);
+    }
+
+    if (out_length == length) {
+        Copy(str, mrg->obuf.pos, length, char);
+        mrg->obuf.pos += length;
+    } else {
+        for (i = 0; i < length; ++i) {
+            if (str[i] < 0x80) {
+                *mrg->obuf.pos++ = str[i];
+            } else {
+                *mrg->obuf.pos++ = (U8) (((str[i] & 0x03) << 6) | (str[i + 1] & 0x3f));
+                ++i;
+            }
+        }
+    }
+
+    DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
+
+    /* Later COPY tags get the key as it was encoded, which means merging
+     * it again if it had to be changed */
+    if (tracked_from) {
+        key = SRL_MRG_BODY_PTR(mrg, key_offset);
+        srl_store_tracked_offset(aTHX_ mrg, tracked_from,
+                                 *key == tag && mrg->obuf.pos - key == mrg->ibuf.pos - tag_ptr
+                                 ? key_offset : SRL_MRG_DROPPED);
+    }
+
+    if (copy_end)
+        mrg->ibuf.pos = copy_end;
+}
+
+/* Forget what was merged since obuf offset offset. Entries of
+ * tracked_offsets which point there are marked as dropped, so that
+ * the items get merged again if they are referred to later on. */
+SRL_STATIC_INLINE void
+srl_drop_merged(pTHX_ srl_merger_t *mrg, UV offset, UV tracked_len)
+{
+    UV i = tracked_len < mrg->tracked_offsets_low ? tracked_len : mrg->tracked_offsets_low;
+
+    mrg->obuf.pos = SRL_MRG_BODY_PTR(mrg, offset);
+    for (; i < mrg->tracked_offsets_len; ++i) {
+        if (mrg->tracked_offsets[i].to >= offset)
+            mrg->tracked_offsets[i].to = SRL_MRG_DROPPED;
+    }
+
+    DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
+}
+
+/* tag refers to the item at ibuf offset offset, which was dropped.
+ * Merge the item in place of the tag instead. */
 SRL_STATIC_INLINE void
-srl_merge_binary_utf8(pTHX_ srl_merger_t *mrg, ptable_entry_ptr ptable_entry)
+srl_merge_dropped_item(pTHX_ srl_merger_t *mrg, const U8 tag, UV offset)
+{
+    srl_reader_char_ptr pos = mrg->ibuf.pos;
+
+    SRL_MERGER_TRACE("merge dropped item at %lu again", (unsigned long) offset);
+
+    if (tag == SRL_HDR_REFP) {
+        GROW_BUF(&mrg->obuf, 1);
+        srl_buf_cat_char_nocheck(&mrg->obuf, SRL_HDR_REFN);
+    }
+
+    mrg->ibuf.pos = mrg->ibuf.body_pos + offset;
+    srl_merge_single_value(aTHX_ mrg);
+    mrg->ibuf.pos = pos;
+}
+
+/* Same as srl_merge_dropped_item() for strings where a stringish is
+ * expected, returns the new obuf offset of the string */
+SRL_STATIC_INLINE UV
+srl_merge_dropped_string(pTHX_ srl_merger_t *mrg, UV offset)
+{
+    srl_reader_char_ptr pos = mrg->ibuf.pos;
+    UV target;
+
+    mrg->ibuf.pos = mrg->ibuf.body_pos + offset;
+    target = srl_merge_stringish(aTHX_ mrg);
+    mrg->ibuf.pos = pos;
+    return target;
+}
+
+/* Merge a BINARY or STR_UTF8 string and remember where it went for COPY tags
+ * refering to it. Returns the obuf offset of the string, which is the offset
+ * of an earlier copy if the string was deduplicated. */
+SRL_STATIC_INLINE UV
+srl_merge_binary_utf8(pTHX_ srl_merger_t *mrg)
 {
     int ok;
-    UV length, total_length;
+    UV length, total_length, target;
+    const UV itag_offset = SRL_RDR_BODY_POS_OFS(mrg->pibuf);
     strtable_entry_ptr strtable_entry;
     srl_reader_char_ptr tag_ptr = mrg->ibuf.pos;
 
@@ -947,19 +1724,15 @@ srl_merge_binary_utf8(pTHX_ srl_merger_t *mrg, ptable_entry_ptr ptable_entry)
 
     if (ok) {
         /* issue COPY tag */
-        srl_buf_cat_varint(aTHX_ &mrg->obuf, SRL_HDR_COPY, strtable_entry->offset);
+        /* Following COPY tags refering to this string have to point to the
+         * original string too. By Sereal spec a COPY tag cannot reffer to
+         * another COPY tag. */
+        target = strtable_entry->offset;
+        srl_merger_emit_copy(aTHX_ mrg, SRL_HDR_COPY, target, total_length);
         mrg->ibuf.pos += length;
-
-        if (expect_false(ptable_entry)) {
-            /* update value in ptable entry */
-            /* This is needed because if any of following tags will reffer to */
-            /* this one as COPY we need to point them to original string. */
-            /* By Sereal spec a COPY tag cannot reffer to another COPY tag. */
-            ptable_entry->value = INT2PTR(void *, strtable_entry->offset);
-        }
     } else if (strtable_entry) {
         mrg->ibuf.pos = tag_ptr;
-        strtable_entry->offset = BODY_POS_OFS(&mrg->obuf);
+        target = strtable_entry->offset = SRL_MRG_BODY_OFS(mrg);
         srl_buf_copy_content_nocheck(aTHX_ mrg, total_length);
 
         STRTABLE_ASSERT_ENTRY(mrg->string_deduper_tbl, strtable_entry);
@@ -967,59 +1740,64 @@ srl_merge_binary_utf8(pTHX_ srl_merger_t *mrg, ptable_entry_ptr ptable_entry)
                                   mrg->ibuf.pos - total_length, total_length);
     } else {
         mrg->ibuf.pos = tag_ptr;
+        target = SRL_MRG_BODY_OFS(mrg);
         srl_buf_copy_content_nocheck(aTHX_ mrg, total_length);
     }
 
+    srl_store_tracked_offset(aTHX_ mrg, itag_offset, target);
+
     DEBUG_ASSERT_RDR_SANE(mrg->pibuf);
     DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
+    return target;
 }
 
-SRL_STATIC_INLINE void
-srl_merge_short_binary(pTHX_ srl_merger_t *mrg, const U8 tag, ptable_entry_ptr ptable_entry)
+/* Same as srl_merge_binary_utf8() for SHORT_BINARY strings. The tag
+ * must not have the track flag. */
+SRL_STATIC_INLINE UV
+srl_merge_short_binary(pTHX_ srl_merger_t *mrg, const U8 tag)
 {
     int ok;
+    UV target;
     strtable_entry_ptr strtable_entry;
     UV length = SRL_HDR_SHORT_BINARY_LEN_FROM_TAG(tag) + 1; /* + 1 for tag */
+    const UV itag_offset = SRL_RDR_BODY_POS_OFS(mrg->pibuf);
 
     DEBUG_ASSERT_RDR_SANE(mrg->pibuf);
     DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
 
     /* +1 because need to respect tag */
-    /* no need to do ASSERT_BUF_SPACE because srl_build_track_table has asserted ibuf */
+    SRL_RDR_ASSERT_SPACE(mrg->pibuf, length, " while reading SHORT_BINARY");
     strtable_entry = srl_lookup_string(aTHX_ mrg, mrg->ibuf.pos, length, &ok);
 
     if (ok) {
-        /* issue COPY tag */
-        srl_buf_cat_varint(aTHX_ &mrg->obuf, SRL_HDR_COPY, strtable_entry->offset);
+        /* issue COPY tag, see srl_merge_binary_utf8() */
+        target = strtable_entry->offset;
+        srl_merger_emit_copy(aTHX_ mrg, SRL_HDR_COPY, target, length);
         mrg->ibuf.pos += length;
-
-        if (expect_false(ptable_entry)) {
-            /* update value in ptable entry */
-            /* This is needed because if any of following tags will reffer to */
-            /* this one as COPY we need to point them to original string. */
-            /* By Sereal spec a COPY tag cannot reffer to another COPY tag */
-            ptable_entry->value = INT2PTR(void *, strtable_entry->offset);
-        }
     } else if (strtable_entry) {
-        strtable_entry->offset = BODY_POS_OFS(&mrg->obuf);
+        target = strtable_entry->offset = SRL_MRG_BODY_OFS(mrg);
         srl_buf_copy_content_nocheck(aTHX_ mrg, length);
 
         STRTABLE_ASSERT_ENTRY(mrg->string_deduper_tbl, strtable_entry);
         STRTABLE_ASSERT_ENTRY_STR(mrg->string_deduper_tbl, strtable_entry, mrg->ibuf.pos - length, length);
     } else {
+        target = SRL_MRG_BODY_OFS(mrg);
         srl_buf_copy_content_nocheck(aTHX_ mrg, length);
     }
 
+    srl_store_tracked_offset(aTHX_ mrg, itag_offset, target);
+
     DEBUG_ASSERT_RDR_SANE(mrg->pibuf);
     DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
+    return target;
 }
 
-SRL_STATIC_INLINE void
+/* Merge a string or a COPY of one. Returns the obuf offset of the string. */
+SRL_STATIC_INLINE UV
 srl_merge_stringish(pTHX_ srl_merger_t *mrg)
 {
     U8 tag, newtag;
-    UV offset = 0;
-    ptable_entry_ptr ptable_entry = NULL;
+    UV from, offset = 0;
 
     DEBUG_ASSERT_RDR_SANE(mrg->pibuf);
     DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
@@ -1031,37 +1809,30 @@ srl_merge_stringish(pTHX_ srl_merger_t *mrg)
     tag = tag & ~SRL_HDR_TRACK_FLAG;
     SRL_REPORT_CURRENT_TAG(mrg, tag);
 
-    if (mrg->tracked_offsets && !srl_stack_empty(mrg->tracked_offsets)) {
-        UV itag_offset = SRL_RDR_BODY_POS_OFS(mrg->pibuf);
-        if (expect_false(itag_offset == srl_stack_peek_nocheck(aTHX_ mrg->tracked_offsets))) {
-            /* trackme case */
-            srl_stack_pop_nocheck(mrg->tracked_offsets);
-            ptable_entry = srl_store_tracked_offset(aTHX_ mrg, itag_offset, BODY_POS_OFS(&mrg->obuf));
-        }
-    }
-
     if (tag >= SRL_HDR_SHORT_BINARY_LOW) {
-        srl_merge_short_binary(aTHX_ mrg, tag, ptable_entry);
+        offset = srl_merge_short_binary(aTHX_ mrg, tag);
     } else if (tag == SRL_HDR_BINARY || tag == SRL_HDR_STR_UTF8) {
-        srl_merge_binary_utf8(aTHX_ mrg, ptable_entry);
+        offset = srl_merge_binary_utf8(aTHX_ mrg);
     } else if (tag == SRL_HDR_COPY) {
         mrg->ibuf.pos++; /* skip tag in input buffer */
-        offset = srl_read_varint_uv_offset(aTHX_ mrg->pibuf, " while reading COPY");
-        offset = srl_lookup_tracked_offset(aTHX_ mrg, offset); /* convert ibuf offset to obuf offset */
+        from = srl_read_varint_uv_offset(aTHX_ mrg->pibuf, " while reading COPY");
+        offset = srl_lookup_tracked_offset(aTHX_ mrg, from); /* convert ibuf offset to obuf offset */
+        if (expect_false(offset == SRL_MRG_DROPPED))
+            return srl_merge_dropped_string(aTHX_ mrg, from);
 
-        newtag = *(mrg->obuf.body_pos + offset);
+        newtag = *SRL_MRG_BODY_PTR(mrg, offset);
         if (expect_false(newtag != SRL_HDR_BINARY && newtag != SRL_HDR_STR_UTF8 && newtag < SRL_HDR_SHORT_BINARY_LOW)) {
             SRL_RDR_ERROR_BAD_COPY(mrg->pibuf, newtag);
         }
 
         srl_buf_cat_varint(aTHX_ &mrg->obuf, tag, offset);
-        /*otag_offset = offset; */
     } else {
         SRL_RDR_ERROR_UNEXPECTED(mrg->pibuf, tag, "stringish");
     }
 
     DEBUG_ASSERT_RDR_SANE(mrg->pibuf);
     DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
+    return offset;
 }
 
 SRL_STATIC_INLINE void
@@ -1069,33 +1840,21 @@ srl_merge_object(pTHX_ srl_merger_t *mrg, const U8 objtag)
 {
     int ok;
     U8 strtag;
+    UV itag_offset;
     srl_reader_char_ptr strtag_ptr = NULL;
-    ptable_entry_ptr ptable_entry = NULL;
 
     DEBUG_ASSERT_RDR_SANE(mrg->pibuf);
     DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
 
     mrg->ibuf.pos++; /* skip object tag */
+    if (expect_false(SRL_RDR_DONE(mrg->pibuf)))
+        SRL_RDR_ERROR(mrg->pibuf, "Unexpected termination of input buffer");
 
     strtag = *mrg->ibuf.pos & ~SRL_HDR_TRACK_FLAG;
     SRL_REPORT_CURRENT_TAG(mrg, strtag);
 
-    if (mrg->tracked_offsets && !srl_stack_empty(mrg->tracked_offsets)) {
-        UV itag_offset = SRL_RDR_BODY_POS_OFS(mrg->pibuf);
-        if (expect_false(itag_offset == srl_stack_peek_nocheck(aTHX_ mrg->tracked_offsets))) {
-            /* trackme case */
-            srl_stack_pop_nocheck(mrg->tracked_offsets);
-
-            /* store offset to future class name tag (stringish), */
-            /* but at the moment we programm reaches this point the output buffer doesn't */
-            /* contain OBJECT tag yet. In other words, BODY_POS_OFS(&mrg->obuf) return location */
-            /* of OBJECT tag where as we need to store location of classname tag. To workaround */
-            /* simply add one which is correct offset if OBJECT tag will be issues. */
-            /* In case deduplication (OBJECTV tag) ptable_entry->value will be updated accordingly. */
-            ptable_entry = srl_store_tracked_offset(aTHX_ mrg, itag_offset, BODY_POS_OFS(&mrg->obuf) + 1);
-        }
-    }
-
+    /* OBJECTV and OBJECTV_FREEZE tags refer to the class name */
+    itag_offset = SRL_RDR_BODY_POS_OFS(mrg->pibuf);
     strtag_ptr = mrg->ibuf.pos++; /* skip string tag in input buffer */
 
     if (strtag == SRL_HDR_BINARY || strtag == SRL_HDR_STR_UTF8 || strtag >= SRL_HDR_SHORT_BINARY_LOW) {
@@ -1109,28 +1868,27 @@ srl_merge_object(pTHX_ srl_merger_t *mrg, const U8 objtag)
 
         assert((mrg->ibuf.pos - strtag_ptr) > 0);
         assert((mrg->ibuf.pos - strtag_ptr) <= SRL_MAX_VARINT_LENGTH);
+        SRL_RDR_ASSERT_SPACE(mrg->pibuf, length, " while reading class name");
 
         strtable_entry = srl_lookup_classname(aTHX_ mrg, strtag_ptr, total_length, &ok);
 
         if (ok) {
             /* issue OBJECTV || OBJECTV_FREEZE tag */
             U8 outtag = (objtag == SRL_HDR_OBJECT ? SRL_HDR_OBJECTV : SRL_HDR_OBJECTV_FREEZE);
-            srl_buf_cat_varint(aTHX_ &mrg->obuf, outtag, strtable_entry->offset);
+            srl_merger_emit_copy(aTHX_ mrg, outtag, strtable_entry->offset, total_length + 1);
             mrg->ibuf.pos += length;
 
-            if (expect_false(ptable_entry)) {
-                /* update value in ptable entry */
-                /* This is needed because if any of following tags will reffer to */
-                /* this one as COPY we need to point them to original string. */
-                /* By Sereal spec a COPY tag cannot reffer to another COPY tag. */
-                ptable_entry->value = INT2PTR(void *, strtable_entry->offset);
-            }
+            /* following tags refering to this class name have to point
+             * to the original string. */
+            srl_store_tracked_offset(aTHX_ mrg, itag_offset, strtable_entry->offset);
         } else if (strtable_entry) {
             /* issue OBJECT tag and update strtable entry */
+            GROW_BUF(&mrg->obuf, 1);
             srl_buf_cat_char_nocheck(&mrg->obuf, objtag);
 
             mrg->ibuf.pos = strtag_ptr; /* reset input buffer to start */
-            strtable_entry->offset = BODY_POS_OFS(&mrg->obuf);
+            strtable_entry->offset = SRL_MRG_BODY_OFS(mrg);
+            srl_store_tracked_offset(aTHX_ mrg, itag_offset, strtable_entry->offset);
             srl_buf_copy_content_nocheck(aTHX_ mrg, total_length);
 
             STRTABLE_ASSERT_ENTRY(mrg->classname_deduper_tbl, strtable_entry);
@@ -1138,23 +1896,36 @@ srl_merge_object(pTHX_ srl_merger_t *mrg, const U8 objtag)
                                       mrg->ibuf.pos - total_length, total_length);
         } else {
             /* issue OBJECT tag */
+            GROW_BUF(&mrg->obuf, 1);
             srl_buf_cat_char_nocheck(&mrg->obuf, objtag);
 
             mrg->ibuf.pos = strtag_ptr;
+            srl_store_tracked_offset(aTHX_ mrg, itag_offset, SRL_MRG_BODY_OFS(mrg));
             srl_buf_copy_content_nocheck(aTHX_ mrg, total_length);
         }
     } else if (strtag == SRL_HDR_COPY) {
         U8 newtag;
-        UV offset = srl_read_varint_uv_offset(aTHX_ mrg->pibuf, " while reading COPY");
-        offset = srl_lookup_tracked_offset(aTHX_ mrg, offset); /* convert ibuf offset to obuf offset */
+        const UV from = srl_read_varint_uv_offset(aTHX_ mrg->pibuf, " while reading COPY");
+        UV offset = srl_lookup_tracked_offset(aTHX_ mrg, from); /* convert ibuf offset to obuf offset */
+
+        if (expect_false(offset == SRL_MRG_DROPPED)) {
+            GROW_BUF(&mrg->obuf, 1);
+            srl_buf_cat_char_nocheck(&mrg->obuf, objtag);
+            offset = srl_merge_dropped_string(aTHX_ mrg, from);
+            srl_store_tracked_offset(aTHX_ mrg, itag_offset, offset);
+            srl_merge_single_value(aTHX_ mrg);
+            return;
+        }
 
-        newtag = *(mrg->obuf.body_pos + offset);
+        newtag = *SRL_MRG_BODY_PTR(mrg, offset);
         if (expect_false(newtag != SRL_HDR_BINARY && newtag != SRL_HDR_STR_UTF8 && newtag < SRL_HDR_SHORT_BINARY_LOW)) {
             SRL_RDR_ERROR_BAD_COPY(mrg->pibuf, newtag);
         }
 
+        GROW_BUF(&mrg->obuf, 1);
+        srl_buf_cat_char_nocheck(&mrg->obuf, objtag);
         srl_buf_cat_varint(aTHX_ &mrg->obuf, strtag, offset);
-        /*otag_offset = offset; */
+        srl_store_tracked_offset(aTHX_ mrg, itag_offset, offset);
     } else {
         SRL_RDR_ERROR_UNEXPECTED(mrg->pibuf, strtag, "stringish");
     }
@@ -1165,29 +1936,89 @@ srl_merge_object(pTHX_ srl_merger_t *mrg, const U8 objtag)
     srl_merge_single_value(aTHX_ mrg);
 }
 
-SRL_STATIC_INLINE ptable_entry_ptr
+/* Remember that the item at ibuf offset from was merged to obuf offset to.
+ * The document is merged front to back, so entries get appended in ascending
+ * order of from and srl_lookup_tracked_offset() can use a binary search.
+ * Only items of a dropped value which get merged again come out of order,
+ * see srl_merge_dropped_item(). */
+SRL_STATIC_INLINE void
 srl_store_tracked_offset(pTHX_ srl_merger_t *mrg, UV from, UV to)
 {
-    /* 0 is a bad offset for all Sereal formats */
+    srl_merger_offset_t *ent;
+    UV lo = mrg->tracked_offsets_len;
 
+    /* 0 is a bad offset for all Sereal formats */
     assert(to > 0);
     assert(from > 0);
 
+    if (expect_false(lo && mrg->tracked_offsets[lo - 1].from >= from)) {
+        UV hi = lo;
+
+        lo = 0;
+        while (lo < hi) {
+            const UV mid = lo + (hi - lo) / 2;
+            if (mrg->tracked_offsets[mid].from < from) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+
+        if (lo < mrg->tracked_offsets_low)
+            mrg->tracked_offsets_low = lo;
+
+        if (mrg->tracked_offsets[lo].from == from) {
+            mrg->tracked_offsets[lo].to = to;
+            return;
+        }
+    }
+
+    if (expect_false(mrg->tracked_offsets_len == mrg->tracked_offsets_size)) {
+        mrg->tracked_offsets_size = mrg->tracked_offsets_size ? mrg->tracked_offsets_size * 2 : 64;
+        Renew(mrg->tracked_offsets, mrg->tracked_offsets_size, srl_merger_offset_t);
+    }
+
     SRL_MERGER_TRACE("srl_store_tracked_offset: %lu -> %lu", from, to);
-    return PTABLE_store(SRL_GET_TRACKED_OFFSETS_TBL(mrg), INT2PTR(void *, from), INT2PTR(void *, to));
+    ent = &mrg->tracked_offsets[lo];
+    if (expect_false(lo < mrg->tracked_offsets_len))
+        Move(ent, ent + 1, mrg->tracked_offsets_len - lo, srl_merger_offset_t);
+
+    mrg->tracked_offsets_len++;
+    ent->from = from;
+    ent->to = to;
 }
 
 SRL_STATIC_INLINE UV
 srl_lookup_tracked_offset(pTHX_ srl_merger_t *mrg, UV offset)
 {
-    UV len;
-    void *res = PTABLE_fetch(SRL_GET_TRACKED_OFFSETS_TBL(mrg), INT2PTR(void *, offset));
-    if (expect_false(!res))
+    UV len = 0;
+    UV lo = 0;
+    UV hi = mrg->tracked_offsets_len;
+    int found = 0;
+
+    while (lo < hi) {
+        const UV mid = lo + (hi - lo) / 2;
+        const UV from = mrg->tracked_offsets[mid].from;
+
+        if (from < offset) {
+            lo = mid + 1;
+        } else if (from > offset) {
+            hi = mid;
+        } else {
+            len = mrg->tracked_offsets[mid].to;
+            found = 1;
+            break;
+        }
+    }
+
+    if (expect_false(!found))
         SRL_RDR_ERRORf1(mrg->pibuf, "bad target offset %lu", offset);
 
-    len = PTR2UV(res);
     SRL_MERGER_TRACE("srl_lookup_tracked_offset: %lu -> %lu", offset, len);
-    if (expect_false(mrg->obuf.body_pos + len >= mrg->obuf.pos)) {
+    if (expect_false(len == SRL_MRG_DROPPED))
+        return len;
+
+    if (expect_false(SRL_MRG_BODY_PTR(mrg, len) >= mrg->obuf.pos)) {
         croak("Corrupted packet. Offset %lu points past current position %lu in packet with length of %lu bytes long",
               (unsigned long) offset, (unsigned long) BUF_POS_OFS(&mrg->obuf), (unsigned long) BUF_SIZE(&mrg->obuf));
     }
@@ -1201,7 +2032,7 @@ srl_lookup_string(pTHX_ srl_merger_t *mrg, const unsigned char *src, STRLEN len,
     strtable_entry_ptr ent;
 
     *ok = 0;
-    if (len <= 3 || len > STRTABLE_MAX_STR_SIZE || !SRL_MRG_HAVE_OPTION(mrg, SRL_F_DEDUPE_STRINGS))
+    if (len <= 3 || len > STRTABLE_MAX_STR_SIZE || !SRL_MRG_HAVE_OPTION(mrg, SRL_F_DEDUPE_STRINGS) || mrg->dropping)
         return NULL;
 
     ent = STRTABLE_insert(SRL_GET_STRING_DEDUPER_TBL(mrg), src, len, ok);
@@ -1224,7 +2055,7 @@ srl_lookup_classname(pTHX_ srl_merger_t *mrg, const unsigned char *src, STRLEN l
     strtable_entry_ptr ent;
 
     *ok = 0;
-    if (len <= 3 || len > STRTABLE_MAX_STR_SIZE || !SRL_MRG_HAVE_OPTION(mrg, SRL_F_DEDUPE_STRINGS))
+    if (len <= 3 || len > STRTABLE_MAX_STR_SIZE || !SRL_MRG_HAVE_OPTION(mrg, SRL_F_DEDUPE_STRINGS) || mrg->dropping)
         return NULL;
 
     ent = STRTABLE_insert(SRL_GET_CLASSNAME_DEDUPER_TBL(mrg), src, len, ok);
@@ -1241,6 +2072,18 @@ srl_lookup_classname(pTHX_ srl_merger_t *mrg, const unsigned char *src, STRLEN l
     return ent;
 }
 
+/* Emit a COPY-like tag instead of replaced_len bytes of a string
+ * which was found in a deduper table, and count it */
+SRL_STATIC_INLINE void
+srl_merger_emit_copy(pTHX_ srl_merger_t *mrg, const U8 tag, UV offset, UV replaced_len)
+{
+    const STRLEN before = BUF_POS_OFS(&mrg->obuf);
+    srl_buf_cat_varint(aTHX_ &mrg->obuf, tag, offset);
+
+    mrg->dedupe_hits++;
+    mrg->dedupe_bytes_saved += replaced_len - (BUF_POS_OFS(&mrg->obuf) - before);
+}
+
 SRL_STATIC_INLINE void
 srl_cleanup_dedup_tlbs(pTHX_ srl_merger_t *mrg, UV offset)
 {
@@ -1258,9 +2101,61 @@ srl_cleanup_dedup_tlbs(pTHX_ srl_merger_t *mrg, UV offset)
     }
 }
 
+/* Forget keys of the top level hash from offset on. The failed document
+ * may have overridden earlier pairs, their keys have to be found again. */
+SRL_STATIC_INLINE void
+srl_cleanup_key_tbl(pTHX_ srl_merger_t *mrg, UV offset)
+{
+    UV i;
+
+    if (!mrg->key_tbl)
+        return;
+
+    STRTABLE_purge(mrg->key_tbl, offset);
+
+    for (i = mrg->overridden_committed; i < mrg->overridden_len; ++i) {
+        const UV pair_offset = mrg->overridden_pairs[i];
+        const srl_buffer_char *key = SRL_MRG_BODY_PTR(mrg, pair_offset);
+        strtable_entry_ptr ent;
+        int ok;
+
+        if (pair_offset >= offset)
+            continue;
+
+        ent = STRTABLE_insert(mrg->key_tbl, key, (U32) srl_merger_string_length(key), &ok);
+        assert(!ok);
+        ent->offset = pair_offset;
+    }
+
+    mrg->overridden_len = mrg->overridden_committed;
+}
+
+/* Length of a string in obuf, including tag and length varint */
+SRL_STATIC_INLINE STRLEN
+srl_merger_string_length(const srl_buffer_char *str)
+{
+    const U8 tag = *str & ~SRL_HDR_TRACK_FLAG;
+    const srl_buffer_char *p = str + 1;
+    unsigned int lshift = 0;
+    STRLEN len = 0;
+
+    if (tag >= SRL_HDR_SHORT_BINARY_LOW)
+        return SRL_HDR_SHORT_BINARY_LEN_FROM_TAG(tag) + 1;
+
+    /* obuf holds valid Sereal only */
+    while (*p & 0x80) {
+        len |= (STRLEN) (*p++ & 0x7f) << lshift;
+        lshift += 7;
+    }
+
+    len |= (STRLEN) *p++ << lshift;
+    return len + (p - str);
+}
+
 SRL_STATIC_INLINE void
 srl_buf_copy_content_nocheck(pTHX_ srl_merger_t *mrg, size_t len)
 {
+    SRL_RDR_ASSERT_SPACE(mrg->pibuf, len, "");
     GROW_BUF(&mrg->obuf, len);
 
     Copy(mrg->ibuf.pos, mrg->obuf.pos, len, char);
@@ -1296,34 +2191,3 @@ srl_copy_varint(pTHX_ srl_merger_t *mrg)
     DEBUG_ASSERT_RDR_SANE(mrg->pibuf);
     DEBUG_ASSERT_BUF_SANE(&mrg->obuf);
 }
-
-SRL_STATIC_INLINE void
-srl_stack_rsort(pTHX_ srl_stack_t *stack)
-{
-    size_t size;
-    DEBUG_ASSERT_STACK_SANE(stack);
-    if (expect_false(srl_stack_empty(stack))) return;
-
-    size = SRL_STACK_SPACE(stack);
-    QSORT(srl_stack_type_t, stack->begin, size, SRL_SRL_STACK_TYPE_GT);
-    /*qsort((void *) stack->begin, size, sizeof(SRL_STACK_TYPE), __compare_SRL_STACK_TYPE); */
-
-    stack->ptr = stack->begin + size - 1;
-}
-
-SRL_STATIC_INLINE void
-srl_stack_dedupe(pTHX_ srl_stack_t *stack)
-{
-    srl_stack_type_t *i, *j;
-    DEBUG_ASSERT_STACK_SANE(stack);
-    if (expect_false(srl_stack_empty(stack))) return;
-
-    i = stack->begin;
-    j = stack->begin;
-    for (; i <= stack->ptr; i++) {
-        if (*j != *i) *++j = *i;
-    }
-
-    stack->ptr = j;
-    DEBUG_ASSERT_STACK_SANE(stack);
-}
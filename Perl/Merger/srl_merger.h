@@ -14,36 +14,74 @@
 #include "srl_reader_types.h"
 #include "srl_buffer_types.h"
 
+/* maps the offset of an item in ibuf to the offset of its copy in obuf */
+typedef struct {
+    UV from;                              /* body offset in ibuf */
+    UV to;                                /* body offset in obuf */
+} srl_merger_offset_t;
+
 /* the merger main struct */
 typedef struct {
     srl_buffer_t obuf;                    /* output buffer */
     srl_reader_buffer_t ibuf;             /* input buffer, MUST NOT be deallocated by srl_buf_free_buffer() */
     srl_reader_buffer_ptr pibuf;          /* pointer to ibuf */
-    struct srl_stack *tracked_offsets;    /* sorted list of offsets from ibuf which
-                                             reffered by COPY, OBJECTV or OBJECTV_FREEZE tag */
+    srl_merger_offset_t *tracked_offsets; /* ibuf to obuf offsets of everything in the current document
+                                             which COPY, REFP, ALIAS, OBJECTV or OBJECTV_FREEZE may refer to,
+                                             sorted by ibuf offset because it's filled in document order */
+    UV tracked_offsets_len;               /* number of entries in tracked_offsets */
+    UV tracked_offsets_size;              /* allocated size of tracked_offsets */
+    UV tracked_offsets_low;               /* lowest entry of tracked_offsets updated out of order, see srl_drop_merged() */
 
-    struct PTABLE   *tracked_offsets_tbl; /* table to convert ibuf offsets to obuf offsets */
     struct STRTABLE *string_deduper_tbl;  /* track strings we have seen before, by content */
     struct STRTABLE *classname_deduper_tbl;  /* track classnames we have seen before, by content */
+    UV dedupe_memory_limit;               /* approximate memory limit for each of the deduper tables, 0 for none */
+    UV dedupe_hits;                       /* strings and class names emitted as COPY */
+    UV dedupe_bytes_saved;                /* bytes saved by emitting COPY tags */
+    UV dedupe_hits_committed;             /* dedupe_hits after the last successfully merged document */
+    UV dedupe_bytes_saved_committed;      /* dedupe_bytes_saved after the last successfully merged document */
+
+    struct STRTABLE *key_tbl;             /* keys of the top level hash, by content, see srl_merge_hash_pair() */
+    UV *overridden_pairs;                 /* offsets of top level pairs whose key came again later, last one wins */
+    UV overridden_len;                    /* number of entries in overridden_pairs */
+    UV overridden_size;                   /* allocated size of overridden_pairs */
+    UV overridden_committed;              /* overridden_len after the last successfully merged document */
+    U32 dropping;                         /* set while merging a value which is dropped afterwards */
 
     UV obuf_last_successfull_offset;      /* pointer to last byte of last successfully merged Sereal document */
     UV obuf_padding_bytes_offset;         /* pointer to start of SRL_MAX_VARINT_LENGTH padding bytes */
+    UV header_space;                      /* bytes reserved in front of the body for Sereal and user headers */
+    UV obuf_flushed;                      /* body bytes which were written to stream_to and dropped from obuf */
+
+    SV *stream_to;                        /* filehandle the merged document is streamed to, or NULL */
+    UV stream_threshold;                  /* write out obuf once it holds this many bytes */
+    UV stream_written;                    /* bytes written to stream_to so far */
+    Off_t stream_count_pos;               /* position of the padding bytes for the element count in stream_to */
 
     UV recursion_depth;                   /* recursion depth of current document */
     UV max_recursion_depth;               /* configurable limit on the number of recursive calls we're willing to make */
 
     U32 cnt_of_merged_elements;           /* total count of merged elements so far */
+    U32 cnt_of_merged_keys;               /* key/value pairs in the top level hash, including overridden ones */
     U32 protocol_version;                 /* the version of the Sereal protocol to emit. */
     U32 flags;                            /* flag-like options: See SRL_F_* defines */
 
+    IV compress_level;                    /* For ZLIB and ZSTD, the compression level */
     void *snappy_workmem;                 /* lazily allocated if and only if using Snappy */
+    struct ZSTD_CCtx_s *zstd_cctx;        /* zstd compression context, only if using zstd */
+    struct ZSTD_DCtx_s *zstd_dctx;        /* zstd decompression context, lazily allocated on first zstd input */
+    SV *zstd_ibuf;                        /* buffer for decompressed zstd input, reused between documents */
+    srl_buffer_t snapshot_buf;            /* uncompressed copy of compressed snapshots, lazily allocated */
 } srl_merger_t;
 
 srl_merger_t *srl_build_merger_struct(pTHX_ HV *opt);         /* constructor from options */
 void srl_destroy_merger(pTHX_ srl_merger_t *mrg);             /* explicit destructor */
 void srl_merger_append(pTHX_ srl_merger_t *mrg, SV *src);     /* merge one item */
 void srl_merger_append_all(pTHX_ srl_merger_t *mrg, AV *src); /* merge all items from src */
+void srl_merger_append_file(pTHX_ srl_merger_t *mrg, SV *path);  /* merge the document in file path */
+void srl_merger_append_files(pTHX_ srl_merger_t *mrg, AV *paths); /* merge the documents in all files */
 SV * srl_merger_finish(pTHX_ srl_merger_t *mrg, SV *user_header_src);
+SV * srl_merger_snapshot(pTHX_ srl_merger_t *mrg, SV *user_header_src); /* merged document so far, merging can go on */
+HV * srl_merger_dedupe_stats(pTHX_ srl_merger_t *mrg);       /* dedupe counters of the merged documents, as a mortal hash */
 
 /* define option bits in srl_merger_t's flags member */
 
@@ -52,9 +90,14 @@ SV * srl_merger_finish(pTHX_ srl_merger_t *mrg, SV *user_header_src);
 #define SRL_F_TOPLEVEL_KEY_ARRAY                0x00002UL
 #define SRL_F_TOPLEVEL_KEY_HASH                 0x00004UL
 
+/* With SRL_F_TOPLEVEL_KEY_HASH, keep the first value of a duplicated key
+ * instead of the last one */
+#define SRL_F_FIRST_KEY_WINS                    0x00008UL
+
 /* WARNING: SRL_F_COMPRESS_SNAPPY               0x00040UL
  *          SRL_F_COMPRESS_SNAPPY_INCREMENTAL   0x00080UL
  *          SRL_F_COMPRESS_ZLIB                 0x00100UL
+ *          SRL_F_COMPRESS_ZSTD                 0x40000UL
  *          are in srl_compress.h */
 
 /* If set, use a hash to emit COPY() tags for all duplicated strings (including keys)
@@ -3,8 +3,14 @@
  */
 
 /*
- * This is a customized version of the pointer table implementation in sv.c
- * The hash functions are taken from hv_func.h
+ * Hash table of strings which were written to a buffer, used to find
+ * duplicates while merging. Strings are not copied into the table, every
+ * entry refers to the string's offset in the buffer.
+ *
+ * Open addressing with linear probing. Entries keep the full 64 bit XXH64
+ * hash of the string, so memcmp() runs only for real matches and for the
+ * odd true collision. Deleted entries are removed by shifting the rest of
+ * their cluster back, so there are no tombstones.
  */
 
 #ifndef STRTABLE_H_
@@ -16,156 +22,31 @@
 #include "ppport.h"
 #include "srl_inline.h"
 #include "srl_buffer_types.h"
+#include "srl_xxhash.h"
 
-#ifndef PERL_HASH_FUNC_MURMUR_HASH_64A
-/* This code is from Austin Appleby and is in the public domain.
-   Altered by Yves Orton to match Perl's hash interface, and to
-   return a 32 bit hash.
-
-   Note uses unaligned 64 bit loads - will NOT work on machines with
-   strict alginment requirements.
-
-   Also this code may not be suitable for big-endian machines.
-*/
-
-/* a 64 bit hash where we only use the low 32 bits */
-SRL_STATIC_INLINE U32
-S_perl_hash_murmur_hash_64a (const unsigned char * const seed, const unsigned char *str, const STRLEN len)
-{
-        const U64TYPE m = 0xc6a4a7935bd1e995;
-        const int r = 47;
-        U64TYPE h = *((U64TYPE*)seed) ^ len;
-        const U64TYPE * data = (const U64TYPE *)str;
-        const U64TYPE * end = data + (len/8);
-        const unsigned char * data2;
-
-        while(data != end)
-        {
-            U64TYPE k = *data++;
-
-            k *= m;
-            k ^= k >> r;
-            k *= m;
-
-            h ^= k;
-            h *= m;
-        }
-
-        data2 = (const unsigned char *)data;
-
-        switch(len & 7)
-        {
-            case 7: h ^= (U64TYPE)(data2[6]) << 48; /* fallthrough */
-            case 6: h ^= (U64TYPE)(data2[5]) << 40; /* fallthrough */
-            case 5: h ^= (U64TYPE)(data2[4]) << 32; /* fallthrough */
-            case 4: h ^= (U64TYPE)(data2[3]) << 24; /* fallthrough */
-            case 3: h ^= (U64TYPE)(data2[2]) << 16; /* fallthrough */
-            case 2: h ^= (U64TYPE)(data2[1]) << 8;  /* fallthrough */
-            case 1: h ^= (U64TYPE)(data2[0]);       /* fallthrough */
-                    h *= m;
-        };
-
-        h ^= h >> r;
-        h *= m;
-        h ^= h >> r;
-
-        /* was: return h; */
-        return h & 0xFFFFFFFF;
-}
-#endif
-
-#ifndef PERL_HASH_FUNC_MURMUR_HASH_64B
-/* This code is from Austin Appleby and is in the public domain.
-   Altered by Yves Orton to match Perl's hash interface and return
-   a 32 bit value
-
-   Note uses unaligned 32 bit loads - will NOT work on machines with
-   strict alginment requirements.
-
-   Also this code may not be suitable for big-endian machines.
-*/
-
-/* a 64-bit hash for 32-bit platforms where we only use the low 32 bits */
-SRL_STATIC_INLINE U32
-S_perl_hash_murmur_hash_64b (const unsigned char * const seed, const unsigned char *str, STRLEN len)
-{
-        const U32 m = 0x5bd1e995;
-        const int r = 24;
-
-        U32 h1 = ((U32 *)seed)[0] ^ len;
-        U32 h2 = ((U32 *)seed)[1];
-
-        const U32 * data = (const U32 *)str;
-
-        while(len >= 8)
-        {
-            U32 k1, k2;
-            k1 = *data++;
-            k1 *= m; k1 ^= k1 >> r; k1 *= m;
-            h1 *= m; h1 ^= k1;
-            len -= 4;
-
-            k2 = *data++;
-            k2 *= m; k2 ^= k2 >> r; k2 *= m;
-            h2 *= m; h2 ^= k2;
-            len -= 4;
-        }
-
-        if(len >= 4)
-        {
-            U32 k1 = *data++;
-            k1 *= m; k1 ^= k1 >> r; k1 *= m;
-            h1 *= m; h1 ^= k1;
-            len -= 4;
-        }
-
-        switch(len)
-        {
-            case 3: h2 ^= ((unsigned char*)data)[2] << 16;  /* fallthrough */
-            case 2: h2 ^= ((unsigned char*)data)[1] << 8;   /* fallthrough */
-            case 1: h2 ^= ((unsigned char*)data)[0];        /* fallthrough */
-                    h2 *= m;
-        };
-
-        h1 ^= h2 >> 18; h1 *= m;
-        h2 ^= h1 >> 22; h2 *= m;
-        /*
-        The following code has been removed as it is unused
-        when only the low 32 bits are used. -- Yves
-
-        h1 ^= h2 >> 17; h1 *= m;
-
-        U64TYPE h = h1;
-
-        h = (h << 32) | h2;
-        */
-
-        return h2;
-}
-#endif
-
-/* hash function has to return 4 bytes long value i.e. U32 */
-
-#if PTRSIZE == 8
-#   define PERL_HASH_SEED_BYTES 8
-#   define STRTABLE_HASH(str, len) S_perl_hash_murmur_hash_64a(PERL_HASH_SEED, (U8*) (str), (len))
-#else
-#   define PERL_HASH_SEED_BYTES 8
-#   define STRTABLE_HASH(str, len) S_perl_hash_murmur_hash_64b(PERL_HASH_SEED, (U8*) (str), (len))
-#endif
+#define STRTABLE_HASH(tbl, str, len) ((U64TYPE) XXH64((str), (len), (tbl)->tbl_seed))
 
 #define STRTABLE_MAX_STR_SIZE 0xFFFFFFFF
+/* seed of bounded tables, see STRTABLE_set_memory_limit */
+#define STRTABLE_FIXED_SEED ((U64TYPE) 0x53524C31)
 #define STRTABLE_ENTRY_STR(tbl, ent) ((tbl)->buf->body_pos + (ent)->offset)
 
+/* offset of a new entry until the caller sets it */
+#define STRTABLE_NO_OFFSET ((UV) -1)
+
+/* approximate memory used per entry, as the table is kept 3/8 to 3/4 full */
+#define STRTABLE_ENTRY_COST (2 * sizeof(struct STRTABLE_entry))
+
 #define STRTABLE_ASSERT_ENTRY(tbl, ent) STMT_START {                      \
     assert((ent) != NULL);                                                \
+    assert((ent)->length != 0);                                           \
     assert((tbl)->buf->body_pos <= STRTABLE_ENTRY_STR((tbl), (ent)));     \
     assert((tbl)->buf->end      >= STRTABLE_ENTRY_STR((tbl), (ent)));     \
 } STMT_END
 
 #define STRTABLE_ASSERT_ENTRY_STR(tbl, ent, str, len) STMT_START {                         \
     assert((ent)->length == (len));                                                        \
-    assert((ent)->hash == STRTABLE_HASH((str), (len)));                                    \
+    assert((ent)->hash == STRTABLE_HASH((tbl), (str), (len)));                             \
     assert(memcmp((char *) STRTABLE_ENTRY_STR((tbl), (ent)), (char*) (str), (len)) == 0); \
 } STMT_END
 
@@ -175,40 +56,33 @@ typedef struct STRTABLE_entry   STRTABLE_ENTRY_t;
 typedef struct STRTABLE_entry * strtable_entry_ptr;
 
 struct STRTABLE_entry {
-    struct STRTABLE_entry   *next;
-
-    U32                     hash;
+    U64TYPE                 hash;
 
-    /* length of string at offset inside tbl->buf.
+    /* length of string at offset inside tbl->buf, 0 for empty slots.
      * Limit to 4 bytes to get more compact struct */
     U32                     length;
 
+    /* CLOCK reference bit, set when STRTABLE_insert finds the entry */
+    U32                     referenced;
+
     /* offset inside STRTABLE->buf
      * where tag (STR_UTF8|BINARY|SHORT_BINARY) is located */
     UV                      offset;
 };
 
-struct STRTABLE_arena {
-    struct STRTABLE_arena   *next;
-#if PTRSIZE == 8
-    struct STRTABLE_entry   array[1023/3]; /* as STRTABLE_entry has 8B + 2*4B + 8B = 3*8B,
-                                            * this magic math makes sure that STRTABLE_arena
-                                            * fits inside two pages (8192 bytes) */
-#else
-    struct STRTABLE_entry   array[1023/5]; /* as STRTABLE_entry has 4B + 2*4B + 8B = 5*4B
-                                            * this magic math make sure that STRTABLE_arena
-                                            * fits inside one page (4096 bytes) */
-#endif
-};
-
 struct STRTABLE {
-    struct STRTABLE_entry   **tbl_ary;
-    UV                      tbl_max;
+    struct STRTABLE_entry   *tbl_ary;
+    UV                      tbl_max;    /* number of slots - 1 */
     UV                      tbl_items;
-    struct STRTABLE_arena   *tbl_arena;
-    struct STRTABLE_entry   *tbl_arena_next;
-    struct STRTABLE_entry   *tbl_arena_end;
+    U64TYPE                 tbl_seed;
     const srl_buffer_t      *buf;
+
+    /* Eviction, only if tbl_max_items isn't 0. Once the table is full,
+     * the CLOCK hand goes over the slots and reuses the first entry which
+     * wasn't found by STRTABLE_insert since the hand passed it last time. */
+    UV                      tbl_max_items;
+    UV                      tbl_evictions;
+    UV                      tbl_hand;
 };
 
 SRL_STATIC_INLINE STRTABLE_t * STRTABLE_new(const srl_buffer_t *buf);
@@ -216,14 +90,20 @@ SRL_STATIC_INLINE STRTABLE_t * STRTABLE_new_size(const srl_buffer_t *buf, const
 
 /* Caller has to fill offset field in returned STRTABLE_ENTRY_t.
  * Such approach shows better performance, BODY_POS_OFS() seems to be quite expensive
- * to calculate it on every call of STRTABLE_insert */
+ * to calculate it on every call of STRTABLE_insert.
+ * The returned pointer is only valid until the table is changed again. */
 SRL_STATIC_INLINE STRTABLE_ENTRY_t * STRTABLE_insert(STRTABLE_t *tbl, const unsigned char *str, U32 len, int *ok);
 
+SRL_STATIC_INLINE void STRTABLE_set_memory_limit(STRTABLE_t *tbl, UV bytes);
+
 SRL_STATIC_INLINE void STRTABLE_grow(STRTABLE_t *tbl);
+SRL_STATIC_INLINE void STRTABLE_delete(STRTABLE_t *tbl, UV slot);
+SRL_STATIC_INLINE void STRTABLE_evict(STRTABLE_t *tbl);
 SRL_STATIC_INLINE void STRTABLE_clear(STRTABLE_t *tbl);
 SRL_STATIC_INLINE void STRTABLE_free(STRTABLE_t *tbl);
+SRL_STATIC_INLINE void STRTABLE_purge(STRTABLE_t *tbl, UV offset);
 
-/* create a new pointer => pointer table */
+/* create a new string table */
 SRL_STATIC_INLINE STRTABLE_t *
 STRTABLE_new(const srl_buffer_t *buf)
 {
@@ -239,253 +119,218 @@ STRTABLE_new_size(const srl_buffer_t *buf, const U8 size_base2_exponent)
     tbl->buf = buf;
     tbl->tbl_max = (1 << size_base2_exponent) - 1;
     tbl->tbl_items      = 0;
-    tbl->tbl_arena      = NULL;
-    tbl->tbl_arena_next = NULL;
-    tbl->tbl_arena_end  = NULL;
+    tbl->tbl_max_items  = 0;
+    tbl->tbl_evictions  = 0;
+    tbl->tbl_hand       = 0;
+
+    /* seed the hash from perl's hash seed,
+     * so that the input can't be crafted to collide */
+    tbl->tbl_seed = 0;
+#if defined(PERL_HASH_SEED) && defined(PERL_HASH_SEED_BYTES)
+    Copy(PERL_HASH_SEED, &tbl->tbl_seed,
+         PERL_HASH_SEED_BYTES < sizeof(tbl->tbl_seed) ? PERL_HASH_SEED_BYTES : sizeof(tbl->tbl_seed), U8);
+#endif
 
-    Newxz(tbl->tbl_ary, tbl->tbl_max + 1, STRTABLE_ENTRY_t*);
+    Newxz(tbl->tbl_ary, tbl->tbl_max + 1, STRTABLE_ENTRY_t);
     return tbl;
 }
 
+/* Limit the memory used by tbl to about bytes, 0 means no limit.
+ * Has to be called before anything is inserted.
+ * Which entry gets evicted depends on the slots the CLOCK hand passes,
+ * that is on the hash values, so a bounded table uses a fixed seed to
+ * produce the same output in every process. */
+SRL_STATIC_INLINE void
+STRTABLE_set_memory_limit(STRTABLE_t *tbl, UV bytes)
+{
+    assert(tbl->tbl_items == 0);
+    tbl->tbl_max_items = bytes ? bytes / STRTABLE_ENTRY_COST : 0;
+    if (bytes && tbl->tbl_max_items == 0)
+        tbl->tbl_max_items = 1;
+    if (bytes)
+        tbl->tbl_seed = STRTABLE_FIXED_SEED;
+}
+
 /* lookup key, return if found, otherwise store */
 SRL_STATIC_INLINE STRTABLE_ENTRY_t *
 STRTABLE_insert(STRTABLE_t *tbl, const unsigned char *str, U32 len, int *ok)
 {
-    UV entry;
+    UV slot;
     STRTABLE_ENTRY_t *tblent;
-    const U32 hash = STRTABLE_HASH(str, len);
+    const U64TYPE hash = STRTABLE_HASH(tbl, str, len);
 
+    assert(len > 0);
     assert(len <= STRTABLE_MAX_STR_SIZE);
     *ok = 0;
 
-    tblent = tbl->tbl_ary[hash & tbl->tbl_max];
-    for (; tblent; tblent = tblent->next) {
+    for (slot = hash & tbl->tbl_max; ; slot = (slot + 1) & tbl->tbl_max) {
+        tblent = &tbl->tbl_ary[slot];
+        if (tblent->length == 0)
+            break;
+
         STRTABLE_ASSERT_ENTRY(tbl, tblent);
 
         if (   tblent->hash == hash
             && tblent->length == len
             && memcmp((char*) STRTABLE_ENTRY_STR(tbl, tblent), (char*) str, len) == 0
         ) {
+            tblent->referenced = 1;
             *ok = 1;
             return tblent;
         }
     }
 
-    /* didn't found record, tblent == NULL */
-    assert(tblent == NULL);
-
-    if (tbl->tbl_arena_next == tbl->tbl_arena_end) {
-       struct STRTABLE_arena *new_arena;
-       Newx(new_arena, 1, struct STRTABLE_arena);
-       new_arena->next = tbl->tbl_arena;
-
-       tbl->tbl_arena = new_arena;
-       tbl->tbl_arena_next = new_arena->array;
-       tbl->tbl_arena_end = new_arena->array + sizeof(new_arena->array) / sizeof(new_arena->array[0]);
+    /* didn't found record, tblent is the empty slot which ended the probe.
+     * Making room moves entries around, so the slot has to be found again. */
+    if (expect_false(tbl->tbl_max_items && tbl->tbl_items >= tbl->tbl_max_items)) {
+        STRTABLE_evict(tbl);
+        for (slot = hash & tbl->tbl_max; tbl->tbl_ary[slot].length; slot = (slot + 1) & tbl->tbl_max) {}
+        tblent = &tbl->tbl_ary[slot];
+    } else if (expect_false((tbl->tbl_items + 1) * 4 > (tbl->tbl_max + 1) * 3)) {
+        STRTABLE_grow(tbl);
+        for (slot = hash & tbl->tbl_max; tbl->tbl_ary[slot].length; slot = (slot + 1) & tbl->tbl_max) {}
+        tblent = &tbl->tbl_ary[slot];
     }
 
-    entry = hash & tbl->tbl_max;
-    tblent = tbl->tbl_arena_next++;
-
     /* tblent->offset has to be set by caller,
-     * but assign tag_offset and str_offset to invalid value
-     * in order to suppress valgrind warnings about uninitalized memory */
-    tblent->offset = (UV) -1;
+     * but assign it to invalid value in order to
+     * suppress valgrind warnings about uninitalized memory */
     tblent->hash = hash;
     tblent->length = len;
-    tblent->next = tbl->tbl_ary[entry];
-
-    tbl->tbl_ary[entry] = tblent;
+    tblent->referenced = 0;
+    tblent->offset = STRTABLE_NO_OFFSET;
     tbl->tbl_items++;
 
-    if (tblent->next && (tbl->tbl_items > tbl->tbl_max))
-        STRTABLE_grow(tbl);
-
     return tblent;
 }
 
-/* double the hash bucket size of an existing ptr table */
+/* double the number of slots of an existing string table */
 
 SRL_STATIC_INLINE void
 STRTABLE_grow(STRTABLE_t *tbl)
 {
-    STRTABLE_ENTRY_t **ary = tbl->tbl_ary;
+    STRTABLE_ENTRY_t *old_ary = tbl->tbl_ary;
     const UV oldsize = tbl->tbl_max + 1;
-    UV newsize = oldsize * 2;
-    UV i;
+    const UV newmax = oldsize * 2 - 1;
+    UV i, slot;
 
-    Renew(ary, newsize, STRTABLE_ENTRY_t*);
-    Zero(&ary[oldsize], newsize - oldsize, STRTABLE_ENTRY_t*);
-    tbl->tbl_max = --newsize;
-    tbl->tbl_ary = ary;
+    Newxz(tbl->tbl_ary, newmax + 1, STRTABLE_ENTRY_t);
+    tbl->tbl_max = newmax;
+    tbl->tbl_hand &= newmax;
 
-    for (i = 0; i < oldsize; i++, ary++) {
-        STRTABLE_ENTRY_t **curentp, **entp, *ent;
-        if (!*ary)
+    for (i = 0; i < oldsize; i++) {
+        if (old_ary[i].length == 0)
             continue;
-        curentp = ary + oldsize;
-        for (entp = ary, ent = *ary; ent; ent = *entp) {
-            if ((newsize & ent->hash) != i) {
-                *entp = ent->next;
-                ent->next = *curentp;
-                *curentp = ent;
-                continue;
-            } else {
-                entp = &ent->next;
-            }
-        }
+
+        for (slot = old_ary[i].hash & newmax; tbl->tbl_ary[slot].length; slot = (slot + 1) & newmax) {}
+        tbl->tbl_ary[slot] = old_ary[i];
     }
+
+    Safefree(old_ary);
 }
 
-/* remove all the entries from a ptr table */
+/* Remove the entry in slot. Following entries of the cluster which could
+ * not be found any more are moved back, so slot may hold another entry
+ * afterwards. Entries are only ever moved back within their cluster. */
 
 SRL_STATIC_INLINE void
-STRTABLE_clear(STRTABLE_t *tbl)
+STRTABLE_delete(STRTABLE_t *tbl, UV slot)
 {
-    if (tbl && tbl->tbl_items) {
-        struct STRTABLE_arena *arena = tbl->tbl_arena;
+    STRTABLE_ENTRY_t *ary = tbl->tbl_ary;
+    const UV max = tbl->tbl_max;
+    UV next = slot;
+
+    assert(ary[slot].length != 0);
+
+    for (;;) {
+        UV home;
+        next = (next + 1) & max;
+        if (ary[next].length == 0)
+            break;
+
+        /* the entry at next stays if its home slot lies in (slot, next] */
+        home = ary[next].hash & max;
+        if (slot <= next ? (slot < home && home <= next)
+                         : (slot < home || home <= next))
+            continue;
+
+        ary[slot] = ary[next];
+        slot = next;
+    }
+
+    ary[slot].length = 0;
+
+    assert(tbl->tbl_items > 0);
+    tbl->tbl_items--;
+}
+
+/* Delete the entry the CLOCK hand points to, skipping and unmarking
+ * referenced entries. The hand stays on the deleted slot because
+ * STRTABLE_delete() may have moved an entry there which it hasn't seen. */
+
+SRL_STATIC_INLINE void
+STRTABLE_evict(STRTABLE_t *tbl)
+{
+    STRTABLE_ENTRY_t *ent;
 
-        Zero(tbl->tbl_ary, tbl->tbl_max + 1, struct STRTABLE_entry **);
+    assert(tbl->tbl_items > 0);
 
-        while (arena) {
-            struct STRTABLE_arena *next = arena->next;
+    for (;; tbl->tbl_hand = (tbl->tbl_hand + 1) & tbl->tbl_max) {
+        ent = &tbl->tbl_ary[tbl->tbl_hand];
+        if (ent->length == 0)
+            continue;
 
-            Safefree(arena);
-            arena = next;
-        };
+        if (ent->referenced) {
+            ent->referenced = 0;
+        } else {
+            STRTABLE_delete(tbl, tbl->tbl_hand);
+            tbl->tbl_evictions++;
+            return;
+        }
+    }
+}
 
+/* remove all the entries from a string table */
+
+SRL_STATIC_INLINE void
+STRTABLE_clear(STRTABLE_t *tbl)
+{
+    if (tbl && tbl->tbl_items) {
+        Zero(tbl->tbl_ary, tbl->tbl_max + 1, STRTABLE_ENTRY_t);
         tbl->tbl_items = 0;
-        tbl->tbl_arena = NULL;
-        tbl->tbl_arena_next = NULL;
-        tbl->tbl_arena_end = NULL;
+        tbl->tbl_hand = 0;
     }
 }
 
-/* clear and free a ptr table */
+/* clear and free a string table */
 
 SRL_STATIC_INLINE void
 STRTABLE_free(STRTABLE_t *tbl)
 {
-    struct STRTABLE_arena *arena;
     if (!tbl) return;
 
-    arena = tbl->tbl_arena;
-
-    while (arena) {
-        struct STRTABLE_arena *next = arena->next;
-        Safefree(arena);
-        arena = next;
-    }
-
     Safefree(tbl->tbl_ary);
     Safefree(tbl);
 }
 
+/* Remove all entries with offset equal to or higher than offset.
+ * This walks all slots, but it's only needed after a broken document.
+ * After a delete the same slot is checked again, as STRTABLE_delete()
+ * may have moved a following entry there. Entries are never moved from
+ * a slot which is still to be checked to one which was checked already. */
+
 SRL_STATIC_INLINE void
 STRTABLE_purge(STRTABLE_t *tbl, UV offset)
 {
-    struct STRTABLE_arena *arena;
-    struct STRTABLE_entry *tblent;
-    struct STRTABLE_entry *tblent_prev;
-    struct STRTABLE_entry *next, *entry, *arena_start;
-    size_t arena_size = sizeof(arena->array) / sizeof(arena->array[0]);
+    UV slot;
 
     if (!tbl || !tbl->tbl_items)
         return;
 
-    assert(tbl->tbl_arena_next >= tbl->tbl_arena->array);
-    assert(tbl->tbl_arena_next <= tbl->tbl_arena->array + arena_size);
-    assert(tbl->tbl_arena_end  == tbl->tbl_arena->array + arena_size);
-
-    arena = tbl->tbl_arena;
-    arena_start = &arena->array[0];
-
-    next = tbl->tbl_arena_next;     /* pointer to next available for usage element */
-    entry = next - 1;               /* pointer to currently inspected element */
-
-    while (entry->offset >= offset) {
-        /*warn("entry->offset: %d", entry->offset); */
-
-        /* start of remove entry from hash buckets.
-         * Hash buckets are single-linked lists,
-         * so I need to scan the list in order to delete it.
-         * But, due to the fact that I'm scanning arena in backward order
-         * and elements are added always to head of the list, it's very
-         * likely that the needed elemnt will be head of linked list */
-
-        assert(tbl->tbl_items > 0);
-        tbl->tbl_items--;
-
-        tblent_prev = NULL;
-        tblent = tbl->tbl_ary[entry->hash & tbl->tbl_max];
-
-        for (; tblent; tblent_prev = tblent, tblent = tblent->next) {
-            if (tblent == entry) {
-                if (tblent_prev != NULL) {
-                    tblent_prev->next = tblent->next;
-                } else {
-                    /* First entry in chain */
-                    tbl->tbl_ary[entry->hash & tbl->tbl_max] = tblent->next;
-                }
-                break;
-            }
-        }
-        /* end of remove entry from hash buckets */
-
-        if (entry == arena_start) {
-            /*warn("entry == arena_start"); */
-
-            /* entry ptr reach start of arena. */
-            /* If there is no arenas - our table is empty, */
-            /* so, make first element in arena to be available */
-            /* for further allocations */
-            struct STRTABLE_arena * next_arena = arena->next;
-            if (!next_arena) {
-                /*warn("!next_arena"); */
-                next = entry;
-                break;
-            }
-
-            /* Otherwise, move entry pointer to last item in next arena */
-            /* Next iteration would free this arena and */
-            /* adjust next pointer accordingly. */
-            /* See comments for next if statemnt. */
-            entry = next_arena->array + arena_size - 1;
-            --next;
-        } else if (next == arena_start) {
-            /*warn("next == arena_start"); */
- 
-            /* next pointer reached start of arena */
-            /* meaning this arena is not used any more. */
-            /* Free arena and move next to last element in next arena. */
-            /* It's not possible and arena->next is NULL here, */
-            /* because if so, we would already exit. */
-            /* See entry == arena_start */
-            struct STRTABLE_arena *next_arena = arena->next;
-            Safefree(arena);
-
-            arena = next_arena;
-            arena_start = &arena->array[0];
-
-            next = arena->array + arena_size - 1;
-            --entry;
-
-            assert(entry == next - 1);
-        } else {
-            --entry;
-            --next;
-
-            assert(entry == next - 1);
-        }
+    for (slot = 0; slot <= tbl->tbl_max; ++slot) {
+        while (tbl->tbl_ary[slot].length && tbl->tbl_ary[slot].offset >= offset)
+            STRTABLE_delete(tbl, slot);
     }
-
-    tbl->tbl_arena = arena;
-    tbl->tbl_arena_next = next;
-    tbl->tbl_arena_end = arena->array + arena_size;
-
-    assert(tbl->tbl_arena_next >= tbl->tbl_arena->array);
-    assert(tbl->tbl_arena_next <= tbl->tbl_arena->array + arena_size);
-    assert(tbl->tbl_arena_end  == tbl->tbl_arena->array + arena_size);
 }
 
 #endif
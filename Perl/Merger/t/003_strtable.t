@@ -3,7 +3,8 @@ use strict;
 use warnings;
 use Sereal::Merger;
 $| = 1;
-print "1..35\n";
+print "1..44\n";
 Sereal::Merger::_strtabletest::test();
 Sereal::Merger::_strtabletest::test_purge();
+Sereal::Merger::_strtabletest::test_evict();
 
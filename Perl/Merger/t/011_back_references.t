@@ -0,0 +1,73 @@
+#!perl
+use strict;
+use warnings;
+use Sereal::Merger;
+use Sereal::Encoder;
+use Sereal::Decoder;
+use Scalar::Util qw(weaken);
+use Test::More;
+
+# Every kind of back reference (REFP, ALIAS, COPY, OBJECTV) has to be
+# translated to the offsets in the merged document.
+
+package Foo;
+sub FREEZE { my ($self) = @_; return [ %$self ] }
+sub THAW   { my ($class, $serializer, $data) = @_; return bless { @$data }, $class }
+
+package main;
+
+my @data;
+{ my $h = { a => 1 }; push @data, [ $h, $h, \$h->{a} ]; }
+{ my $a = [1]; push @$a, $a; push @data, $a; }
+{ my $x = "str" x 10; push @data, [ \$x, \$x, $x, $x ]; }
+{ my $o = bless { x => 1 }, 'Some::Class';
+  push @data, [ $o, $o, bless([], 'Some::Class'), bless({}, 'Other::Class'), bless([], 'Some::Class') ]; }
+{ my $h = {}; $h->{self} = $h; weaken($h->{self}); push @data, $h; }
+push @data, [ map { { name => "name$_", kind => "kind" . ($_ % 2), list => [ ("abcd") x 3 ] } } 1 .. 20 ];
+push @data, [ bless({ a => 1 }, 'Foo'), bless({ b => 2 }, 'Foo') ];
+push @data, [ qr/abc/i, qr/abc/i, qr/def/ ];
+
+my %encoders = (
+    plain          => {},
+    dedupe         => { dedupe_strings => 1 },
+    aliased_dedupe => { aliased_dedupe_strings => 1 },
+    freeze         => { freeze_callbacks => 1, dedupe_strings => 1 },
+    zstd           => { compress => Sereal::Encoder::SRL_ZSTD(), compress_threshold => 0 },
+);
+
+my $dec = Sereal::Decoder->new;
+foreach my $enc_name (sort keys %encoders) {
+    my $enc = Sereal::Encoder->new($encoders{$enc_name});
+    my @docs = map { $enc->encode($_) } @data, @data;
+    my $expect = [ map { $dec->decode($_) } @docs ];
+
+    foreach my $dedupe (0, 1) {
+        my $name = "$enc_name, dedupe_strings => $dedupe";
+
+        my $mrg = Sereal::Merger->new({ dedupe_strings => $dedupe });
+        $mrg->append($_) for @docs;
+        my $got = $dec->decode($mrg->finish);
+        is_deeply($got, $expect, "$name: append");
+        is($got->[0][0], $got->[0][1], "$name: shared ref is still shared");
+        is($got->[1][1], $got->[1], "$name: cycle is still a cycle");
+
+        $mrg = Sereal::Merger->new({ dedupe_strings => $dedupe });
+        $mrg->append_all(\@docs);
+        is_deeply($dec->decode($mrg->finish), $expect, "$name: append_all");
+    }
+}
+
+# truncated documents croak and leave the merger usable
+{
+    my $doc = Sereal::Encoder->new({ dedupe_strings => 1 })->encode($data[3]);
+    my $mrg = Sereal::Merger->new;
+    my $failed = 0;
+    for my $len (6 .. length($doc) - 1) {
+        $failed++ unless eval { $mrg->append(substr($doc, 0, $len)); 1 };
+    }
+    is($failed, length($doc) - 6, "all truncated documents croak");
+    $mrg->append($doc);
+    is_deeply($dec->decode($mrg->finish), [ $dec->decode($doc) ], "merger usable after truncated input");
+}
+
+done_testing();
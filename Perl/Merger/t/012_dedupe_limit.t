@@ -0,0 +1,83 @@
+#!perl
+use strict;
+use warnings;
+use Sereal::Merger;
+use Sereal::Encoder;
+use Sereal::Decoder qw(decode_sereal);
+use Test::More;
+
+my $enc = Sereal::Encoder->new;
+
+# a few hot strings and many cold ones
+my @docs = map {
+    my $i = $_;
+    [ map { { type => "event_type_" . ($_ % 3), host => "host_name_$i" . "_$_", class => "cold_$i" } } 1 .. 20 ]
+} 1 .. 200;
+push @{ $docs[$_] }, bless({}, "Some::Class::" . ($_ % 50)) for 0 .. $#docs;
+my @encoded = map { $enc->encode($_) } @docs;
+
+my %stats;
+foreach my $limit (0, 100_000, 1_000, 1) {
+    my $mrg = Sereal::Merger->new({ dedupe_strings => 1, dedupe_memory_limit => $limit });
+    $mrg->append_all(\@encoded);
+    my $merged = $mrg->finish;
+    is_deeply(decode_sereal($merged), \@docs, "limit $limit: roundtrip");
+
+    my $stats = $stats{$limit} = $mrg->dedupe_stats;
+    cmp_ok($stats->{bytes_saved}, '>=', $stats->{hits}, "limit $limit: every hit saves bytes");
+}
+
+is($stats{0}{evictions}, 0, "no evictions without limit");
+cmp_ok($stats{1_000}{evictions}, '>', 0, "small limit evicts");
+cmp_ok($stats{1_000}{entries}, '<', $stats{0}{entries}, "small limit bounds the number of entries");
+cmp_ok($stats{1}{entries}, '<=', 2, "tiny limit keeps one entry per table");
+cmp_ok($stats{1_000}{hits}, '>', 0, "hot strings stay in a small table");
+cmp_ok($stats{1_000}{bytes_saved}, '<', $stats{0}{bytes_saved}, "evictions cost some savings");
+
+{
+    my $mrg = Sereal::Merger->new;
+    $mrg->append_all(\@encoded);
+    is_deeply($mrg->dedupe_stats, { hits => 0, bytes_saved => 0, entries => 0, evictions => 0 },
+              "no stats without dedupe_strings");
+}
+
+# a broken document after evictions leaves the tables consistent
+{
+    my $mrg = Sereal::Merger->new({ dedupe_strings => 1, dedupe_memory_limit => 1_000 });
+    $mrg->append_all([ @encoded[0 .. 49] ]);
+    ok(!eval { $mrg->append(substr($encoded[50], 0, -20)); 1 }, "truncated document croaks");
+    $mrg->append_all([ @encoded[50 .. $#encoded] ]);
+    is_deeply(decode_sereal($mrg->finish), \@docs, "roundtrip after broken document with evictions");
+}
+
+# a broken document doesn't count
+{
+    my $mrg = Sereal::Merger->new({ dedupe_strings => 1 });
+    my $ref = Sereal::Merger->new({ dedupe_strings => 1 });
+    $_->append_all([ @encoded[0 .. 9] ]) for $mrg, $ref;
+    ok(!eval { $mrg->append(substr($encoded[10], 0, -20)); 1 }, "truncated document croaks");
+    is_deeply($mrg->dedupe_stats, $ref->dedupe_stats, "stats don't count the broken document");
+    $_->append_all([ @encoded[10 .. 19] ]) for $mrg, $ref;
+    is_deeply($mrg->dedupe_stats, $ref->dedupe_stats, "stats after merging went on");
+}
+
+# evictions, and so the output, don't depend on perl's hash seed
+{
+    my $code = q{
+        use Sereal::Merger; use Sereal::Encoder;
+        my $enc = Sereal::Encoder->new;
+        my $mrg = Sereal::Merger->new({ dedupe_strings => 1, dedupe_memory_limit => 1_000 });
+        $mrg->append($enc->encode([ map { "string_$_" } 1 .. 50, 1 .. 50 ])) for 1 .. 20;
+        print unpack("H*", $mrg->finish);
+    };
+    my @out;
+    foreach my $seed (1, 2) {
+        local $ENV{PERL_HASH_SEED} = $seed;
+        local $ENV{PERL_PERTURB_KEYS} = 1;
+        push @out, scalar `"$^X" @{[ map { qq{"-I$_"} } @INC ]} -e '$code'`;
+    }
+    ok(length $out[0], "merged in a child process");
+    is($out[0], $out[1], "same output with different hash seeds");
+}
+
+done_testing();
@@ -0,0 +1,82 @@
+#!perl
+use strict;
+use warnings;
+use Sereal::Merger qw(:all);
+use Sereal::Encoder;
+use Sereal::Decoder qw(decode_sereal);
+use Test::More;
+
+my @docs = map { { id => $_, name => "item $_" x 10, tags => [ ("tag") x 20 ] } } 1 .. 50;
+
+my %enc_name = (
+    SRL_UNCOMPRESSED, 'raw',
+    SRL_SNAPPY,       'snappy',
+    SRL_ZLIB,         'zlib',
+    SRL_ZSTD,         'zstd',
+);
+
+# the merger must accept input in every encoding
+foreach my $in (sort keys %enc_name) {
+    my $enc = Sereal::Encoder->new({ compress => $in, compress_threshold => 0 });
+    my @encoded = map { $enc->encode($_) } @docs;
+
+    # reuse one merger for several documents so the zstd input buffer
+    # gets reused across documents of different size
+    foreach my $out (sort keys %enc_name) {
+        my $name = "$enc_name{$in} input, $enc_name{$out} output";
+        my $mrg = Sereal::Merger->new({ compress => $out });
+        $mrg->append($_) for @encoded;
+        $mrg->append($enc->encode("x" x 10_000));
+
+        my $merged = $mrg->finish;
+        my $encoding = ord(substr($merged, 4, 1)) >> 4;
+        is($encoding, $out ? $out + 1 : 0, "$name: output has expected encoding");
+        is_deeply(decode_sereal($merged), [ @docs, "x" x 10_000 ], "$name: roundtrip");
+    }
+}
+
+# user header survives compression
+{
+    my $enc = Sereal::Encoder->new;
+    my $mrg = Sereal::Merger->new({ compress => SRL_ZSTD });
+    $mrg->append($enc->encode($_)) for @docs;
+    my $merged = $mrg->finish($enc->encode("header"));
+
+    my $dec = Sereal::Decoder->new;
+    my ($header, $body);
+    $dec->decode_with_header($merged, $body, $header);
+    is($header, "header", "zstd output: user header");
+    is_deeply($body, \@docs, "zstd output: body with user header");
+}
+
+foreach my $level (1, 19) {
+    my $mrg = Sereal::Merger->new({ compress => SRL_ZSTD, compress_level => $level });
+    $mrg->append(Sereal::Encoder->new->encode($_)) for @docs;
+    is_deeply(decode_sereal($mrg->finish), \@docs, "zstd output at level $level");
+}
+
+ok(!eval { Sereal::Merger->new({ compress => SRL_ZSTD, compress_level => 23 }); 1 },
+   "zstd compress_level out of range");
+like($@, qr/between 1 and \d+/, "zstd compress_level range comes from the library");
+ok(!eval { Sereal::Merger->new({ compress => SRL_ZLIB, compress_level => 11 }); 1 },
+   "zlib compress_level out of range");
+ok(!eval { Sereal::Merger->new({ compress => SRL_ZSTD, protocol_version => 2 }); 1 },
+   "zstd needs protocol version 3");
+ok(!eval { Sereal::Merger->new({ compress => 4 }); 1 },
+   "unknown compression format");
+
+# a broken zstd input doesn't spoil what was merged before
+{
+    my $enc = Sereal::Encoder->new({ compress => SRL_ZSTD, compress_threshold => 0 });
+    my $good = $enc->encode(\@docs);
+    my $bad = $good;
+    substr($bad, -10, 5, "\0" x 5);
+
+    my $mrg = Sereal::Merger->new({ compress => SRL_ZSTD });
+    $mrg->append($good);
+    ok(!eval { $mrg->append($bad); 1 }, "corrupted zstd input croaks");
+    $mrg->append($good);
+    is_deeply(decode_sereal($mrg->finish), [ \@docs, \@docs ], "merger usable after bad zstd input");
+}
+
+done_testing();
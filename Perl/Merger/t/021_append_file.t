@@ -0,0 +1,128 @@
+#!perl
+use strict;
+use warnings;
+use Sereal::Merger qw(:all);
+use Sereal::Encoder;
+use Sereal::Decoder qw(decode_sereal);
+use File::Temp qw(tempdir);
+use File::Spec;
+use Test::More;
+
+my $dir = tempdir(CLEANUP => 1);
+my $enc = Sereal::Encoder->new;
+
+my @docs = map { { id => $_, name => "item $_" x 10, list => [ (1.5) x 20 ] } } 1 .. 50;
+my @paths;
+foreach my $i (0 .. $#docs) {
+    my $path = File::Spec->catfile($dir, "doc$i.srl");
+    write_file($path, $enc->encode($docs[$i]));
+    push @paths, $path;
+}
+
+{
+    my $mrg = Sereal::Merger->new;
+    $mrg->append_file($_) for @paths;
+    is_deeply(decode_sereal($mrg->finish), \@docs, "append_file");
+}
+
+{
+    my $mrg = Sereal::Merger->new;
+    $mrg->append_files(\@paths);
+    is($mrg->elements_merged, scalar @docs, "append_files: elements_merged");
+
+    my $mrg2 = Sereal::Merger->new;
+    $mrg2->append_all([ map { $enc->encode($_) } @docs ]);
+    is($mrg->finish, $mrg2->finish, "append_files and append_all produce the same output");
+}
+
+# broken files croak, but what was merged before stays intact
+{
+    my $truncated = File::Spec->catfile($dir, "truncated.srl");
+    my $data = $enc->encode(\@docs);
+    write_file($truncated, substr($data, 0, length($data) - 10));
+    my $empty = File::Spec->catfile($dir, "empty.srl");
+    write_file($empty, "");
+
+    my $mrg = Sereal::Merger->new;
+    ok(!eval { $mrg->append_files([ @paths[0 .. 1], $truncated, $paths[2] ]); 1 },
+       "truncated file croaks");
+    is($mrg->elements_merged, 2, "elements_merged after truncated file");
+    ok(!eval { $mrg->append_file($empty); 1 }, "empty file croaks");
+    ok(!eval { $mrg->append_file(File::Spec->catfile($dir, "nonexistent.srl")); 1 },
+       "missing file croaks");
+    like($@, qr/Failed to open/, "missing file error message");
+    $mrg->append_file($paths[3]);
+    is_deeply(decode_sereal($mrg->finish), [ @docs[0 .. 1], $docs[3] ], "merger usable after bad files");
+}
+
+# streaming output
+foreach my $top (SRL_TOP_LEVEL_ARRAY, SRL_TOP_LEVEL_SCALAR) {
+    foreach my $threshold (0, 100, 1_000_000) {
+        my $name = ($top == SRL_TOP_LEVEL_ARRAY ? "array" : "scalar") . ", threshold $threshold";
+        my $out = File::Spec->catfile($dir, "out.srl");
+        open my $fh, '+>', $out or die "Can't open $out: $!";
+        binmode $fh;
+        print $fh "prefix";
+
+        my $mrg = Sereal::Merger->new({
+            top_level_element => $top,
+            stream_to         => $fh,
+            stream_threshold  => $threshold,
+        });
+        my $expected = Sereal::Merger->new({ top_level_element => $top });
+
+        my @in = map { $enc->encode($_) } @docs;
+        $in[10] = $enc->encode([ \@docs, \@docs ]); # refs to earlier items
+        $expected->append_all(\@in);
+        $mrg->append_all([ @in[0 .. 19] ]);
+        ok(!eval { $mrg->append(substr($in[20], 0, -3)); 1 }, "$name: truncated document croaks");
+        $mrg->append_files([ @paths[20 .. 29] ]);
+        $mrg->append($_) for @in[30 .. $#in];
+
+        my $written = $mrg->finish;
+        close $fh;
+
+        my $merged = read_file($out);
+        is(substr($merged, 0, 6, ""), "prefix", "$name: data before the document kept");
+        is($written, length($merged), "$name: finish returns the number of bytes written");
+        my $want = $expected->finish;
+        is($merged, $want, "$name: same as merging in memory");
+    }
+}
+
+{
+    open my $fh, '>', File::Spec->catfile($dir, "x.srl") or die $!;
+    ok(!eval { Sereal::Merger->new({ stream_to => $fh, dedupe_strings => 1 }); 1 },
+       "stream_to and dedupe_strings");
+    ok(!eval { Sereal::Merger->new({ stream_to => $fh, compress => SRL_SNAPPY }); 1 },
+       "stream_to and compress");
+    ok(!eval { Sereal::Merger->new({ stream_to => $fh, protocol_version => 1 }); 1 },
+       "stream_to and protocol version 1");
+    ok(!eval { Sereal::Merger->new({ stream_to => $fh, top_level_element => SRL_TOP_LEVEL_HASH }); 1 },
+       "stream_to and top level hash");
+
+    my $mrg = Sereal::Merger->new({ stream_to => $fh });
+    $mrg->append($enc->encode(1));
+    ok(!eval { $mrg->finish($enc->encode("header")); 1 }, "stream_to and user header");
+
+    open my $in, '<', $paths[0] or die $!;
+    ok(!eval { Sereal::Merger->new({ stream_to => $in }); 1 }, "stream_to not opened for writing");
+}
+
+done_testing();
+
+sub write_file {
+    my ($path, $data) = @_;
+    open my $fh, '>', $path or die "Can't open $path: $!";
+    binmode $fh;
+    print $fh $data;
+    close $fh or die "Can't close $path: $!";
+}
+
+sub read_file {
+    my ($path) = @_;
+    open my $fh, '<', $path or die "Can't open $path: $!";
+    binmode $fh;
+    local $/;
+    return scalar <$fh>;
+}
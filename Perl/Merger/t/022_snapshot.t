@@ -0,0 +1,65 @@
+#!perl
+use strict;
+use warnings;
+use Sereal::Merger qw(:all);
+use Sereal::Encoder;
+use Sereal::Decoder qw(decode_sereal);
+use Test::More;
+
+my $enc = Sereal::Encoder->new;
+my @docs = map { { id => $_, name => "item " . ($_ % 7), list => [ ($_) x 5 ] } } 1 .. 100;
+my @encoded = map { $enc->encode($_) } @docs;
+
+foreach my $opt (
+    {},
+    { dedupe_strings => 1 },
+    { compress => SRL_SNAPPY },
+    { compress => SRL_ZSTD, dedupe_strings => 1 },
+) {
+    my $name = join(", ", map { "$_ => $opt->{$_}" } sort keys %$opt) || "defaults";
+    my $mrg = Sereal::Merger->new($opt);
+    my $ref = Sereal::Merger->new($opt);
+    my @in = @encoded;
+
+    is_deeply(decode_sereal($mrg->snapshot), [], "$name: empty snapshot");
+
+    foreach my $n (10, 11, 50, 100) {
+        $mrg->append($_) for @in[$mrg->elements_merged .. $n - 1];
+        is_deeply(decode_sereal($mrg->snapshot), [ @docs[0 .. $n - 1] ], "$name: snapshot after $n documents");
+    }
+
+    $ref->append_all(\@in);
+    is($mrg->snapshot, $ref->finish, "$name: snapshot is the same as finish");
+    is($mrg->snapshot, $mrg->finish, "$name: finish after snapshots");
+}
+
+# a broken document doesn't end up in the snapshot
+{
+    my $mrg = Sereal::Merger->new({ dedupe_strings => 1 });
+    $mrg->append_all([ @encoded[0 .. 9] ]);
+    ok(!eval { $mrg->append(substr($encoded[10], 0, -5)); 1 }, "truncated document croaks");
+    is_deeply(decode_sereal($mrg->snapshot), [ @docs[0 .. 9] ], "snapshot after broken document");
+    $mrg->append_all([ @encoded[10 .. 19] ]);
+    is_deeply(decode_sereal($mrg->snapshot), [ @docs[0 .. 19] ], "merging goes on after snapshot");
+}
+
+# user header
+{
+    my $mrg = Sereal::Merger->new;
+    $mrg->append_all(\@encoded);
+    my $big = "x" x 5000;
+    foreach my $header ("header", $big) {
+        my ($got_header, $body);
+        Sereal::Decoder->new->decode_with_header($mrg->snapshot($enc->encode($header)), $body, $got_header);
+        is($got_header, $header, "snapshot with user header of " . length($header) . " bytes");
+        is_deeply($body, \@docs, "body of snapshot with user header of " . length($header) . " bytes");
+    }
+}
+
+ok(!eval { Sereal::Merger->new({ protocol_version => 1 })->snapshot; 1 }, "no snapshots for protocol version 1");
+{
+    open my $fh, '+>', undef or die $!;
+    ok(!eval { Sereal::Merger->new({ stream_to => $fh })->snapshot; 1 }, "no snapshots with stream_to");
+}
+
+done_testing();
@@ -0,0 +1,57 @@
+#!perl
+use strict;
+use warnings;
+use Sereal::Merger qw(:all);
+use Sereal::Encoder;
+use Sereal::Decoder;
+use Test::More;
+
+my $enc = Sereal::Encoder->new;
+my $dec = Sereal::Decoder->new;
+my @docs = map { { id => $_, name => "item $_" } } 1 .. 20;
+
+sub check {
+    my ($merged, $header, $name) = @_;
+    my ($got_header, $body);
+    $dec->decode_with_header($merged, $body, $got_header);
+    is_deeply($got_header, $header, "$name: header");
+    is_deeply($body, \@docs, "$name: body");
+}
+
+foreach my $opt (
+    {},
+    { expected_header_size => 0 },
+    { expected_header_size => 200 },
+    { dedupe_strings => 1 },
+    { compress => SRL_ZSTD },
+) {
+    my $opt_name = join(", ", map { "$_ => $opt->{$_}" } sort keys %$opt) || "defaults";
+    foreach my $size (1, 150, 1000, 1020, 5000, 200_000) {
+        my $header = { routing => "x" x $size };
+        my $mrg = Sereal::Merger->new($opt);
+        $mrg->append($enc->encode($_)) for @docs;
+        check($mrg->finish($enc->encode($header)), $header, "$opt_name, user header of $size bytes");
+    }
+}
+
+# header space stays valid after growing it
+{
+    my $mrg = Sereal::Merger->new({ expected_header_size => 10, dedupe_strings => 1 });
+    $mrg->append($enc->encode($_)) for @docs[0 .. 9];
+    my $header = [ ("routing") x 1000 ];
+    $mrg->finish($enc->encode($header));
+    $mrg->append($enc->encode($_)) for @docs[10 .. 19];
+    check($mrg->finish($enc->encode($header)), $header, "header space grown after appends");
+}
+
+# the whole user header fits in expected_header_size
+{
+    my $header = { routing => "x" x 300 };
+    my $encoded_header = $enc->encode($header);
+    my $mrg = Sereal::Merger->new({ expected_header_size => length($encoded_header) });
+    $mrg->append($enc->encode($_)) for @docs;
+    check($mrg->finish($encoded_header), $header, "user header of expected_header_size");
+    check($mrg->finish, undef, "finish again without user header");
+}
+
+done_testing();
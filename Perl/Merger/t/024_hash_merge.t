@@ -0,0 +1,187 @@
+#!perl
+use strict;
+use warnings;
+use Sereal::Merger qw(:all);
+use Sereal::Encoder;
+use Sereal::Decoder qw(decode_sereal);
+use Scalar::Util qw(refaddr);
+use Test::More;
+
+my $enc = Sereal::Encoder->new;
+my $enc_dedupe = Sereal::Encoder->new({ dedupe_strings => 1 });
+
+# shards of { key => record } with overlapping keys. Records share hash keys
+# and strings, so later records refer back to earlier ones with COPY tags,
+# which also happens across keys which get dropped.
+my @shards;
+foreach my $shard (0 .. 9) {
+    my %data;
+    foreach my $i ($shard * 7 .. $shard * 7 + 14) {
+        $data{"key_$i"} = {
+            id      => $i,
+            shard   => $shard,
+            type    => "record type " . ($i % 3),
+            tags    => [ "common tag", "tag " . ($i % 4) ],
+            object  => bless({ i => $i }, "Some::Class::" . ($i % 2)),
+        };
+    }
+    push @shards, \%data;
+}
+
+sub merge_expected {
+    my ($policy, @docs) = @_;
+    my %h;
+    foreach my $doc (@docs) {
+        foreach my $key (keys %$doc) {
+            $h{$key} = $doc->{$key} if $policy == SRL_LAST_WINS || !exists $h{$key};
+        }
+    }
+    return \%h;
+}
+
+my %policy_name = (SRL_FIRST_WINS, "first wins", SRL_LAST_WINS, "last wins");
+
+foreach my $policy (SRL_FIRST_WINS, SRL_LAST_WINS) {
+    foreach my $opt ({}, { dedupe_strings => 1 }, { compress => SRL_ZSTD }, { protocol_version => 2 }) {
+        foreach my $encoder ($enc, $enc_dedupe) {
+            my $name = join ", ", $policy_name{$policy},
+                       (map { "$_ => $opt->{$_}" } sort keys %$opt),
+                       ($encoder == $enc ? () : "dedupe input");
+
+            my $mrg = Sereal::Merger->new({
+                %$opt,
+                top_level_element => SRL_TOP_LEVEL_HASH,
+                duplicate_keys    => $policy,
+            });
+            $mrg->append($encoder->encode($_)) for @shards;
+            is($mrg->elements_merged, scalar @shards, "$name: elements_merged");
+            is_deeply(decode_sereal($mrg->finish), merge_expected($policy, @shards), "$name: merged");
+        }
+    }
+}
+
+is_deeply(
+    decode_sereal(do {
+        my $mrg = Sereal::Merger->new({ top_level_element => SRL_TOP_LEVEL_HASH });
+        $mrg->append_all([ map { $enc->encode($_) } @shards ]);
+        $mrg->finish;
+    }),
+    merge_expected(SRL_LAST_WINS, @shards),
+    "last wins by default"
+);
+
+# values which are referred to from later values of the same document
+{
+    my $shared = { name => "shared value" };
+    my $shared_string = "a string which is long enough to be deduplicated";
+    my @docs = (
+        { b => 1, d => 2 },
+        { a => $shared, b => $shared, c => [ $shared ], d => $shared_string, e => $shared_string },
+        { a => 3, c => 4, e => 5 },
+    );
+
+    foreach my $policy (SRL_FIRST_WINS, SRL_LAST_WINS) {
+        my $mrg = Sereal::Merger->new({
+            top_level_element => SRL_TOP_LEVEL_HASH,
+            duplicate_keys    => $policy,
+            dedupe_strings    => 1,
+        });
+        $mrg->append($enc_dedupe->encode($_)) for @docs;
+        my $got = decode_sereal($mrg->finish);
+        is_deeply($got, merge_expected($policy, @docs), "$policy_name{$policy}: references to dropped values");
+
+        if ($policy == SRL_FIRST_WINS) {
+            is(refaddr($got->{a}), refaddr($got->{c}[0]), "$policy_name{$policy}: shared reference kept");
+        }
+    }
+}
+
+# a broken document doesn't leave its keys behind
+foreach my $policy (SRL_FIRST_WINS, SRL_LAST_WINS) {
+    my $mrg = Sereal::Merger->new({
+        top_level_element => SRL_TOP_LEVEL_HASH,
+        duplicate_keys    => $policy,
+    });
+    my $bad = $enc->encode($shards[1]);
+    substr($bad, -10) = "";
+
+    $mrg->append($enc->encode($shards[0]));
+    ok(!eval { $mrg->append($bad); 1 }, "$policy_name{$policy}: truncated document croaks");
+    ok(!eval { $mrg->append($enc->encode([ 1, 2 ])); 1 }, "$policy_name{$policy}: array croaks");
+    like($@, qr/while expecting a hash/, "$policy_name{$policy}: array error message");
+    $mrg->append($enc->encode($shards[2]));
+    is_deeply(decode_sereal($mrg->finish), merge_expected($policy, @shards[0, 2]),
+              "$policy_name{$policy}: merger usable after broken documents");
+}
+
+# snapshots and appending after finish
+foreach my $policy (SRL_FIRST_WINS, SRL_LAST_WINS) {
+    my $mrg = Sereal::Merger->new({
+        top_level_element => SRL_TOP_LEVEL_HASH,
+        duplicate_keys    => $policy,
+        dedupe_strings    => 1,
+    });
+    $mrg->append($enc->encode($_)) for @shards[0 .. 3];
+    is_deeply(decode_sereal($mrg->snapshot), merge_expected($policy, @shards[0 .. 3]),
+              "$policy_name{$policy}: snapshot");
+
+    $mrg->append($enc->encode($_)) for @shards[4 .. 6];
+    is_deeply(decode_sereal($mrg->finish($enc->encode("header"))), merge_expected($policy, @shards[0 .. 6]),
+              "$policy_name{$policy}: finish after snapshot");
+
+    $mrg->append($enc->encode($_)) for @shards[7 .. 9];
+    is_deeply(decode_sereal($mrg->finish), merge_expected($policy, @shards),
+              "$policy_name{$policy}: finish again");
+}
+
+{
+    my %h = (a => 1);
+    $h{self} = \%h;
+    my $mrg = Sereal::Merger->new({ top_level_element => SRL_TOP_LEVEL_HASH });
+    ok(!eval { $mrg->append($enc->encode(\%h)); 1 }, "hash referenced from inside croaks");
+
+    my $empty = Sereal::Merger->new({ top_level_element => SRL_TOP_LEVEL_HASH });
+    $empty->append($enc->encode({}));
+    is_deeply(decode_sereal($empty->finish), {}, "empty hashes");
+
+    ok(!eval { Sereal::Merger->new({ top_level_element => SRL_TOP_LEVEL_HASH, duplicate_keys => 2 }); 1 },
+       "invalid duplicate_keys");
+}
+
+# the same key encoded as a byte string in one document and as UTF-8
+# in another, values refer back to the key of their document
+{
+    my @keys = ("foo", "caf\xe9", "a key which is longer than 31 bytes", "wide \x{263a}");
+    my (@bytes, @upgraded);
+    foreach my $key (@keys) {
+        my $u = $key;
+        utf8::upgrade($u);
+        push @bytes, $key;
+        push @upgraded, $u;
+    }
+
+    foreach my $policy (SRL_FIRST_WINS, SRL_LAST_WINS) {
+        my $mrg = Sereal::Merger->new({
+            top_level_element => SRL_TOP_LEVEL_HASH,
+            duplicate_keys    => $policy,
+        });
+        $mrg->append($enc_dedupe->encode({ map { $_ => [ 1, $_ ] } @bytes }));
+        $mrg->append($enc_dedupe->encode({ map { $_ => [ 2, $_ ] } @upgraded }));
+
+        my $name = $policy_name{$policy};
+        my $got = eval { decode_sereal($mrg->finish) };
+        ok($got, "$name: UTF-8 and byte string keys decode") or diag $@;
+        is(scalar keys %$got, scalar @keys, "$name: UTF-8 and byte string keys are merged");
+
+        my $which = $policy == SRL_FIRST_WINS ? 1 : 2;
+        foreach my $i (0 .. $#keys) {
+            my $v = $got->{$keys[$i]};
+            is($v->[0], $which, "$name: value of key $i");
+            is($v->[1], $keys[$i], "$name: string referring to key $i");
+            is(utf8::is_utf8($v->[1]) ? 1 : 0, utf8::is_utf8($which == 1 ? $bytes[$i] : $upgraded[$i]) ? 1 : 0,
+               "$name: string referring to key $i keeps its encoding");
+        }
+    }
+}
+
+done_testing();
@@ -53,6 +53,27 @@ disjoin(iter)
   CODE:
     srl_iterator_disjoin(aTHX_ iter);
 
+void
+build_index(iter)
+    srl_iterator_t *iter;
+  CODE:
+    srl_iterator_build_index(aTHX_ iter);
+
+SV *
+dump_index(iter)
+    srl_iterator_t *iter;
+  CODE:
+    RETVAL = srl_iterator_dump_index(aTHX_ iter);
+    SvREFCNT_inc(RETVAL);
+  OUTPUT: RETVAL
+
+void
+load_index(iter, src)
+    srl_iterator_t *iter;
+    SV *src;
+  CODE:
+    srl_iterator_load_index(aTHX_ iter, src);
+
 UV
 eof(iter)
     srl_iterator_t *iter;
@@ -97,6 +97,24 @@ Sereal document as first argument and uses C<set> to set it.
 
   my $spi = Sereal::Path::Iterator->new(encode_sereal({}));
 
+The second optional argument is a hash reference with options:
+
+=over 4
+
+=item index
+
+If true, a structural index (see L</build_index>) is built on first call to
+C<next>, C<step_out> or C<array_goto>, and on first call after each C<set>.
+
+=item index_min_span
+
+Containers shorter than this number of bytes are not put into the index.
+Skipping over them is cheap anyway and the index is kept small. Default is 64.
+
+=back
+
+  my $spi = Sereal::Path::Iterator->new($data, { index => 1 });
+
 =head2 set
 
 As alternative to passing serialized document to C<new> you can call this
@@ -108,6 +126,11 @@ function to achieve same result.
 The current position is set to be very first top level element of parse
 document.
 
+The decompressed body of the last compressed document is kept by the
+iterator. Setting the same compressed document again (for example once per
+query) reuses it, together with the index, instead of decompressing the
+document again. Decompression contexts are reused between documents too.
+
 =head2 reset
 
 This method resets iterator's internal state. The result will be equal to
@@ -268,6 +291,9 @@ depth. If such element exists, the function moves current position to given
 index. C<array_goto> rewinds stack if necessary. The function croaks if given
 index is outside of array boundaries.
 
+With an index (see L</build_index>) C<array_goto> does one jump per skipped
+element instead of walking their content.
+
 =head2 array_exists
 
 C<array_exists> returns non-negative value if given index exists and -1
@@ -278,8 +304,12 @@ otherwise.
 C<hash_exists> returns non-negative value if given hash key exists and -1
 otherwise. If key exists, the functions stops at key's value.
 
-Note that C<hash_exists> does search by linearly scanning entire hash until
-either key is found or end of hash is reached. It's an O(n) operation.
+The first lookup in a hash linearly scans the hash until either key is found
+or end of hash is reached. It's an O(n) operation. Starting with the second
+lookup in the same hash, scanned keys are remembered in the iterator's cache
+together with offsets of their values. Keys which were already scanned are
+then found in O(1), for others scanning continues where it stopped, so each
+key is scanned only once. The cache is dropped by C<set>.
 
 =head2 hash_key
 
@@ -300,6 +330,36 @@ C<stack_length> returns total amount of elements at current depth. Please note
 that value returned by this function does not always match with length returned
 by C<info>. In particular, length for hashes will be twice bigger.
 
+=head2 build_index
+
+Walks the whole document once and records, for every array and hash, where
+its content ends. Afterwards C<next>, C<step_out> and C<array_goto> jump over
+indexed containers instead of walking every nested element. This pays off
+when the same document is navigated many times, e.g. by L<Sereal::Path::Tie>
+or repeated L<Sereal::Path> queries on one iterator.
+
+The index belongs to the current document and is dropped by C<set>. Current
+position is not changed.
+
+=head2 dump_index
+
+Returns the index as a binary string, building it first if necessary. A
+producer can ship the string along with the document so that consumers don't
+have to walk the document to get an index.
+
+  my $index = Sereal::Path::Iterator->new($data)->dump_index();
+
+=head2 load_index
+
+Loads an index returned by C<dump_index> for the current document. The
+function croaks if the string isn't a valid index or if it was built for a
+body of different length. Note that the index is not verified against the
+document itself: loading an index of another document of exactly the same
+length results in wrong navigation.
+
+  my $spi = Sereal::Path::Iterator->new($data);
+  $spi->load_index($index);
+
 =head2 decode
 
 C<decode> decodes object at current position. Also check L<KNOWN ISSUES>.
@@ -83,6 +83,21 @@ extern "C" {
 #define SRL_ITER_STACK_ROOT_TAG SRL_HDR_PACKET_START
 #define SRL_ITER_STACK_ON_ROOT(stack) ((stack)->ptr->tag == SRL_ITER_STACK_ROOT_TAG)
 
+#define SRL_ITER_INDEX_MIN_SPAN (64)
+#define SRL_ITER_INDEX_MAGIC "=sri"
+#define SRL_ITER_INDEX_MAGIC_LEN (sizeof(SRL_ITER_INDEX_MAGIC) - 1)
+#define SRL_ITER_INDEX_VERSION (1)
+#define SRL_ITER_INDEX_LENGTH(index) (SvCUR(index) / sizeof(srl_iterator_index_entry_t))
+#define SRL_ITER_INDEX_ENTRIES(index) ((srl_iterator_index_entry_t *) SvPVX(index))
+#define SRL_ITER_INDEX_BODY_LENGTH(iter) ((UV) ((iter)->buf.end - (iter)->buf.body_pos))
+
+/* slots of per-hash key index stored in iter->cache */
+#define SRL_ITER_HASH_INDEX_KEYS    0   /* key => number of key/value pair */
+#define SRL_ITER_HASH_INDEX_VALUES  1   /* array of value offsets of scanned pairs */
+#define SRL_ITER_HASH_INDEX_LENGTH  2   /* stack's length of the hash */
+#define SRL_ITER_HASH_INDEX_END     3   /* offset after last element, 0 until all pairs are scanned */
+#define SRL_ITER_HASH_INDEX_SIZE    4
+
 #define SRL_ITER_BASE_ERROR_FORMAT              "Sereal::Path::Iterator: Error in %s:%u "
 #define SRL_ITER_BASE_ERROR_ARGS                __FILE__, __LINE__
 
@@ -161,6 +176,11 @@ extern "C" {
     }                                                                               \
 } STMT_END
 
+#define SRL_ITER_ENSURE_INDEX(iter) STMT_START {                                    \
+    if (expect_false((iter)->want_index && (iter)->index == NULL))                  \
+        srl_iterator_build_index(aTHX_ (iter));                                     \
+} STMT_END
+
 #define SRL_ITER_ASSERT_STACK(iter) STMT_START {                                    \
     assert(!srl_stack_empty((iter)->pstack));                                       \
     if (expect_false((iter)->stack.ptr->idx >= (iter)->stack.ptr->length)) {        \
@@ -205,6 +225,8 @@ SRL_STATIC_INLINE void srl_iterator_read_object(pTHX_ srl_iterator_t *iter, int
 SRL_STATIC_INLINE void srl_iterator_read_refn(pTHX_ srl_iterator_t *iter, U8 *tag_out, UV *length_out);
 SRL_STATIC_INLINE UV   srl_iterator_read_refp(pTHX_ srl_iterator_t *iter, U8 *tag_out, UV *length_out);
 SRL_STATIC_INLINE UV   srl_iterator_read_alias(pTHX_ srl_iterator_t *iter, int *is_ref_out, U8 *tag_out, UV *length_out);
+SRL_STATIC_INLINE srl_iterator_index_entry_t *srl_iterator_index_lookup(pTHX_ srl_iterator_t *iter, UV first, UV count);
+SRL_STATIC_INLINE int  srl_iterator_index_skip(pTHX_ srl_iterator_t *iter, UV length);
 
 /* wrappers */
 UV srl_iterator_eof(pTHX_ srl_iterator_t *iter)     { return SRL_RDR_DONE(iter->pbuf) ? 1 : 0; }
@@ -244,12 +266,25 @@ srl_init_iterator(pTHX_ srl_iterator_t *iter, HV *opt)
     iter->pstack = &iter->stack;
     iter->document = NULL;
     iter->dec = NULL;
+    iter->index = NULL;
+    iter->cache = NULL;
+    iter->index_min_span = SRL_ITER_INDEX_MIN_SPAN;
+    iter->want_index = 0;
+    iter->compressed = NULL;
+    iter->zstd_dctx = NULL;
+    iter->zlib_stream = NULL;
 
     /* load options */
     if (opt != NULL) {
-        /* svp = hv_fetchs(opt, "dedupe_strings", 0);
+        SV **svp;
+
+        svp = hv_fetchs(opt, "index", 0);
         if (svp && SvTRUE(*svp))
-            SRL_iter_SET_OPTION(iter, SRL_F_DEDUPE_STRINGS); */
+            iter->want_index = 1;
+
+        svp = hv_fetchs(opt, "index_min_span", 0);
+        if (svp && SvOK(*svp))
+            iter->index_min_span = SvUV(*svp);
     }
 }
 
@@ -273,6 +308,21 @@ srl_shallow_copy_iterator(pTHX_ srl_iterator_t *from, srl_iterator_t *to)
     to->pbuf = &to->buf;
     to->dec = NULL;
 
+    /* index describes the document, so it's shared as well */
+    to->index = from->index;
+    if (to->index) SvREFCNT_inc(to->index);
+    to->cache = from->cache;
+    if (to->cache) SvREFCNT_inc((SV *) to->cache);
+    to->index_min_span = from->index_min_span;
+    to->want_index = from->want_index;
+
+    /* so is decompressed body, but not decompression contexts */
+    to->compressed = from->compressed;
+    if (to->compressed) SvREFCNT_inc(to->compressed);
+    Copy(&from->body_buf, &to->body_buf, 1, srl_reader_buffer_t);
+    to->zstd_dctx = NULL;
+    to->zlib_stream = NULL;
+
     assert(to->buf.pos == from->buf.pos);
 }
 
@@ -287,6 +337,23 @@ srl_deinit_iterator(pTHX_ srl_iterator_t *iter)
     if (iter->document)
         SvREFCNT_dec(iter->document);
 
+    if (iter->index)
+        SvREFCNT_dec(iter->index);
+
+    if (iter->cache)
+        SvREFCNT_dec((SV *) iter->cache);
+
+    if (iter->compressed)
+        SvREFCNT_dec(iter->compressed);
+
+    if (iter->zstd_dctx)
+        ZSTD_freeDCtx(iter->zstd_dctx);
+
+    if (iter->zlib_stream) {
+        mz_inflateEnd(iter->zlib_stream);
+        Safefree(iter->zlib_stream);
+    }
+
     srl_stack_deinit(aTHX_ &iter->stack);
 }
 
@@ -297,10 +364,40 @@ srl_destroy_iterator(pTHX_ srl_iterator_t *iter)
     Safefree(iter);
 }
 
+/* Decompression contexts are allocated on first use and reused for all
+ * following documents of the same kind */
+SRL_STATIC_INLINE ZSTD_DCtx *
+srl_iterator_zstd_dctx(pTHX_ srl_iterator_t *iter)
+{
+    if (expect_false(iter->zstd_dctx == NULL)) {
+        iter->zstd_dctx = ZSTD_createDCtx();
+        if (iter->zstd_dctx == NULL) croak("Out of memory");
+    }
+
+    return iter->zstd_dctx;
+}
+
+SRL_STATIC_INLINE mz_streamp
+srl_iterator_zlib_stream(pTHX_ srl_iterator_t *iter)
+{
+    if (expect_false(iter->zlib_stream == NULL)) {
+        mz_streamp strm;
+        Newxz(strm, 1, mz_stream);
+        if (mz_inflateInit(strm) != Z_OK) {
+            Safefree(strm);
+            croak("Failed to initialize zlib inflate stream");
+        }
+
+        iter->zlib_stream = strm;
+    }
+
+    return iter->zlib_stream;
+}
+
 void
 srl_iterator_set(pTHX_ srl_iterator_t *iter, SV *src)
 {
-    SV *sv;
+    SV *sv = NULL;
     STRLEN len;
     UV header_len;
     U8 encoding_flags;
@@ -309,15 +406,45 @@ srl_iterator_set(pTHX_ srl_iterator_t *iter, SV *src)
     IV proto_version_and_encoding_flags_int;
     srl_iterator_stack_ptr stack_ptr = NULL;
 
+    tmp = (srl_reader_char_ptr) SvPV(src, len);
+
+    /* Same compressed document as last time. Its body is still around,
+     * so are index and per-hash key indexes, reuse them all */
+    if (   iter->compressed
+        && SvCUR(iter->compressed) == len
+        && memcmp(SvPVX(iter->compressed), tmp, len) == 0)
+    {
+        SRL_ITER_TRACE("reuse decompressed body");
+        Copy(&iter->body_buf, &iter->buf, 1, srl_reader_buffer_t);
+        srl_stack_clear(iter->pstack);
+        srl_stack_push_and_set(iter, SRL_ITER_STACK_ROOT_TAG, 1, stack_ptr);
+        srl_iterator_reset(aTHX_ iter);
+        return;
+    }
+
     if (iter->document) {
         SvREFCNT_dec(iter->document);
         iter->document = NULL;
     }
 
+    if (iter->index) {
+        SvREFCNT_dec(iter->index);
+        iter->index = NULL;
+    }
+
+    if (iter->cache) {
+        SvREFCNT_dec((SV *) iter->cache);
+        iter->cache = NULL;
+    }
+
+    if (iter->compressed) {
+        SvREFCNT_dec(iter->compressed);
+        iter->compressed = NULL;
+    }
+
     iter->document = src;
     SvREFCNT_inc(iter->document);
 
-    tmp = (srl_reader_char_ptr) SvPV(src, len);
     iter->buf.start = iter->buf.pos = tmp;
     iter->buf.end = iter->buf.start + len;
 
@@ -352,12 +479,12 @@ srl_iterator_set(pTHX_ srl_iterator_t *iter, SV *src)
         SvREFCNT_inc(sv);
         iter->document = sv;
     } else if (encoding_flags == SRL_PROTOCOL_ENCODING_ZLIB) {
-        srl_decompress_body_zlib(aTHX_ iter->pbuf, &sv);
+        srl_decompress_body_zlib(aTHX_ iter->pbuf, srl_iterator_zlib_stream(aTHX_ iter), &sv);
         SvREFCNT_dec(iter->document);
         SvREFCNT_inc(sv);
         iter->document = sv;
     } else if (encoding_flags == SRL_PROTOCOL_ENCODING_ZSTD) {
-        srl_decompress_body_zstd(aTHX_ iter->pbuf, &sv);
+        srl_decompress_body_zstd(aTHX_ iter->pbuf, srl_iterator_zstd_dctx(aTHX_ iter), &sv);
         SvREFCNT_dec(iter->document);
         SvREFCNT_inc(sv);
         iter->document = sv;
@@ -369,6 +496,15 @@ srl_iterator_set(pTHX_ srl_iterator_t *iter, SV *src)
     SRL_RDR_UPDATE_BODY_POS(iter->pbuf, protocol_version);
     DEBUG_ASSERT_RDR_SANE(iter->pbuf);
 
+    if (encoding_flags != SRL_PROTOCOL_ENCODING_RAW) {
+        /* remember what was decompressed, src can be modified in place
+         * later, so keep a copy of it rather than a reference */
+        iter->compressed = newSVpvn((const char *) tmp, len);
+        Copy(&iter->buf, &iter->body_buf, 1, srl_reader_buffer_t);
+    }
+
+    /* drop frames left from previous document */
+    srl_stack_clear(iter->pstack);
     srl_stack_push_and_set(iter, SRL_ITER_STACK_ROOT_TAG, 1, stack_ptr);
     srl_iterator_reset(aTHX_ iter);
 }
@@ -524,7 +660,7 @@ srl_iterator_step_in(pTHX_ srl_iterator_t *iter, UV n)
                         goto read_again;
 
                     case SRL_HDR_PAD:
-                        while (SRL_RDR_NOT_DONE(iter->pbuf) && *iter->buf.pos++ == SRL_HDR_PAD) {};
+                        while (SRL_RDR_NOT_DONE(iter->pbuf) && *iter->buf.pos == SRL_HDR_PAD) iter->buf.pos++;
                         goto read_again;
 
                     case SRL_HDR_BINARY:
@@ -618,13 +754,27 @@ srl_iterator_step_out(pTHX_ srl_iterator_t *iter, UV n)
         SRL_ITER_ERRORf1("Can't do %"UVuf" steps out", n);
     }
 
+    SRL_ITER_ENSURE_INDEX(iter);
+
     while (iter->stack.depth > expected_depth) {
+        srl_iterator_index_entry_t *entry = NULL;
         stack_ptr = iter->stack.ptr;
         if (expect_false(stack_ptr->tag == SRL_ITER_STACK_ROOT_TAG)) {
             SRL_ITER_ERROR("Root of the stack is reached");
         }
 
-        srl_iterator_next(aTHX_ iter, stack_ptr->length - stack_ptr->idx);
+        if (iter->index)
+            entry = srl_iterator_index_lookup(aTHX_ iter, stack_ptr->first, stack_ptr->length);
+
+        if (entry) {
+            /* jump straight to the end of current container */
+            iter->buf.pos = iter->buf.body_pos + entry->end;
+            stack_ptr->idx = stack_ptr->length;
+            SRL_ITER_TRACE_WITH_POSITION("index jump to end of stack");
+        } else {
+            srl_iterator_next(aTHX_ iter, stack_ptr->length - stack_ptr->idx);
+        }
+
         assert(stack_ptr->idx == stack_ptr->length);
         srl_iterator_wrap_stack(aTHX_ iter, expected_depth);
     }
@@ -653,6 +803,7 @@ srl_iterator_next(pTHX_ srl_iterator_t *iter, UV n)
 
     DEBUG_ASSERT_RDR_SANE(iter->pbuf);
     SRL_ITER_ASSERT_STACK(iter);
+    SRL_ITER_ENSURE_INDEX(iter);
 
     while (1) {
         /* wrapping stack */
@@ -692,7 +843,8 @@ srl_iterator_next(pTHX_ srl_iterator_t *iter, UV n)
             case 0x40: /* ARRAYREF_0 .. HASHREF_15 */
                 /* for HASHREF_0 .. HASHREF_15 multiple length by two */
                 length = (tag & 0xF) << ((tag & 0x10) ? 1 : 0);
-                srl_stack_push_and_set(iter, tag, length, stack_ptr);
+                if (!srl_iterator_index_skip(aTHX_ iter, length))
+                    srl_stack_push_and_set(iter, tag, length, stack_ptr);
                 break;
 
             case 0x60: /* SHORT_BINARY_0 .. SHORT_BINARY_31 */
@@ -703,12 +855,14 @@ srl_iterator_next(pTHX_ srl_iterator_t *iter, UV n)
                 switch (tag) {
                     case SRL_HDR_HASH:
                         length = srl_read_varint_uv_count(aTHX_ iter->pbuf, " while reading HASH");
-                        srl_stack_push_and_set(iter, tag, length * 2, stack_ptr);
+                        if (!srl_iterator_index_skip(aTHX_ iter, length * 2))
+                            srl_stack_push_and_set(iter, tag, length * 2, stack_ptr);
                         break;
 
                     case SRL_HDR_ARRAY:
                         length = srl_read_varint_uv_count(aTHX_ iter->pbuf, " while reading ARRAY");
-                        srl_stack_push_and_set(iter, tag, length, stack_ptr);
+                        if (!srl_iterator_index_skip(aTHX_ iter, length))
+                            srl_stack_push_and_set(iter, tag, length, stack_ptr);
                         break;
 
                     case SRL_HDR_VARINT:
@@ -731,7 +885,7 @@ srl_iterator_next(pTHX_ srl_iterator_t *iter, UV n)
                         goto read_again;
 
                     case SRL_HDR_PAD:
-                        while (SRL_RDR_NOT_DONE(iter->pbuf) && *iter->buf.pos++ == SRL_HDR_PAD) {};
+                        while (SRL_RDR_NOT_DONE(iter->pbuf) && *iter->buf.pos == SRL_HDR_PAD) iter->buf.pos++;
                         goto read_again;
 
                     case SRL_HDR_BINARY:
@@ -814,6 +968,36 @@ srl_iterator_rewind(pTHX_ srl_iterator_t *iter, UV n)
     SRL_ITER_REPORT_STACK_STATE(iter);
 }
 
+/* Mark and restore are O(1): restoring pops frames pushed after marking and
+ * puts back the frame at marked depth, which step_in() and REFP modify */
+void
+srl_iterator_mark(pTHX_ srl_iterator_t *iter, srl_iterator_mark_t *mark)
+{
+    SRL_ITER_ASSERT_STACK_NONSTRICT(iter);
+    Copy(iter->stack.ptr, &mark->frame, 1, srl_iterator_stack_t);
+    mark->pos = iter->buf.pos;
+    mark->depth = iter->stack.depth;
+}
+
+void
+srl_iterator_restore(pTHX_ srl_iterator_t *iter, const srl_iterator_mark_t *mark)
+{
+    srl_stack_t *stack = iter->pstack;
+    if (expect_false(stack->depth < mark->depth)) {
+        SRL_ITER_ERRORf1("Can't restore position at depth %"IVdf, mark->depth);
+    }
+
+    while (stack->depth > mark->depth) {
+        srl_stack_pop_nocheck(stack);
+    }
+
+    Copy(&mark->frame, iter->stack.ptr, 1, srl_iterator_stack_t);
+    iter->buf.pos = mark->pos;
+
+    SRL_ITER_REPORT_STACK_STATE(iter);
+    DEBUG_ASSERT_RDR_SANE(iter->pbuf);
+}
+
 void
 srl_iterator_array_goto(pTHX_ srl_iterator_t *iter, I32 idx)
 {
@@ -867,6 +1051,47 @@ srl_iterator_hash_key(pTHX_ srl_iterator_t *iter, const char **keyname, STRLEN *
     stack_ptr->idx++;
 }
 
+/* Per-hash key index. It's filled while the hash is scanned for a key, so
+ * each pair is scanned at most once no matter how many keys are looked up.
+ * Lookups of scanned keys are O(1), otherwise scanning resumes after the
+ * last scanned pair. Filling the index costs more than plain scan, so it's
+ * only done from the second lookup in a hash on. Until then NULL is
+ * returned and the cache just remembers that the hash was looked up. */
+
+SRL_STATIC_INLINE AV *
+srl_iterator_hash_index(pTHX_ srl_iterator_t *iter)
+{
+    srl_iterator_stack_ptr stack_ptr = iter->stack.ptr;
+    SV **svp;
+    AV *hidx;
+
+    if (iter->cache == NULL) iter->cache = newHV();
+
+    svp = hv_fetch(iter->cache, (const char *) &stack_ptr->first, sizeof(stack_ptr->first), 1);
+    if (expect_true(SvROK(*svp))) {
+        hidx = (AV *) SvRV(*svp);
+
+        /* ALIAS or REFP stack may start at same offset but */
+        /* have different length, don't use the index then */
+        svp = av_fetch(hidx, SRL_ITER_HASH_INDEX_LENGTH, 0);
+        return SvUV(*svp) == stack_ptr->length ? hidx : NULL;
+    }
+
+    if (!SvOK(*svp)) {
+        sv_setuv(*svp, 1);
+        return NULL;
+    }
+
+    hidx = newAV();
+    av_extend(hidx, SRL_ITER_HASH_INDEX_SIZE - 1);
+    av_store(hidx, SRL_ITER_HASH_INDEX_KEYS, newRV_noinc((SV *) newHV()));
+    av_store(hidx, SRL_ITER_HASH_INDEX_VALUES, newSVpvs(""));
+    av_store(hidx, SRL_ITER_HASH_INDEX_LENGTH, newSVuv(stack_ptr->length));
+    av_store(hidx, SRL_ITER_HASH_INDEX_END, newSVuv(0));
+    sv_setsv(*svp, sv_2mortal(newRV_noinc((SV *) hidx)));
+    return hidx;
+}
+
 /* Function looks for name key in current hash. If the key is found, the function stops
  * at the key's value object. If the key is not found, the function traverses
  * entire hash and stops after the end of the hash. But remains stack unwrapper. */
@@ -874,22 +1099,88 @@ srl_iterator_hash_key(pTHX_ srl_iterator_t *iter, const char **keyname, STRLEN *
 IV
 srl_iterator_hash_exists(pTHX_ srl_iterator_t *iter, const char *name, STRLEN name_length)
 {
+    UV pairs;
+    HV *keys;
+    AV *hidx;
+    SV *values, *end, **svp;
     const char *keyname;
     STRLEN keyname_length;
+    srl_iterator_stack_ptr stack_ptr = iter->stack.ptr;
 
     srl_iterator_rewind(aTHX_ iter, 0);
+    if (expect_false(stack_ptr->length == 0)) {
+        SRL_ITER_TRACE("didn't found key '%.*s' in empty hash", (int) name_length, name);
+        return SRL_ITER_NOT_FOUND;
+    }
+
+    hidx = srl_iterator_hash_index(aTHX_ iter);
+    if (expect_false(hidx == NULL)) {
+        while (iter->stack.ptr->idx < iter->stack.ptr->length) {
+            srl_iterator_hash_key(aTHX_ iter, &keyname, &keyname_length);
+            if (keyname_length == name_length && memcmp(name, keyname, name_length) == 0) {
+                SRL_ITER_TRACE_WITH_POSITION("found key '%.*s'", (int) name_length, name);
+                return SRL_RDR_BODY_POS_OFS(iter->pbuf);
+            }
+
+            /* step over value, srl_iterator_next() remains on current stack */
+            srl_iterator_next(aTHX_ iter, 1);
+        }
+
+        SRL_ITER_TRACE("didn't found key '%.*s'", (int) name_length, name);
+        return SRL_ITER_NOT_FOUND;
+    }
+
+    keys   = (HV *) SvRV(*av_fetch(hidx, SRL_ITER_HASH_INDEX_KEYS, 0));
+    values = *av_fetch(hidx, SRL_ITER_HASH_INDEX_VALUES, 0);
+    end    = *av_fetch(hidx, SRL_ITER_HASH_INDEX_END, 0);
+    pairs  = SvCUR(values) / sizeof(UV);
+
+    svp = hv_fetch(keys, name, name_length, 0);
+    if (svp) {
+        UV pair = SvUV(*svp);
+        iter->buf.pos = iter->buf.body_pos + ((UV *) SvPVX(values))[pair];
+        stack_ptr->idx = 2 * pair + 1;
+        SRL_ITER_TRACE_WITH_POSITION("found key '%.*s' in hash index", (int) name_length, name);
+        return SRL_RDR_BODY_POS_OFS(iter->pbuf);
+    }
 
+    if (SvUV(end)) {
+        iter->buf.pos = iter->buf.body_pos + SvUV(end);
+        stack_ptr->idx = stack_ptr->length;
+        SRL_ITER_TRACE("didn't found key '%.*s' in hash index", (int) name_length, name);
+        return SRL_ITER_NOT_FOUND;
+    }
+
+    /* resume scanning after the last scanned pair */
+    if (pairs) {
+        iter->buf.pos = iter->buf.body_pos + ((UV *) SvPVX(values))[pairs - 1];
+        stack_ptr->idx = 2 * pairs - 1;
+        srl_iterator_next(aTHX_ iter, 1);
+    }
+
+    /* srl_iterator_next() may reallocate the stack, so don't cache stack_ptr below */
     while (iter->stack.ptr->idx < iter->stack.ptr->length) {
+        UV offset;
+
         srl_iterator_hash_key(aTHX_ iter, &keyname, &keyname_length);
+        offset = SRL_RDR_BODY_POS_OFS(iter->pbuf);
+
+        /* first occurrence wins, same as for linear scan */
+        svp = hv_fetch(keys, keyname, keyname_length, 1);
+        if (!SvOK(*svp)) sv_setuv(*svp, pairs);
+        sv_catpvn(values, (const char *) &offset, sizeof(offset));
+        pairs++;
+
         if (keyname_length == name_length && memcmp(name, keyname, name_length) == 0) {
             SRL_ITER_TRACE_WITH_POSITION("found key '%.*s'", (int) name_length, name);
-            return SRL_RDR_BODY_POS_OFS(iter->pbuf);
+            return offset;
         }
 
         /* step over value, srl_iterator_next() remains on current stack */
         srl_iterator_next(aTHX_ iter, 1);
     }
 
+    sv_setuv(end, SRL_RDR_BODY_POS_OFS(iter->pbuf));
     SRL_ITER_TRACE("didn't found key '%.*s'", (int) name_length, name);
     return SRL_ITER_NOT_FOUND;
 }
@@ -1196,6 +1487,112 @@ srl_iterator_decode_and_next(pTHX_ srl_iterator_t *iter)
     return sv;
 }
 
+/* Read scalar at current position without creating an SV. The iterator
+ * doesn't move. Strings point into the document. COPY and ALIAS tags are
+ * followed. Returns one of SRL_ITER_SCALAR_* */
+int
+srl_iterator_peek_scalar(pTHX_ srl_iterator_t *iter, srl_iterator_scalar_t *out)
+{
+    U8 tag;
+    UV uv;
+    int type = SRL_ITER_SCALAR_NONE;
+    int jumped = 0;
+    srl_reader_char_ptr orig_pos = iter->buf.pos;
+
+    DEBUG_ASSERT_RDR_SANE(iter->pbuf);
+    SRL_ITER_ASSERT_STACK(iter);
+
+read_again:
+    SRL_ITER_ASSERT_EOF(iter, "scalar");
+    tag = *iter->buf.pos & ~SRL_HDR_TRACK_FLAG;
+    SRL_ITER_REPORT_TAG(iter, tag);
+    iter->buf.pos++;
+
+    if (tag <= SRL_HDR_POS_HIGH) {
+        out->iv = (IV) tag;
+        type = SRL_ITER_SCALAR_IV;
+    } else if (tag <= SRL_HDR_NEG_HIGH) {
+        out->iv = (IV) tag - 32;
+        type = SRL_ITER_SCALAR_IV;
+    } else if (tag >= SRL_HDR_SHORT_BINARY_LOW) {
+        out->len = SRL_HDR_SHORT_BINARY_LEN_FROM_TAG(tag);
+        SRL_RDR_ASSERT_SPACE(iter->pbuf, out->len, " while reading SHORT_BINARY");
+        out->str = (const char *) iter->buf.pos;
+        type = SRL_ITER_SCALAR_STRING;
+    } else {
+        switch (tag) {
+            case SRL_HDR_VARINT:
+                uv = srl_read_varint_uv(aTHX_ iter->pbuf);
+                if (uv > (UV) IV_MAX) {
+                    out->uv = uv;
+                    type = SRL_ITER_SCALAR_UV;
+                } else {
+                    out->iv = (IV) uv;
+                    type = SRL_ITER_SCALAR_IV;
+                }
+                break;
+
+            case SRL_HDR_ZIGZAG:
+                uv = srl_read_varint_uv(aTHX_ iter->pbuf);
+                out->iv = (IV) ((uv >> 1) ^ (-(uv & 1)));
+                type = SRL_ITER_SCALAR_IV;
+                break;
+
+            case SRL_HDR_FLOAT: {
+                float f;
+                SRL_RDR_ASSERT_SPACE(iter->pbuf, sizeof(float), " while reading FLOAT");
+                Copy(iter->buf.pos, &f, 1, float);
+                out->nv = (NV) f;
+                type = SRL_ITER_SCALAR_NV;
+                break;
+            }
+
+            case SRL_HDR_DOUBLE: {
+                double d;
+                SRL_RDR_ASSERT_SPACE(iter->pbuf, sizeof(double), " while reading DOUBLE");
+                Copy(iter->buf.pos, &d, 1, double);
+                out->nv = (NV) d;
+                type = SRL_ITER_SCALAR_NV;
+                break;
+            }
+
+            case SRL_HDR_TRUE:
+            case SRL_HDR_FALSE:
+                out->iv = tag == SRL_HDR_TRUE ? 1 : 0;
+                type = SRL_ITER_SCALAR_IV;
+                break;
+
+            case SRL_HDR_UNDEF:
+            case SRL_HDR_CANONICAL_UNDEF:
+                type = SRL_ITER_SCALAR_UNDEF;
+                break;
+
+            case SRL_HDR_BINARY:
+            case SRL_HDR_STR_UTF8:
+                out->len = srl_read_varint_uv_length(aTHX_ iter->pbuf, " while reading string");
+                out->str = (const char *) iter->buf.pos;
+                type = SRL_ITER_SCALAR_STRING;
+                break;
+
+            case SRL_HDR_COPY:
+            case SRL_HDR_ALIAS:
+                if (!jumped) {
+                    UV offset = srl_read_varint_uv_offset(aTHX_ iter->pbuf, " while reading COPY/ALIAS tag");
+                    iter->buf.pos = iter->buf.body_pos + offset;
+                    jumped = 1;
+                    goto read_again;
+                }
+                break;
+
+            default: /* references, containers, objects, etc */
+                break;
+        }
+    }
+
+    iter->buf.pos = orig_pos;
+    return type;
+}
+
 SV *
 srl_iterator_decode(pTHX_ srl_iterator_t *iter)
 {
@@ -1233,6 +1630,345 @@ srl_iterator_decode(pTHX_ srl_iterator_t *iter)
     return into;
 }
 
+/* Structural index.
+ *
+ * The index lists containers (arrays, hashes and their ref variants) in the
+ * order their headers appear in the body. Each entry has offset to first
+ * element, offset after last element and number of child objects. Parsing
+ * is deterministic, so any stack whose first and length match an entry ends
+ * at entry's end. This holds for stacks created by REFP and ALIAS too. */
+
+typedef struct {
+    UV entry;       /* entry's index in index SV */
+    UV left;        /* number of child objects left to parse */
+} srl_iterator_index_open_t;
+
+SRL_STATIC_INLINE srl_iterator_index_entry_t *
+srl_iterator_index_add(pTHX_ SV *index, UV first, UV count)
+{
+    srl_iterator_index_entry_t *entry;
+    STRLEN need = SvCUR(index) + sizeof(srl_iterator_index_entry_t);
+    if (expect_false(SvLEN(index) < need)) SvGROW(index, need * 2);
+
+    entry = (srl_iterator_index_entry_t *) (SvPVX(index) + SvCUR(index));
+    entry->first = first;
+    entry->end = 0;
+    entry->count = count;
+    SvCUR_set(index, need);
+    return entry;
+}
+
+SRL_STATIC_INLINE void
+srl_iterator_index_skip_stringish(pTHX_ srl_reader_buffer_t *buf)
+{
+    U8 tag;
+    UV length = 0;
+
+    if (expect_false(SRL_RDR_DONE(buf))) {
+        SRL_RDR_ERROR_EOF(buf, "stringish");
+    }
+
+    tag = *buf->pos++ & ~SRL_HDR_TRACK_FLAG;
+    switch (tag) {
+        CASE_SRL_HDR_SHORT_BINARY:
+            length = SRL_HDR_SHORT_BINARY_LEN_FROM_TAG(tag);
+            break;
+
+        case SRL_HDR_BINARY:
+        case SRL_HDR_STR_UTF8:
+            length = srl_read_varint_uv_length(aTHX_ buf, " while reading BINARY or STR_UTF8");
+            break;
+
+        case SRL_HDR_COPY:
+            srl_skip_varint(aTHX_ buf);
+            break;
+
+        default:
+            SRL_RDR_ERROR_UNEXPECTED(buf, tag, "stringish");
+    }
+
+    SRL_RDR_ASSERT_SPACE(buf, length, " while reading stringish");
+    buf->pos += length;
+}
+
+/* Walk entire body once and record end of each container at least
+ * index_min_span bytes long. Current position is not changed. */
+
+void
+srl_iterator_build_index(pTHX_ srl_iterator_t *iter)
+{
+    U8 tag;
+    UV length, root_left = 1, nopen = 0;
+    srl_reader_buffer_t buf;
+    srl_iterator_index_open_t *open;
+    SV *index, *open_sv;
+
+    if (expect_false(iter->document == NULL || srl_stack_empty(iter->pstack))) {
+        SRL_ITER_ERROR("No document to build index for");
+    }
+
+    /* work on a copy of the buffer to leave the iterator untouched */
+    Copy(&iter->buf, &buf, 1, srl_reader_buffer_t);
+    buf.pos = buf.body_pos + iter->stack.begin->first;
+
+    /* both SVs are mortal so nothing leaks if the document is broken */
+    index = sv_2mortal(newSV(16 * sizeof(srl_iterator_index_entry_t)));
+    open_sv = sv_2mortal(newSV(SRL_ITER_STACK_PREALLOCATE * sizeof(srl_iterator_index_open_t)));
+    SvPOK_on(index);
+    SvCUR_set(index, 0);
+
+    while (1) {
+        open = (srl_iterator_index_open_t *) SvPVX(open_sv);
+
+        /* close completed containers */
+        while (nopen && open[nopen - 1].left == 0) {
+            srl_iterator_index_entry_t *entry = SRL_ITER_INDEX_ENTRIES(index) + open[nopen - 1].entry;
+            entry->end = SRL_RDR_BODY_POS_OFS(&buf);
+
+            /* nested containers are shorter and are already dropped, */
+            /* so a short container is always the last entry */
+            if (entry->end - entry->first < iter->index_min_span) {
+                assert(open[nopen - 1].entry == SRL_ITER_INDEX_LENGTH(index) - 1);
+                SvCUR_set(index, SvCUR(index) - sizeof(srl_iterator_index_entry_t));
+            }
+
+            nopen--;
+        }
+
+        if (nopen) open[nopen - 1].left--;
+        else if (root_left) root_left--;
+        else break;
+
+        length = 0;
+
+    read_again:
+        if (expect_false(SRL_RDR_DONE(&buf))) {
+            SRL_RDR_ERROR_EOF(&buf, "tag");
+        }
+
+        tag = *buf.pos & ~SRL_HDR_TRACK_FLAG;
+        buf.pos++;
+
+        switch (tag & 0xE0) {
+            case 0x0: /* POS_0 .. NEG_1 */
+                break;
+
+            case 0x40: /* ARRAYREF_0 .. HASHREF_15 */
+                length = (tag & 0xF) << ((tag & 0x10) ? 1 : 0);
+                break;
+
+            case 0x60: /* SHORT_BINARY_0 .. SHORT_BINARY_31 */
+                buf.pos += SRL_HDR_SHORT_BINARY_LEN_FROM_TAG(tag);
+                break;
+
+            default:
+                switch (tag) {
+                    case SRL_HDR_HASH:
+                        length = 2 * srl_read_varint_uv_count(aTHX_ &buf, " while reading HASH");
+                        break;
+
+                    case SRL_HDR_ARRAY:
+                        length = srl_read_varint_uv_count(aTHX_ &buf, " while reading ARRAY");
+                        break;
+
+                    case SRL_HDR_VARINT:
+                    case SRL_HDR_ZIGZAG:
+                        srl_skip_varint(aTHX_ &buf);
+                        break;
+
+                    case SRL_HDR_FLOAT:         buf.pos += 4;      break;
+                    case SRL_HDR_DOUBLE:        buf.pos += 8;      break;
+                    case SRL_HDR_LONG_DOUBLE:   buf.pos += 16;     break;
+
+                    case SRL_HDR_TRUE:
+                    case SRL_HDR_FALSE:
+                    case SRL_HDR_UNDEF:
+                    case SRL_HDR_CANONICAL_UNDEF:
+                        break;
+
+                    case SRL_HDR_REFN:
+                    case SRL_HDR_WEAKEN:
+                        goto read_again;
+
+                    case SRL_HDR_PAD:
+                        while (SRL_RDR_NOT_DONE(&buf) && *buf.pos == SRL_HDR_PAD) buf.pos++;
+                        goto read_again;
+
+                    case SRL_HDR_BINARY:
+                    case SRL_HDR_STR_UTF8:
+                        length = srl_read_varint_uv_length(aTHX_ &buf, " while reading BINARY or STR_UTF8");
+                        buf.pos += length;
+                        length = 0;
+                        break;
+
+                    case SRL_HDR_COPY:
+                    case SRL_HDR_REFP:
+                    case SRL_HDR_ALIAS:
+                        srl_skip_varint(aTHX_ &buf);
+                        break;
+
+                    case SRL_HDR_OBJECT:
+                    case SRL_HDR_OBJECT_FREEZE:
+                        srl_iterator_index_skip_stringish(aTHX_ &buf);
+                        goto read_again;
+
+                    case SRL_HDR_OBJECTV:
+                    case SRL_HDR_OBJECTV_FREEZE:
+                        srl_skip_varint(aTHX_ &buf);
+                        goto read_again;
+
+                    case SRL_HDR_REGEXP:
+                        srl_iterator_index_skip_stringish(aTHX_ &buf);
+                        srl_iterator_index_skip_stringish(aTHX_ &buf);
+                        break;
+
+                    default:
+                        SRL_RDR_ERROR_UNIMPLEMENTED(&buf, tag, "");
+                        break;
+                }
+        }
+
+        if (length) {
+            if (expect_false(SvLEN(open_sv) < (nopen + 1) * sizeof(srl_iterator_index_open_t)))
+                SvGROW(open_sv, (nopen + 1) * 2 * sizeof(srl_iterator_index_open_t));
+
+            open = (srl_iterator_index_open_t *) SvPVX(open_sv);
+            open[nopen].entry = SRL_ITER_INDEX_LENGTH(index);
+            open[nopen].left = length;
+            nopen++;
+
+            srl_iterator_index_add(aTHX_ index, SRL_RDR_BODY_POS_OFS(&buf), length);
+        }
+    }
+
+    if (iter->index) SvREFCNT_dec(iter->index);
+    iter->index = SvREFCNT_inc(index);
+
+    SRL_ITER_TRACE("built index with %"UVuf" entries", (UV) SRL_ITER_INDEX_LENGTH(index));
+}
+
+SRL_STATIC_INLINE void
+srl_iterator_index_cat_varint(pTHX_ SV *sv, UV n)
+{
+    U8 *pos = (U8 *) SvGROW(sv, SvCUR(sv) + SRL_MAX_VARINT_LENGTH + 1) + SvCUR(sv);
+    U8 *start = pos;
+
+    while (n >= 0x80) {
+        *pos++ = (U8) ((n & 0x7f) | 0x80);
+        n >>= 7;
+    }
+
+    *pos++ = (U8) n;
+    SvCUR_set(sv, SvCUR(sv) + (pos - start));
+}
+
+/* Serialized index is:
+ *   magic, version byte, body length varint, number of entries varint,
+ *   and for each entry: delta of first, end - first and count as varints */
+
+SV *
+srl_iterator_dump_index(pTHX_ srl_iterator_t *iter)
+{
+    UV i, length, prev = 0;
+    srl_iterator_index_entry_t *entries;
+    SV *sv;
+
+    if (iter->index == NULL) srl_iterator_build_index(aTHX_ iter);
+
+    length = SRL_ITER_INDEX_LENGTH(iter->index);
+    entries = SRL_ITER_INDEX_ENTRIES(iter->index);
+
+    sv = sv_2mortal(newSV(SRL_ITER_INDEX_MAGIC_LEN + 1 + length * 4));
+    sv_setpvn(sv, SRL_ITER_INDEX_MAGIC "\0", SRL_ITER_INDEX_MAGIC_LEN + 1);
+    SvPVX(sv)[SRL_ITER_INDEX_MAGIC_LEN] = SRL_ITER_INDEX_VERSION;
+
+    srl_iterator_index_cat_varint(aTHX_ sv, SRL_ITER_INDEX_BODY_LENGTH(iter));
+    srl_iterator_index_cat_varint(aTHX_ sv, length);
+
+    for (i = 0; i < length; ++i) {
+        srl_iterator_index_cat_varint(aTHX_ sv, entries[i].first - prev);
+        srl_iterator_index_cat_varint(aTHX_ sv, entries[i].end - entries[i].first);
+        srl_iterator_index_cat_varint(aTHX_ sv, entries[i].count);
+        prev = entries[i].first;
+    }
+
+    return sv;
+}
+
+/* Load index created by srl_iterator_dump_index(). The index isn't verified */
+/* against the document (that would require full walk) but every entry */
+/* has to be within the body so a mismatching index can't lead outside of it. */
+
+void
+srl_iterator_load_index(pTHX_ srl_iterator_t *iter, SV *src)
+{
+    UV i, length, body_length, first = 0;
+    srl_reader_buffer_t buf;
+    STRLEN len;
+    SV *index;
+
+    if (expect_false(iter->document == NULL)) {
+        SRL_ITER_ERROR("No document to load index for");
+    }
+
+    SRL_RDR_CLEAR(&buf);
+    buf.start = buf.pos = (srl_reader_char_ptr) SvPV(src, len);
+    buf.end = buf.start + len;
+    buf.body_pos = buf.start;
+
+    if (   len < SRL_ITER_INDEX_MAGIC_LEN + 1
+        || memNE(buf.start, SRL_ITER_INDEX_MAGIC, SRL_ITER_INDEX_MAGIC_LEN))
+    {
+        SRL_ITER_ERROR("Bad index: not a Sereal::Path::Iterator index");
+    }
+
+    buf.pos += SRL_ITER_INDEX_MAGIC_LEN;
+    if (expect_false(*buf.pos != SRL_ITER_INDEX_VERSION)) {
+        SRL_ITER_ERRORf1("Bad index: unsupported version %u", (unsigned int) *buf.pos);
+    }
+
+    buf.pos++;
+    body_length = srl_read_varint_uv_safe(aTHX_ &buf);
+    if (expect_false(body_length != SRL_ITER_INDEX_BODY_LENGTH(iter))) {
+        SRL_ITER_ERRORf2("Bad index: it's built for body of %"UVuf" bytes but document's body has %"UVuf" bytes",
+                         body_length, SRL_ITER_INDEX_BODY_LENGTH(iter));
+    }
+
+    /* each entry takes at least 3 bytes */
+    length = srl_read_varint_uv_safe(aTHX_ &buf);
+    if (expect_false(length > (UV) SRL_RDR_SPACE_LEFT(&buf) / 3)) {
+        SRL_ITER_ERROR("Bad index: truncated");
+    }
+
+    index = sv_2mortal(newSV(length * sizeof(srl_iterator_index_entry_t) + 1));
+    SvPOK_on(index);
+    SvCUR_set(index, 0);
+
+    for (i = 0; i < length; ++i) {
+        UV delta = srl_read_varint_uv_safe(aTHX_ &buf);
+        UV span  = srl_read_varint_uv_safe(aTHX_ &buf);
+        UV count = srl_read_varint_uv_safe(aTHX_ &buf);
+
+        if (expect_false(   (i > 0 && delta == 0)
+                         || delta > body_length - first
+                         || span > body_length - first - delta
+                         || count == 0 || count > span))
+        {
+            SRL_ITER_ERRORf1("Bad index: corrupted entry %"UVuf, i);
+        }
+
+        first += delta;
+        srl_iterator_index_add(aTHX_ index, first, count)->end = first + span;
+    }
+
+    if (expect_false(SRL_RDR_NOT_DONE(&buf))) {
+        SRL_ITER_ERROR("Bad index: trailing garbage");
+    }
+
+    if (iter->index) SvREFCNT_dec(iter->index);
+    iter->index = SvREFCNT_inc(index);
+}
+
 SRL_STATIC_INLINE void
 srl_iterator_read_refn(pTHX_ srl_iterator_t *iter, U8 *tag_out, UV *length_out)
 {
@@ -1457,3 +2193,37 @@ srl_iterator_read_stringish(pTHX_ srl_iterator_t *iter, const char **str_out, ST
     if (new_pos) iter->buf.pos = new_pos;
     else iter->buf.pos += length;
 }
+
+SRL_STATIC_INLINE srl_iterator_index_entry_t *
+srl_iterator_index_lookup(pTHX_ srl_iterator_t *iter, UV first, UV count)
+{
+    srl_iterator_index_entry_t *entries = SRL_ITER_INDEX_ENTRIES(iter->index);
+    IV lo = 0, hi = (IV) SRL_ITER_INDEX_LENGTH(iter->index) - 1;
+
+    while (lo <= hi) {
+        IV mid = lo + (hi - lo) / 2;
+        if (entries[mid].first < first) lo = mid + 1;
+        else if (entries[mid].first > first) hi = mid - 1;
+        else return entries[mid].count == count ? &entries[mid] : NULL;
+    }
+
+    return NULL;
+}
+
+/* Called by srl_iterator_next() right after container's header is parsed. */
+/* If the container is in the index, position is moved after its last */
+/* element and 1 is returned. Otherwise the caller walks the container. */
+
+SRL_STATIC_INLINE int
+srl_iterator_index_skip(pTHX_ srl_iterator_t *iter, UV length)
+{
+    srl_iterator_index_entry_t *entry;
+    if (iter->index == NULL || length == 0) return 0;
+
+    entry = srl_iterator_index_lookup(aTHX_ iter, SRL_RDR_BODY_POS_OFS(iter->pbuf), length);
+    if (entry == NULL) return 0;
+
+    iter->buf.pos = iter->buf.body_pos + entry->end;
+    SRL_ITER_TRACE_WITH_POSITION("index skip over %"UVuf" elements", length);
+    return 1;
+}
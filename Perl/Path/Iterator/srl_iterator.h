@@ -22,6 +22,37 @@ struct srl_iterator_stack {
 #define srl_stack_type_t srl_iterator_stack_t
 #include "srl_stack.h"
 
+/* structural index: one entry per container, sorted by first */
+typedef struct srl_iterator_index_entry srl_iterator_index_entry_t;
+struct srl_iterator_index_entry {
+    UV first;       /* offset to first element */
+    UV end;         /* offset after last element */
+    UV count;       /* number of child objects, same as stack's length */
+};
+
+/* position to return to, see srl_iterator_mark() */
+typedef struct {
+    srl_iterator_stack_t frame; /* frame at depth */
+    srl_reader_char_ptr pos;
+    IV depth;
+} srl_iterator_mark_t;
+
+/* scalar read in place, see srl_iterator_peek_scalar() */
+#define SRL_ITER_SCALAR_NONE    0   /* not a scalar */
+#define SRL_ITER_SCALAR_UNDEF   1
+#define SRL_ITER_SCALAR_IV      2
+#define SRL_ITER_SCALAR_UV      3   /* only for values above IV_MAX */
+#define SRL_ITER_SCALAR_NV      4
+#define SRL_ITER_SCALAR_STRING  5
+
+typedef struct {
+    IV iv;
+    UV uv;
+    NV nv;
+    const char *str;    /* points into document */
+    STRLEN len;
+} srl_iterator_scalar_t;
+
 /* the iterator main struct */
 struct srl_iterator {
     srl_reader_buffer_t buf;
@@ -30,6 +61,14 @@ struct srl_iterator {
     srl_stack_ptr pstack;
     SV *document;
     struct srl_decoder *dec;
+    SV *index;              /* srl_iterator_index_entry_t array, shared by shallow copies */
+    HV *cache;              /* per-hash key indexes keyed by hash's first, shared by shallow copies */
+    UV index_min_span;      /* containers shorter than this are not indexed */
+    U8 want_index;          /* build index on first navigation */
+    SV *compressed;         /* copy of compressed document whose body is in document, shared by shallow copies */
+    srl_reader_buffer_t body_buf;   /* buffer state right after decompressing the body */
+    struct ZSTD_DCtx_s *zstd_dctx;  /* reused between zstd documents, allocated on first use */
+    struct mz_stream_s *zlib_stream;/* reused between zlib documents, allocated on first use */
 };
 
 /* constructor/destructor */
@@ -59,6 +98,15 @@ void srl_iterator_rewind(pTHX_ srl_iterator_t *iter, UV n);
 
 UV srl_iterator_eof(pTHX_ srl_iterator_t *iter);
 
+/* remember current position and return to it after navigating deeper */
+void srl_iterator_mark(pTHX_ srl_iterator_t *iter, srl_iterator_mark_t *mark);
+void srl_iterator_restore(pTHX_ srl_iterator_t *iter, const srl_iterator_mark_t *mark);
+
+/* structural index */
+void srl_iterator_build_index(pTHX_ srl_iterator_t *iter);
+SV * srl_iterator_dump_index(pTHX_ srl_iterator_t *iter);            /* return mortalized SV */
+void srl_iterator_load_index(pTHX_ srl_iterator_t *iter, SV *src);
+
 /* expose stack status */
 SRL_STATIC_INLINE IV
 srl_iterator_stack_depth(pTHX_ srl_iterator_t *iter)
@@ -96,6 +144,7 @@ void srl_iterator_hash_key(pTHX_ srl_iterator_t *iter, const char **keyname, STR
 IV srl_iterator_hash_exists(pTHX_ srl_iterator_t *iter, const char *name, STRLEN name_len);
 
 SV * srl_iterator_decode(pTHX_ srl_iterator_t *iter); /* return mortalized SV */
+int srl_iterator_peek_scalar(pTHX_ srl_iterator_t *iter, srl_iterator_scalar_t *out);
 SV * srl_iterator_decode_and_next(pTHX_ srl_iterator_t *iter); /* return mortalized SV */
 
 #define SRL_ITER_NOT_FOUND (-1)
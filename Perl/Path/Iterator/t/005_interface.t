@@ -46,6 +46,38 @@ subtest "set document", sub {
     is($spi->decode(), 200, 'decode 200');
 };
 
+subtest "set compressed document again", sub {
+    my $data = { list => [ map { { id => $_ } } 1 .. 100 ], name => 'x' x 100 };
+    my %docs = (
+        snappy => encode_sereal($data, { compress => Sereal::Encoder::SRL_SNAPPY }),
+        zlib   => encode_sereal($data, { compress => Sereal::Encoder::SRL_ZLIB }),
+        zstd   => encode_sereal($data, { compress => 3 }), # SRL_ZSTD
+        raw    => encode_sereal($data),
+    );
+
+    my $spi = Sereal::Path::Iterator->new($docs{raw}, { index => 1 });
+    foreach my $name ((sort keys %docs) x 2) {
+        foreach (1 .. 2) {
+            $spi->set($docs{$name});
+            $spi->step_in();
+            is($spi->hash_exists('name'), $spi->hash_exists('name'), "$name: hash_exists");
+            is($spi->decode(), 'x' x 100, "$name: decode value");
+            $spi->reset();
+            is_deeply($spi->decode(), $data, "$name: decode document");
+        }
+    }
+
+    # same length, different content: must not reuse previous body
+    my $doc = encode_sereal({ a => 'aaaa' }, { compress => Sereal::Encoder::SRL_ZLIB });
+    $spi->set($doc);
+    is_deeply($spi->decode(), { a => 'aaaa' }, 'decode first document');
+    my $other = encode_sereal({ a => 'bbbb' }, { compress => Sereal::Encoder::SRL_ZLIB });
+    is(length($other), length($doc), 'documents of same length');
+    $doc = $other; # modify in place
+    $spi->set($doc);
+    is_deeply($spi->decode(), { a => 'bbbb' }, 'decode modified document');
+};
+
 subtest "reset document", sub {
     my $spi = Sereal::Path::Iterator->new(encode_sereal(100));
     lives_ok(sub { $spi->reset() }, 'expect reset() to live');
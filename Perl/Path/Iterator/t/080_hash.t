@@ -54,4 +54,44 @@ subtest "hash key exists", sub {
     is($spi->hash_exists('nonexistent'), 0, "hash key 'nonexistent' does not exist");
 };
 
+subtest "repeated hash key lookups", sub {
+    my %hash = map { ("key$_" => { value => $_, list => [ 1 .. $_ ] }) } 1 .. 50;
+    my $doc = encode_sereal([ \%hash, \%hash, 'end' ], { sort_keys => 2 });
+    my $spi = Sereal::Path::Iterator->new($doc);
+    my @keys = ((map { "key$_" } 25, 1, 50, 25, reverse(1 .. 50)), 'missing', 'key0', 'key25', 'missing');
+    my @sorted = sort keys %hash;
+    my %value_idx = map { ($sorted[$_] => 2 * $_ + 1) } 0 .. $#sorted;
+
+    $spi->step_in(2);
+    foreach my $key (@keys) {
+        my $exists = exists $hash{$key} ? 1 : 0;
+        is($spi->hash_exists($key), $exists, "first hash: key '$key' " . ($exists ? "exists" : "does not exist"));
+        if ($exists) {
+            is($spi->stack_index(), $value_idx{$key}, "first hash: at value of '$key'");
+            is_deeply($spi->decode(), $hash{$key}, "first hash: value of '$key'");
+        } else {
+            is($spi->stack_index(), $spi->stack_length(), "first hash: at end after '$key'");
+        }
+    }
+
+    # the second hash is REFP to the first one
+    $spi->step_out();
+    $spi->step_in();
+    foreach my $key ('key30', 'missing', 'key1') {
+        ok($spi->hash_exists($key), "second hash: key '$key' exists") if $key ne 'missing';
+        ok(!$spi->hash_exists($key), "second hash: key '$key' does not exist") if $key eq 'missing';
+    }
+
+    is_deeply($spi->decode(), $hash{key1}, "second hash: value of 'key1'");
+    $spi->step_out();
+    is($spi->decode(), 'end', 'step out of second hash');
+
+    # another document with hash at the same offset
+    $spi->set(encode_sereal([ { map { ("key$_" => "other $_") } 1 .. 50 } ], { sort_keys => 2 }));
+    $spi->step_in();
+    $spi->step_in();
+    ok($spi->hash_exists('key30'), "new document: key 'key30' exists");
+    is($spi->decode(), 'other 30', "new document: value of 'key30'");
+};
+
 done_testing();
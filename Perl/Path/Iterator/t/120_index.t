@@ -0,0 +1,150 @@
+#!perl
+use strict;
+use warnings;
+
+use Test::More;
+use Test::Exception;
+use Scalar::Util qw/weaken/;
+use Sereal::Path::Iterator;
+use Sereal::Encoder qw/encode_sereal/;
+
+sub dump_value { encode_sereal($_[0], { canonical => 1 }) }
+
+# Visit current element and leave iterator right after it. For containers
+# only first half of elements is visited, the rest is skipped by step_out().
+sub walk {
+    my ($spi, $out) = @_;
+    my ($type, $length) = $spi->info();
+    push @$out, join(',', $spi->stack_depth(), $spi->stack_index(), $type, $length);
+
+    if (($type & SRL_INFO_REF_TO) && ($type & (SRL_INFO_HASH | SRL_INFO_ARRAY))) {
+        $spi->step_in();
+        my $n = $spi->stack_length();
+        walk($spi, $out) foreach 1 .. ($n + 1) >> 1;
+        $spi->step_out();
+    } else {
+        push @$out, dump_value($spi->decode());
+        $spi->next();
+    }
+}
+
+# Go to each element of top level array and decode it with and without
+# skipping over the previous ones.
+sub goto_all {
+    my ($spi, $out) = @_;
+    $spi->step_in();
+    my $n = $spi->stack_length();
+    foreach my $idx (reverse(0 .. $n - 1), 0 .. $n - 1) {
+        $spi->array_goto($idx);
+        push @$out, dump_value($spi->decode());
+    }
+    $spi->reset();
+}
+
+sub navigate {
+    my ($spi) = @_;
+    my @out;
+    walk($spi, \@out);
+    $spi->reset();
+    goto_all($spi, \@out);
+    return \@out;
+}
+
+my $shared = { shared => [ 1 .. 20 ] };
+my $self_ref = { name => 'loop' x 10 };
+$self_ref->{self} = $self_ref;
+weaken($self_ref->{self});
+
+my $data = [
+    { foo => 'bar' x 30, list => [ map { { id => $_, tags => [ ('tag') x $_ ] } } 1 .. 20 ] },
+    [],
+    {},
+    \\\\'scalar',
+    $shared,
+    [ $shared, $shared, { nested => $shared } ],
+    bless({ obj => [ 1 .. 30 ] }, 'Some::Class'),
+    bless([ map { bless({ n => $_ }, 'Other::Class') } 1 .. 10 ], 'Some::Class'),
+    qr/regexp/,
+    $self_ref,
+    [ map { [ ($_) x $_ ] } 0 .. 40 ],
+    { map { ("key$_" => { value => $_ x 20 }) } 1 .. 30 },
+    'end',
+];
+
+my %documents = (
+    plain            => encode_sereal($data),
+    dedupe           => encode_sereal($data, { dedupe_strings => 1 }),
+    aliased_dedupe   => encode_sereal($data, { aliased_dedupe_strings => 1 }),
+    snappy           => encode_sereal($data, { compress => Sereal::Encoder::SRL_SNAPPY() }),
+    zlib             => encode_sereal($data, { compress => Sereal::Encoder::SRL_ZLIB() }),
+    protocol_v1      => encode_sereal($data, { protocol_version => 1 }),
+);
+
+foreach my $name (sort keys %documents) {
+    my $doc = $documents{$name};
+    my $expected = navigate(Sereal::Path::Iterator->new($doc));
+
+    foreach my $min_span (0, 64) {
+        my $spi = Sereal::Path::Iterator->new($doc, { index => 1, index_min_span => $min_span });
+        is_deeply(navigate($spi), $expected, "$name: lazily built index with min span $min_span");
+
+        my $dump = $spi->dump_index();
+        my $loaded = Sereal::Path::Iterator->new($doc);
+        lives_ok(sub { $loaded->load_index($dump) }, "$name: load dumped index");
+        is_deeply(navigate($loaded), $expected, "$name: loaded index with min span $min_span");
+        is($loaded->dump_index(), $dump, "$name: same index after load");
+    }
+
+    my $spi = Sereal::Path::Iterator->new($doc);
+    $spi->build_index();
+    is_deeply(navigate($spi), $expected, "$name: explicitly built index");
+}
+
+subtest "PAD tags", sub {
+    # [[1,2,3],[1,2,3]] as written by Sereal::Merger, with PADs after the array length
+    my $doc = pack('H*', '3df3726c0400282b023f3f3f3f4301020343010203');
+
+    foreach my $opt ({}, { index => 1, index_min_span => 0 }) {
+        my $name = %$opt ? 'with index' : 'without index';
+        my $spi = Sereal::Path::Iterator->new($doc, $opt);
+        $spi->step_in();
+        is($spi->stack_length(), 2, "$name: array length");
+        is_deeply($spi->decode(), [ 1, 2, 3 ], "$name: first element");
+        $spi->next();
+        is_deeply($spi->decode(), [ 1, 2, 3 ], "$name: second element");
+
+        $spi->reset();
+        $spi->step_in();
+        $spi->array_goto(1);
+        is_deeply($spi->decode(), [ 1, 2, 3 ], "$name: array_goto to second element");
+    }
+};
+
+subtest "index is dropped by set", sub {
+    my $spi = Sereal::Path::Iterator->new($documents{plain}, { index => 1, index_min_span => 0 });
+    my $dump = $spi->dump_index();
+    my $doc = encode_sereal([ { foo => 'bar' }, [ 1 .. 10 ], 'end' ]);
+
+    $spi->set($doc);
+    is_deeply(navigate($spi), navigate(Sereal::Path::Iterator->new($doc)), 'index is rebuilt for new document');
+    isnt($spi->dump_index(), $dump, 'new index differs');
+};
+
+subtest "bad index", sub {
+    my $spi = Sereal::Path::Iterator->new($documents{plain});
+    my $dump = $spi->dump_index();
+    my $other = Sereal::Path::Iterator->new(encode_sereal([ 1 .. 10 ]));
+
+    throws_ok(sub { $other->load_index($dump) }, qr/Bad index: it's built for body of/, 'index of other document');
+    throws_ok(sub { $spi->load_index('foo') }, qr/Bad index: not a/, 'not an index');
+    throws_ok(sub { $spi->load_index(substr($dump, 0, -2)) }, qr/Bad index|end of packet/, 'truncated index');
+    throws_ok(sub { $spi->load_index($dump . "\0") }, qr/Bad index: trailing garbage/, 'trailing garbage');
+
+    my $bad_version = $dump;
+    substr($bad_version, 4, 1, chr(2));
+    throws_ok(sub { $spi->load_index($bad_version) }, qr/Bad index: unsupported version 2/, 'unsupported version');
+
+    is_deeply(navigate($spi), navigate(Sereal::Path::Iterator->new($documents{plain})), 'iterator works after failed loads');
+};
+
+done_testing();
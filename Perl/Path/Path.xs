@@ -43,15 +43,42 @@ results(path)
     XSRETURN(1);
 
 void
-_traverse(path, expr, route)
+_traverse(path, programs)
     srl_path_t *path;
-    SV *expr;
-    SV *route;
+    AV *programs;
+  PREINIT:
+    SSize_t i, n;
+    SV *buf;
+    srl_path_compiled_t **progs;
+  CODE:
+    n = av_len(programs) + 1;
+    buf = sv_2mortal(newSV((n ? n : 1) * sizeof(srl_path_compiled_t *)));
+    progs = (srl_path_compiled_t **) SvPVX(buf);
+
+    for (i = 0; i < n; ++i) {
+        SV **svp = av_fetch(programs, i, 0);
+        if (!svp || !sv_isobject(*svp) || !sv_isa(*svp, "Sereal::Path::Compiled"))
+            croak("query must be Sereal::Path::Compiled object");
+        progs[i] = INT2PTR(srl_path_compiled_t *, SvIV((SV*) SvRV(*svp)));
+    }
+
+    srl_path_traverse(aTHX_ path, progs, n);
+
+MODULE = Sereal::Path               PACKAGE = Sereal::Path::Compiled
+
+srl_path_compiled_t *
+_new(CLASS, expr)
+    char *CLASS;
+    AV *expr;
+  CODE:
+    RETVAL = srl_path_compile(aTHX_ expr);
+  OUTPUT: RETVAL
+
+void
+DESTROY(prog)
+    srl_path_compiled_t *prog;
   CODE:
-    if (SvTYPE(expr) != SVt_RV) croak("query mush be arrayref");
-    expr = SvRV(expr);
-    if (SvTYPE(expr) != SVt_PVAV) croak("query mush be arrayref");
-    srl_path_traverse(aTHX_ path, (AV*) expr, route);
+    srl_destroy_path_compiled(aTHX_ prog);
 
 MODULE = Sereal::Path               PACKAGE = Sereal::Path::_tests
 
@@ -38,6 +38,7 @@ struct sereal_iterator_tied_scalar {
     IV depth;
     U32 count;
     SV *store; // internal storage to workaround autovivification
+    SV *cache; // value returned by FETCH
 };
 
 // same memory layout as in sereal_iterator_tied
@@ -46,6 +47,10 @@ struct sereal_iterator_tied_array {
     IV depth;
     U32 count;
     AV *store; // internal storage to workaround autovivification
+    AV *cache; // values returned by FETCH: decoded scalars and tied containers
+    srl_iterator_mark_t first;      // position of first element
+    srl_reader_char_ptr *offsets;   // positions of elements [0..nvisited)
+    U32 nvisited;
 };
 
 // same memory layout as in sereal_iterator_tied
@@ -55,8 +60,11 @@ struct sereal_iterator_tied_hash {
     U32 count;
     I32 cur_idx;
     HV *store; // internal storage to workaround autovivification
+    HV *cache; // values returned by FETCH, offsets of keys are cached by iterator
 };
 
+SRL_STATIC_INLINE void srl_tie_prefetch_sv(pTHX_ SV *sv, IV depth);
+
 SRL_STATIC_INLINE SV *
 srl_tie_new_tied_sv(pTHX_ srl_iterator_t *iter)
 {
@@ -66,6 +74,7 @@ srl_tie_new_tied_sv(pTHX_ srl_iterator_t *iter)
     SV *tie, *result;
     const char* tied_class_name;
     sereal_iterator_tied_t *tied;
+    sereal_iterator_tied_array_t *tied_array = NULL;
     U32 type = srl_iterator_info(aTHX_ iter, &count, NULL, NULL);
 
     if ((type & SRL_ITERATOR_INFO_REF_TO) == 0) {
@@ -78,6 +87,7 @@ srl_tie_new_tied_sv(pTHX_ srl_iterator_t *iter)
         if (!hash) croak("Out of memory");
 
         hash->store = NULL;
+        hash->cache = NULL;
         tied = (sereal_iterator_tied_t*) hash;
         tied_class_name = "Sereal::Path::Tie::Hash";
         tied->count = count * 2; // for proper iterating
@@ -88,6 +98,10 @@ srl_tie_new_tied_sv(pTHX_ srl_iterator_t *iter)
         Newx(array, 1, sereal_iterator_tied_array_t);
         if (!array) croak("Out of memory");
         array->store = NULL;
+        array->cache = NULL;
+        array->offsets = NULL;
+        array->nvisited = 0;
+        tied_array = array;
 
         tied = (sereal_iterator_tied_t*) array;
         tied_class_name = "Sereal::Path::Tie::Array";
@@ -99,6 +113,7 @@ srl_tie_new_tied_sv(pTHX_ srl_iterator_t *iter)
         Newx(scalar, 1, sereal_iterator_tied_scalar_t);
         if (!scalar) croak("Out of memory");
         scalar->store = NULL;
+        scalar->cache = NULL;
 
         tied = (sereal_iterator_tied_t*) scalar;
         tied_class_name = "Sereal::Path::Tie::Scalar";
@@ -139,9 +154,142 @@ srl_tie_new_tied_sv(pTHX_ srl_iterator_t *iter)
 
     srl_iterator_step_in(aTHX_ tied->iter, 1);
     tied->depth = srl_iterator_stack_depth(aTHX_ tied->iter);
+
+    if (tied_array != NULL)
+        srl_iterator_mark(aTHX_ tied->iter, &tied_array->first);
+
     return result;
 }
 
+/* Position array's iterator at element idx. Positions of elements are
+ * remembered, so each element is stepped over at most once no matter in
+ * which order elements are accessed. */
+SRL_STATIC_INLINE void
+srl_tie_array_goto(pTHX_ sereal_iterator_tied_array_t *this, U32 idx)
+{
+    srl_iterator_mark_t mark;
+    assert(idx < this->count);
+
+    if (this->offsets == NULL) {
+        Newx(this->offsets, this->count, srl_reader_char_ptr);
+        if (this->offsets == NULL) croak("Out of memory");
+        this->offsets[0] = this->first.pos;
+        this->nvisited = 1;
+    }
+
+    Copy(&this->first, &mark, 1, srl_iterator_mark_t);
+    mark.frame.idx = idx < this->nvisited ? idx : this->nvisited - 1;
+    mark.pos = this->offsets[mark.frame.idx];
+    srl_iterator_restore(aTHX_ this->iter, &mark);
+
+    while (this->nvisited <= idx) {
+        srl_iterator_next(aTHX_ this->iter, 1);
+        srl_iterator_mark(aTHX_ this->iter, &mark);
+        this->offsets[this->nvisited++] = mark.pos;
+    }
+}
+
+/* return value of element idx, it's decoded (or tied) only once */
+SRL_STATIC_INLINE SV *
+srl_tie_array_fetch(pTHX_ sereal_iterator_tied_array_t *this, U32 idx)
+{
+    SV *sv, **svptr;
+    if (this->cache != NULL && (svptr = av_fetch(this->cache, idx, 0)) != NULL) {
+        return *svptr;
+    }
+
+    srl_tie_array_goto(aTHX_ this, idx);
+    sv = srl_tie_new_tied_sv(aTHX_ this->iter);
+
+    if (this->cache == NULL)
+        this->cache = newAV();
+
+    av_store(this->cache, idx, SvREFCNT_inc(sv));
+    return sv;
+}
+
+/* value of the pair the iterator is at, i.e. right after the key */
+SRL_STATIC_INLINE SV *
+srl_tie_hash_fetch(pTHX_ sereal_iterator_tied_hash_t *this, const char *keyname, STRLEN keyname_length)
+{
+    SV *sv = srl_tie_new_tied_sv(aTHX_ this->iter);
+    if (this->cache == NULL)
+        this->cache = newHV();
+
+    (void) hv_store(this->cache, keyname, keyname_length, SvREFCNT_inc(sv), 0);
+    return sv;
+}
+
+SRL_STATIC_INLINE SV *
+srl_tie_scalar_fetch(pTHX_ sereal_iterator_tied_scalar_t *this)
+{
+    if (this->cache == NULL)
+        this->cache = SvREFCNT_inc(srl_tie_new_tied_sv(aTHX_ this->iter));
+
+    return this->cache;
+}
+
+/* Fill caches of container and its children down to depth levels (all
+ * levels if depth is negative) in one forward pass over the container */
+SRL_STATIC_INLINE void
+srl_tie_prefetch_array(pTHX_ sereal_iterator_tied_array_t *this, IV depth)
+{
+    U32 idx;
+    if (depth == 0) return;
+
+    for (idx = 0; idx < this->count; idx++) {
+        SV *sv = srl_tie_array_fetch(aTHX_ this, idx);
+        if (depth != 1) srl_tie_prefetch_sv(aTHX_ sv, depth - 1);
+    }
+}
+
+SRL_STATIC_INLINE void
+srl_tie_prefetch_hash(pTHX_ sereal_iterator_tied_hash_t *this, IV depth)
+{
+    SV *sv, **svptr;
+    U32 idx;
+    const char *keyname;
+    STRLEN keyname_length;
+    if (depth == 0 || this->count == 0) return;
+
+    srl_iterator_rewind(aTHX_ this->iter, 0);
+    for (idx = 0; idx < this->count; idx += 2) {
+        assert(this->depth == srl_iterator_stack_depth(aTHX_ this->iter));
+        srl_iterator_hash_key(aTHX_ this->iter, &keyname, &keyname_length);
+
+        // first value wins if keys are duplicated, same as in FETCH
+        svptr = this->cache != NULL ? hv_fetch(this->cache, keyname, keyname_length, 0) : NULL;
+        sv = svptr != NULL ? *svptr : srl_tie_hash_fetch(aTHX_ this, keyname, keyname_length);
+        if (depth != 1) srl_tie_prefetch_sv(aTHX_ sv, depth - 1);
+
+        srl_iterator_next(aTHX_ this->iter, 1);
+    }
+}
+
+SRL_STATIC_INLINE void
+srl_tie_prefetch_sv(pTHX_ SV *sv, IV depth)
+{
+    MAGIC *mg;
+    SV *obj;
+
+    if (depth == 0 || !SvROK(sv) || !SvRMAGICAL(SvRV(sv)))
+        return;
+
+    if ((mg = mg_find(SvRV(sv), PERL_MAGIC_tied)) == NULL
+        && (mg = mg_find(SvRV(sv), PERL_MAGIC_tiedscalar)) == NULL)
+        return;
+
+    obj = mg->mg_obj;
+    if (sv_isa(obj, "Sereal::Path::Tie::Array")) {
+        srl_tie_prefetch_array(aTHX_ INT2PTR(sereal_iterator_tied_array_t*, SvIV(SvRV(obj))), depth);
+    } else if (sv_isa(obj, "Sereal::Path::Tie::Hash")) {
+        srl_tie_prefetch_hash(aTHX_ INT2PTR(sereal_iterator_tied_hash_t*, SvIV(SvRV(obj))), depth);
+    } else if (sv_isa(obj, "Sereal::Path::Tie::Scalar")) {
+        sereal_iterator_tied_scalar_t *scalar = INT2PTR(sereal_iterator_tied_scalar_t*, SvIV(SvRV(obj)));
+        srl_tie_prefetch_sv(aTHX_ srl_tie_scalar_fetch(aTHX_ scalar), depth - 1);
+    }
+}
+
 MODULE = Sereal::Path::Tie   PACKAGE = Sereal::Path::Tie
 PROTOTYPES: DISABLE
 
@@ -174,6 +322,8 @@ DESTROY(this)
   CODE:
     if (this->store != NULL)
         SvREFCNT_dec(this->store);
+    if (this->cache != NULL)
+        SvREFCNT_dec(this->cache);
     if (this->iter != NULL)
         srl_destroy_iterator(aTHX_ this->iter);
     Safefree(this);
@@ -183,13 +333,21 @@ FETCH(this)
     sereal_iterator_tied_scalar_t *this;
   PPCODE:
     if (this->store == NULL) {
-        ST(0) = srl_tie_new_tied_sv(aTHX_ this->iter);
+        ST(0) = sv_2mortal(SvREFCNT_inc(srl_tie_scalar_fetch(aTHX_ this)));
     } else {
         ST(0) = sv_2mortal(SvREFCNT_inc(this->store));
     }
 
     XSRETURN(1);
 
+void
+prefetch(this, depth = 1)
+    sereal_iterator_tied_scalar_t *this;
+    IV depth;
+  CODE:
+    if (depth != 0)
+        srl_tie_prefetch_sv(aTHX_ srl_tie_scalar_fetch(aTHX_ this), depth - 1);
+
 void
 STORE(this, value)
     sereal_iterator_tied_scalar_t *this;
@@ -215,8 +373,11 @@ DESTROY(this)
   CODE:
     if (this->store != NULL)
         SvREFCNT_dec((SV*) this->store);
+    if (this->cache != NULL)
+        SvREFCNT_dec((SV*) this->cache);
     if (this->iter != NULL)
         srl_destroy_iterator(aTHX_ this->iter);
+    Safefree(this->offsets);
     Safefree(this);
 
 void
@@ -236,12 +397,18 @@ FETCH(this, key)
     if (idx == SRL_ITER_NOT_FOUND) {
         ST(0) = &PL_sv_undef;
     } else {
-        srl_iterator_array_goto(aTHX_ this->iter, key);
-        ST(0) = srl_tie_new_tied_sv(aTHX_ this->iter);
+        ST(0) = sv_2mortal(SvREFCNT_inc(srl_tie_array_fetch(aTHX_ this, (U32) idx)));
     }
 
     XSRETURN(1);
 
+void
+prefetch(this, depth = 1)
+    sereal_iterator_tied_array_t *this;
+    IV depth;
+  CODE:
+    srl_tie_prefetch_array(aTHX_ this, depth);
+
 void
 FETCHSIZE(this)
     sereal_iterator_tied_array_t *this;
@@ -341,6 +508,8 @@ DESTROY(this)
   CODE:
     if (this->store != NULL)
         SvREFCNT_dec((SV*) this->store);
+    if (this->cache != NULL)
+        SvREFCNT_dec((SV*) this->cache);
     if (this->iter != NULL)
         srl_destroy_iterator(aTHX_ this->iter);
     Safefree(this);
@@ -351,6 +520,7 @@ FETCH(this, key)
     SV *key;
   PREINIT:
     HE *he;
+    SV **svptr;
     const char *keyname;
     STRLEN keyname_length;
   PPCODE:
@@ -362,14 +532,23 @@ FETCH(this, key)
     }
 
     keyname = SvPV(key, keyname_length);
-    if (srl_iterator_hash_exists(aTHX_ this->iter, keyname, keyname_length) == SRL_ITER_NOT_FOUND) {
+    if (this->cache != NULL && (svptr = hv_fetch(this->cache, keyname, keyname_length, 0)) != NULL) {
+        ST(0) = sv_2mortal(SvREFCNT_inc(*svptr));
+    } else if (srl_iterator_hash_exists(aTHX_ this->iter, keyname, keyname_length) == SRL_ITER_NOT_FOUND) {
         ST(0) = &PL_sv_undef;
     } else {
-        ST(0) = srl_tie_new_tied_sv(aTHX_ this->iter);
+        ST(0) = sv_2mortal(SvREFCNT_inc(srl_tie_hash_fetch(aTHX_ this, keyname, keyname_length)));
     }
 
     XSRETURN(1);
 
+void
+prefetch(this, depth = 1)
+    sereal_iterator_tied_hash_t *this;
+    IV depth;
+  CODE:
+    srl_tie_prefetch_hash(aTHX_ this, depth);
+
 void
 EXISTS(this, key)
     sereal_iterator_tied_hash_t *this;
@@ -384,6 +563,11 @@ EXISTS(this, key)
     }
 
     keyname = SvPV(key, keyname_length);
+    if (this->cache != NULL && hv_exists(this->cache, keyname, keyname_length)) {
+        ST(0) = &PL_sv_yes;
+        XSRETURN(1);
+    }
+
     ST(0) = srl_iterator_hash_exists(aTHX_ this->iter, keyname, keyname_length) == SRL_ITER_NOT_FOUND
           ? &PL_sv_undef
           : &PL_sv_yes;
@@ -11,6 +11,21 @@ our $XS_VERSION = $VERSION; $VERSION= eval $VERSION;
 
 XSLoader::load(__PACKAGE__, $XS_VERSION);
 
+sub prefetch {
+    my ($tie, $depth) = @_;
+    my $type = ref($tie);
+    my $obj = $type eq 'HASH'   ? tied(%$tie)
+            : $type eq 'ARRAY'  ? tied(@$tie)
+            : $type             ? tied($$tie)
+            :                     undef;
+
+    croak("prefetch() expects a value returned by Sereal::Path::Tie->new()")
+        if !$obj || ref($obj) !~ /^Sereal::Path::Tie::(?:Hash|Array|Scalar)$/;
+
+    $obj->prefetch(defined $depth ? $depth : 1);
+    return $tie;
+}
+
 1;
 
 __END__
@@ -32,6 +47,27 @@ Sereal::Path::Tie - interface to Sereal documents via tied variables
   my $tie = Sereal::Path::Tie->new($spi);
   my $val = $tie->{foo}; # return bar
 
+  # decode everything two levels deep in one pass
+  Sereal::Path::Tie::prefetch($tie, 2);
+
+=head1 DESCRIPTION
+
+Tied hashes and arrays look up their elements in the encoded document on
+first access only. Values returned by C<FETCH> are cached per container:
+scalars are decoded once and nested hashes and arrays are returned as the
+same tied variables, so they keep their own caches. Arrays also remember
+the position of every element they passed, so accessing elements in any
+order steps over each of them at most once.
+
+=head2 prefetch($tie, $depth)
+
+Fills the caches of C<$tie> and of its nested containers down to C<$depth>
+levels (1 by default, negative means all levels) in one forward pass over
+the container. After that a loop over a tied array of hashes reading
+few fields of each hash doesn't touch the document anymore. Returns
+C<$tie>. The same is available as a method of tie objects, e.g.
+C<< tied(@$tie)->prefetch($depth) >>.
+
 =head1 AUTHOR
 
 Ivan Kruglov <ivan.kruglov@yahoo.com>
@@ -0,0 +1,56 @@
+#!perl
+use strict;
+use warnings;
+
+use Test::More;
+use Scalar::Util qw/refaddr/;
+use Sereal::Path::Tie;
+use Sereal::Path::Iterator;
+use Sereal::Encoder qw/encode_sereal/;
+
+my $data = {
+    list => [ map { { id => $_, name => "name $_", tags => [ ('tag') x ($_ % 4) ] } } 0 .. 99 ],
+    nested => { a => { b => { c => [ 1, 2, \"scalar" ] } } },
+    plain => [ 1 .. 50 ],
+    empty => [],
+};
+
+my %documents = (
+    plain   => encode_sereal($data),
+    dedupe  => encode_sereal($data, { dedupe_strings => 1 }),
+    zlib    => encode_sereal($data, { compress => Sereal::Encoder::SRL_ZLIB() }),
+);
+
+foreach my $name (sort keys %documents) {
+    my $tie = Sereal::Path::Tie->new(Sereal::Path::Iterator->new($documents{$name}));
+
+    is(refaddr($tie->{list}), refaddr($tie->{list}), "$name: same tied array is returned");
+    is(refaddr($tie->{list}[5]), refaddr($tie->{list}[5]), "$name: same tied hash is returned");
+
+    my $list = $tie->{list};
+    my @order = (reverse(0 .. 99), map { ($_ * 37) % 100 } 0 .. 99);
+    is_deeply([ map { $list->[$_]{id} } @order ], \@order, "$name: elements accessed in any order");
+    is_deeply([ map { $list->[$_]{name} } -3 .. -1 ], [ map { "name $_" } 97 .. 99 ], "$name: negative indexes");
+
+    $tie->{nested}{a}{new} = 'stored';
+    is($tie->{nested}{a}{new}, 'stored', "$name: stored value is kept in cached container");
+    is_deeply($tie->{nested}{a}{b}, $data->{nested}{a}{b}, "$name: nested");
+
+    my $fresh = Sereal::Path::Tie->new(Sereal::Path::Iterator->new($documents{$name}));
+    is(Sereal::Path::Tie::prefetch($fresh, 2), $fresh, "$name: prefetch returns its argument");
+    is_deeply([ map { $_->{id} } @{ $fresh->{list} } ], [ 0 .. 99 ], "$name: loop after prefetch");
+
+    my $all = Sereal::Path::Tie->new(Sereal::Path::Iterator->new($documents{$name}));
+    tied(%$all)->prefetch(-1);
+    is_deeply($all, $data, "$name: all levels prefetched");
+
+    my $array = Sereal::Path::Tie->new(Sereal::Path::Iterator->new(encode_sereal($data->{plain})));
+    is($array->[10], 11, "$name: partial access");
+    Sereal::Path::Tie::prefetch($array);
+    is_deeply([ @$array ], $data->{plain}, "$name: prefetch after partial access");
+}
+
+ok(!eval { Sereal::Path::Tie::prefetch({}); 1 }, "prefetch of not tied hash croaks");
+like($@, qr/expects a value returned by Sereal::Path::Tie->new/, "prefetch error message");
+
+done_testing();
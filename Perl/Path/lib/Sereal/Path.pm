@@ -11,8 +11,14 @@ our $XS_VERSION = $VERSION; $VERSION= eval $VERSION;
 
 XSLoader::load(__PACKAGE__, $XS_VERSION);
 
+# [?(...)] filter, strings inside of it may contain any characters
+my $filter_re = qr/\[\?\(((?:[^()"']|"(?:[^"\\]|\\.)*"|'(?:[^'\\]|\\.)*')*)\)\]/;
+my $number_re = qr/[-+]?(?:[0-9]+\.?[0-9]*|\.[0-9]+)(?:[eE][-+]?[0-9]+)?/;
+
 sub _normalize {
-    my ($self, $x) = @_;
+    my ($self, $x, $filters) = @_;
+    # filters are replaced by placeholders, otherwise they would be split
+    $x =~ s/$filter_re/push(@$filters, $1); "[?#$#$filters]"/eg if $filters;
     #$x =~ s/[\['](\??\(.*?\))[\]']/_callback_01($self,$1)/eg;
     $x =~ s/'?\.'?|\['?/;/g;
     $x =~ s/;;;|;;/;..;/g;
@@ -22,12 +28,66 @@ sub _normalize {
     return $x;
 }
 
-sub traverse {
+sub _unquote {
+    my ($str) = @_;
+    $str =~ s/\\(.)/$1/g;
+    return $str;
+}
+
+# Parse filter like '@.name == "value"' into structure understood by
+# Sereal::Path::Compiled: [ text, [ keys ], operator, value, is_string ]
+sub _parse_filter {
+    my ($text) = @_;
+    my $x = $text;
+    my @keys;
+
+    $x =~ s/^\s*\@// or croak("Invalid filter '$text': it should start with '\@'");
+    while (1) {
+        if ($x =~ s/^\.([^\s.\[=!<>]+)//) {
+            push @keys, $1;
+        } elsif ($x =~ s/^\[\s*"((?:[^"\\]|\\.)*)"\s*\]// || $x =~ s/^\[\s*'((?:[^'\\]|\\.)*)'\s*\]//) {
+            push @keys, _unquote($1);
+        } elsif ($x =~ s/^\[\s*(-?[0-9]+)\s*\]//) {
+            push @keys, $1;
+        } else {
+            last;
+        }
+    }
+
+    $x =~ s/^\s+//;
+    return [ "?($text)", \@keys ] if $x eq '';
+
+    $x =~ s/^(==|!=|<=|>=|<|>)\s*// or croak("Invalid filter '$text': unknown operator");
+    my $op = $1;
+
+    if ($x =~ /^"((?:[^"\\]|\\.)*)"\s*$/ || $x =~ /^'((?:[^'\\]|\\.)*)'\s*$/) {
+        return [ "?($text)", \@keys, $op, _unquote($1), 1 ];
+    } elsif ($x =~ /^($number_re)\s*$/) {
+        return [ "?($text)", \@keys, $op, $1, 0 ];
+    }
+
+    croak("Invalid filter '$text': value should be a number or a quoted string");
+}
+
+sub compile {
     my ($self, $query) = @_;
-    my $norm = $self->_normalize($query);
+    my @filters;
+    my $norm = $self->_normalize($query, \@filters);
     $norm =~ s/^\$;//;
-    my @expr = split(/;/, $norm);
-    $self->_traverse(\@expr, '$');
+    my @expr = map { /^\?#([0-9]+)$/ ? _parse_filter($filters[$1]) : $_ } split(/;/, $norm);
+    return Sereal::Path::Compiled->_new(\@expr);
+}
+
+sub traverse {
+    my ($self, $query) = @_;
+    $query = $self->compile($query) unless ref $query;
+    $self->_traverse([ $query ]);
+    return $self->results->[0];
+}
+
+sub traverse_many {
+    my ($self, $queries) = @_;
+    $self->_traverse([ map { ref $_ ? $_ : $self->compile($_) } @$queries ]);
     return $self->results;
 }
 
@@ -118,12 +178,62 @@ between XPath, JSONPath and Sereal::Path:
   |               [,]                 [,]                     Union operator in XPath results in a combination of node sets.
                                                               JSONPath allows alternate names or array indices as a set.
   n/a             [start:end:step]    [start:end:step]        Array slice operator borrowed from ES4.
-  []              ?()                 not impl                Applies a filter (script) expression.
+  []              ?()                 ?()                     Applies a filter expression, see L</Filters>.
   n/a             ()                  not impl                Script expression, using the underlying script engine.
   ()              n/a                 n/a                     Grouping in Xpath
 
 Items which are marked as 'not impl' will be implemented at later stages of the project.
 
+=head2 Compiled queries
+
+  my $sp = Sereal::Path->new($encoded);
+  my @compiled = map { Sereal::Path->compile($_) } ('$[*][foo]', '$[0][bar]');
+
+  my $foos = $sp->traverse($compiled[0]);
+  my ($foos, $bars) = @{ $sp->traverse_many(\@compiled) };
+
+=over 4
+
+=item compile($query)
+
+Parses the query once and returns a C<Sereal::Path::Compiled> object. It can
+be passed to C<traverse>, C<traverse_many>, C<value> and C<values> instead of
+the string, and reused with any document.
+
+=item traverse_many(\@queries)
+
+Evaluates several queries (compiled or strings) in a single walk over the
+document. Queries starting with the same steps share them, so common prefixes
+are evaluated once. Returns an arrayref with the results of each query, in
+the same order as the queries.
+
+=back
+
+=head2 Filters
+
+  # elements of items whose status is "active"
+  $sp->traverse('$.items[?(@.status == "active")]');
+
+  # ids of items with price over 100 and of those having a discount
+  $sp->traverse('$.items[?(@.price > 100)].id');
+  $sp->traverse('$.items[?(@.discount)].id');
+
+A filter selects elements of an array (or values of a hash) for which the
+condition holds. The condition is either C<@> followed by a path to a value
+inside of the element (C<@.name>, C<@["some key"]>, C<@[0]>, or nested like
+C<@.meta.age>), which is true if the value exists, or such path compared to a
+literal by one of C<==>, C<!=>, C<< < >>, C<< <= >>, C<< > >> or C<< >= >>.
+
+The literal is either a quoted string or a number. Encoded strings are
+compared with string literals bytewise, everything else is compared
+numerically: a string which looks like a number is compared with a number
+literal, and a number with a string literal which looks like a number. The values are compared in their encoded form, elements are only
+decoded if they match. Values which can't be compared, like references or
+missing values, don't match any comparison (including C<!=>).
+
+Only a single comparison is supported, C<&&>, C<||> and script expressions are
+not.
+
 =head2 Important
 
 Sereal::Path is still under development. It's possible that API will be change at any moment.
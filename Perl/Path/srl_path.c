@@ -76,22 +76,25 @@ extern "C" {
     }                                        \
 } STMT_END
 
-SRL_STATIC_INLINE void srl_parse_next(pTHX_ srl_path_t *path, int expr_idx, SV *route);
-SRL_STATIC_INLINE void srl_parse_next_int(pTHX_ srl_path_t *path, int expr_idx, SV *route, IV n);
-SRL_STATIC_INLINE void srl_parse_next_str(pTHX_ srl_path_t *path, int expr_idx, SV *route,
-                                          const char *str, STRLEN len);
-
-SRL_STATIC_INLINE void srl_parse_hash(pTHX_ srl_path_t *path, int expr_idx, SV *route);
-SRL_STATIC_INLINE void srl_parse_hash_all(pTHX_ srl_path_t *path, int expr_idx, SV *route);
-SRL_STATIC_INLINE void srl_parse_hash_list(pTHX_ srl_path_t *path, int expr_idx, SV *route, const char *list, STRLEN list_len);
-SRL_STATIC_INLINE void srl_parse_hash_item(pTHX_ srl_path_t *path, int expr_idx, SV *route, const char *str, STRLEN str_len);
-
-SRL_STATIC_INLINE void srl_parse_array(pTHX_ srl_path_t *path, int expr_idx, SV *route);
-SRL_STATIC_INLINE void srl_parse_array_all(pTHX_ srl_path_t *path, int expr_idx, SV *route);
-SRL_STATIC_INLINE void srl_parse_array_list(pTHX_ srl_path_t *path, int expr_idx, SV *route, const char *list, STRLEN list_len);
-SRL_STATIC_INLINE void srl_parse_array_range(pTHX_ srl_path_t *path, int expr_idx, SV *route, int *range);
-SRL_STATIC_INLINE void srl_parse_array_item(pTHX_ srl_path_t *path, int expr_idx, SV *route, I32 idx);
-SRL_STATIC_INLINE void run_until(pTHX_ srl_path_t *path, UV expected_depth, U32 expected_idx);
+SRL_STATIC_INLINE void srl_parse_next(pTHX_ srl_path_t *path, srl_path_node_t *node);
+
+SRL_STATIC_INLINE void srl_parse_hash(pTHX_ srl_path_t *path, srl_path_node_t *node);
+SRL_STATIC_INLINE void srl_parse_hash_all(pTHX_ srl_path_t *path, srl_path_node_t *node);
+SRL_STATIC_INLINE void srl_parse_hash_list(pTHX_ srl_path_t *path, srl_path_node_t *node);
+SRL_STATIC_INLINE void srl_parse_hash_item(pTHX_ srl_path_t *path, srl_path_node_t *node, const char *str, STRLEN str_len);
+
+SRL_STATIC_INLINE void srl_parse_array(pTHX_ srl_path_t *path, srl_path_node_t *node);
+SRL_STATIC_INLINE void srl_parse_array_all(pTHX_ srl_path_t *path, srl_path_node_t *node);
+SRL_STATIC_INLINE void srl_parse_array_list(pTHX_ srl_path_t *path, srl_path_node_t *node);
+SRL_STATIC_INLINE void srl_parse_array_range(pTHX_ srl_path_t *path, srl_path_node_t *node, const int *range);
+SRL_STATIC_INLINE void srl_parse_array_item(pTHX_ srl_path_t *path, srl_path_node_t *node, I32 idx);
+
+SRL_STATIC_INLINE void srl_parse_filter(pTHX_ srl_path_t *path, srl_path_node_t *node, int is_hash);
+SRL_STATIC_INLINE int srl_path_filter_match(pTHX_ srl_path_t *path, const srl_path_step_t *step);
+SRL_STATIC_INLINE int srl_path_filter_cmp(pTHX_ const srl_path_filter_t *filter, int type, const srl_iterator_scalar_t *val);
+SRL_STATIC_INLINE int srl_path_str_to_number(pTHX_ const char *str, STRLEN len, int *is_int, IV *iv, NV *nv);
+SRL_STATIC_INLINE void step_out_until(pTHX_ srl_path_t *path, IV expected_depth);
+SRL_STATIC_INLINE void run_until(pTHX_ srl_path_t *path, IV expected_depth, U32 expected_idx);
 
 SRL_STATIC_INLINE int is_all(const char *str, STRLEN len);
 SRL_STATIC_INLINE int is_list(const char *str, STRLEN len);
@@ -99,7 +102,6 @@ SRL_STATIC_INLINE int is_number(const char *str, STRLEN len);
 SRL_STATIC_INLINE int * is_range(const char *str, STRLEN len, int *out);
 SRL_STATIC_INLINE int next_item_in_list(const char *list, STRLEN list_len,
                                         const char **item_out, STRLEN *item_len_out);
-SRL_STATIC_INLINE void print_route(SV *route, const char *str);
 
 srl_path_t *
 srl_build_path_struct(pTHX_ HV *opt)
@@ -109,8 +111,9 @@ srl_build_path_struct(pTHX_ HV *opt)
     if (path == NULL) croak("Out of memory");
 
     path->iter = NULL;
-    path->expr = NULL;
     path->results = NULL;
+    path->nodes = NULL;
+    path->nodes_size = 0;
     path->i_own_iterator = 0;
 
     if (opt != NULL) {}
@@ -122,45 +125,276 @@ srl_destroy_path(pTHX_ srl_path_t *path)
 {
     CLEAR_RESULTS(path);
     CLEAR_ITERATOR(path);
+    Safefree(path->nodes);
     Safefree(path);
 }
 
 void
 srl_path_set(pTHX_ srl_path_t *path, SV *src)
 {
-    path->expr = NULL;
     CLEAR_RESULTS(path);
-    CLEAR_ITERATOR(path);
 
     if (sv_isobject(src) && sv_isa(src, "Sereal::Path::Iterator")) {
+        CLEAR_ITERATOR(path);
         path->iter = INT2PTR(srl_iterator_ptr, SvIV((SV*) SvRV(src)));
         path->i_own_iterator = 0;
     } else if (SvPOK(src)) {
-        path->iter = srl_build_iterator_struct(aTHX_ NULL);
-        path->i_own_iterator = 1;
+        /* own iterator is kept, so setting the same compressed
+         * document again doesn't decompress it again */
+        if (!path->iter || !path->i_own_iterator) {
+            path->iter = srl_build_iterator_struct(aTHX_ NULL);
+            path->i_own_iterator = 1;
+        }
+
         srl_iterator_set(aTHX_ path->iter, src);
     } else {
         croak("Sereal::Path: input should be either Sereal::Path::Iterator object or encoded Sereal document");
     }
 }
 
+/* filters come from Perl as [ text, [ keys ], operator, value, is_string ] */
+SRL_STATIC_INLINE AV *
+srl_path_filter_av(pTHX_ AV *av, SSize_t idx)
+{
+    SV **svp = av_fetch(av, idx, 0);
+    if (svp && SvROK(*svp) && SvTYPE(SvRV(*svp)) == SVt_PVAV)
+        return (AV*) SvRV(*svp);
+    return NULL;
+}
+
+SRL_STATIC_INLINE void
+srl_path_compile_filter(pTHX_ srl_path_compiled_t *prog, srl_path_step_t *step,
+                        AV *filter, srl_path_item_t *items)
+{
+    SV **svp;
+    SSize_t i, nkeys;
+    const char *op = NULL;
+    srl_path_filter_t *f = &step->filter;
+    AV *keys = srl_path_filter_av(aTHX_ filter, 1);
+
+    step->flags = SRL_PATH_STEP_FILTER;
+    step->items = items;
+    step->nitems = nkeys = keys ? av_len(keys) + 1 : 0;
+
+    /* copies are owned by prog->expr */
+    for (i = 0; i < nkeys; ++i) {
+        SV *key;
+        svp = av_fetch(keys, i, 0);
+        key = svp ? newSVsv(*svp) : newSVpvs("");
+        av_push(prog->expr, key);
+
+        items[i].str = SvPV(key, items[i].len);
+        items[i].number = atoi(items[i].str);
+    }
+
+    svp = av_fetch(filter, 2, 0);
+    if (svp && SvOK(*svp)) op = SvPV_nolen(*svp);
+
+    if      (op == NULL)       f->op = SRL_PATH_FILTER_EXISTS;
+    else if (strEQ(op, "==")) f->op = SRL_PATH_FILTER_EQ;
+    else if (strEQ(op, "!=")) f->op = SRL_PATH_FILTER_NE;
+    else if (strEQ(op, "<"))  f->op = SRL_PATH_FILTER_LT;
+    else if (strEQ(op, "<=")) f->op = SRL_PATH_FILTER_LE;
+    else if (strEQ(op, ">"))  f->op = SRL_PATH_FILTER_GT;
+    else if (strEQ(op, ">=")) f->op = SRL_PATH_FILTER_GE;
+    else {
+        srl_destroy_path_compiled(aTHX_ prog);
+        croak("Unknown filter operator '%s'", op);
+    }
+
+    if (f->op != SRL_PATH_FILTER_EXISTS) {
+        SV *value;
+        svp = av_fetch(filter, 3, 0);
+        value = svp ? newSVsv(*svp) : newSVpvs("");
+        av_push(prog->expr, value);
+
+        f->str = SvPV(value, f->len);
+        svp = av_fetch(filter, 4, 0);
+        f->is_string = svp && SvTRUE(*svp);
+        f->is_number = srl_path_str_to_number(aTHX_ f->str, f->len, &f->is_int, &f->iv, &f->nv);
+    }
+}
+
+/* Parse every component of expression once. Components are interpreted
+ * as hash keys or array indexes depending on what they are applied to,
+ * so all possible interpretations are stored in the step */
+srl_path_compiled_t *
+srl_path_compile(pTHX_ AV *expr)
+{
+    srl_path_compiled_t *prog;
+    srl_path_step_t *step;
+    srl_path_item_t *items;
+    const char *item;
+    STRLEN item_len;
+    UV nitems = 0;
+    SSize_t i, nsteps = av_len(expr) + 1;
+
+    Newxz(prog, 1, srl_path_compiled_t);
+    prog->expr = newAV();
+    prog->nsteps = nsteps;
+    av_extend(prog->expr, nsteps);
+
+    for (i = 0; i < nsteps; ++i) {
+        SV *copy;
+        AV *filter = srl_path_filter_av(aTHX_ expr, i);
+
+        if (filter) {
+            SV **svp = av_fetch(filter, 0, 0);
+            AV *keys = srl_path_filter_av(aTHX_ filter, 1);
+            copy = svp ? newSVsv(*svp) : newSVpvs("");
+            av_push(prog->expr, copy);
+            if (keys) nitems += av_len(keys) + 1;
+        } else {
+            SV **svp = av_fetch(expr, i, 0);
+            copy = svp ? newSVsv(*svp) : newSVpvs("");
+            av_push(prog->expr, copy);
+
+            item = NULL;
+            while (next_item_in_list(SvPV_nolen(copy), SvCUR(copy), &item, &item_len))
+                nitems++;
+        }
+    }
+
+    Newxz(prog->steps, nsteps ? nsteps : 1, srl_path_step_t);
+    Newxz(prog->items, nitems ? nitems : 1, srl_path_item_t);
+
+    for (i = 0, items = prog->items; i < nsteps; ++i) {
+        AV *filter = srl_path_filter_av(aTHX_ expr, i);
+
+        step = &prog->steps[i];
+        step->str = SvPV(AvARRAY(prog->expr)[i], step->len);
+
+        if (filter) {
+            srl_path_compile_filter(aTHX_ prog, step, filter, items);
+            items += step->nitems;
+            continue;
+        }
+
+        if (is_all(step->str, step->len)) {
+            step->flags = SRL_PATH_STEP_ALL;
+            continue;
+        }
+
+        if (is_number(step->str, step->len)) {
+            step->flags |= SRL_PATH_STEP_NUMBER;
+            step->number = atoi(step->str);
+        }
+
+        if (is_list(step->str, step->len)) {
+            step->flags |= SRL_PATH_STEP_LIST;
+            step->items = items;
+
+            item = NULL;
+            while (next_item_in_list(step->str, step->len, &item, &item_len)) {
+                if (item_len == 0) continue;
+                items->str = item;
+                items->len = item_len;
+                items->number = atoi(item);
+                items++;
+            }
+
+            step->nitems = items - step->items;
+        }
+
+        if (is_range(step->str, step->len, step->range)) {
+            step->flags |= SRL_PATH_STEP_RANGE;
+        }
+    }
+
+    return prog;
+}
+
 void
-srl_path_traverse(pTHX_ srl_path_t *path, AV *expr, SV *route)
+srl_destroy_path_compiled(pTHX_ srl_path_compiled_t *prog)
 {
-    SV *route_copy;
-    if (!path->iter) croak("No document to traverse");
+    SvREFCNT_dec(prog->expr);
+    Safefree(prog->steps);
+    Safefree(prog->items);
+    Safefree(prog);
+}
+
+SRL_STATIC_INLINE int
+srl_path_step_eq(const srl_path_step_t *a, const srl_path_step_t *b)
+{
+    return a->len == b->len && memcmp(a->str, b->str, a->len) == 0;
+}
 
-    assert(expr != NULL);
-    assert(route != NULL);
+/* All programs are merged into a prefix tree and the document is walked
+ * once. Equal leading steps of different programs share a node, so they are
+ * evaluated once. Each program gets own array of results. */
+void
+srl_path_traverse(pTHX_ srl_path_t *path, srl_path_compiled_t **programs, UV nprograms)
+{
+    UV i, j, used, nnodes = 1;
+    srl_path_node_t *root, *node, *child, *last;
+    SV **results;
 
-    CLEAR_RESULTS(path);
+    if (!path->iter) croak("No document to traverse");
 
+    CLEAR_RESULTS(path);
     path->results = newAV();
-    path->expr = expr;
-    route_copy = sv_2mortal(newSVsv(route));
+    if (nprograms == 0) return;
+
+    for (i = 0; i < nprograms; ++i)
+        nnodes += programs[i]->nsteps;
+
+    if (path->nodes_size < nnodes) {
+        Renew(path->nodes, nnodes, srl_path_node_t);
+        path->nodes_size = nnodes;
+    }
+
+    root = path->nodes;
+    Zero(root, 1, srl_path_node_t);
+    used = 1;
+
+    av_extend(path->results, nprograms - 1);
+    for (i = 0; i < nprograms; ++i) {
+        srl_path_compiled_t *prog = programs[i];
+
+        node = root;
+        for (j = 0; j < prog->nsteps; ++j) {
+            const srl_path_step_t *step = &prog->steps[j];
+
+            last = NULL;
+            for (child = node->child; child; child = child->sibling) {
+                if (srl_path_step_eq(child->step, step)) break;
+                last = child;
+            }
+
+            if (child == NULL) {
+                child = &path->nodes[used++];
+                Zero(child, 1, srl_path_node_t);
+                child->step = step;
+                if (last) last->sibling = child;
+                else      node->child = child;
+            }
+
+            node = child;
+        }
+
+        if (node->results == NULL) {
+            node->results = newAV();
+            av_push(path->results, newRV_noinc((SV*) node->results));
+        } else {
+            av_push(path->results, newRV_inc((SV*) node->results));
+        }
+    }
 
     srl_iterator_reset(aTHX_ path->iter);
-    srl_parse_next(aTHX_ path, 0, route_copy);
+    srl_parse_next(aTHX_ path, root);
+
+    /* equal programs share results, give each its own copy */
+    results = AvARRAY(path->results);
+    for (i = 1; i < nprograms; ++i) {
+        for (j = 0; j < i; ++j) {
+            if (SvRV(results[i]) == SvRV(results[j])) {
+                AV *copy = av_make(av_len((AV*) SvRV(results[i])) + 1, AvARRAY((AV*) SvRV(results[i])));
+                SvREFCNT_dec(results[i]);
+                results[i] = newRV_noinc((SV*) copy);
+                break;
+            }
+        }
+    }
 }
 
 SV *
@@ -171,79 +405,64 @@ srl_path_results(pTHX_ srl_path_t *path)
     return sv_2mortal(newRV_noinc((SV*) results));
 }
 
+/* iterator is at the value matched by all steps up to the node */
 SRL_STATIC_INLINE void
-srl_parse_next(pTHX_ srl_path_t *path, int expr_idx, SV *route)
+srl_parse_next(pTHX_ srl_path_t *path, srl_path_node_t *node)
 {
     U32 type;
+    UV length;
+    IV depth;
+    srl_path_node_t *child;
     srl_iterator_t *iter = path->iter;
 
-    assert(route != NULL);
-    SRL_PATH_TRACE("expr_idx=%d", expr_idx);
-
     if (srl_iterator_eof(aTHX_ iter)) return;
-    if (expr_idx > av_len(path->expr)) { /* scaned entiry expr */
-        SV *res;
-        print_route(route, "to decode");
-        res = srl_iterator_decode(aTHX_ iter);
+    if (node->results) { /* some programs end here */
+        SV *res = srl_iterator_decode(aTHX_ iter);
         SvREFCNT_inc(res);
-        av_push(path->results, res); /* TODO store route if needed */
-        return;
+        av_push(node->results, res);
     }
 
-    type = srl_iterator_info(aTHX_ iter, NULL, NULL, NULL);
+    if (node->child == NULL) return;
+
+    /* nothing to match in empty containers */
+    type = srl_iterator_info(aTHX_ iter, &length, NULL, NULL);
+    if (length == 0) return;
+
     if ((type & SRL_ITERATOR_INFO_HASH) == SRL_ITERATOR_INFO_HASH) {
         srl_iterator_step_in(aTHX_ iter, 1);
-        srl_parse_hash(aTHX_ path, expr_idx, route);
+        depth = srl_iterator_stack_depth(aTHX_ iter);
+        for (child = node->child; child; child = child->sibling) {
+            step_out_until(aTHX_ path, depth);
+            srl_parse_hash(aTHX_ path, child);
+        }
     } else if ((type & SRL_ITERATOR_INFO_ARRAY) == SRL_ITERATOR_INFO_ARRAY) {
         srl_iterator_step_in(aTHX_ iter, 1);
-        srl_parse_array(aTHX_ path, expr_idx, route);
+        depth = srl_iterator_stack_depth(aTHX_ iter);
+        for (child = node->child; child; child = child->sibling) {
+            step_out_until(aTHX_ path, depth);
+            srl_parse_array(aTHX_ path, child);
+        }
     }
 }
 
 SRL_STATIC_INLINE void
-srl_parse_next_str(pTHX_ srl_path_t *path, int expr_idx, SV *route,
-                   const char *str, STRLEN len)
-{
-    STRLEN route_len = SvCUR(route);
-    sv_catpvf(route, ";%.*s", (int) len, str); /* append parsed object to route */
-    srl_parse_next(aTHX_ path, expr_idx, route);
-    SvCUR_set(route, route_len);  /* restore original value */
-}
-
-SRL_STATIC_INLINE void
-srl_parse_next_int(pTHX_ srl_path_t *path, int expr_idx, SV *route, IV n)
+srl_parse_hash(pTHX_ srl_path_t *path, srl_path_node_t *node)
 {
-    STRLEN route_len = SvCUR(route);
-    sv_catpvf(route, ";[%"UVuf"]", n); /* append parsed object to route */
-    srl_parse_next(aTHX_ path, expr_idx, route);
-    SvCUR_set(route, route_len);  /* restore original value */
-}
-
-SRL_STATIC_INLINE void
-srl_parse_hash(pTHX_ srl_path_t *path, int expr_idx, SV *route)
-{
-    const char *loc_str;
-    STRLEN loc_len;
-    SV *loc;
-
-    assert(route != NULL);
-    assert(expr_idx >= 0);
-    assert(expr_idx <= av_len(path->expr));
-
-    loc   = *av_fetch(path->expr, expr_idx, 0);
-    loc_str = SvPV(loc, loc_len);
-
-    if (is_all(loc_str, loc_len)) {                                                     /* * */
-        srl_parse_hash_all(aTHX_ path, expr_idx, route);
-    } else if (is_list(loc_str, loc_len)) {                                             /* [name1,name2] */
-        srl_parse_hash_list(aTHX_ path, expr_idx, route, loc_str, loc_len);
+    const srl_path_step_t *step = node->step;
+
+    if (step->flags & SRL_PATH_STEP_FILTER) {                                           /* ?(@.name == "value") */
+        srl_parse_filter(aTHX_ path, node, 1);
+    } else if (step->flags & SRL_PATH_STEP_ALL) {                                       /* * */
+        srl_parse_hash_all(aTHX_ path, node);
+    } else if (step->flags & SRL_PATH_STEP_LIST) {                                      /* [name1,name2] */
+        srl_parse_hash_list(aTHX_ path, node);
     } else {                                                                            /* name */
-        srl_parse_hash_item(aTHX_ path, expr_idx, route, loc_str, loc_len);
+        srl_parse_hash_item(aTHX_ path, node, step->str, step->len);
     }
 }
 
 SRL_STATIC_INLINE void
-srl_parse_hash_all(pTHX_ srl_path_t *path, int expr_idx, SV *route)
+srl_parse_hash_all(pTHX_ srl_path_t *path, srl_path_node_t *node)
 {
     srl_iterator_ptr iter = path->iter;
     IV depth = srl_iterator_stack_depth(aTHX_ iter);
@@ -259,37 +478,36 @@ srl_parse_hash_all(pTHX_ srl_path_t *path, int expr_idx, SV *route)
         srl_iterator_hash_key(aTHX_ iter, &item, &item_len);
         SRL_PATH_TRACE("walk over item=%.*s in hash at depth=%"IVdf,
                        (int) item_len, item, srl_iterator_stack_depth(aTHX_ iter));
-        srl_parse_next_int(aTHX_ path, expr_idx + 1, route, idx);
+        srl_parse_next(aTHX_ path, node);
     }
 }
 
 SRL_STATIC_INLINE void
-srl_parse_hash_list(pTHX_ srl_path_t *path, int expr_idx, SV *route,
-                   const char *list, STRLEN list_len)
+srl_parse_hash_list(pTHX_ srl_path_t *path, srl_path_node_t *node)
 {
-    STRLEN item_len;
-    const char *item = NULL;
+    UV i;
+    const srl_path_step_t *step = node->step;
     srl_iterator_ptr iter = path->iter;
     IV depth = srl_iterator_stack_depth(aTHX_ iter);
 
     SRL_PATH_TRACE("parse items '%.*s' in hash of size=%d at depth=%"IVdf,
-                   (int) list_len, list, srl_iterator_stack_length(aTHX_ iter), depth);
+                   (int) step->len, step->str, srl_iterator_stack_length(aTHX_ iter), depth);
 
-    while (next_item_in_list(list, list_len, &item, &item_len)) {
-        assert(srl_iterator_stack_depth(aTHX_ iter) == depth);
-        if (item_len == 0) continue;
+    for (i = 0; i < step->nitems; ++i) {
+        const srl_path_item_t *item = &step->items[i];
+        step_out_until(aTHX_ path, depth);
 
         SRL_PATH_TRACE("scan for item=%.*s in hash at depth=%"IVdf,
-                       (int) item_len, item, srl_iterator_stack_depth(aTHX_ iter));
+                       (int) item->len, item->str, srl_iterator_stack_depth(aTHX_ iter));
 
-        if (srl_iterator_hash_exists(aTHX_ iter, item, item_len) != SRL_ITER_NOT_FOUND) {
-            srl_parse_next_str(aTHX_ path, expr_idx + 1, route, item, item_len);
+        if (srl_iterator_hash_exists(aTHX_ iter, item->str, item->len) != SRL_ITER_NOT_FOUND) {
+            srl_parse_next(aTHX_ path, node);
         }
     }
 }
 
 SRL_STATIC_INLINE void
-srl_parse_hash_item(pTHX_ srl_path_t *path, int expr_idx, SV *route,
+srl_parse_hash_item(pTHX_ srl_path_t *path, srl_path_node_t *node,
                     const char *str, STRLEN str_len)
 {
     srl_iterator_ptr iter = path->iter;
@@ -299,38 +517,30 @@ srl_parse_hash_item(pTHX_ srl_path_t *path, int expr_idx, SV *route,
                    srl_iterator_stack_depth(aTHX_ iter));
 
     if (srl_iterator_hash_exists(aTHX_ iter, str, str_len) != SRL_ITER_NOT_FOUND) {
-        srl_parse_next_str(aTHX_ path, expr_idx + 1, route, str, str_len);
+        srl_parse_next(aTHX_ path, node);
     }
 }
 
 SRL_STATIC_INLINE void
-srl_parse_array(pTHX_ srl_path_t *path, int expr_idx, SV *route)
+srl_parse_array(pTHX_ srl_path_t *path, srl_path_node_t *node)
 {
-    int range[3];
-    const char *loc_str;
-    STRLEN loc_len;
-    SV *loc;
-
-    assert(route != NULL);
-    assert(expr_idx >= 0);
-    assert(expr_idx <= av_len(path->expr));
-
-    loc = *av_fetch(path->expr, expr_idx, 0);
-    loc_str = SvPV(loc, loc_len);
-
-    if (is_all(loc_str, loc_len)) {                                                     /* * */
-        srl_parse_array_all(aTHX_ path, expr_idx, route);
-    } else if (is_number(loc_str, loc_len)) {                                           /* [10] */
-        srl_parse_array_item(aTHX_ path, expr_idx, route, atoi(loc_str));
-    } else if (is_list(loc_str, loc_len)) {                                             /* [0,1,2] */
-        srl_parse_array_list(aTHX_ path, expr_idx, route, loc_str, loc_len);
-    } else if (is_range(loc_str, loc_len, (int*) &range)) {                             /* [start:stop:step] */
-        srl_parse_array_range(aTHX_ path, expr_idx, route, (int*) &range);
+    const srl_path_step_t *step = node->step;
+
+    if (step->flags & SRL_PATH_STEP_FILTER) {                                           /* ?(@.name == "value") */
+        srl_parse_filter(aTHX_ path, node, 0);
+    } else if (step->flags & SRL_PATH_STEP_ALL) {                                       /* * */
+        srl_parse_array_all(aTHX_ path, node);
+    } else if (step->flags & SRL_PATH_STEP_NUMBER) {                                    /* [10] */
+        srl_parse_array_item(aTHX_ path, node, step->number);
+    } else if (step->flags & SRL_PATH_STEP_LIST) {                                      /* [0,1,2] */
+        srl_parse_array_list(aTHX_ path, node);
+    } else if (step->flags & SRL_PATH_STEP_RANGE) {                                     /* [start:stop:step] */
+        srl_parse_array_range(aTHX_ path, node, step->range);
     }
 }
 
 SRL_STATIC_INLINE void
-srl_parse_array_all(pTHX_ srl_path_t *path, int expr_idx, SV *route)
+srl_parse_array_all(pTHX_ srl_path_t *path, srl_path_node_t *node)
 {
     U32 idx;
     srl_iterator_ptr iter = path->iter;
@@ -345,39 +555,38 @@ srl_parse_array_all(pTHX_ srl_path_t *path, int expr_idx, SV *route)
         SRL_PATH_TRACE("walk over item=%d in array at depth=%d",
                        idx, (int) srl_iterator_stack_depth(aTHX_ iter));
 
-        srl_parse_next_int(aTHX_ path, expr_idx + 1, route, idx);
+        srl_parse_next(aTHX_ path, node);
     }
 }
 
 SRL_STATIC_INLINE void
-srl_parse_array_list(pTHX_ srl_path_t *path, int expr_idx, SV *route,
-                     const char *list, STRLEN list_len)
+srl_parse_array_list(pTHX_ srl_path_t *path, srl_path_node_t *node)
 {
+    UV i;
     I32 idx;
-    STRLEN item_len;
-    const char *item = NULL;
+    const srl_path_step_t *step = node->step;
     srl_iterator_ptr iter = path->iter;
     IV depth = srl_iterator_stack_depth(aTHX_ iter);
 
     SRL_PATH_TRACE("parse items '%.*s' in array of size=%d at depth=%"IVdf,
-                   (int) list_len, list, srl_iterator_stack_length(aTHX_ iter), depth);
+                   (int) step->len, step->str, srl_iterator_stack_length(aTHX_ iter), depth);
 
-    while (next_item_in_list(list, list_len, &item, &item_len)) {
-        if (item_len == 0) continue;
+    for (i = 0; i < step->nitems; ++i) {
+        idx = step->items[i].number;
+        step_out_until(aTHX_ path, depth);
 
-        idx = atoi(item);
         SRL_PATH_TRACE("scan for item=%d in array at depth=%"IVdf,
                        idx, srl_iterator_stack_depth(aTHX_ iter));
 
         if (srl_iterator_array_exists(aTHX_ iter, idx) != SRL_ITER_NOT_FOUND) {
             srl_iterator_array_goto(aTHX_ iter, idx);
-            srl_parse_next_int(aTHX_ path, expr_idx + 1, route, idx);
+            srl_parse_next(aTHX_ path, node);
         }
     }
 }
 
 SRL_STATIC_INLINE void
-srl_parse_array_range(pTHX_ srl_path_t *path, int expr_idx, SV *route, int *range)
+srl_parse_array_range(pTHX_ srl_path_t *path, srl_path_node_t *node, const int *range)
 {
     I32 idx, start, stop, step;
     srl_iterator_ptr iter = path->iter;
@@ -405,12 +614,12 @@ srl_parse_array_range(pTHX_ srl_path_t *path, int expr_idx, SV *route, int *rang
         SRL_PATH_TRACE("walk over item=%d in array at depth=%d",
                        idx, (int) srl_iterator_stack_depth(aTHX_ iter));
 
-        srl_parse_next_int(aTHX_ path, expr_idx + 1, route, idx);
+        srl_parse_next(aTHX_ path, node);
     }
 }
 
 SRL_STATIC_INLINE void
-srl_parse_array_item(pTHX_ srl_path_t *path, int expr_idx, SV *route, I32 idx)
+srl_parse_array_item(pTHX_ srl_path_t *path, srl_path_node_t *node, I32 idx)
 {
     srl_iterator_ptr iter = path->iter;
     SRL_PATH_TRACE("parse item %d in array of size=%d at depth=%"IVdf,
@@ -418,30 +627,205 @@ srl_parse_array_item(pTHX_ srl_path_t *path, int expr_idx, SV *route, I32 idx)
 
     if (srl_iterator_array_exists(aTHX_ iter, idx) != SRL_ITER_NOT_FOUND) {
         srl_iterator_array_goto(aTHX_ iter, idx);
-        srl_parse_next_int(aTHX_ path, expr_idx + 1, route, idx);
+        srl_parse_next(aTHX_ path, node);
     }
 }
 
+/* Walk over all values of the container and continue with those which
+ * match filter. Filters are evaluated on encoded values, only matching
+ * elements are decoded (if the filter is the last step) */
 SRL_STATIC_INLINE void
-run_until(pTHX_ srl_path_t *path, UV expected_depth, U32 expected_idx)
+srl_parse_filter(pTHX_ srl_path_t *path, srl_path_node_t *node, int is_hash)
 {
     U32 idx;
     srl_iterator_ptr iter = path->iter;
     IV depth = srl_iterator_stack_depth(aTHX_ iter);
+    U32 length = srl_iterator_stack_length(aTHX_ iter);
+    const char *key = NULL;
+    STRLEN key_len;
+
+    SRL_PATH_TRACE("filter '%.*s' items in container of size=%d at depth=%"IVdf,
+                   (int) node->step->len, node->step->str, length, depth);
+
+    for (idx = 0; idx < length; idx += is_hash ? 2 : 1) {
+        run_until(aTHX_ path, depth, idx);
+        if (is_hash) srl_iterator_hash_key(aTHX_ iter, &key, &key_len);
+
+        if (srl_path_filter_match(aTHX_ path, node->step)) {
+            srl_parse_next(aTHX_ path, node);
+        }
+    }
+}
+
+/* iterator is at the element, it's returned there after evaluation */
+SRL_STATIC_INLINE int
+srl_path_filter_match(pTHX_ srl_path_t *path, const srl_path_step_t *step)
+{
+    UV i;
+    UV length;
+    int type, cmp;
+    int match = 0;
+    srl_iterator_scalar_t val;
+    srl_iterator_mark_t mark;
+    srl_iterator_ptr iter = path->iter;
+    const srl_path_filter_t *f = &step->filter;
+
+    srl_iterator_mark(aTHX_ iter, &mark);
+
+    for (i = 0; i < step->nitems; ++i) {
+        const srl_path_item_t *item = &step->items[i];
+
+        type = srl_iterator_info(aTHX_ iter, &length, NULL, NULL);
+        if (length == 0) goto done;
+
+        if ((type & SRL_ITERATOR_INFO_HASH) == SRL_ITERATOR_INFO_HASH) {
+            srl_iterator_step_in(aTHX_ iter, 1);
+            if (srl_iterator_hash_exists(aTHX_ iter, item->str, item->len) == SRL_ITER_NOT_FOUND)
+                goto done;
+        } else if ((type & SRL_ITERATOR_INFO_ARRAY) == SRL_ITERATOR_INFO_ARRAY) {
+            if (!is_number(item->str, item->len)) goto done;
+            srl_iterator_step_in(aTHX_ iter, 1);
+            if (srl_iterator_array_exists(aTHX_ iter, item->number) == SRL_ITER_NOT_FOUND)
+                goto done;
+            srl_iterator_array_goto(aTHX_ iter, item->number);
+        } else {
+            goto done;
+        }
+    }
+
+    if (f->op == SRL_PATH_FILTER_EXISTS) {
+        match = 1;
+        goto done;
+    }
+
+    type = srl_iterator_peek_scalar(aTHX_ iter, &val);
+    cmp = srl_path_filter_cmp(aTHX_ f, type, &val);
+    if (cmp == 2) goto done; /* not comparable */
+
+    switch (f->op) {
+        case SRL_PATH_FILTER_EQ: match = cmp == 0; break;
+        case SRL_PATH_FILTER_NE: match = cmp != 0; break;
+        case SRL_PATH_FILTER_LT: match = cmp <  0; break;
+        case SRL_PATH_FILTER_LE: match = cmp <= 0; break;
+        case SRL_PATH_FILTER_GT: match = cmp >  0; break;
+        case SRL_PATH_FILTER_GE: match = cmp >= 0; break;
+    }
+
+done:
+    srl_iterator_restore(aTHX_ iter, &mark);
+    return match;
+}
 
-    SRL_PATH_TRACE("expected_depth=%"UVuf" expected_idx=%u at depth=%"IVdf,
-                   expected_depth, expected_idx, depth);
+/* Compare a value with filter's literal without creating SVs. Strings are
+ * compared bytewise with string literals and numerically otherwise, if they
+ * look like numbers. Returns -1, 0, 1 or 2 if they can't be compared */
+SRL_STATIC_INLINE int
+srl_path_filter_cmp(pTHX_ const srl_path_filter_t *f, int type, const srl_iterator_scalar_t *val)
+{
+    int is_int;
+    IV iv = 0;
+    NV nv;
+
+    switch (type) {
+        case SRL_ITER_SCALAR_STRING:
+            if (f->is_string) {
+                int cmp = memcmp(val->str, f->str, val->len < f->len ? val->len : f->len);
+                if (cmp != 0) return cmp < 0 ? -1 : 1;
+                return val->len < f->len ? -1 : val->len > f->len ? 1 : 0;
+            }
+
+            if (!srl_path_str_to_number(aTHX_ val->str, val->len, &is_int, &iv, &nv))
+                return 2;
+            break;
+
+        case SRL_ITER_SCALAR_IV:
+            is_int = 1;
+            iv = val->iv;
+            nv = (NV) iv;
+            break;
+
+        case SRL_ITER_SCALAR_UV: /* above IV_MAX */
+            if (f->is_int) return 1;
+            is_int = 0;
+            nv = (NV) val->uv;
+            break;
+
+        case SRL_ITER_SCALAR_NV:
+            is_int = 0;
+            nv = val->nv;
+            break;
+
+        default: /* undef, references, etc */
+            return 2;
+    }
+
+    if (!f->is_number) return 2;
+    if (is_int && f->is_int) return iv < f->iv ? -1 : iv > f->iv ? 1 : 0;
+    if (Perl_isnan(nv) || Perl_isnan(f->nv)) return 2;
+    return nv < f->nv ? -1 : nv > f->nv ? 1 : 0;
+}
+
+/* numeric value of a string, returns 0 if it doesn't look like a number */
+SRL_STATIC_INLINE int
+srl_path_str_to_number(pTHX_ const char *str, STRLEN len, int *is_int, IV *iv, NV *nv)
+{
+    UV uv;
+    char buf[64];
+    int flags = grok_number(str, len, &uv);
+
+    if (flags == 0 || (flags & (IS_NUMBER_INFINITY | IS_NUMBER_NAN))) return 0;
 
-    if ((IV) expected_depth > depth) {
-        croak("run_until: expected_depth > depth (%"UVuf" > %"IVdf")", expected_depth, depth);
+    if ((flags & (IS_NUMBER_IN_UV | IS_NUMBER_NOT_INT)) == IS_NUMBER_IN_UV && uv <= (UV) IV_MAX) {
+        *is_int = 1;
+        *iv = (flags & IS_NUMBER_NEG) ? -(IV) uv : (IV) uv;
+        *nv = (NV) *iv;
+        return 1;
+    }
+
+    if (len >= sizeof(buf)) return 0;
+    Copy(str, buf, len, char);
+    buf[len] = '\0';
+
+    *is_int = 0;
+    *nv = Atof(buf);
+    return 1;
+}
+
+/* return to container at expected_depth after descending into its elements,
+ * the container is rewound if all its elements are passed */
+SRL_STATIC_INLINE void
+step_out_until(pTHX_ srl_path_t *path, IV expected_depth)
+{
+    srl_iterator_ptr iter = path->iter;
+    IV depth = srl_iterator_stack_depth(aTHX_ iter);
+
+    if (expected_depth > depth) {
+        croak("step_out_until: expected_depth > depth (%"IVdf" > %"IVdf")", expected_depth, depth);
     }
 
     srl_iterator_step_out(aTHX_ iter, depth - expected_depth);
-    assert((IV) expected_depth == srl_iterator_stack_depth(aTHX_ iter));
+    assert(expected_depth == srl_iterator_stack_depth(aTHX_ iter));
+
+    if (srl_iterator_stack_index(aTHX_ iter) >= srl_iterator_stack_length(aTHX_ iter))
+        srl_iterator_rewind(aTHX_ iter, 0);
+}
+
+SRL_STATIC_INLINE void
+run_until(pTHX_ srl_path_t *path, IV expected_depth, U32 expected_idx)
+{
+    U32 idx;
+    srl_iterator_ptr iter = path->iter;
 
+    SRL_PATH_TRACE("expected_depth=%"IVdf" expected_idx=%u at depth=%"IVdf,
+                   expected_depth, expected_idx, srl_iterator_stack_depth(aTHX_ iter));
+
+    step_out_until(aTHX_ path, expected_depth);
+
+    /* previous step applied to the same container could move past expected_idx */
     idx = srl_iterator_stack_index(aTHX_ iter);
     if (expected_idx < idx) {
-        croak("run_until: expected_idx < idx (%u < %d))", expected_idx, idx);
+        srl_iterator_rewind(aTHX_ iter, 0);
+        idx = 0;
     }
 
     srl_iterator_next(aTHX_ iter, expected_idx - idx);
@@ -569,13 +953,3 @@ next_item_in_list(const char *list, STRLEN list_len, const char **item_out, STRL
     *item_len_out = (list - start_pos);
     return 1;
 }
-
-SRL_STATIC_INLINE void
-print_route(SV *route, const char *str)
-{
-#ifdef TRACE_SRL_PATH
-    STRLEN len;
-    const char *ptr = SvPV(route, len);
-    SRL_PATH_TRACE("route (%s): %.*s", str, (int) len, ptr);
-#endif
-}
@@ -4,20 +4,90 @@
 #include "EXTERN.h"
 #include "perl.h"
 
+/* flags of compiled step, a step can be both number/list and range */
+#define SRL_PATH_STEP_ALL       0x01 /* * */
+#define SRL_PATH_STEP_LIST      0x02 /* [name1,name2] or [0,1,2] */
+#define SRL_PATH_STEP_NUMBER    0x04 /* [10] */
+#define SRL_PATH_STEP_RANGE     0x08 /* [start:stop:step] */
+#define SRL_PATH_STEP_FILTER    0x10 /* [?(@.name == "value")] */
+
+/* comparison operators of filters */
+#define SRL_PATH_FILTER_EXISTS  0    /* [?(@.name)] */
+#define SRL_PATH_FILTER_EQ      1
+#define SRL_PATH_FILTER_NE      2
+#define SRL_PATH_FILTER_LT      3
+#define SRL_PATH_FILTER_LE      4
+#define SRL_PATH_FILTER_GT      5
+#define SRL_PATH_FILTER_GE      6
+
+typedef struct {
+    const char *str;
+    STRLEN len;
+    I32 number;
+} srl_path_item_t;
+
+/* literal a filter compares with, strings which look like numbers
+ * have numeric form as well */
+typedef struct {
+    int op;
+    int is_string;
+    int is_number;
+    int is_int;
+    const char *str;
+    STRLEN len;
+    IV iv;
+    NV nv;
+} srl_path_filter_t;
+
+/* one component of an expression. Whether it's applied to hash or array
+ * is only known while traversing, so it's parsed for both cases.
+ * For filters items are keys/indexes leading from element to the value */
+typedef struct {
+    const char *str;
+    STRLEN len;
+    U32 flags;
+    I32 number;
+    int range[3];
+    srl_path_item_t *items;
+    UV nitems;
+    srl_path_filter_t filter;
+} srl_path_step_t;
+
+/* pre-parsed expression (Sereal::Path::Compiled) */
+typedef struct {
+    AV *expr;       /* copy of components, steps point into their buffers */
+    srl_path_step_t *steps;
+    srl_path_item_t *items;
+    UV nsteps;
+} srl_path_compiled_t;
+
+/* node of the prefix tree of traversed expressions */
+typedef struct srl_path_node srl_path_node_t;
+struct srl_path_node {
+    const srl_path_step_t *step;    /* step leading to the node, NULL for root */
+    srl_path_node_t *child;         /* first child */
+    srl_path_node_t *sibling;       /* next child of the same parent */
+    AV *results;                    /* results of expressions ending here or NULL */
+};
+
 /* the iterator main struct */
 typedef struct {
     struct srl_iterator *iter;
-    AV *expr;       /* srl_path_t do *NOT* own expr */
     AV *results;    /* srl_path_t own results */
+    srl_path_node_t *nodes; /* reused between traversals */
+    UV nodes_size;
     int i_own_iterator;
 } srl_path_t;
 
 srl_path_t * srl_build_path_struct(pTHX_ HV *opt);
 void srl_destroy_path(pTHX_ srl_path_t *path);
 void srl_path_set(pTHX_ srl_path_t *path, SV *src);
-void srl_path_traverse(pTHX_ srl_path_t *path, AV *expr, SV *route);
+void srl_path_traverse(pTHX_ srl_path_t *path, srl_path_compiled_t **programs, UV nprograms);
 SV * srl_path_results(pTHX_ srl_path_t *path); /* return mortalized SV */
 
+srl_path_compiled_t * srl_path_compile(pTHX_ AV *expr);
+void srl_destroy_path_compiled(pTHX_ srl_path_compiled_t *prog);
+
 /* for testing purposes */
 int * _is_range(const char *str, STRLEN len, int *out);
 
@@ -0,0 +1,75 @@
+#!perl
+use strict;
+use warnings;
+
+use Sereal::Path;
+use Sereal::Encoder qw/encode_sereal/;
+use Test::More;
+
+my $data = {
+    users => [
+        { name => 'alice', roles => [ 'admin', 'dev' ], meta => { age => 30, city => 'Amsterdam' } },
+        { name => 'bob',   roles => [ 'dev' ],          meta => { age => 25 } },
+        { name => 'carol', roles => [],                 meta => { city => 'Berlin' } },
+    ],
+    counts => [ 0 .. 20 ],
+    nested => { a => { x => 1, y => 2 }, b => { x => 3 }, c => [ 4, 5 ] },
+    route  => 'main',
+};
+
+my @queries = (
+    '$[route]', '$[users][*][name]', '$[users][0][roles][*]', '$[users][*][meta][age]',
+    '$[users][*][meta][city]', '$[users][-1]', '$[users][0,2][name]', '$[counts][2:10:3]',
+    '$[counts][5]', '$[counts][-1,0]', '$[counts][:3]', '$[nested][a,b][x]', '$[nested][*][x]',
+    '$[nested][c][1]', '$[nested][missing][x]', '$[users][7][name]', '$[users][name]',
+    '$[nested][a][x,y,z]', '$[users][*][roles][0]', '$[users][1,0][meta][age,city]',
+);
+
+my %expected = (
+    '$[nested][a,b][x]'              => [ 1, 3 ],
+    '$[users][0,2][name]'            => [ 'alice', 'carol' ],
+    '$[users][1,0][meta][age,city]'  => [ 25, 30, 'Amsterdam' ],
+);
+
+foreach my $encoded (encode_sereal($data), encode_sereal($data, { canonical => 1, dedupe_strings => 1 })) {
+    my $sp = Sereal::Path->new($encoded);
+
+    my %single;
+    foreach my $query (@queries) {
+        my $compiled = Sereal::Path->compile($query);
+        isa_ok($compiled, 'Sereal::Path::Compiled');
+        $single{$query} = $sp->traverse($query);
+        is_deeply($sp->traverse($compiled), $single{$query}, "compiled $query");
+        is_deeply($sp->traverse($compiled), $single{$query}, "compiled $query reused");
+    }
+
+    is_deeply($single{$_}, $expected{$_}, "list step followed by more steps: $_")
+        foreach sort keys %expected;
+
+    my @compiled = map { $sp->compile($_) } @queries;
+    is_deeply($sp->traverse_many(\@compiled), [ map { $single{$_} } @queries ],
+              "traverse_many in one pass");
+    is_deeply($sp->traverse_many([ reverse @compiled ]), [ map { $single{$_} } reverse @queries ],
+              "traverse_many in reverse order");
+    is_deeply($sp->traverse_many([ @queries ]), [ map { $single{$_} } @queries ],
+              "traverse_many compiles strings");
+
+    my $dups = $sp->traverse_many([ $compiled[1], $compiled[1], '$[users][*][name]' ]);
+    is_deeply($dups, [ ($single{'$[users][*][name]'}) x 3 ], "equal queries");
+    push @{ $dups->[0] }, 'extra';
+    is_deeply($dups->[1], $single{'$[users][*][name]'}, "equal queries get own results");
+
+    is_deeply($sp->traverse_many([]), [], "no queries");
+}
+
+my $sp = Sereal::Path->new(encode_sereal([ { foo => 1 }, { foo => 2 } ]));
+my $compiled = Sereal::Path->compile('$[*][foo]');
+is_deeply($sp->traverse($compiled), [ 1, 2 ], "compiled query on first document");
+$sp->set(encode_sereal([ { foo => 3 } ]));
+is_deeply($sp->traverse($compiled), [ 3 ], "compiled query on next document");
+is($sp->value($compiled), 3, "->value() with compiled query");
+
+ok(!eval { $sp->traverse_many([ $compiled, {} ]); 1 }, "traverse_many with non compiled query");
+like($@, qr/query must be Sereal::Path::Compiled object/, "error message");
+
+done_testing();
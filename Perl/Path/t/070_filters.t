@@ -0,0 +1,86 @@
+#!perl
+use strict;
+use warnings;
+
+use Sereal::Path;
+use Sereal::Encoder qw/encode_sereal/;
+use Test::More;
+
+my $shared = { status => 'active', price => 10 };
+my $data = {
+    items => [
+        { id => 1, status => 'active', price => 150,   meta => { tags => [ 'new' ], rank => -3 } },
+        { id => 2, status => 'off',    price => 50,    meta => { rank => 7 } },
+        { id => 3, status => 'active', price => 99.5,  meta => { tags => [] } },
+        { id => 4, price => '200', discount => undef },
+        { id => 5, status => [ 'active' ], price => 'n/a' },
+        { id => 6, %$shared },
+        'not a hash',
+        [ 'list', 100 ],
+        { id => 7, status => "\x{263A}", price => 18446744073709551615 },
+    ],
+    by_name => {
+        foo => { size => 3, kind => 'file' },
+        bar => { size => 12, kind => 'dir' },
+        baz => { kind => 'file' },
+    },
+    empty => [],
+};
+
+my %expected = (
+    '$.items[?(@.status == "active")].id'       => [ 1, 3, 6 ],
+    '$.items[?(@.status != "active")].id'       => [ 2, 7 ],
+    '$.items[?(@.status)].id'                   => [ 1, 2, 3, 5, 6, 7 ],
+    '$.items[?(@.discount)].id'                 => [ 4 ],
+    '$.items[?(@.price > 100)].id'              => [ 1, 4, 7 ],
+    '$.items[?(@.price >= 150)].id'             => [ 1, 4, 7 ],
+    '$.items[?(@.price < 99.5)].id'             => [ 2, 6 ],
+    '$.items[?(@.price <= 99.5)].id'            => [ 2, 3, 6 ],
+    '$.items[?(@.price == "50")].id'            => [ 2 ],
+    '$.items[?(@.price == 1.5e2)].id'           => [ 1 ],
+    '$.items[?(@["status"] == \'off\')].id'     => [ 2 ],
+    '$.items[?(@.meta.rank < 0)].id'            => [ 1 ],
+    '$.items[?(@.meta.rank > -10)].id'          => [ 1, 2 ],
+    '$.items[?(@.meta.tags[0] == "new")].id'    => [ 1 ],
+    '$.items[?(@.meta.tags)].meta.tags'         => [ [ 'new' ], [] ],
+    '$.items[?(@[1] == 100)][0]'                => [ 'list' ],
+    '$.items[?(@.id == 2)].status'              => [ 'off' ],
+    '$.items[?(@.id == 2)]'                     => [ $data->{items}[1] ],
+    '$.items[?(@.missing)]'                     => [],
+    '$.items[?(@.missing != 1)]'                => [],
+    '$.by_name[?(@.kind == "file")].kind'       => [ 'file', 'file' ],
+    '$.by_name[?(@.size > 5)].size'             => [ 12 ],
+    '$.by_name[?(@.size)].kind'                 => [ 'file', 'dir' ],
+    '$.empty[?(@.id)]'                          => [],
+    '$.items[?(@.status == "a)b")]'             => [],
+);
+
+sub sorted { [ sort { (ref $a ? 1 : $a) cmp (ref $b ? 1 : $b) } @{ $_[0] } ] }
+
+my %documents = (
+    plain          => encode_sereal($data, { canonical => 1 }),
+    dedupe         => encode_sereal($data, { canonical => 1, dedupe_strings => 1 }),
+    aliased_dedupe => encode_sereal($data, { canonical => 1, aliased_dedupe_strings => 1 }),
+    zlib           => encode_sereal($data, { canonical => 1, compress => Sereal::Encoder::SRL_ZLIB() }),
+);
+
+foreach my $name (sort keys %documents) {
+    my $sp = Sereal::Path->new($documents{$name});
+    foreach my $query (sort keys %expected) {
+        is_deeply(sorted($sp->traverse($query)), sorted($expected{$query}), "$name: $query");
+    }
+
+    my @queries = sort keys %expected;
+    my $many = $sp->traverse_many([ map { Sereal::Path->compile($_) } @queries ]);
+    is_deeply([ map { sorted($_) } @$many ], [ map { sorted($expected{$_}) } @queries ],
+              "$name: all filters in one traversal");
+}
+
+foreach my $bad ('$.items[?(status == 1)]', '$.items[?(@.status = 1)]', '$.items[?(@.status == foo)]',
+                 '$.items[?(@.price > 1 && @.price < 5)]') {
+    my $ok = eval { Sereal::Path->compile($bad); 1 };
+    ok(!$ok, "$bad croaks");
+    like($@, qr/Invalid filter/, "$bad error message");
+}
+
+done_testing();
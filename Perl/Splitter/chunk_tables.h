@@ -0,0 +1,334 @@
+/*
+ * Tables used by a splitter while it crafts a chunk:
+ *
+ *  - DEDUPE_TABLE maps strings of the input to the offset in the chunk
+ *    where they were first written, so that later occurrences can be
+ *    turned into COPY tags. Strings are not copied, entries point into
+ *    the input string, which outlives the splitter's chunks.
+ *
+ *  - OFFSET_TABLE maps the offset of a tracked item in the input to its
+ *    offset in the chunk, for REFP, ALIAS, COPY and OBJECTV tags.
+ *
+ * Both are open addressing tables with linear probing, and every table
+ * belongs to one splitter. The slots are allocated once and kept from
+ * chunk to chunk: each entry is stamped with the generation of the table
+ * when it was inserted, and entries of an older generation count as empty
+ * slots. So clearing a table for the next chunk only bumps the generation.
+ *
+ * The worker threads of a parallel splitter use them too, so they are
+ * allocated with plain calloc()/free() rather than with perl's allocator.
+ */
+
+#ifndef CHUNK_TABLES_H_
+#define CHUNK_TABLES_H_
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ppport.h"
+#include "srl_inline.h"
+#include "srl_xxhash.h"
+
+/* strings longer than this are not deduplicated */
+#define DEDUPE_TABLE_MAX_STR_SIZE 0xFFFFFFFF
+
+/* The utf8 flag is folded into the lowest bit of the hash. A binary and
+ * an utf8 string with the same bytes have the same XXH64 hash, so they
+ * end up with different hashes and never match each other. */
+#define DEDUPE_TABLE_HASH(tbl, str, len, is_utf8) \
+    (((U64TYPE) XXH64((str), (len), (tbl)->tbl_seed)) ^ ((is_utf8) ? 1 : 0))
+
+#define OFFSET_TABLE_HASH(key) \
+    (((U64TYPE) (key) * (U64TYPE) UINT64_C(0x9E3779B97F4A7C15)) >> 20)
+
+#define CHUNK_TABLE_IS_LIVE(tbl, ent) ((ent)->gen == (tbl)->tbl_gen)
+
+#define CHUNK_TABLE_CALLOC(ptr, n, type) STMT_START {     \
+    (ptr) = (type *) calloc((n), sizeof(type));           \
+    if ((ptr) == NULL)                                    \
+        CHUNK_TABLE_out_of_memory();                      \
+} STMT_END
+
+typedef struct DEDUPE_TABLE         DEDUPE_TABLE_t;
+typedef struct DEDUPE_TABLE_entry   DEDUPE_TABLE_ENTRY_t;
+typedef struct OFFSET_TABLE         OFFSET_TABLE_t;
+typedef struct OFFSET_TABLE_entry   OFFSET_TABLE_ENTRY_t;
+
+struct DEDUPE_TABLE_entry {
+    U64TYPE     hash;
+    const char  *str;       /* the string, inside the input */
+    UV          offset;     /* offset in the chunk where the string was written */
+    U32         len;
+    U32         gen;        /* generation of the table when inserted, 0 for never used slots */
+};
+
+struct DEDUPE_TABLE {
+    DEDUPE_TABLE_ENTRY_t    *tbl_ary;
+    UV                      tbl_max;    /* number of slots - 1 */
+    UV                      tbl_items;
+    U32                     tbl_gen;
+    U64TYPE                 tbl_seed;
+};
+
+struct OFFSET_TABLE_entry {
+    UV          key;        /* offset of the tracked item in the input */
+    UV          value;      /* offset of the tracked item in the chunk */
+    U32         gen;
+};
+
+struct OFFSET_TABLE {
+    OFFSET_TABLE_ENTRY_t    *tbl_ary;
+    UV                      tbl_max;
+    UV                      tbl_items;
+    U32                     tbl_gen;
+};
+
+SRL_STATIC_INLINE void CHUNK_TABLE_out_of_memory(void);
+
+SRL_STATIC_INLINE DEDUPE_TABLE_t * DEDUPE_TABLE_new(const U8 size_base2_exponent);
+SRL_STATIC_INLINE DEDUPE_TABLE_ENTRY_t * DEDUPE_TABLE_insert(DEDUPE_TABLE_t *tbl, const char *str, U32 len, int is_utf8, int *found);
+SRL_STATIC_INLINE void DEDUPE_TABLE_grow(DEDUPE_TABLE_t *tbl);
+SRL_STATIC_INLINE void DEDUPE_TABLE_clear(DEDUPE_TABLE_t *tbl);
+SRL_STATIC_INLINE void DEDUPE_TABLE_free(DEDUPE_TABLE_t *tbl);
+
+SRL_STATIC_INLINE OFFSET_TABLE_t * OFFSET_TABLE_new(const U8 size_base2_exponent);
+SRL_STATIC_INLINE OFFSET_TABLE_ENTRY_t * OFFSET_TABLE_find(OFFSET_TABLE_t *tbl, UV key);
+SRL_STATIC_INLINE OFFSET_TABLE_ENTRY_t * OFFSET_TABLE_insert(OFFSET_TABLE_t *tbl, UV key, int *found);
+SRL_STATIC_INLINE void OFFSET_TABLE_grow(OFFSET_TABLE_t *tbl);
+SRL_STATIC_INLINE void OFFSET_TABLE_clear(OFFSET_TABLE_t *tbl);
+SRL_STATIC_INLINE void OFFSET_TABLE_free(OFFSET_TABLE_t *tbl);
+
+/* give up like perl does when it runs out of memory, without needing
+ * the interpreter */
+
+SRL_STATIC_INLINE void
+CHUNK_TABLE_out_of_memory(void)
+{
+    fputs("Out of memory!\n", stderr);
+    abort();
+}
+
+/* create a new dedupe table of 2**size_base2_exponent slots */
+
+SRL_STATIC_INLINE DEDUPE_TABLE_t *
+DEDUPE_TABLE_new(const U8 size_base2_exponent)
+{
+    DEDUPE_TABLE_t *tbl;
+    CHUNK_TABLE_CALLOC(tbl, 1, DEDUPE_TABLE_t);
+
+    tbl->tbl_max = ((UV)1 << size_base2_exponent) - 1;
+    tbl->tbl_items = 0;
+    tbl->tbl_gen = 1;
+
+    /* seed the hash from perl's hash seed,
+     * so that the input can't be crafted to collide */
+    tbl->tbl_seed = 0;
+#if defined(PERL_HASH_SEED) && defined(PERL_HASH_SEED_BYTES)
+    Copy(PERL_HASH_SEED, &tbl->tbl_seed,
+         PERL_HASH_SEED_BYTES < sizeof(tbl->tbl_seed) ? PERL_HASH_SEED_BYTES : sizeof(tbl->tbl_seed), U8);
+#endif
+
+    CHUNK_TABLE_CALLOC(tbl->tbl_ary, tbl->tbl_max + 1, DEDUPE_TABLE_ENTRY_t);
+    return tbl;
+}
+
+/* Lookup the string. If it is there, set *found and return its entry.
+ * Otherwise store it and return the new entry, whose offset has to be
+ * set by the caller. The returned pointer is only valid until the next
+ * insert. */
+
+SRL_STATIC_INLINE DEDUPE_TABLE_ENTRY_t *
+DEDUPE_TABLE_insert(DEDUPE_TABLE_t *tbl, const char *str, U32 len, int is_utf8, int *found)
+{
+    UV slot;
+    DEDUPE_TABLE_ENTRY_t *ent;
+    const U64TYPE hash = DEDUPE_TABLE_HASH(tbl, str, len, is_utf8);
+
+    *found = 0;
+
+    if (expect_false((tbl->tbl_items + 1) * 4 > (tbl->tbl_max + 1) * 3))
+        DEDUPE_TABLE_grow(tbl);
+
+    for (slot = hash & tbl->tbl_max; ; slot = (slot + 1) & tbl->tbl_max) {
+        ent = &tbl->tbl_ary[slot];
+        if (!CHUNK_TABLE_IS_LIVE(tbl, ent))
+            break;
+
+        if (   ent->hash == hash
+            && ent->len == len
+            && memcmp(ent->str, str, len) == 0
+        ) {
+            *found = 1;
+            return ent;
+        }
+    }
+
+    ent->hash = hash;
+    ent->str = str;
+    ent->len = len;
+    ent->gen = tbl->tbl_gen;
+    ent->offset = 0;
+    tbl->tbl_items++;
+
+    return ent;
+}
+
+/* double the number of slots, keeping the entries of the current generation */
+
+SRL_STATIC_INLINE void
+DEDUPE_TABLE_grow(DEDUPE_TABLE_t *tbl)
+{
+    DEDUPE_TABLE_ENTRY_t *old_ary = tbl->tbl_ary;
+    const UV oldsize = tbl->tbl_max + 1;
+    const UV newmax = oldsize * 2 - 1;
+    UV i, slot;
+
+    CHUNK_TABLE_CALLOC(tbl->tbl_ary, newmax + 1, DEDUPE_TABLE_ENTRY_t);
+    tbl->tbl_max = newmax;
+
+    for (i = 0; i < oldsize; i++) {
+        if (!CHUNK_TABLE_IS_LIVE(tbl, &old_ary[i]))
+            continue;
+
+        for (slot = old_ary[i].hash & newmax; tbl->tbl_ary[slot].gen; slot = (slot + 1) & newmax) {}
+        tbl->tbl_ary[slot] = old_ary[i];
+    }
+
+    free(old_ary);
+}
+
+/* Forget all the entries. The slots are only zeroed once the generation
+ * counter wraps around. */
+
+SRL_STATIC_INLINE void
+DEDUPE_TABLE_clear(DEDUPE_TABLE_t *tbl)
+{
+    if (!tbl || !tbl->tbl_items)
+        return;
+
+    if (expect_false(++tbl->tbl_gen == 0)) {
+        Zero(tbl->tbl_ary, tbl->tbl_max + 1, DEDUPE_TABLE_ENTRY_t);
+        tbl->tbl_gen = 1;
+    }
+    tbl->tbl_items = 0;
+}
+
+SRL_STATIC_INLINE void
+DEDUPE_TABLE_free(DEDUPE_TABLE_t *tbl)
+{
+    if (!tbl) return;
+
+    free(tbl->tbl_ary);
+    free(tbl);
+}
+
+/* create a new offset table of 2**size_base2_exponent slots */
+
+SRL_STATIC_INLINE OFFSET_TABLE_t *
+OFFSET_TABLE_new(const U8 size_base2_exponent)
+{
+    OFFSET_TABLE_t *tbl;
+    CHUNK_TABLE_CALLOC(tbl, 1, OFFSET_TABLE_t);
+
+    tbl->tbl_max = ((UV)1 << size_base2_exponent) - 1;
+    tbl->tbl_items = 0;
+    tbl->tbl_gen = 1;
+
+    CHUNK_TABLE_CALLOC(tbl->tbl_ary, tbl->tbl_max + 1, OFFSET_TABLE_ENTRY_t);
+    return tbl;
+}
+
+/* return the entry of key, or NULL */
+
+SRL_STATIC_INLINE OFFSET_TABLE_ENTRY_t *
+OFFSET_TABLE_find(OFFSET_TABLE_t *tbl, UV key)
+{
+    UV slot;
+    OFFSET_TABLE_ENTRY_t *ent;
+
+    for (slot = OFFSET_TABLE_HASH(key) & tbl->tbl_max; ; slot = (slot + 1) & tbl->tbl_max) {
+        ent = &tbl->tbl_ary[slot];
+        if (!CHUNK_TABLE_IS_LIVE(tbl, ent))
+            return NULL;
+        if (ent->key == key)
+            return ent;
+    }
+}
+
+/* Like DEDUPE_TABLE_insert(), the caller sets the value of a new entry */
+
+SRL_STATIC_INLINE OFFSET_TABLE_ENTRY_t *
+OFFSET_TABLE_insert(OFFSET_TABLE_t *tbl, UV key, int *found)
+{
+    UV slot;
+    OFFSET_TABLE_ENTRY_t *ent;
+
+    *found = 0;
+
+    if (expect_false((tbl->tbl_items + 1) * 4 > (tbl->tbl_max + 1) * 3))
+        OFFSET_TABLE_grow(tbl);
+
+    for (slot = OFFSET_TABLE_HASH(key) & tbl->tbl_max; ; slot = (slot + 1) & tbl->tbl_max) {
+        ent = &tbl->tbl_ary[slot];
+        if (!CHUNK_TABLE_IS_LIVE(tbl, ent))
+            break;
+        if (ent->key == key) {
+            *found = 1;
+            return ent;
+        }
+    }
+
+    ent->key = key;
+    ent->value = 0;
+    ent->gen = tbl->tbl_gen;
+    tbl->tbl_items++;
+
+    return ent;
+}
+
+SRL_STATIC_INLINE void
+OFFSET_TABLE_grow(OFFSET_TABLE_t *tbl)
+{
+    OFFSET_TABLE_ENTRY_t *old_ary = tbl->tbl_ary;
+    const UV oldsize = tbl->tbl_max + 1;
+    const UV newmax = oldsize * 2 - 1;
+    UV i, slot;
+
+    CHUNK_TABLE_CALLOC(tbl->tbl_ary, newmax + 1, OFFSET_TABLE_ENTRY_t);
+    tbl->tbl_max = newmax;
+
+    for (i = 0; i < oldsize; i++) {
+        if (!CHUNK_TABLE_IS_LIVE(tbl, &old_ary[i]))
+            continue;
+
+        for (slot = OFFSET_TABLE_HASH(old_ary[i].key) & newmax; tbl->tbl_ary[slot].gen; slot = (slot + 1) & newmax) {}
+        tbl->tbl_ary[slot] = old_ary[i];
+    }
+
+    free(old_ary);
+}
+
+SRL_STATIC_INLINE void
+OFFSET_TABLE_clear(OFFSET_TABLE_t *tbl)
+{
+    if (!tbl || !tbl->tbl_items)
+        return;
+
+    if (expect_false(++tbl->tbl_gen == 0)) {
+        Zero(tbl->tbl_ary, tbl->tbl_max + 1, OFFSET_TABLE_ENTRY_t);
+        tbl->tbl_gen = 1;
+    }
+    tbl->tbl_items = 0;
+}
+
+SRL_STATIC_INLINE void
+OFFSET_TABLE_free(OFFSET_TABLE_t *tbl)
+{
+    if (!tbl) return;
+
+    free(tbl->tbl_ary);
+    free(tbl);
+}
+
+#endif
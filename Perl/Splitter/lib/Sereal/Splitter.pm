@@ -38,7 +38,18 @@ Takes a HashRef with options:
 
 =head3 input
 
-Mandatory, String, the Sereal blob to split
+String, the Sereal blob to split. Either C<input> or C<input_fh> is mandatory.
+
+=head3 input_fh
+
+Filehandle, opened on a plain file which contains the Sereal blob to split,
+from the current position of the filehandle on. The file is mapped in memory
+instead of being read in a string, and the parts of it which were already
+split are handed back to the operating system as the splitter goes. So even
+a very big file can be split with bounded memory.
+
+The file must not change while it is being split. A compressed Sereal blob is
+decompressed in memory, as with C<input>.
 
 =head3 chunk_size
 
@@ -46,9 +57,36 @@ Mandatory, positive Int, the approximate size of the B<uncompressed> chunk
 
 =head3 compress
 
-Optional, Int, one of SRL_UNCOMPRESSED, SRL_SNAPPY or SRL_ZLIB. These constant
-can be exported at use time. If set, indicates how chunks must be compressed.
-Defaults to SRL_UNCOMPRESSED.
+Optional, Int, one of SRL_UNCOMPRESSED, SRL_SNAPPY, SRL_ZLIB or SRL_ZSTD. These
+constant can be exported at use time. If set, indicates how chunks must be
+compressed. Defaults to SRL_UNCOMPRESSED.
+
+SRL_SNAPPY produces Snappy incremental chunks. The compressor and the
+buffer the chunks are assembled in are set up once and reused for every
+chunk.
+
+=head3 compress_level
+
+Optional, Int, the compression level. Between 1 and 9 for SRL_ZLIB (defaults
+to 6), between 1 and 22 for SRL_ZSTD (defaults to 3).
+
+=head3 threads
+
+Optional, positive Int, defaults to 1. If bigger than 1, the chunks are
+crafted and compressed by that many threads, while C<next_chunk> returns them
+in order. The threads work in C, and the splitter can be used from a
+program which doesn't use Perl threads.
+
+The input is first scanned to find where the chunks start, on the first call
+to C<next_chunk>. Then every thread crafts a chunk on its own, and the threads
+stay at most twice their number of chunks ahead of C<next_chunk>.
+
+With threads, C<chunk_size> is the approximate size of the elements of a chunk
+in the B<input>, rather than of the resulting chunk, so the chunks are not the
+same as without threads. Dedupe and back references can make a chunk smaller
+or bigger than its input. The chunks don't depend on the number of threads.
+
+Croaks if threads are not supported on the platform.
 
 =head3 header_data_template
 
@@ -89,6 +127,7 @@ our $VERSION     = '0.840';
 use constant SRL_UNCOMPRESSED => 0;
 use constant SRL_SNAPPY       => 1;
 use constant SRL_ZLIB         => 2;
+use constant SRL_ZSTD         => 3;
 
 use IO::File;
 
@@ -97,6 +136,7 @@ our @EXPORT_OK = qw(
   SRL_UNCOMPRESSED
   SRL_SNAPPY
   SRL_ZLIB
+  SRL_ZSTD
   create_header_data_template
 );
 our %EXPORT_TAGS = (all => \@EXPORT_OK);
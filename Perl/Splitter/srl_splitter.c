@@ -13,6 +13,13 @@ extern "C" {
 #endif
 
 #include <stdlib.h>
+#ifdef HAS_MMAP
+#include <sys/mman.h>
+#endif
+#ifdef SRL_SPLITTER_HAVE_PTHREAD
+#include <pthread.h>
+#include <signal.h>
+#endif
 
 #ifndef PERL_VERSION
 #    include <patchlevel.h>
@@ -51,10 +58,26 @@ extern "C" {
 #include "srl_protocol.h"
 #include "srl_inline.h"
 
+#if defined(HAVE_CSNAPPY)
+#include <csnappy.h>
+#else
 #include "snappy/csnappy_decompress.c"
+#include "snappy/csnappy_compress.c"
+#endif
+
+#if defined(HAVE_MINIZ)
+#include <miniz.h>
+#else
 #include "miniz.h"
+#endif
+
+#if defined(HAVE_ZSTD)
+#include <zstd.h>
+#else
+#include "zstd/zstd.h"
+#endif
 
-#include "uthash.h"
+#include "chunk_tables.h"
 
 #define STACK_SIZE_INCR 1024
 
@@ -70,6 +93,18 @@ extern "C" {
 
 #define SRL_MAX_VARINT_LENGTH 11
 
+/* The parse and compress code runs in the worker threads of a parallel
+ * splitter too, where there is no interpreter to croak with. There the
+ * error is handed over to the thread collecting the chunks, which croaks
+ * instead. msg must be a static string. */
+#define SRL_SPLITTER_CROAK(splitter, msg) STMT_START {      \
+    if ((splitter)->worker_jmp != NULL) {                   \
+        (splitter)->worker_error = (msg);                   \
+        longjmp(*(splitter)->worker_jmp, 1);                \
+    }                                                       \
+    croak("%s", (msg));                                     \
+} STMT_END
+
 
 /* predeclare all our subs so we have one definitive authority for their signatures */
 SRL_STATIC_INLINE srl_splitter_t * srl_empty_splitter_struct(pTHX);
@@ -96,41 +131,60 @@ SRL_STATIC_INLINE void _read_regexp(srl_splitter_t * splitter);
 SRL_STATIC_INLINE void _update_varint_from_to(char *varint_start, char *varint_end, UV number);
 SRL_STATIC_INLINE char* _set_varint_nocheck(char* buf, UV n);
 SRL_STATIC_INLINE bool _maybe_flush_chunk (pTHX_ srl_splitter_t *splitter, char* end_pos, char* next_start_pos);
-SRL_STATIC_INLINE void _empty_hashes(pTHX);
 SRL_STATIC_INLINE void _check_for_duplicates(pTHX_ srl_splitter_t * splitter, char* binary_start_pos, UV len, bool is_utf8);
 SRL_STATIC_INLINE void _cat_to_chunk(pTHX_ srl_splitter_t *splitter, char* str, UV str_len);
-SRL_STATIC_INLINE UV stack_pop(srl_splitter_stack_t * stack);
+SRL_STATIC_INLINE void _init_chunk_state(pTHX_ srl_splitter_t *splitter);
+SRL_STATIC_INLINE void _free_chunk_state(srl_splitter_t *splitter);
+SRL_STATIC_INLINE srl_splitter_buf_t * _build_chunk(pTHX_ srl_splitter_t *splitter);
+SRL_STATIC_INLINE srl_splitter_buf_t * _compress_chunk(pTHX_ srl_splitter_t *splitter, UV chunk_header_len);
+SRL_STATIC_INLINE void _map_input_fh(pTHX_ srl_splitter_t *splitter, SV *fh);
+SRL_STATIC_INLINE void _unmap_input(srl_splitter_t *splitter);
+SRL_STATIC_INLINE void _release_input(srl_splitter_t *splitter, char *until);
+SRL_STATIC_INLINE void buf_reserve(srl_splitter_buf_t * buf, STRLEN len);
+SRL_STATIC_INLINE void buf_cat(srl_splitter_buf_t * buf, const char *str, STRLEN len);
+#ifdef SRL_SPLITTER_HAVE_PTHREAD
+SRL_STATIC_INLINE SV* _parallel_next_chunk(pTHX_ srl_splitter_t *splitter);
+SRL_STATIC_INLINE void _parallel_start(pTHX_ srl_splitter_t *splitter);
+SRL_STATIC_INLINE void _parallel_free(pTHX_ srl_splitter_t *splitter);
+SRL_STATIC_INLINE void _scan_chunks(pTHX_ srl_splitter_t *splitter);
+static void * _worker_main(void *arg);
+#endif
+SRL_STATIC_INLINE UV stack_pop(pTHX_ srl_splitter_t *splitter, srl_splitter_stack_t * stack);
 SRL_STATIC_INLINE bool stack_is_empty(srl_splitter_stack_t * stack);
 SRL_STATIC_INLINE void stack_push(srl_splitter_stack_t * stack, UV val);
 
 
 SRL_STATIC_INLINE void _cat_to_chunk(pTHX_ srl_splitter_t *splitter, char* str, UV str_len) {
-        sv_catpvn(splitter->chunk, str, str_len);
+        buf_cat(&splitter->chunk, str, str_len);
         splitter->chunk_current_offset += str_len;
         splitter->chunk_size += str_len;
 }
 
-typedef struct {
-    char* key;         /* the string to dedup */
-    UV value;          /* the position in the chunk */
-    UT_hash_handle hh; /* makes this structure hashable */
-} dedupe_el_t;
-
-dedupe_el_t *dedupe_hashtable = NULL; /* important! initialize to NULL */
-dedupe_el_t *dedupe_hashtable_utf8 = NULL; /* important! initialize to NULL */
-
-typedef struct {
-    UV key;            /* key, the original offset in input */
-    UV value;          /* value, the new offset in the chunk */
-    UT_hash_handle hh; /* makes this structure hashable */
-} offset_el_t;
+/* make room for len more bytes */
+SRL_STATIC_INLINE void buf_reserve(srl_splitter_buf_t * buf, STRLEN len) {
+    if (buf->len + len > buf->size) {
+        STRLEN new_size = buf->size * 2;
+        char *tmp;
+        if (new_size < buf->len + len)
+            new_size = buf->len + len;
+        tmp = (char *) realloc(buf->start, new_size);
+        if (tmp == NULL)
+            CHUNK_TABLE_out_of_memory();
+        buf->start = tmp;
+        buf->size = new_size;
+    }
+}
 
-offset_el_t *offset_hashtable = NULL;    /* important! initialize to NULL */
+SRL_STATIC_INLINE void buf_cat(srl_splitter_buf_t * buf, const char *str, STRLEN len) {
+    buf_reserve(buf, len);
+    memcpy(buf->start + buf->len, str, len);
+    buf->len += len;
+}
 
-SRL_STATIC_INLINE UV stack_pop(srl_splitter_stack_t * stack) {
+SRL_STATIC_INLINE UV stack_pop(pTHX_ srl_splitter_t *splitter, srl_splitter_stack_t * stack) {
     UV val = 0;
     if ( stack->top <= 0 )
-        croak("Stack is empty");
+        SRL_SPLITTER_CROAK(splitter, "Stack is empty");
     val = stack->data[stack->top-1];
     stack->top--;
     return val;
@@ -143,11 +197,9 @@ SRL_STATIC_INLINE bool stack_is_empty(srl_splitter_stack_t * stack) {
 SRL_STATIC_INLINE void stack_push(srl_splitter_stack_t * stack, UV val) {
     if (stack->top >= stack->size) {
         UV new_size = stack->size + STACK_SIZE_INCR;
-        UV* tmp;
-        dTHX;
-        Newxz(tmp, new_size, UV );
-        memcpy(tmp, stack->data, stack->size * sizeof(UV));
-        Safefree(stack->data);
+        UV* tmp = (UV *) realloc(stack->data, new_size * sizeof(UV));
+        if (tmp == NULL)
+            CHUNK_TABLE_out_of_memory();
         stack->data = tmp;
         stack->size = new_size;
     }
@@ -164,6 +216,11 @@ srl_splitter_t * srl_build_splitter_struct(pTHX_ HV *opt) {
     splitter->dont_check_for_duplicate = 0;
     splitter->tag_is_tracked = 0;
 
+    splitter->input_sv = NULL;
+    splitter->input_map = NULL;
+    splitter->input_map_len = 0;
+    splitter->input_map_released = NULL;
+
     /* load options */
     svp = hv_fetchs(opt, "input", 0);
     if (svp && SvOK(*svp)) {
@@ -173,6 +230,8 @@ srl_splitter_t * srl_build_splitter_struct(pTHX_ HV *opt) {
         splitter->input_str_end = splitter->input_str + input_len;
         splitter->input_sv = SvREFCNT_inc(*svp);
         SRL_SPLITTER_TRACE("input_size %" UVuf, input_len);
+    } else if ((svp = hv_fetchs(opt, "input_fh", 0)) && SvOK(*svp)) {
+        _map_input_fh(aTHX_ splitter, *svp);
     } else {
         croak ("no input given");
     }
@@ -183,6 +242,7 @@ srl_splitter_t * srl_build_splitter_struct(pTHX_ HV *opt) {
     }
 
     splitter->compression_format = 0;
+    splitter->compression_level = 0;
     svp = hv_fetchs(opt, "compress", 0);
     if (svp && SvOK(*svp)) {
         IV compression_format = SvIV(*svp);
@@ -193,17 +253,53 @@ srl_splitter_t * srl_build_splitter_struct(pTHX_ HV *opt) {
             SRL_SPLITTER_TRACE("no compression %s", "");
             break;
         case 1:
-            croak("incremental snappy compression not yet supported. Try gzip");
+            splitter->compression_format = 1;
+            SRL_SPLITTER_TRACE("snappy incremental compression %s", "");
             break;
         case 2:
             splitter->compression_format = 2;
+            splitter->compression_level = MZ_DEFAULT_COMPRESSION;
+            svp = hv_fetchs(opt, "compress_level", 0);
+            if (svp && SvTRUE(*svp)) {
+                IV lvl = SvIV(*svp);
+                if (lvl < 1 || lvl > 10) /* Sekrit: compression lvl 10 is a miniz thing that doesn't exist in normal zlib */
+                    croak("'compress_level' needs to be between 1 and 9");
+                splitter->compression_level = lvl;
+            }
             SRL_SPLITTER_TRACE("gzip compression %s", "");
             break;
+        case 3:
+            splitter->compression_format = 3;
+            splitter->compression_level = 3; /* default compression level */
+            svp = hv_fetchs(opt, "compress_level", 0);
+            if (svp && SvTRUE(*svp)) {
+                IV lvl = SvIV(*svp);
+                const int max_lvl = ZSTD_maxCLevel();
+                if (lvl < 1 || lvl > max_lvl)
+                    croak("'compress_level' needs to be between 1 and %d", max_lvl);
+                splitter->compression_level = lvl;
+            }
+            SRL_SPLITTER_TRACE("zstd compression %s", "");
+            break;
         default:
             croak("invalid valie for 'compress' parameter");
         }
     }
 
+    splitter->nb_threads = 1;
+    svp = hv_fetchs(opt, "threads", 0);
+    if (svp && SvOK(*svp)) {
+        IV nb_threads = SvIV(*svp);
+        if (nb_threads < 1)
+            croak("'threads' needs to be a positive number");
+#ifndef SRL_SPLITTER_HAVE_PTHREAD
+        if (nb_threads > 1)
+            croak("'threads' is not supported on this platform");
+#endif
+        splitter->nb_threads = (UV)nb_threads;
+        SRL_SPLITTER_TRACE("threads %" UVuf, splitter->nb_threads);
+    }
+
     splitter->header_str = NULL;
     splitter->header_sv = NULL;
     splitter->header_len = 0;
@@ -225,13 +321,12 @@ srl_splitter_t * srl_build_splitter_struct(pTHX_ HV *opt) {
 
     _parse_header(aTHX_ splitter);
 
-    /* initialize stacks */
-    srl_splitter_stack_t * status_stack;
-    Newxz(status_stack, 1, srl_splitter_stack_t );
-    Newxz(status_stack->data, STACK_SIZE_INCR, UV );
-    status_stack->size = STACK_SIZE_INCR;
-    status_stack->top = 0;
-    splitter->status_stack = status_stack;
+    /* a compressed document was decompressed into input_sv, the mapped
+     * file isn't needed any more */
+    if (splitter->input_map != NULL && splitter->input_sv != NULL)
+        _unmap_input(splitter);
+
+    _init_chunk_state(aTHX_ splitter);
 
     /* initialize */
     splitter->deepness = 0;
@@ -268,23 +363,83 @@ srl_splitter_t * srl_build_splitter_struct(pTHX_ HV *opt) {
 
 
 void srl_destroy_splitter(pTHX_ srl_splitter_t *splitter) {
-    _empty_hashes(aTHX);
+#ifdef SRL_SPLITTER_HAVE_PTHREAD
+    /* the workers point into the input, stop them first */
+    if (splitter->parallel != NULL)
+        _parallel_free(aTHX_ splitter);
+#endif
+    _unmap_input(splitter);
+    _free_chunk_state(splitter);
     SvREFCNT_dec(splitter->input_sv);
     if (splitter->header_sv != NULL)
         SvREFCNT_dec(splitter->header_sv);
 
-    if (splitter->status_stack) {
-        if (splitter->status_stack->data != NULL)
-            Safefree(splitter->status_stack->data);
-        Safefree(splitter->status_stack);
+    Safefree(splitter);
+}
+
+/* The state needed to craft chunks: the stack, the tables, the buffers
+ * and the compressor. It's kept from chunk to chunk, and every worker of
+ * a parallel splitter has its own. It's set up by the main thread, but
+ * only uses plain malloc()ed memory, so that the workers can use it. */
+SRL_STATIC_INLINE void _init_chunk_state(pTHX_ srl_splitter_t *splitter) {
+    srl_splitter_stack_t * status_stack;
+
+    status_stack = (srl_splitter_stack_t *) calloc(1, sizeof(srl_splitter_stack_t));
+    if (status_stack == NULL)
+        croak("Out of memory");
+    splitter->status_stack = status_stack;
+    status_stack->data = (UV *) calloc(STACK_SIZE_INCR, sizeof(UV));
+    if (status_stack->data == NULL)
+        croak("Out of memory");
+    status_stack->size = STACK_SIZE_INCR;
+    status_stack->top = 0;
+
+    splitter->dedupe_tbl = DEDUPE_TABLE_new(10);
+    splitter->offset_tbl = OFFSET_TABLE_new(10);
+
+    /* allocate the chunk once, it grows if a chunk gets bigger */
+    buf_reserve(&splitter->chunk, splitter->size_limit + 50);
+
+    if (splitter->compression_format == 1) {
+        splitter->snappy_workmem = malloc(CSNAPPY_WORKMEM_BYTES);
+        if (splitter->snappy_workmem == NULL)
+            croak("Out of memory");
+    } else if (splitter->compression_format == 2) {
+        splitter->zlib_stream = (mz_stream *) calloc(1, sizeof(mz_stream));
+        if (splitter->zlib_stream == NULL)
+            croak("Out of memory");
+        if (mz_deflateInit(splitter->zlib_stream, (int)splitter->compression_level) != MZ_OK)
+            croak("Failed to initialize zlib compression");
+    } else if (splitter->compression_format == 3) {
+        splitter->zstd_cctx = ZSTD_createCCtx();
+        if (splitter->zstd_cctx == NULL)
+            croak("Out of memory");
     }
+}
 
-    Safefree(splitter);
+SRL_STATIC_INLINE void _free_chunk_state(srl_splitter_t *splitter) {
+    DEDUPE_TABLE_free(splitter->dedupe_tbl);
+    OFFSET_TABLE_free(splitter->offset_tbl);
+    free(splitter->chunk.start);
+    free(splitter->compressed.start);
+    if (splitter->zlib_stream != NULL) {
+        mz_deflateEnd(splitter->zlib_stream);
+        free(splitter->zlib_stream);
+    }
+    free(splitter->snappy_workmem);
+    if (splitter->zstd_cctx != NULL)
+        ZSTD_freeCCtx(splitter->zstd_cctx);
+
+    if (splitter->status_stack) {
+        free(splitter->status_stack->data);
+        free(splitter->status_stack);
+    }
 }
 
 SRL_STATIC_INLINE srl_splitter_t * srl_empty_splitter_struct(pTHX) {
     srl_splitter_t *splitter = NULL;
-    Newx(splitter, 1, srl_splitter_t);
+    /* zeroed, so that the chunk state can be freed at any time */
+    Newxz(splitter, 1, srl_splitter_t);
     if (splitter == NULL) {
         croak("Out of memory");
     }
@@ -460,7 +615,7 @@ SRL_STATIC_INLINE int _parse(pTHX_ srl_splitter_t * splitter) {
     bool force_tracking_tag = 0;
 
     while( ! stack_is_empty(splitter->status_stack) ) {
-        UV status = stack_pop(splitter->status_stack);
+        UV status = stack_pop(aTHX_ splitter, splitter->status_stack);
         UV absolute_offset;
 
         SRL_SPLITTER_TRACE("* ITERATING -- deepness value: %d", splitter->deepness);
@@ -496,19 +651,19 @@ SRL_STATIC_INLINE int _parse(pTHX_ srl_splitter_t * splitter) {
                 tag = tag & ~SRL_HDR_TRACK_FLAG;
                 SRL_SPLITTER_TRACE("    * tag must be tracked, %ld\n", splitter->pos - splitter->input_body_pos);
 
-                offset_el_t *element = NULL;
+                if (!splitter->scanning) {
+                    OFFSET_TABLE_ENTRY_t *element;
+                    int found;
 
-                UV origin_offset = splitter->pos - splitter->input_body_pos + 1;
-                UV new_offset    = splitter->chunk_current_offset + (splitter->pos - splitter->chunk_iter_start);
+                    UV origin_offset = splitter->pos - splitter->input_body_pos + 1;
+                    UV new_offset    = splitter->chunk_current_offset + (splitter->pos - splitter->chunk_iter_start);
 
-                HASH_FIND(hh, offset_hashtable, &origin_offset, sizeof(UV), element);
+                    element = OFFSET_TABLE_insert(splitter->offset_tbl, origin_offset, &found);
 
-                if(element == NULL) {
-                    Newx(element, 1, offset_el_t);
-                    element->key = origin_offset;
-                    element->value = new_offset;
-                    SRL_SPLITTER_TRACE("    * adding %lu -> %lu\n", element->key, element->value);
-                    HASH_ADD_KEYPTR(hh, offset_hashtable, &(element->key), sizeof(UV), element);
+                    if(!found) {
+                        element->value = new_offset;
+                        SRL_SPLITTER_TRACE("    * adding %lu -> %lu\n", element->key, element->value);
+                    }
                 }
             }
 	    /* move after the tag */
@@ -520,13 +675,13 @@ SRL_STATIC_INLINE int _parse(pTHX_ srl_splitter_t * splitter) {
         case ST_ABSOLUTE_JUMP:
             /* before jumping, flush the chunk */
             _maybe_flush_chunk(aTHX_ splitter, NULL, NULL);
-            absolute_offset = stack_pop(splitter->status_stack);
+            absolute_offset = stack_pop(aTHX_ splitter, splitter->status_stack);
             SRL_SPLITTER_TRACE("  * ABSOLUTE_JUMP to %lu", (UV) ( (char*)absolute_offset - splitter->input_str ) );
             splitter->pos = (char*) absolute_offset;
             splitter->chunk_iter_start = splitter->pos;
             break;
         default:
-            croak("unknown stack value %lu", status);
+            SRL_SPLITTER_CROAK(splitter, "unknown stack value");
         }
         if ( splitter->deepness == 0) {
             /* Here it means we have properly parsed a full VALUE, so we have
@@ -541,7 +696,7 @@ SRL_STATIC_INLINE int _parse(pTHX_ srl_splitter_t * splitter) {
     }
     SRL_SPLITTER_TRACE("* END ITERATING (deepness value: %d)", splitter->deepness);
     if (splitter->deepness != 0)
-        croak("Something wrong happens: parsing finished but deepness is not zero");
+        SRL_SPLITTER_CROAK(splitter, "Something wrong happens: parsing finished but deepness is not zero");
 
     /* iteration is finished, if we had to flush something return success */
     if (_maybe_flush_chunk(aTHX_ splitter, NULL, NULL))
@@ -556,18 +711,15 @@ SRL_STATIC_INLINE int _parse(pTHX_ srl_splitter_t * splitter) {
 }
 
 void _check_for_duplicates(pTHX_ srl_splitter_t * splitter, char* binary_start_pos, UV len, bool is_utf8) {
-    dedupe_el_t *element = NULL;
-    if (splitter->dont_check_for_duplicate) {
+    DEDUPE_TABLE_ENTRY_t *element;
+    int found;
+    if (splitter->scanning || splitter->dont_check_for_duplicate || len > DEDUPE_TABLE_MAX_STR_SIZE) {
 	splitter->pos += len;
 	return;
     }
-    if (is_utf8) {
-        HASH_FIND(hh, dedupe_hashtable_utf8, splitter->pos, len, element);
-    } else {
-        HASH_FIND(hh, dedupe_hashtable, splitter->pos, len, element);
-    }
-    if ( element != NULL) {
-        SRL_SPLITTER_TRACE("   * FOUND DEDUP key %s value %lu", element->key, element->value);
+    element = DEDUPE_TABLE_insert(splitter->dedupe_tbl, splitter->pos, (U32)len, is_utf8, &found);
+    if (found) {
+        SRL_SPLITTER_TRACE("   * FOUND DEDUP value %lu", element->offset);
         _maybe_flush_chunk(aTHX_ splitter, binary_start_pos, splitter->pos + len);
 
         /* the copy tag */
@@ -575,20 +727,13 @@ void _check_for_duplicates(pTHX_ srl_splitter_t * splitter, char* binary_start_p
         tmp[0] = ( splitter->tag_is_tracked ? SRL_HDR_COPY | SRL_HDR_TRACK_FLAG : SRL_HDR_COPY );
         _cat_to_chunk(aTHX_ splitter, tmp, 1 );
 
-        UV len = (UV) (_set_varint_nocheck(tmp, element->value) - tmp);
+        UV len = (UV) (_set_varint_nocheck(tmp, element->offset) - tmp);
         _cat_to_chunk(aTHX_ splitter, tmp, len);
 
     } else {
         UV offset = splitter->chunk_current_offset + ( binary_start_pos - splitter->chunk_iter_start);
-        Newx(element, 1, dedupe_el_t);
-        element->key = "";
-        element->value = offset;
+        element->offset = offset;
         SRL_SPLITTER_TRACE("   * ADDED DEDUP offset %lu", offset);
-        if (is_utf8) {
-            HASH_ADD_KEYPTR(hh, dedupe_hashtable_utf8, splitter->pos, len, element);
-        } else {
-            HASH_ADD_KEYPTR(hh, dedupe_hashtable, splitter->pos, len, element);
-        }
     }
 
     splitter->pos += len;
@@ -652,7 +797,7 @@ _read_tag(pTHX_ srl_splitter_t * splitter, char tag)
             case SRL_HDR_EXTEND:         /* no op */                      break;
             case SRL_HDR_REGEXP:         _read_regexp(splitter);       break;
             case SRL_HDR_PAD:            /* no op */                      break;
-            default:                     croak("Unexpected tag value");   break;
+            default:                     SRL_SPLITTER_CROAK(splitter, "Unexpected tag value"); break;
         }
     }
 }
@@ -710,19 +855,22 @@ SRL_STATIC_INLINE void _read_refp(pTHX_ srl_splitter_t * splitter) {
     UV offset = _read_varint_uv_nocheck(splitter);
 
     if (offset == 0)
-        croak("REFP offset is zero !");
+        SRL_SPLITTER_CROAK(splitter, "REFP offset is zero !");
 
     SRL_SPLITTER_TRACE(" * REFP, must jump to offset %lu, from input_body_pos %lu, then back here %lu.",
                        offset,
                        splitter->input_body_pos - splitter->input_str,
                        splitter->pos - splitter->input_str);
 
+    /* when scanning, the REFP is a whole value, don't follow it */
+    if (splitter->scanning)
+        return;
+
     /* if we have to flush the chunk first, let's do it, until before the REFP tag */
     _maybe_flush_chunk(aTHX_ splitter, saved_pos, NULL);
 
     /* search in the mapping hash */
-    offset_el_t *element = NULL;
-    HASH_FIND(hh, offset_hashtable, &offset, sizeof(UV), element);
+    OFFSET_TABLE_ENTRY_t *element = OFFSET_TABLE_find(splitter->offset_tbl, offset);
     if (element != NULL) {
         UV new_offset = element->value;
         /* insert a refp */
@@ -768,13 +916,21 @@ SRL_STATIC_INLINE void _read_objectv(pTHX_ srl_splitter_t * splitter, bool is_fr
     char* saved_pos = splitter->pos - 1;
     UV offset = _read_varint_uv_nocheck(splitter);
     if (offset == 0)
-        croak("OBJECTV offset is zero !");
+        SRL_SPLITTER_CROAK(splitter, "OBJECTV offset is zero !");
 
     SRL_SPLITTER_TRACE(" * OBJECTV%s, jump to offset %lu, from input_body_pos %lu, then back here %lu.",
             (is_freeze ? "FREEZE" : ""), offset,
             splitter->input_body_pos - splitter->input_str,
             splitter->pos - splitter->input_str);
 
+    if (splitter->scanning) {
+        /* the class name is elsewhere, only the object struct follows */
+        splitter->deepness++;
+        stack_push(splitter->status_stack, ST_DEEPNESS_UP);
+        stack_push(splitter->status_stack, ST_VALUE);
+        return;
+    }
+
     /* if we have to flush the chunk first, let's do it, until before the OBJECTV tag */
     _maybe_flush_chunk(aTHX_ splitter, saved_pos, NULL);
 
@@ -818,13 +974,16 @@ SRL_STATIC_INLINE void _read_copy(pTHX_ srl_splitter_t * splitter) {
     char* saved_pos = splitter->pos - 1;
     UV offset = _read_varint_uv_nocheck(splitter);
     if (offset == 0)
-        croak("COPY offset is zero !");
+        SRL_SPLITTER_CROAK(splitter, "COPY offset is zero !");
 
     SRL_SPLITTER_TRACE(" * COPY, must jump to offset %lu, from input_body_pos %lu, then back here %lu.",
                        offset,
                        splitter->input_body_pos - splitter->input_str,
                        splitter->pos - splitter->input_str);
 
+    if (splitter->scanning)
+        return;
+
     /* if we have to flush the chunk first, let's do it, until before the COPY tag */
     _maybe_flush_chunk(aTHX_ splitter, saved_pos, NULL);
 
@@ -869,19 +1028,21 @@ SRL_STATIC_INLINE void _read_alias(pTHX_ srl_splitter_t * splitter) {
     UV offset = _read_varint_uv_nocheck(splitter);
 
     if (offset == 0)
-        croak("ALIAS offset is zero !");
+        SRL_SPLITTER_CROAK(splitter, "ALIAS offset is zero !");
 
     SRL_SPLITTER_TRACE(" * ALIAS, must jump to offset %lu, from input_body_pos %lu, then back here %lu.",
                        offset,
                        splitter->input_body_pos - splitter->input_str,
                        splitter->pos - splitter->input_str);
 
+    if (splitter->scanning)
+        return;
+
     /* if we have to flush the chunk first, let's do it, until before the ALIAS tag */
     _maybe_flush_chunk(aTHX_ splitter, saved_pos, NULL);
 
     /* search in the mapping hash */
-    offset_el_t *element = NULL;
-    HASH_FIND(hh, offset_hashtable, &offset, sizeof(UV), element);
+    OFFSET_TABLE_ENTRY_t *element = OFFSET_TABLE_find(splitter->offset_tbl, offset);
     if (element != NULL) {
         UV new_offset = element->value;
         /* insert an ALIAS tag */
@@ -942,34 +1103,341 @@ SRL_STATIC_INLINE void _read_regexp(srl_splitter_t * splitter) {
     stack_push(splitter->status_stack, ST_VALUE);
 }
 
-void _empty_hashes(pTHX) {
-    dedupe_el_t *elt_d, *tmp_d;
-    HASH_ITER(hh, dedupe_hashtable, elt_d, tmp_d) {
-        HASH_DEL(dedupe_hashtable,elt_d);  /* delete; dedupe_hashtable advances to next */
-        Safefree(elt_d);
+#ifdef SRL_SPLITTER_HAVE_PTHREAD
+
+/* Parallel splitting, with threads => N.
+ *
+ * The main thread first scans the input: _parse() is run in scanning mode,
+ * where it doesn't write anything nor follow back references, only walks
+ * over the top level elements. It cuts them into runs of about size_limit
+ * bytes of input, the plan.
+ *
+ * Then N workers craft and compress the chunks of the plan, each with its
+ * own splitter struct sharing the input. A back reference to an element
+ * of another chunk is handled like in the sequential case, the pointed
+ * data is copied in the chunk. The workers don't use the interpreter at
+ * all: the chunk state is malloc()ed, and errors are reported with
+ * SRL_SPLITTER_CROAK.
+ *
+ * next_chunk() then returns the finished chunks in order. The workers
+ * stay at most 2 * N chunks ahead of it, so that the memory used by the
+ * chunks waiting to be returned is bounded. */
+
+typedef struct {
+    char *start;                    /* first element of the chunk, in the input */
+    UV nb_elts;
+    srl_splitter_buf_t result;      /* set by the worker once done */
+    const char *error;
+    bool done;
+} srl_splitter_plan_t;
+
+struct srl_splitter_parallel {
+    srl_splitter_plan_t *plan;
+    UV plan_len;
+    UV plan_size;
+
+    UV next_to_build;               /* next entry of the plan a worker takes */
+    UV next_to_return;              /* next entry of the plan next_chunk() returns */
+    UV window;
+    bool stop;
+    const char *error;              /* first error of a worker */
+
+    srl_splitter_t **workers;
+    pthread_t *threads;
+    UV nb_workers;
+    UV nb_started;
+
+    bool sync_ready;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond_done;       /* an entry of the plan was built */
+    pthread_cond_t cond_space;      /* an entry was returned, or stop was set */
+};
+
+SRL_STATIC_INLINE SV* _parallel_next_chunk(pTHX_ srl_splitter_t *splitter) {
+    struct srl_splitter_parallel *parallel;
+    srl_splitter_plan_t *entry;
+    const char *error = NULL;
+    SV *chunk;
+
+    if (splitter->parallel_done)
+        return &PL_sv_undef;
+    if (splitter->parallel == NULL)
+        _parallel_start(aTHX_ splitter);
+    parallel = splitter->parallel;
+
+    if (parallel->next_to_return >= parallel->plan_len) {
+        _parallel_free(aTHX_ splitter);
+        splitter->parallel_done = 1;
+        return &PL_sv_undef;
     }
 
-    HASH_ITER(hh, dedupe_hashtable_utf8, elt_d, tmp_d) {
-        HASH_DEL(dedupe_hashtable_utf8,elt_d);  /* delete; dedupe_hashtable_utf8 advances to next */
-        Safefree(elt_d);
+    entry = &parallel->plan[parallel->next_to_return];
+    _release_input(splitter, entry->start);
+
+    pthread_mutex_lock(&parallel->mutex);
+    while (!entry->done && !(parallel->stop && parallel->next_to_return >= parallel->next_to_build))
+        pthread_cond_wait(&parallel->cond_done, &parallel->mutex);
+    if (!entry->done)
+        error = parallel->error;
+    else
+        error = entry->error;
+    pthread_mutex_unlock(&parallel->mutex);
+
+    if (error != NULL) {
+        _parallel_free(aTHX_ splitter);
+        splitter->parallel_done = 1;
+        croak("%s", error);
     }
 
-    offset_el_t *elt_o, *tmp_o;
-    HASH_ITER(hh, offset_hashtable, elt_o, tmp_o) {
-        HASH_DEL(offset_hashtable, elt_o);  /* delete; offset_hashtable advances to next */
-        Safefree(elt_o);
+    chunk = newSVpvn(entry->result.start, entry->result.len);
+    free(entry->result.start);
+    entry->result.start = NULL;
+
+    pthread_mutex_lock(&parallel->mutex);
+    parallel->next_to_return++;
+    pthread_cond_broadcast(&parallel->cond_space);
+    pthread_mutex_unlock(&parallel->mutex);
+
+    return chunk;
+}
+
+/* First phase: cut the input in runs of elements */
+SRL_STATIC_INLINE void _scan_chunks(pTHX_ srl_splitter_t *splitter) {
+    struct srl_splitter_parallel *parallel = splitter->parallel;
+    char *start;
+
+    splitter->scanning = 1;
+    for (;;) {
+        start = splitter->pos;
+        splitter->chunk_size = 0;
+        splitter->chunk_start = start;
+        splitter->chunk_iter_start = start;
+        splitter->chunk_nb_elts = 0;
+
+        /* nothing is written, so the size checked by _parse() is the size
+         * of the elements in the input */
+        _parse(aTHX_ splitter);
+        if (splitter->chunk_nb_elts == 0)
+            break;
+
+        if (parallel->plan_len >= parallel->plan_size) {
+            parallel->plan_size = parallel->plan_size * 2 + 16;
+            Renew(parallel->plan, parallel->plan_size, srl_splitter_plan_t);
+        }
+        Zero(&parallel->plan[parallel->plan_len], 1, srl_splitter_plan_t);
+        parallel->plan[parallel->plan_len].start = start;
+        parallel->plan[parallel->plan_len].nb_elts = splitter->chunk_nb_elts;
+        parallel->plan_len++;
+
+        _release_input(splitter, splitter->pos);
     }
+    splitter->scanning = 0;
+
+    /* the workers read the input again, release it again behind them */
+    splitter->input_map_released = splitter->input_map;
 }
 
+SRL_STATIC_INLINE void _parallel_start(pTHX_ srl_splitter_t *splitter) {
+    struct srl_splitter_parallel *parallel;
+    sigset_t all_signals, old_signals;
+    UV i;
+    int rc = 0;
+
+    /* if anything below croaks, the splitter is done */
+    splitter->parallel_done = 1;
+
+    Newxz(parallel, 1, struct srl_splitter_parallel);
+    splitter->parallel = parallel;
+
+    _scan_chunks(aTHX_ splitter);
+
+    parallel->nb_workers = splitter->nb_threads < parallel->plan_len ? splitter->nb_threads : parallel->plan_len;
+    parallel->window = 2 * splitter->nb_threads;
+    Newxz(parallel->workers, parallel->nb_workers, srl_splitter_t *);
+    Newxz(parallel->threads, parallel->nb_workers, pthread_t);
+
+    for (i = 0; i < parallel->nb_workers; i++) {
+        srl_splitter_t *worker;
+        Newxz(worker, 1, srl_splitter_t);
+        parallel->workers[i] = worker;
+
+        worker->input_str = splitter->input_str;
+        worker->input_str_end = splitter->input_str_end;
+        worker->input_len = splitter->input_len;
+        worker->input_body_pos = splitter->input_body_pos;
+        worker->input_nb_elts = splitter->input_nb_elts;
+        worker->header_str = splitter->header_str;
+        worker->header_len = splitter->header_len;
+        worker->header_count_idx = splitter->header_count_idx;
+        worker->compression_format = splitter->compression_format;
+        worker->compression_level = splitter->compression_level;
+        worker->size_limit = splitter->size_limit;
+        worker->parallel = parallel;
+
+        _init_chunk_state(aTHX_ worker);
+
+        /* the chunks were cut by the scan, a worker puts all the elements
+         * it's given in its chunk */
+        worker->size_limit = (UV)-1;
+    }
+
+    if (pthread_mutex_init(&parallel->mutex, NULL) != 0)
+        croak("Failed to initialize the splitter threads");
+    if (pthread_cond_init(&parallel->cond_done, NULL) != 0) {
+        pthread_mutex_destroy(&parallel->mutex);
+        croak("Failed to initialize the splitter threads");
+    }
+    if (pthread_cond_init(&parallel->cond_space, NULL) != 0) {
+        pthread_cond_destroy(&parallel->cond_done);
+        pthread_mutex_destroy(&parallel->mutex);
+        croak("Failed to initialize the splitter threads");
+    }
+    parallel->sync_ready = 1;
+
+    /* perl's signal handlers must run in the main thread */
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_BLOCK, &all_signals, &old_signals);
+    for (i = 0; i < parallel->nb_workers; i++) {
+        rc = pthread_create(&parallel->threads[i], NULL, _worker_main, parallel->workers[i]);
+        if (rc != 0)
+            break;
+        parallel->nb_started++;
+    }
+    pthread_sigmask(SIG_SETMASK, &old_signals, NULL);
+
+    if (rc != 0) {
+        _parallel_free(aTHX_ splitter);
+        croak("Failed to start the splitter threads: %s", Strerror(rc));
+    }
+
+    splitter->parallel_done = 0;
+}
+
+/* Stop the workers, and free everything but the splitter itself */
+SRL_STATIC_INLINE void _parallel_free(pTHX_ srl_splitter_t *splitter) {
+    struct srl_splitter_parallel *parallel = splitter->parallel;
+    UV i;
+
+    if (parallel->sync_ready) {
+        pthread_mutex_lock(&parallel->mutex);
+        parallel->stop = 1;
+        pthread_cond_broadcast(&parallel->cond_space);
+        pthread_mutex_unlock(&parallel->mutex);
+    }
+    for (i = 0; i < parallel->nb_started; i++)
+        pthread_join(parallel->threads[i], NULL);
+    if (parallel->sync_ready) {
+        pthread_cond_destroy(&parallel->cond_space);
+        pthread_cond_destroy(&parallel->cond_done);
+        pthread_mutex_destroy(&parallel->mutex);
+    }
+
+    for (i = 0; i < parallel->nb_workers; i++) {
+        if (parallel->workers[i] != NULL) {
+            _free_chunk_state(parallel->workers[i]);
+            Safefree(parallel->workers[i]);
+        }
+    }
+    for (i = 0; i < parallel->plan_len; i++)
+        free(parallel->plan[i].result.start);
+
+    Safefree(parallel->workers);
+    Safefree(parallel->threads);
+    Safefree(parallel->plan);
+    Safefree(parallel);
+    splitter->parallel = NULL;
+}
+
+/* Second phase, in every worker thread: take the next entry of the plan,
+ * craft its chunk, and hand it over. */
+static void * _worker_main(void *arg) {
+    srl_splitter_t *worker = (srl_splitter_t *) arg;
+    struct srl_splitter_parallel *parallel = worker->parallel;
+    jmp_buf jmp;
+    dTHXa(NULL);
+
+    worker->worker_jmp = &jmp;
+
+    pthread_mutex_lock(&parallel->mutex);
+    for (;;) {
+        srl_splitter_plan_t *entry;
+        srl_splitter_buf_t * volatile chunk = NULL;
+        UV i;
+
+        while (   !parallel->stop
+               && parallel->next_to_build < parallel->plan_len
+               && parallel->next_to_build >= parallel->next_to_return + parallel->window)
+            pthread_cond_wait(&parallel->cond_space, &parallel->mutex);
+        if (parallel->stop || parallel->next_to_build >= parallel->plan_len)
+            break;
+        entry = &parallel->plan[parallel->next_to_build++];
+        pthread_mutex_unlock(&parallel->mutex);
+
+        if (setjmp(jmp) == 0) {
+            worker->pos = entry->start;
+            worker->deepness = 0;
+            worker->status_stack->top = 0;
+            for (i = 0; i < entry->nb_elts; i++)
+                stack_push(worker->status_stack, ST_VALUE);
+            chunk = _build_chunk(aTHX_ worker);
+        }
+
+        pthread_mutex_lock(&parallel->mutex);
+        if (chunk != NULL) {
+            /* the chunk is handed over as is, the worker starts a new buffer */
+            entry->result = *chunk;
+            chunk->start = NULL;
+            chunk->len = chunk->size = 0;
+        } else {
+            entry->error = worker->worker_error ? worker->worker_error : "Sereal chunk is empty";
+            if (parallel->error == NULL)
+                parallel->error = entry->error;
+            parallel->stop = 1;
+            pthread_cond_broadcast(&parallel->cond_space);
+        }
+        entry->done = 1;
+        pthread_cond_broadcast(&parallel->cond_done);
+    }
+    /* wake up the main thread, in case it waits for an entry nobody takes */
+    pthread_cond_broadcast(&parallel->cond_done);
+    pthread_mutex_unlock(&parallel->mutex);
+
+    return NULL;
+}
+
+#endif
+
 SV* srl_splitter_next_chunk(pTHX_ srl_splitter_t * splitter) {
+    srl_splitter_buf_t *chunk;
 
-    /* create a new chunk */
+#ifdef SRL_SPLITTER_HAVE_PTHREAD
+    if (splitter->nb_threads > 1)
+        return _parallel_next_chunk(aTHX_ splitter);
+#endif
 
-    /* empty the dedupe_hashtable and offset_hashtable */
-    _empty_hashes(aTHX);
+    _release_input(splitter, splitter->pos);
 
-    /* zero length Perl string */
-    splitter->chunk = newSVpvn("", 0);
+    chunk = _build_chunk(aTHX_ splitter);
+    if (chunk == NULL)
+        return &PL_sv_undef;
+    return newSVpvn(chunk->start, chunk->len);
+}
+
+/* Craft the next chunk, with the elements in the status stack, starting at
+ * splitter->pos. Returns the buffer holding it, which is overwritten by
+ * the next chunk, or NULL if there's nothing left. */
+SRL_STATIC_INLINE srl_splitter_buf_t * _build_chunk(pTHX_ srl_splitter_t *splitter) {
+    UV chunk_header_len = 0;
+    char tmp_str[SRL_MAX_VARINT_LENGTH];
+    UV varint_len;
+    UV varint_pos;
+    int found;
+
+    /* forget the strings and tracked items of the previous chunk */
+    DEDUPE_TABLE_clear(splitter->dedupe_tbl);
+    OFFSET_TABLE_clear(splitter->offset_tbl);
+
+    splitter->chunk.len = 0;
     splitter->chunk_size = 0;
     splitter->chunk_start = splitter->pos;
     splitter->chunk_iter_start = splitter->pos;
@@ -977,127 +1445,243 @@ SV* srl_splitter_next_chunk(pTHX_ srl_splitter_t * splitter) {
 
     splitter->chunk_body_pos = splitter->chunk_start;
 
-    /* allocate the chunk to avoid multiple memory allocation */
-    SvGROW(splitter->chunk, splitter->size_limit + 50);
-
     /* for some reason, jump offset start at 1 in sereal spec, go figure why */
     splitter->chunk_current_offset = 1;
         
-    UV chunk_header_len = 0;
     /* srl magic */
-    sv_catpvn(splitter->chunk, SRL_MAGIC_STRING_HIGHBIT, SRL_MAGIC_STRLEN);
+    buf_cat(&splitter->chunk, SRL_MAGIC_STRING_HIGHBIT, SRL_MAGIC_STRLEN);
     splitter->chunk_body_pos += SRL_MAGIC_STRLEN;
     chunk_header_len += SRL_MAGIC_STRLEN;
 
     /* srl version-type type=raw, version=3 */
-    sv_catpvn(splitter->chunk, "\3", 1);
+    buf_cat(&splitter->chunk, "\3", 1);
     splitter->chunk_body_pos += 1;
     chunk_header_len += 1;
 
     if ( ! splitter->header_len) {
         /* no srl header */
-        sv_catpvn(splitter->chunk, "\0", 1);
+        buf_cat(&splitter->chunk, "\0", 1);
         splitter->chunk_body_pos += 1;
         chunk_header_len += 1;
     } else {
-        sv_catpvn(splitter->chunk, splitter->header_str, splitter->header_len);
+        buf_cat(&splitter->chunk, splitter->header_str, splitter->header_len);
         splitter->chunk_body_pos += splitter->header_len;
         chunk_header_len += splitter->header_len;
     }
 
-    char tmp_str[SRL_MAX_VARINT_LENGTH];
     tmp_str[0] = SRL_HDR_REFN;
-    sv_catpvn(splitter->chunk, tmp_str, 1);
+    buf_cat(&splitter->chunk, tmp_str, 1);
     splitter->chunk_current_offset += 1;
 
     tmp_str[0] = SRL_HDR_ARRAY;
-    sv_catpvn(splitter->chunk, tmp_str, 1);
+    buf_cat(&splitter->chunk, tmp_str, 1);
     splitter->chunk_current_offset += 1;
 
     /* append the varint of the maximum array's number of elements */
-    UV varint_len = (UV) (_set_varint_nocheck(tmp_str, splitter->input_nb_elts) - tmp_str);
+    varint_len = (UV) (_set_varint_nocheck(tmp_str, splitter->input_nb_elts) - tmp_str);
     /* This is the char number where we're going to write the varint */
-    UV varint_pos = SvCUR(splitter->chunk);
-    sv_catpvn(splitter->chunk, tmp_str, varint_len);
+    varint_pos = splitter->chunk.len;
+    buf_cat(&splitter->chunk, tmp_str, varint_len);
     splitter->chunk_current_offset += varint_len;
 
-    int found = _parse(aTHX_ splitter);
-    if (found) {
-        char * varint_start = SvPVX(splitter->chunk) + varint_pos;
+    found = _parse(aTHX_ splitter);
+    if (!found)
+        return NULL;
+
+    {
+        char * varint_start = splitter->chunk.start + varint_pos;
         char * varint_end = varint_start + varint_len - 1;
         _update_varint_from_to(varint_start, varint_end, splitter->chunk_nb_elts);
+    }
 
-        if (splitter->header_count_idx != -1) {
-            /* chunk + magic size + version size + header varint size(8) + index where the count is */
-            char * header_count_varint_start = SvPVX(splitter->chunk) + SRL_MAGIC_STRLEN + 1 + splitter->header_count_idx;
-            /* note: instead of 8, it should be SRL_MAX_VARINT_LENGTH,
-               srl_decoder.c:831 is buggy: decoding of varint only support
-               varint of size 8 bytes, instead of 11 */
-            char * header_count_varint_end = header_count_varint_start + 8 - 1;
-            _update_varint_from_to(header_count_varint_start, header_count_varint_end, splitter->chunk_nb_elts);
-        }
-
-        if (splitter->compression_format == 0) /* no compression */
-            return splitter->chunk;
-
-        /* gzip compression: reforge the SV completely */
+    if (splitter->header_count_idx != -1) {
+        /* chunk + magic size + version size + header varint size(8) + index where the count is */
+        char * header_count_varint_start = splitter->chunk.start + SRL_MAGIC_STRLEN + 1 + splitter->header_count_idx;
+        /* note: instead of 8, it should be SRL_MAX_VARINT_LENGTH,
+           srl_decoder.c:831 is buggy: decoding of varint only support
+           varint of size 8 bytes, instead of 11 */
+        char * header_count_varint_end = header_count_varint_start + 8 - 1;
+        _update_varint_from_to(header_count_varint_start, header_count_varint_end, splitter->chunk_nb_elts);
+    }
 
-        UV uncompressed_body_length = SvCUR(splitter->chunk) - chunk_header_len;
-        SRL_SPLITTER_TRACE(" * UNCOMPRESS BODY_LENGTH %lu", uncompressed_body_length);
+    if (splitter->compression_format == 0) /* no compression */
+        return &splitter->chunk;
 
-        size_t dest_len;
-        /* Get uncompressed payload and total packet output (after compression) lengths */
-        dest_len = chunk_header_len + 1 + (size_t)mz_compressBound(uncompressed_body_length) + (2 * SRL_MAX_VARINT_LENGTH);
+    return _compress_chunk(aTHX_ splitter, chunk_header_len);
+}
 
-        SV* compressed_chunk = newSVpvn("", 0);
-        sv_catpvn(compressed_chunk, SvPVX(splitter->chunk), chunk_header_len);
+/* Compress the body of the chunk into splitter->compressed. The compressor
+ * is reset for every chunk rather than set up again. */
+SRL_STATIC_INLINE srl_splitter_buf_t * _compress_chunk(pTHX_ srl_splitter_t *splitter, UV chunk_header_len) {
+    char * uncompressed_body = splitter->chunk.start + chunk_header_len;
+    UV uncompressed_body_length = splitter->chunk.len - chunk_header_len;
+    bool is_snappy = splitter->compression_format == 1;
+    bool is_zstd = splitter->compression_format == 3;
+    size_t compressed_bound;
+    size_t dest_len;
+    srl_splitter_buf_t *compressed_chunk = &splitter->compressed;
+    char* compressed_pos;
+    char* varint_start;
+    char* varint_end;
+
+    SRL_SPLITTER_TRACE(" * UNCOMPRESS BODY_LENGTH %lu", uncompressed_body_length);
+
+    if (is_snappy) {
+        if (uncompressed_body_length > 0xFFFFFFFFU)
+            SRL_SPLITTER_CROAK(splitter, "chunk too big for Snappy compression");
+        compressed_bound = (size_t)csnappy_max_compressed_length((uint32_t)uncompressed_body_length);
+    } else if (is_zstd) {
+        compressed_bound = ZSTD_compressBound(uncompressed_body_length);
+    } else {
+        if (uncompressed_body_length > 0xFFFFFFFFU)
+            SRL_SPLITTER_CROAK(splitter, "chunk too big for ZLIB compression");
+        compressed_bound = (size_t)mz_compressBound(uncompressed_body_length);
+    }
 
+    compressed_chunk->len = 0;
+    buf_reserve(compressed_chunk, chunk_header_len + compressed_bound + (2 * SRL_MAX_VARINT_LENGTH));
+    compressed_pos = compressed_chunk->start;
+    Copy(splitter->chunk.start, compressed_pos, chunk_header_len, char);
+    compressed_pos += chunk_header_len;
 
-        SRL_SPLITTER_TRACE(" * ALLOCATED DEST LEN %lu", dest_len);
-        char * compressed_pos = SvGROW(compressed_chunk, dest_len);
+    /* ZLIB: varint of the uncompressed length, then of the compressed one.
+     * Snappy incremental and ZSTD: varint of the compressed length. It's
+     * filled in afterwards, reserve the space needed for the worst case. */
+    if (!is_zstd && !is_snappy)
+        compressed_pos = _set_varint_nocheck(compressed_pos, uncompressed_body_length);
+    varint_start = compressed_pos;
+    compressed_pos = _set_varint_nocheck(compressed_pos, compressed_bound);
+    varint_end = compressed_pos - 1;
+
+    if (is_snappy) {
+        uint32_t len = (uint32_t) compressed_bound;
+        csnappy_compress(uncompressed_body, (uint32_t) uncompressed_body_length,
+                         compressed_pos, &len,
+                         splitter->snappy_workmem, CSNAPPY_WORKMEM_BYTES_POWER_OF_TWO);
+        dest_len = (size_t) len;
+    } else if (is_zstd) {
+        size_t code = ZSTD_compressCCtx(splitter->zstd_cctx,
+                                        compressed_pos, compressed_bound,
+                                        uncompressed_body, uncompressed_body_length,
+                                        (int)splitter->compression_level);
+        if (ZSTD_isError(code))
+            SRL_SPLITTER_CROAK(splitter, "ZSTD compression of Sereal chunk failed");
+        dest_len = code;
+    } else {
+        mz_streamp stream = splitter->zlib_stream;
+        int status = mz_deflateReset(stream);
+        if (status == MZ_OK) {
+            stream->next_in = (const unsigned char *) uncompressed_body;
+            stream->avail_in = (unsigned int) uncompressed_body_length;
+            stream->next_out = (unsigned char *) compressed_pos;
+            stream->avail_out = (unsigned int) compressed_bound;
+            status = mz_deflate(stream, MZ_FINISH);
+        }
+        if (status != MZ_STREAM_END)
+            SRL_SPLITTER_CROAK(splitter, "ZLIB compression of Sereal chunk failed");
+        dest_len = (size_t) stream->total_out;
+    }
 
-        compressed_pos += chunk_header_len;
+    SRL_SPLITTER_TRACE(" * COMPRESSED LEN %lu", dest_len);
 
-        /* append the varint of the uncompressed length */
-        compressed_pos = _set_varint_nocheck(compressed_pos, uncompressed_body_length);
-        /* append the varint of the compressed length */
-        char* varint_start2 = compressed_pos;
-        compressed_pos = _set_varint_nocheck(compressed_pos, dest_len);
-        char* varint_end2 = compressed_pos -1;
+    _update_varint_from_to(varint_start, varint_end, dest_len);
 
+    compressed_chunk->len = compressed_pos - compressed_chunk->start + dest_len;
 
-                splitter->compression_level = MZ_DEFAULT_COMPRESSION;
+    /* sereal version = 3, and the compression method */
+    compressed_chunk->start[SRL_MAGIC_STRLEN] = 3 | (  is_snappy ? SRL_PROTOCOL_ENCODING_SNAPPY_INCREMENTAL
+                                                     : is_zstd   ? SRL_PROTOCOL_ENCODING_ZSTD
+                                                     :             SRL_PROTOCOL_ENCODING_ZLIB);
 
-                mz_ulong dl = (mz_ulong)dest_len;
-                int status = mz_compress2(
-                    (unsigned char *) compressed_pos,
-                    &dl,
-                    (const unsigned char *)(SvPVX(splitter->chunk) + chunk_header_len),
-                    (mz_ulong)uncompressed_body_length,
-                    splitter->compression_level
-                );
-                (void)status;
-                assert(status == Z_OK);
-                dest_len = (size_t)dl;
+    return compressed_chunk;
+}
 
-        SRL_SPLITTER_TRACE(" * COMPRESSED LEN %lu", dest_len);
+/* Use the plain file opened in fh as input, from its current position on.
+ * The file is mapped rather than read, so the parser can follow back
+ * references anywhere into it. The mapped pages are handed back to the
+ * system as the splitter moves on, see _release_input(). */
+SRL_STATIC_INLINE void _map_input_fh(pTHX_ srl_splitter_t *splitter, SV *fh) {
+#ifdef HAS_MMAP
+    IO *io = sv_2io(fh);
+    PerlIO *fp = IoIFP(io);
+    Stat_t st;
+    Off_t start;
+    int fd;
+    void *map;
+
+    if (fp == NULL)
+        croak("input_fh is not an opened filehandle");
+
+    fd = PerlIO_fileno(fp);
+    start = PerlIO_tell(fp);
+    if (fd < 0 || start < 0 || PerlLIO_fstat(fd, &st) < 0)
+        croak("input_fh: can't get the size of the input: %s", Strerror(errno));
+    if (!S_ISREG(st.st_mode))
+        croak("input_fh must be a plain file");
+    if (st.st_size <= start)
+        croak("input Sereal string lacks data");
+    if ((Off_t)(size_t)st.st_size != st.st_size)
+        croak("input_fh: file too big to be mapped");
+
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED)
+        croak("input_fh: can't map the input: %s", Strerror(errno));
+#ifdef MADV_SEQUENTIAL
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
 
-        _update_varint_from_to(varint_start2, varint_end2, dest_len);
+    splitter->input_map = (char *) map;
+    splitter->input_map_len = (STRLEN)st.st_size;
+    splitter->input_map_released = splitter->input_map;
 
-        SvCUR_set(compressed_chunk, compressed_pos - SvPVX(compressed_chunk) + dest_len);
+    splitter->input_str = splitter->input_map + start;
+    splitter->pos = splitter->input_str;
+    splitter->input_len = (STRLEN)(st.st_size - start);
+    splitter->input_str_end = splitter->input_str + splitter->input_len;
+    SRL_SPLITTER_TRACE("input_size %" UVuf, (UV)splitter->input_len);
+#else
+    PERL_UNUSED_ARG(splitter);
+    PERL_UNUSED_ARG(fh);
+    croak("input_fh is not supported on this platform");
+#endif
+}
 
-	/* This means "sereal version = 3, and compression method = gzip" */
-        (SvPVX(compressed_chunk))[4] = 0x33;
+SRL_STATIC_INLINE void _unmap_input(srl_splitter_t *splitter) {
+#ifdef HAS_MMAP
+    if (splitter->input_map != NULL)
+        munmap(splitter->input_map, splitter->input_map_len);
+#endif
+    splitter->input_map = NULL;
+    splitter->input_map_len = 0;
+    splitter->input_map_released = NULL;
+}
 
-        sv_2mortal(splitter->chunk);
-        return compressed_chunk;
-    } else {
-        sv_2mortal(splitter->chunk);
-        return &PL_sv_undef;
+/* Drop the mapped pages before until, the start of the next chunk, to keep
+ * the memory used bounded when going through a big file. Back references
+ * to them still work, the pages are then read from the file again. */
+SRL_STATIC_INLINE void _release_input(srl_splitter_t *splitter, char *until) {
+#if defined(HAS_MMAP) && defined(MADV_DONTNEED)
+    UV page_size;
+    char *release_end;
+
+    if (splitter->input_map == NULL)
+        return;
+
+    page_size = (UV)sysconf(_SC_PAGESIZE);
+
+    release_end = splitter->input_map
+                + ((UV)(until - splitter->input_map) / page_size) * page_size;
+    if (release_end > splitter->input_map_released) {
+        madvise(splitter->input_map_released,
+                release_end - splitter->input_map_released, MADV_DONTNEED);
+        splitter->input_map_released = release_end;
     }
+#else
+    PERL_UNUSED_ARG(splitter);
+    PERL_UNUSED_ARG(until);
+#endif
 }
 
-
 SRL_STATIC_INLINE char* _set_varint_nocheck(char* buf, UV n) {
     while (n >= 0x80) {             /* while we are larger than 7 bits long */
         *(buf++) = (n & 0x7f) | 0x80; /* write out the least significant 7 bits, set the high bit */
@@ -1154,6 +1738,8 @@ SRL_STATIC_INLINE void _update_varint_from_to(char *varint_start, char *varint_e
 SRL_STATIC_INLINE bool _maybe_flush_chunk (pTHX_ srl_splitter_t *splitter, char* end_pos, char* next_start_pos) {
     UV len;
     bool did_we_flush = 0;
+    if (splitter->scanning)
+        return 0;
     if (end_pos == NULL)
         end_pos = splitter->pos;
     if (next_start_pos == NULL)
@@ -10,10 +10,21 @@ typedef struct {
     UV top;
 } srl_splitter_stack_t;
 
+/* output buffer, malloc()ed so that worker threads can use it */
+typedef struct {
+    char * start;
+    STRLEN len;
+    STRLEN size;
+} srl_splitter_buf_t;
+
 /* the splitter main struct */
 typedef struct {
     SV* input_sv;
     char * input_str;
+    /* input_fh: the file is mapped, input_str points into the mapping */
+    char * input_map;
+    STRLEN input_map_len;
+    char * input_map_released;  /* pages before this were handed back */
     char * input_str_end;
     char * pos;
     char * input_body_pos;
@@ -36,7 +47,7 @@ typedef struct {
     char* chunk_start;
     char* chunk_iter_start;
     char* chunk_body_pos;
-    SV* chunk;
+    srl_splitter_buf_t chunk;
     UV chunk_nb_elts;
     IV chunk_offset_delta;
 
@@ -46,9 +57,31 @@ typedef struct {
     IV compression_format;
     IV compression_level;
 
+    /* kept from chunk to chunk when compressing */
+    srl_splitter_buf_t compressed;
+    struct mz_stream_s *zlib_stream;
+    void *snappy_workmem;
+    struct ZSTD_CCtx_s *zstd_cctx;
+
     bool tag_is_tracked;
     bool dont_check_for_duplicate;
 
+    /* only walk over the input to find where chunks start, see _scan_chunks() */
+    bool scanning;
+
+    /* set in worker threads, which can't croak */
+    jmp_buf *worker_jmp;
+    const char *worker_error;
+
+    /* threads => N, see "Parallel splitting" in srl_splitter.c */
+    UV nb_threads;
+    struct srl_splitter_parallel *parallel;
+    bool parallel_done;
+
+    /* both are cleared for every chunk, see chunk_tables.h */
+    struct DEDUPE_TABLE *dedupe_tbl;  /* strings written to the chunk, by content */
+    struct OFFSET_TABLE *offset_tbl;  /* offsets of tracked items, input offset to chunk offset */
+
 } srl_splitter_t;
 
 enum {
@@ -0,0 +1,56 @@
+#!perl
+use strict;
+use warnings;
+use Test::More;
+
+use Sereal::Splitter;
+
+use Sereal::Encoder qw(encode_sereal);
+use Sereal::Decoder qw(decode_sereal);
+
+# Every splitter has its own dedupe and offset tables, which are kept from
+# chunk to chunk. Splitters used side by side produce the same chunks as
+# when they are used one after the other.
+
+my $shared = { name => "shared value", list => [ 1 .. 5 ] };
+my @inputs = (
+    [ map { { id => $_, type => "event type " . ($_ % 3), ref => $shared } } 1 .. 200 ],
+    [ map { [ "string $_", "event type " . ($_ % 3), \$shared->{name}, $shared ] } 1 .. 200 ],
+    [ map { bless({ id => $_, tag => "tag " . ($_ % 5) }, "Some::Class::" . ($_ % 2)) } 1 .. 200 ],
+);
+
+sub split_alone {
+    my ($data, $size) = @_;
+    my $o = Sereal::Splitter->new({ chunk_size => $size, input => $data });
+    my @chunks;
+    while (defined(my $chunk = $o->next_chunk())) {
+        push @chunks, $chunk;
+    }
+    return \@chunks;
+}
+
+foreach my $size (1, 200, 2000) {
+    my @data = map { encode_sereal($_, { dedupe_strings => 1 }) } @inputs;
+    my @expected = map { split_alone($_, $size) } @data;
+
+    my @splitters = map { Sereal::Splitter->new({ chunk_size => $size, input => $_ }) } @data;
+    my @got = map { [] } @splitters;
+    my $active = @splitters;
+    while ($active) {
+        $active = 0;
+        foreach my $i (0 .. $#splitters) {
+            my $chunk = $splitters[$i]->next_chunk();
+            defined $chunk or next;
+            push @{$got[$i]}, $chunk;
+            $active++;
+        }
+    }
+
+    foreach my $i (0 .. $#inputs) {
+        is_deeply($got[$i], $expected[$i], "chunk_size $size, input $i: same chunks when interleaved");
+        is_deeply([ map { @{ decode_sereal($_) } } @{$got[$i]} ], $inputs[$i],
+                  "chunk_size $size, input $i: chunks decode to the input");
+    }
+}
+
+done_testing;
@@ -0,0 +1,50 @@
+#!perl
+use strict;
+use warnings;
+use Test::More;
+
+use Sereal::Splitter qw(:all);
+
+use Sereal::Encoder qw(encode_sereal);
+use Sereal::Decoder qw(decode_sereal decode_sereal_with_header_data);
+
+my @elements = map { { id => $_, type => "event type " . ($_ % 3), payload => "x" x ($_ % 50) } } 1 .. 500;
+my $data = encode_sereal(\@elements, { dedupe_strings => 1 });
+
+my %encoding = (SRL_SNAPPY, 2, SRL_ZLIB, 3, SRL_ZSTD, 4);
+my %name = (SRL_SNAPPY, "snappy", SRL_ZLIB, "zlib", SRL_ZSTD, "zstd");
+
+foreach my $compress (SRL_SNAPPY, SRL_ZLIB, SRL_ZSTD) {
+    foreach my $level ($compress == SRL_SNAPPY ? undef : (undef, 1, 9)) {
+        my $name = "$name{$compress}, level " . (defined $level ? $level : "default");
+        my $o = Sereal::Splitter->new({
+            chunk_size => 2000,
+            input      => $data,
+            compress   => $compress,
+            (defined $level ? (compress_level => $level) : ()),
+            header_data_template => create_header_data_template({ count => '__$CNT__' }),
+        });
+
+        my (@got, $nb_chunks, $bad_encoding, $bad_count);
+        while (defined(my $chunk = $o->next_chunk())) {
+            $nb_chunks++;
+            $bad_encoding++ if ord(substr($chunk, 4, 1)) >> 4 != $encoding{$compress};
+            my $struct = decode_sereal($chunk);
+            my ($header) = @{ decode_sereal_with_header_data($chunk) };
+            $bad_count++ if $header->{count} != @$struct;
+            push @got, @$struct;
+        }
+        cmp_ok($nb_chunks, '>', 1, "$name: several chunks");
+        ok(!$bad_encoding, "$name: chunks are compressed");
+        ok(!$bad_count, "$name: element count in the header");
+        is_deeply(\@got, \@elements, "$name: chunks decode to the input");
+    }
+}
+
+ok(!eval { Sereal::Splitter->new({ chunk_size => 1, input => $data, compress => SRL_ZSTD, compress_level => 23 }); 1 },
+   "invalid zstd level");
+like($@, qr/between 1 and \d+/, "zstd level range comes from the library");
+ok(!eval { Sereal::Splitter->new({ chunk_size => 1, input => $data, compress => SRL_ZLIB, compress_level => 11 }); 1 },
+   "invalid zlib level");
+
+done_testing;
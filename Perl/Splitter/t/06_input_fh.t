@@ -0,0 +1,71 @@
+#!perl
+use strict;
+use warnings;
+use Test::More;
+use File::Temp qw(tempfile);
+
+use Sereal::Splitter qw(:all);
+
+use Sereal::Encoder qw(encode_sereal);
+use Sereal::Decoder qw(decode_sereal);
+
+sub all_chunks {
+    my ($o) = @_;
+    my @chunks;
+    while (defined(my $chunk = $o->next_chunk())) {
+        push @chunks, $chunk;
+    }
+    return \@chunks;
+}
+
+sub file_with {
+    my ($content) = @_;
+    my ($fh, $path) = tempfile(UNLINK => 1);
+    binmode $fh;
+    print $fh $content;
+    close $fh or die "Can't close $path: $!";
+    open $fh, '<', $path or die "Can't open $path: $!";
+    binmode $fh;
+    return $fh;
+}
+
+my $big = do { local(@ARGV, $/) = 'big.srl'; <> };
+
+my $shared = { name => "shared value" };
+my $refs = encode_sereal([ map { { id => $_, ref => $shared, type => "type " . ($_ % 3) } } 1 .. 300 ],
+                         { dedupe_strings => 1 });
+my $snappy = encode_sereal([ map { "string $_" } 1 .. 300 ], { compress => Sereal::Encoder::SRL_SNAPPY() });
+
+foreach my $case ([ "big.srl", $big, 50 * 1024 ], [ "back references", $refs, 100 ], [ "compressed input", $snappy, 100 ]) {
+    my ($name, $data, $size) = @$case;
+    foreach my $compress (SRL_UNCOMPRESSED, SRL_ZSTD) {
+        my $expected = all_chunks(Sereal::Splitter->new({ chunk_size => $size, input => $data, compress => $compress }));
+
+        my $fh = file_with($data);
+        my $got = all_chunks(Sereal::Splitter->new({ chunk_size => $size, input_fh => $fh, compress => $compress }));
+        cmp_ok(scalar @$got, '>', 1, "$name, compress $compress: several chunks");
+        is_deeply($got, $expected, "$name, compress $compress: same chunks as with input");
+    }
+}
+
+# the document starts at the current position of the filehandle
+{
+    my $fh = file_with("some prefix" . $refs);
+    read($fh, my $prefix, length "some prefix");
+    my $o = Sereal::Splitter->new({ chunk_size => 100, input_fh => $fh });
+    is_deeply([ map { @{ decode_sereal($_) } } @{ all_chunks($o) } ], decode_sereal($refs),
+              "document after the current position");
+}
+
+ok(!eval { Sereal::Splitter->new({ chunk_size => 100, input_fh => file_with("") }); 1 },
+   "empty file croaks");
+like($@, qr/lacks data/, "empty file error message");
+
+SKIP: {
+    open my $pipe, '-|', $^X, '-e', 'print "x" x 100' or skip "can't open a pipe", 2;
+    ok(!eval { Sereal::Splitter->new({ chunk_size => 100, input_fh => $pipe }); 1 }, "pipe croaks");
+    like($@, qr/plain file/, "pipe error message");
+    close $pipe;
+}
+
+done_testing;
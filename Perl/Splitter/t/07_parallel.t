@@ -0,0 +1,103 @@
+#!perl
+use strict;
+use warnings;
+use Test::More;
+use File::Temp qw(tempfile);
+
+use Sereal::Splitter qw(:all);
+
+use Sereal::Encoder qw(encode_sereal);
+use Sereal::Decoder qw(decode_sereal);
+
+sub all_chunks {
+    my ($o) = @_;
+    my @chunks;
+    while (defined(my $chunk = $o->next_chunk())) {
+        push @chunks, $chunk;
+    }
+    return \@chunks;
+}
+
+sub decode_chunks {
+    my ($chunks) = @_;
+    return [ map { @{ decode_sereal($_) } } @$chunks ];
+}
+
+my $have_threads = eval { Sereal::Splitter->new({ input => encode_sereal([1]), chunk_size => 1, threads => 2 }); 1 };
+plan skip_all => "threads are not supported on this platform" if !$have_threads;
+
+my $big = do { local(@ARGV, $/) = 'big.srl'; <> };
+
+my $shared = { name => "shared value" };
+my $refs = encode_sereal([ map { { id => $_, ref => $shared, type => "type " . ($_ % 3),
+                                   obj => bless({ n => $_ }, "Some::Class") } } 1 .. 300 ],
+                         { dedupe_strings => 1 });
+my $snappy = encode_sereal([ map { "string $_" } 1 .. 300 ], { compress => Sereal::Encoder::SRL_SNAPPY() });
+
+foreach my $case ([ "big.srl", $big, 50 * 1024 ], [ "back references", $refs, 100 ], [ "compressed input", $snappy, 100 ]) {
+    my ($name, $data, $size) = @$case;
+    my $expected = decode_sereal($data);
+    foreach my $compress (SRL_UNCOMPRESSED, SRL_SNAPPY, SRL_ZLIB, SRL_ZSTD) {
+        my $two = all_chunks(Sereal::Splitter->new({ chunk_size => $size, input => $data, compress => $compress, threads => 2 }));
+        cmp_ok(scalar @$two, '>', 1, "$name, compress $compress: several chunks");
+        is_deeply(decode_chunks($two), $expected, "$name, compress $compress: chunks decode to the input");
+
+        # the chunks only depend on the input, not on the number of threads
+        my $four = all_chunks(Sereal::Splitter->new({ chunk_size => $size, input => $data, compress => $compress, threads => 4 }));
+        is_deeply($four, $two, "$name, compress $compress: same chunks with 2 and 4 threads");
+    }
+}
+
+# more threads than chunks, and an empty array
+is_deeply(decode_chunks(all_chunks(Sereal::Splitter->new({ chunk_size => 1000, input => $refs, threads => 8 }))),
+          decode_sereal($refs), "one chunk, 8 threads");
+is_deeply(all_chunks(Sereal::Splitter->new({ chunk_size => 1000, input => encode_sereal([]), threads => 2 })),
+          [], "no chunks for an empty array");
+
+# input_fh
+{
+    my ($fh, $path) = tempfile(UNLINK => 1);
+    binmode $fh;
+    print $fh $big;
+    close $fh or die "Can't close $path: $!";
+    open $fh, '<', $path or die "Can't open $path: $!";
+    binmode $fh;
+    my $got = all_chunks(Sereal::Splitter->new({ chunk_size => 50 * 1024, input_fh => $fh, threads => 3 }));
+    is_deeply($got, all_chunks(Sereal::Splitter->new({ chunk_size => 50 * 1024, input => $big, threads => 2 })),
+              "input_fh: same chunks as with input");
+}
+
+# a splitter dropped while its workers are busy
+{
+    my $o = Sereal::Splitter->new({ chunk_size => 1024, input => $big, compress => SRL_ZLIB, threads => 4 });
+    ok(defined $o->next_chunk(), "first chunk");
+    undef $o;
+    pass("splitter destroyed while splitting");
+}
+
+# The last element is a COPY of a byte inside a string, which isn't a valid
+# tag. Only the worker following the COPY sees it: the chunks before it are
+# returned, then next_chunk croaks.
+{
+    my $body = chr(0x28) . chr(0x2b) . chr(102)     # REFN, ARRAY of 102 elements
+             . (chr(0x6a) . "x" x 10) x 100        # SHORT_BINARY "xxxxxxxxxx"
+             . chr(0x61) . chr(0x34);              # SHORT_BINARY of a reserved tag
+    my $offset = length($body);                    # offsets start at 1
+    $body .= chr(0x2f) . chr(0x80 | ($offset & 0x7f)) . chr($offset >> 7); # COPY of it
+    my $bad = "=\xF3rl" . chr(3) . chr(0) . $body;
+
+    my $o = Sereal::Splitter->new({ chunk_size => 100, input => $bad, threads => 2 });
+    my @chunks;
+    my $ok = eval { while (defined(my $chunk = $o->next_chunk())) { push @chunks, $chunk } 1 };
+    ok(!$ok, "invalid tag croaks");
+    like($@, qr/Unexpected tag value/, "invalid tag error message");
+    cmp_ok(scalar(@chunks), '>', 1, "the chunks before the invalid one are returned");
+    is_deeply(decode_chunks(\@chunks), [ ("x" x 10) x scalar(map { @{ decode_sereal($_) } } @chunks) ],
+              "the chunks before the invalid one are valid");
+    ok(!defined $o->next_chunk(), "no more chunks after the error");
+}
+
+ok(!eval { Sereal::Splitter->new({ chunk_size => 100, input => $refs, threads => 0 }); 1 },
+   "threads => 0 croaks");
+
+done_testing;
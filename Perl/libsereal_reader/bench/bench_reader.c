@@ -0,0 +1,305 @@
+/* Throughput of libsereal_reader on generated documents, and of the
+ * kernels against their scalar versions.
+ *
+ * Usage:
+ *   ./bench/bench_reader                   # generated documents
+ *   ./bench/bench_reader -n 50 file.srl    # also these files, 50 times each
+ */
+
+#define SRL_READER_STANDALONE
+
+#include <time.h>
+
+#include "srl_common.h"
+#include "srl_protocol.h"
+
+#include "sereal_reader.h"
+
+#define N_ITEMS (1 << 20)
+
+static volatile uint64_t sink;
+
+typedef struct {
+    unsigned char *data;
+    size_t len;
+    size_t size;
+} out_t;
+
+static void
+out_bytes(out_t *out, const void *bytes, size_t len)
+{
+    if (out->len + len > out->size) {
+        out->size = (out->len + len) * 2;
+        out->data = (unsigned char *) realloc(out->data, out->size);
+        if (out->data == NULL) {
+            fprintf(stderr, "Out of memory\n");
+            exit(2);
+        }
+    }
+
+    memcpy(out->data + out->len, bytes, len);
+    out->len += len;
+}
+
+static void
+out_byte(out_t *out, unsigned char b)
+{
+    out_bytes(out, &b, 1);
+}
+
+static void
+out_varint(out_t *out, uint64_t v)
+{
+    while (v >= 0x80) {
+        out_byte(out, (unsigned char) (v | 0x80));
+        v >>= 7;
+    }
+    out_byte(out, (unsigned char) v);
+}
+
+static uint64_t
+random_u64(void)
+{
+    static uint64_t x = UINT64_C(0x9e3779b97f4a7c15);
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return x;
+}
+
+/* values of 1 to 64 bits, the varints of the payload are kept in varints */
+static void
+make_varint_document(out_t *doc, out_t *varints)
+{
+    long i;
+
+    out_bytes(doc, "=\xF3rl\x04\x00", 6);
+    out_byte(doc, SRL_HDR_ARRAY);
+    out_varint(doc, N_ITEMS);
+
+    for (i = 0; i < N_ITEMS; i++) {
+        const uint64_t v = random_u64() >> (random_u64() % 64);
+        out_byte(doc, SRL_HDR_VARINT);
+        out_varint(doc, v);
+        out_varint(varints, v);
+    }
+}
+
+/* strings of 8 to 71 bytes, one in eight has multibyte characters */
+static void
+make_string_document(out_t *doc, out_t *text)
+{
+    static const char ascii[] = "the quick brown fox jumps over the lazy dog, 0123456789 ";
+    long i;
+
+    out_bytes(doc, "=\xF3rl\x04\x00", 6);
+    out_byte(doc, SRL_HDR_ARRAY);
+    out_varint(doc, N_ITEMS / 4);
+
+    for (i = 0; i < N_ITEMS / 4; i++) {
+        unsigned char str[128];
+        size_t len = 8 + random_u64() % 64, j;
+
+        for (j = 0; j < len; j++)
+            str[j] = (unsigned char) ascii[random_u64() % (sizeof(ascii) - 1)];
+        if (i % 8 == 0) {
+            j = random_u64() % (len - 3);
+            memcpy(str + j, "\xe2\x98\xba", 3);
+        }
+
+        out_byte(doc, SRL_HDR_STR_UTF8);
+        out_varint(doc, len);
+        out_bytes(doc, str, len);
+        out_bytes(text, str, len);
+    }
+}
+
+static double
+seconds_since(clock_t start)
+{
+    return (double) (clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void
+report(const char *name, double seconds, long repeat, size_t bytes, uint64_t items)
+{
+    if (seconds <= 0) seconds = 1e-9;
+    printf("%-32s %8.1f MB/s", name, (double) bytes * repeat / seconds / (1024 * 1024));
+    if (items)
+        printf(" %8.1f M items/s", (double) items * repeat / seconds / 1e6);
+    printf("\n");
+}
+
+static void
+bench_varint_kernel(const char *name, const out_t *varints, long repeat,
+                    size_t (*decode)(const unsigned char *, const unsigned char *, uint64_t *))
+{
+    clock_t start = clock();
+    uint64_t count = 0, sum = 0;
+    long r;
+
+    for (r = 0; r < repeat; r++) {
+        const unsigned char *p = varints->data, *end = p + varints->len;
+        count = 0;
+        while (p < end) {
+            uint64_t v;
+            const size_t n = decode(p, end, &v);
+            if (n == 0) abort();
+            p += n;
+            sum += v;
+            count++;
+        }
+    }
+
+    sink = sum;
+    report(name, seconds_since(start), repeat, varints->len, count);
+}
+
+static void
+bench_utf8_kernel(const char *name, const out_t *text, long repeat,
+                  int (*valid)(const unsigned char *, size_t))
+{
+    clock_t start = clock();
+    long r;
+
+    for (r = 0; r < repeat; r++) {
+        if (!valid(text->data, text->len)) abort();
+    }
+
+    report(name, seconds_since(start), repeat, text->len, 0);
+}
+
+/* Read or skip the whole document, returns 0 on errors */
+static int
+bench_document(const char *name, srl_rdr_t *rdr, const unsigned char *data, size_t len,
+               long repeat, int skip)
+{
+    clock_t start = clock();
+    srl_rdr_token_t tok;
+    uint64_t tokens = 0;
+    long r;
+    int rc;
+
+    for (r = 0; r < repeat; r++) {
+        tokens = 0;
+        if (srl_rdr_open(rdr, data, len) != SRL_RDR_OK)
+            goto error;
+
+        if (skip) {
+            if (srl_rdr_next(rdr, &tok) != SRL_RDR_TOKEN || srl_rdr_skip(rdr) != SRL_RDR_OK)
+                goto error;
+            rc = srl_rdr_next(rdr, &tok);
+        } else {
+            while ((rc = srl_rdr_next(rdr, &tok)) == SRL_RDR_TOKEN)
+                tokens++;
+        }
+
+        if (rc != SRL_RDR_END)
+            goto error;
+    }
+
+    report(name, seconds_since(start), repeat, len, tokens);
+    return 1;
+
+  error:
+    fprintf(stderr, "%s: %s\n", name, srl_rdr_error(rdr));
+    return 0;
+}
+
+static unsigned char *
+read_file(const char *name, size_t *len)
+{
+    long size;
+    unsigned char *data;
+    FILE *fh = fopen(name, "rb");
+    if (fh == NULL) return NULL;
+
+    if (fseek(fh, 0, SEEK_END) != 0 || (size = ftell(fh)) < 0 || fseek(fh, 0, SEEK_SET) != 0) {
+        fclose(fh);
+        return NULL;
+    }
+
+    data = (unsigned char *) malloc(size ? size : 1);
+    if (data != NULL && fread(data, 1, size, fh) != (size_t) size) {
+        free(data);
+        data = NULL;
+    }
+
+    fclose(fh);
+    *len = (size_t) size;
+    return data;
+}
+
+int
+main(int argc, char **argv)
+{
+    out_t varint_doc = { NULL, 0, 0 }, varints = { NULL, 0, 0 };
+    out_t string_doc = { NULL, 0, 0 }, text = { NULL, 0, 0 };
+    srl_rdr_config_t config;
+    srl_rdr_t *rdr, *validating;
+    long repeat = 20;
+    int i, status = 0;
+
+    for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            repeat = atol(argv[++i]);
+            if (repeat < 1) repeat = 1;
+        } else {
+            fprintf(stderr, "Usage: %s [-n repeat] [file.srl ...]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    memset(&config, 0, sizeof(config));
+    rdr = srl_rdr_new(&config);
+    config.flags = SRL_RDR_F_VALIDATE_UTF8;
+    validating = srl_rdr_new(&config);
+    if (rdr == NULL || validating == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return 2;
+    }
+
+    make_varint_document(&varint_doc, &varints);
+    make_string_document(&string_doc, &text);
+    printf("kernels: %s, %ld runs each\n", srl_rdr_kernels(), repeat);
+
+    bench_varint_kernel("varint kernel", &varints, repeat, srl_rdr_varint_decode);
+    bench_varint_kernel("varint scalar", &varints, repeat, srl_rdr_varint_decode_scalar);
+    bench_utf8_kernel("utf8 kernel", &text, repeat, srl_rdr_utf8_valid);
+    bench_utf8_kernel("utf8 scalar", &text, repeat, srl_rdr_utf8_valid_scalar);
+
+    if (!bench_document("varint document", rdr, varint_doc.data, varint_doc.len, repeat, 0)
+        || !bench_document("varint document, skip", rdr, varint_doc.data, varint_doc.len, repeat, 1)
+        || !bench_document("string document", rdr, string_doc.data, string_doc.len, repeat, 0)
+        || !bench_document("string document, validate", validating, string_doc.data, string_doc.len, repeat, 0)
+        || !bench_document("string document, skip", rdr, string_doc.data, string_doc.len, repeat, 1))
+    {
+        status = 1;
+    }
+
+    for (; i < argc; i++) {
+        size_t len;
+        unsigned char *data = read_file(argv[i], &len);
+
+        if (data == NULL) {
+            fprintf(stderr, "%s: can't read file\n", argv[i]);
+            status = 1;
+            continue;
+        }
+
+        if (!bench_document(argv[i], rdr, data, len, repeat, 0)
+            || !bench_document("  skip", rdr, data, len, repeat, 1))
+        {
+            status = 1;
+        }
+        free(data);
+    }
+
+    free(varint_doc.data);
+    free(varints.data);
+    free(string_doc.data);
+    free(text.data);
+    srl_rdr_free(rdr);
+    srl_rdr_free(validating);
+    return status;
+}
@@ -0,0 +1,125 @@
+#ifndef SEREAL_READER_H_
+#define SEREAL_READER_H_
+
+/* libsereal_reader: reads Sereal documents without an interpreter.
+ *
+ * A reader opens one document at a time, decompresses its body if needed
+ * and hands out the body as a stream of tokens, one per tag, in document
+ * order. Containers are not materialized, a token says how many items
+ * follow it instead, and the reader keeps track of the nesting.
+ *
+ *   srl_rdr_t *rdr = srl_rdr_new(NULL);
+ *   srl_rdr_token_t tok;
+ *   int rc;
+ *
+ *   if (srl_rdr_open(rdr, data, len) != SRL_RDR_OK) ... srl_rdr_error(rdr) ...
+ *   while ((rc = srl_rdr_next(rdr, &tok)) == SRL_RDR_TOKEN) { ... }
+ *   if (rc == SRL_RDR_ERR) ... srl_rdr_error(rdr) ...
+ *   srl_rdr_free(rdr);
+ *
+ * All memory is obtained through the allocator of the configuration and
+ * errors are reported through the reader, there is no global state. Tag
+ * values are the SRL_HDR_* constants of srl_protocol.h. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* return values */
+#define SRL_RDR_OK      0
+#define SRL_RDR_TOKEN   1   /* srl_rdr_next() returned a token */
+#define SRL_RDR_END     0   /* srl_rdr_next(): the root item is complete */
+#define SRL_RDR_ERR     (-1)
+
+/* srl_rdr_config_t flags */
+#define SRL_RDR_F_VALIDATE_UTF8     0x01    /* reject STR_UTF8 strings which are not valid UTF-8 */
+#define SRL_RDR_F_REFUSE_COMPRESSED 0x02    /* don't decompress, fail on compressed documents */
+
+typedef struct srl_rdr_allocator {
+    void *(*alloc)(void *ud, size_t size);
+    void *(*realloc)(void *ud, void *ptr, size_t size);
+    void  (*free)(void *ud, void *ptr);
+    void *ud;
+} srl_rdr_allocator_t;
+
+/* Called with the message of every error, before the failing call returns */
+typedef void (*srl_rdr_error_handler_t)(void *ud, const char *message);
+
+typedef struct srl_rdr_config {
+    srl_rdr_allocator_t allocator;      /* all NULL: malloc(), realloc() and free() */
+    srl_rdr_error_handler_t on_error;   /* optional */
+    void *error_ud;
+    uint32_t flags;                     /* SRL_RDR_F_* */
+    uint32_t max_depth;                 /* 0: 10000 */
+} srl_rdr_config_t;
+
+typedef struct srl_rdr_token {
+    uint8_t tag;            /* tag without track flag */
+    uint8_t tracked;        /* track flag was set, REFP and ALIAS may refer to the item */
+    uint32_t depth;         /* nesting depth, 0 for the root item */
+    size_t offset;          /* offset of the tag, as used by COPY, REFP, ALIAS and OBJECTV */
+    uint64_t uv;            /* POS and VARINT values, offsets of COPY, REFP, ALIAS and OBJECTV,
+                             * element counts of arrays and pair counts of hashes */
+    int64_t iv;             /* POS, NEG and ZIGZAG values */
+    double nv;              /* FLOAT and DOUBLE values */
+    const unsigned char *str; /* payload of strings and the raw bytes of LONG_DOUBLE */
+    size_t len;
+} srl_rdr_token_t;          /* fields which don't apply to the tag are 0 */
+
+typedef struct srl_rdr srl_rdr_t;
+
+/* config is copied, NULL means defaults. Returns NULL if out of memory. */
+srl_rdr_t *srl_rdr_new(const srl_rdr_config_t *config);
+void srl_rdr_free(srl_rdr_t *rdr);
+
+/* Message of the last error */
+const char *srl_rdr_error(const srl_rdr_t *rdr);
+
+/* Read the header of the document in data and decompress its body.
+ * Uncompressed documents are read in place, so data has to outlive the
+ * tokens. Decompressed bodies live in the reader until the next call. */
+int srl_rdr_open(srl_rdr_t *rdr, const unsigned char *data, size_t len);
+
+int srl_rdr_version(const srl_rdr_t *rdr);
+int srl_rdr_encoding(const srl_rdr_t *rdr);     /* SRL_PROTOCOL_ENCODING_* */
+
+/* The user header, itself a Sereal body, or NULL if there is none */
+const unsigned char *srl_rdr_user_header(const srl_rdr_t *rdr, size_t *len);
+
+/* Length of the document within data. Known after srl_rdr_open() for
+ * compressed documents, otherwise once srl_rdr_next() returned SRL_RDR_END.
+ * Returns 0 while unknown. */
+size_t srl_rdr_document_length(const srl_rdr_t *rdr);
+
+/* Next token of the body: SRL_RDR_TOKEN, SRL_RDR_END or SRL_RDR_ERR.
+ * PAD tags are skipped. */
+int srl_rdr_next(srl_rdr_t *rdr, srl_rdr_token_t *tok);
+
+/* Skip the contents of the item the last token started, so that the next
+ * token is the one after it. Does nothing after tokens without contents.
+ * Returns SRL_RDR_OK or SRL_RDR_ERR. */
+int srl_rdr_skip(srl_rdr_t *rdr);
+
+/* Kernels, also used by srl_rdr_next(). The _scalar variants are the
+ * reference implementations, for tests and benchmarks. */
+
+/* Decode the varint at p, returns its length or 0 if it is truncated or too long */
+size_t srl_rdr_varint_decode(const unsigned char *p, const unsigned char *end, uint64_t *value);
+size_t srl_rdr_varint_decode_scalar(const unsigned char *p, const unsigned char *end, uint64_t *value);
+
+/* Whether s is well-formed UTF-8 (RFC 3629: no overlong forms, surrogates
+ * or code points above 0x10FFFF) */
+int srl_rdr_utf8_valid(const unsigned char *s, size_t len);
+int srl_rdr_utf8_valid_scalar(const unsigned char *s, size_t len);
+
+/* Name of the kernel implementation compiled in: "sse2", "swar" or "scalar" */
+const char *srl_rdr_kernels(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
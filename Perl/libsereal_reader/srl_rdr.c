@@ -0,0 +1,641 @@
+/* libsereal_reader: Sereal documents as a stream of tokens, see
+ * sereal_reader.h. Built on the reader headers of Perl/shared in their
+ * standalone mode, errors longjmp() back to the public function which
+ * was called and are reported from there. */
+
+#define SRL_READER_STANDALONE
+#define ZSTD_STATIC_LINKING_ONLY
+
+#include "srl_common.h"
+#include "srl_protocol.h"
+#include "srl_reader.h"
+#include "srl_reader_error.h"
+#include "srl_reader_varint.h"
+#include "srl_reader_misc.h"
+#include "srl_reader_decompress.h"
+
+#include "sereal_reader.h"
+#include "srl_rdr_kernels.h"
+
+#define SRL_RDR_DEFAULT_MAX_DEPTH 10000
+
+enum {
+    SRL_RDR_S_CLOSED,   /* no document */
+    SRL_RDR_S_BODY,     /* reading the body */
+    SRL_RDR_S_DONE,     /* root item complete */
+    SRL_RDR_S_FAILED
+};
+
+struct srl_rdr {
+    srl_rdr_config_t config;
+    srl_reader_error_ctx_t err;
+    srl_reader_buffer_t buf;
+    int state;
+    int version;
+    int encoding;
+    const unsigned char *user_header;
+    size_t user_header_len;
+    size_t document_length;
+
+    unsigned char *body;        /* decompressed body, reused between documents */
+    size_t body_size;
+    mz_stream *zstrm;           /* created on first use */
+    ZSTD_DCtx *dctx;            /* created on first use */
+
+    UV *items_left;             /* items each open item is still waiting for */
+    U32 depth;
+    U32 stack_size;
+    int opened;                 /* the last token opened an item */
+};
+
+static void *
+srl_rdr_default_alloc(void *ud, size_t size)
+{
+    (void) ud;
+    return malloc(size);
+}
+
+static void *
+srl_rdr_default_realloc(void *ud, void *ptr, size_t size)
+{
+    (void) ud;
+    return realloc(ptr, size);
+}
+
+static void
+srl_rdr_default_free(void *ud, void *ptr)
+{
+    (void) ud;
+    free(ptr);
+}
+
+/* allocation in the middle of reading, fails with an error */
+static void *
+srl_rdr_realloc(srl_rdr_t *rdr, void *ptr, size_t size)
+{
+    const srl_rdr_allocator_t *a = &rdr->config.allocator;
+    void *p = ptr ? a->realloc(a->ud, ptr, size) : a->alloc(a->ud, size);
+    if (expect_false(p == NULL))
+        SRL_RDR_ERROR(&rdr->buf, "Out of memory");
+    return p;
+}
+
+static void *
+srl_rdr_mz_alloc(void *opaque, size_t items, size_t size)
+{
+    const srl_rdr_allocator_t *a = &((srl_rdr_t *) opaque)->config.allocator;
+    if (size && items > SIZE_MAX / size)
+        return NULL;
+    return a->alloc(a->ud, items * size);
+}
+
+static void
+srl_rdr_mz_free(void *opaque, void *address)
+{
+    const srl_rdr_allocator_t *a = &((srl_rdr_t *) opaque)->config.allocator;
+    if (address != NULL)
+        a->free(a->ud, address);
+}
+
+static void
+srl_rdr_zstd_free(void *opaque, void *address)
+{
+    srl_rdr_mz_free(opaque, address);
+}
+
+static void *
+srl_rdr_zstd_alloc(void *opaque, size_t size)
+{
+    return srl_rdr_mz_alloc(opaque, 1, size);
+}
+
+srl_rdr_t *
+srl_rdr_new(const srl_rdr_config_t *config)
+{
+    srl_rdr_t *rdr;
+    srl_rdr_config_t cfg;
+
+    if (config != NULL) {
+        cfg = *config;
+    } else {
+        memset(&cfg, 0, sizeof(cfg));
+    }
+
+    if (cfg.allocator.alloc == NULL || cfg.allocator.realloc == NULL || cfg.allocator.free == NULL) {
+        cfg.allocator.alloc = srl_rdr_default_alloc;
+        cfg.allocator.realloc = srl_rdr_default_realloc;
+        cfg.allocator.free = srl_rdr_default_free;
+        cfg.allocator.ud = NULL;
+    }
+    if (cfg.max_depth == 0)
+        cfg.max_depth = SRL_RDR_DEFAULT_MAX_DEPTH;
+
+    rdr = (srl_rdr_t *) cfg.allocator.alloc(cfg.allocator.ud, sizeof(srl_rdr_t));
+    if (rdr == NULL)
+        return NULL;
+
+    memset(rdr, 0, sizeof(srl_rdr_t));
+    rdr->config = cfg;
+    rdr->buf.error_ctx = &rdr->err;
+    rdr->state = SRL_RDR_S_CLOSED;
+    return rdr;
+}
+
+void
+srl_rdr_free(srl_rdr_t *rdr)
+{
+    srl_rdr_allocator_t a;
+
+    if (rdr == NULL)
+        return;
+
+    a = rdr->config.allocator;
+    if (rdr->zstrm != NULL) {
+        mz_inflateEnd(rdr->zstrm);
+        a.free(a.ud, rdr->zstrm);
+    }
+    if (rdr->dctx != NULL)
+        ZSTD_freeDCtx(rdr->dctx);
+    if (rdr->body != NULL)
+        a.free(a.ud, rdr->body);
+    if (rdr->items_left != NULL)
+        a.free(a.ud, rdr->items_left);
+    a.free(a.ud, rdr);
+}
+
+const char *
+srl_rdr_error(const srl_rdr_t *rdr)
+{
+    return rdr->err.message;
+}
+
+static int
+srl_rdr_failed(srl_rdr_t *rdr)
+{
+    rdr->state = SRL_RDR_S_FAILED;
+    if (rdr->config.on_error != NULL)
+        rdr->config.on_error(rdr->config.error_ud, rdr->err.message);
+    return SRL_RDR_ERR;
+}
+
+/* varints, read with the kernels of srl_rdr_kernels.h */
+
+static void
+srl_rdr_varint_error(srl_reader_buffer_t *buf)
+{
+    size_t i;
+
+    for (i = 0; i < 10 && buf->pos + i < buf->end; i++) {
+        if (!(buf->pos[i] & 0x80))
+            SRL_RDR_ERROR(buf, "varint too big");
+    }
+
+    if (i < 10)
+        SRL_RDR_ERROR(buf, "end of packet reached before varint parsed");
+    SRL_RDR_ERROR(buf, "varint not terminated in time, corrupt packet");
+}
+
+SRL_STATIC_INLINE UV
+srl_rdr_read_varint(srl_reader_buffer_t *buf)
+{
+    UV uv;
+    const size_t n = srl_rdr_varint_decode_inline(buf->pos, buf->end, &uv);
+
+    if (expect_false(n == 0))
+        srl_rdr_varint_error(buf);
+
+    buf->pos += n;
+    return uv;
+}
+
+SRL_STATIC_INLINE UV
+srl_rdr_read_varint_length(srl_reader_buffer_t *buf, const char * const errstr)
+{
+    const UV len = srl_rdr_read_varint(buf);
+    SRL_RDR_ASSERT_SPACE(buf, len, errstr);
+    return len;
+}
+
+SRL_STATIC_INLINE UV
+srl_rdr_read_varint_count(srl_reader_buffer_t *buf, const char * const errstr)
+{
+    const UV len = srl_rdr_read_varint(buf);
+    if (expect_false(len > I32_MAX)) {
+        SRL_RDR_ERRORf3(buf, "Corrupted packet%s. Count %"UVuf" exceeds I32_MAX (%i), which is impossible.",
+                        errstr, len, I32_MAX);
+    }
+    return len;
+}
+
+SRL_STATIC_INLINE UV
+srl_rdr_read_varint_offset(srl_reader_buffer_t *buf, const char * const errstr)
+{
+    const UV offset = srl_rdr_read_varint(buf);
+    /* only things which precede it can be referred to */
+    if (expect_false(offset >= (UV) SRL_RDR_BODY_POS_OFS(buf))) {
+        SRL_RDR_ERRORf4(buf, "Corrupted packet%s. Offset %"UVuf" points past current position %"UVuf" in packet with length of %"UVuf" bytes long",
+                        errstr, offset, (UV) SRL_RDR_POS_OFS(buf), (UV) SRL_RDR_SIZE(buf));
+    }
+    return offset;
+}
+
+/* header and decompression */
+
+static mz_streamp
+srl_rdr_zlib_stream(srl_rdr_t *rdr)
+{
+    if (rdr->zstrm == NULL) {
+        mz_streamp strm = (mz_streamp) srl_rdr_realloc(rdr, NULL, sizeof(mz_stream));
+
+        memset(strm, 0, sizeof(mz_stream));
+        strm->zalloc = srl_rdr_mz_alloc;
+        strm->zfree = srl_rdr_mz_free;
+        strm->opaque = rdr;
+        if (mz_inflateInit(strm) != Z_OK) {
+            srl_rdr_mz_free(rdr, strm);
+            SRL_RDR_ERROR(&rdr->buf, "Failed to initialize zlib stream");
+        }
+        rdr->zstrm = strm;
+    }
+
+    return rdr->zstrm;
+}
+
+static ZSTD_DCtx *
+srl_rdr_zstd_dctx(srl_rdr_t *rdr)
+{
+    if (rdr->dctx == NULL) {
+        ZSTD_customMem mem;
+
+        mem.customAlloc = srl_rdr_zstd_alloc;
+        mem.customFree = srl_rdr_zstd_free;
+        mem.opaque = rdr;
+        rdr->dctx = ZSTD_createDCtx_advanced(mem);
+        if (rdr->dctx == NULL)
+            SRL_RDR_ERROR(&rdr->buf, "Out of memory");
+    }
+
+    return rdr->dctx;
+}
+
+static void
+srl_rdr_decompress(srl_rdr_t *rdr)
+{
+    srl_reader_buffer_t *buf = &rdr->buf;
+    srl_compressed_body_t body;
+    mz_streamp strm = NULL;
+    ZSTD_DCtx *dctx = NULL;
+    const size_t header_len = (size_t) SRL_RDR_POS_OFS(buf);
+
+    srl_read_compressed_body(buf, (U8) rdr->encoding, &body);
+    if (rdr->encoding == SRL_PROTOCOL_ENCODING_ZLIB) {
+        strm = srl_rdr_zlib_stream(rdr);
+    } else if (rdr->encoding == SRL_PROTOCOL_ENCODING_ZSTD) {
+        dctx = srl_rdr_zstd_dctx(rdr);
+    }
+
+    if (expect_false(body.body_len > SIZE_MAX - header_len))
+        SRL_RDR_ERROR(buf, "Out of memory");
+
+    if (header_len + body.body_len > rdr->body_size) {
+        rdr->body = (unsigned char *) srl_rdr_realloc(rdr, rdr->body, header_len + body.body_len);
+        rdr->body_size = header_len + body.body_len;
+    }
+
+    /* offsets of protocol version 1 count from the start of the document */
+    memcpy(rdr->body, buf->start, header_len);
+    buf->start = rdr->body;
+    buf->pos = buf->start + header_len;
+    buf->end = buf->pos + body.body_len;
+
+    srl_decompress_body_into(buf, (U8) rdr->encoding, &body, rdr->body + header_len, strm, dctx);
+    rdr->document_length = (size_t) body.bytes_consumed;
+}
+
+static void
+srl_rdr_read_header(srl_rdr_t *rdr)
+{
+    srl_reader_buffer_t *buf = &rdr->buf;
+    UV header_len;
+    const IV version_encoding = srl_validate_header_version(buf->pos, (STRLEN) SRL_RDR_SPACE_LEFT(buf));
+
+    if (expect_false(version_encoding < 1)) {
+        if (version_encoding == 0)
+            SRL_RDR_ERROR(buf, "Bad Sereal header: It seems your document was accidentally UTF-8 encoded");
+        SRL_RDR_ERROR(buf, "Bad Sereal header: Not a valid Sereal document.");
+    }
+
+    buf->pos += SRL_MAGIC_STRLEN + 1;
+    rdr->version = (int) (version_encoding & SRL_PROTOCOL_VERSION_MASK);
+    rdr->encoding = (int) (version_encoding & SRL_PROTOCOL_ENCODING_MASK);
+
+    if (expect_false(rdr->version > SRL_PROTOCOL_VERSION))
+        SRL_RDR_ERRORf1(buf, "Unsupported Sereal protocol version %u", (unsigned int) rdr->version);
+
+    if (expect_false(rdr->encoding > SRL_PROTOCOL_ENCODING_ZSTD)) {
+        SRL_RDR_ERRORf1(buf, "Sereal document encoded in an unknown format '%d'",
+                        rdr->encoding >> SRL_PROTOCOL_VERSION_BITS);
+    }
+
+    if (expect_false(rdr->encoding != SRL_PROTOCOL_ENCODING_RAW
+                     && (rdr->config.flags & SRL_RDR_F_REFUSE_COMPRESSED)))
+    {
+        SRL_RDR_ERROR(buf, "Sereal document is compressed, "
+                      "but this reader is configured to refuse compressed input.");
+    }
+
+    header_len = srl_rdr_read_varint_length(buf, " while reading header");
+    if (rdr->version > 1 && header_len && (*buf->pos & SRL_PROTOCOL_HDR_USER_DATA)) {
+        rdr->user_header = buf->pos + 1;
+        rdr->user_header_len = (size_t) header_len - 1;
+    }
+    buf->pos += header_len;
+
+    if (rdr->encoding != SRL_PROTOCOL_ENCODING_RAW)
+        srl_rdr_decompress(rdr);
+
+    SRL_RDR_ASSERT_SPACE(buf, 1, " while reading body");
+    SRL_RDR_UPDATE_BODY_POS(buf, rdr->version);
+}
+
+int
+srl_rdr_open(srl_rdr_t *rdr, const unsigned char *data, size_t len)
+{
+    rdr->buf.start = rdr->buf.pos = rdr->buf.body_pos = data;
+    rdr->buf.end = data + len;
+    rdr->user_header = NULL;
+    rdr->user_header_len = 0;
+    rdr->document_length = 0;
+    rdr->version = 0;
+    rdr->encoding = 0;
+    rdr->depth = 0;
+    rdr->opened = 0;
+    rdr->err.message[0] = '\0';
+
+    if (setjmp(rdr->err.env) != 0)
+        return srl_rdr_failed(rdr);
+
+    srl_rdr_read_header(rdr);
+    rdr->state = SRL_RDR_S_BODY;
+    return SRL_RDR_OK;
+}
+
+int
+srl_rdr_version(const srl_rdr_t *rdr)
+{
+    return rdr->version;
+}
+
+int
+srl_rdr_encoding(const srl_rdr_t *rdr)
+{
+    return rdr->encoding;
+}
+
+const unsigned char *
+srl_rdr_user_header(const srl_rdr_t *rdr, size_t *len)
+{
+    if (len != NULL)
+        *len = rdr->user_header_len;
+    return rdr->user_header;
+}
+
+size_t
+srl_rdr_document_length(const srl_rdr_t *rdr)
+{
+    return rdr->document_length;
+}
+
+/* tokens */
+
+/* Read the tag at buf->pos with its payload, filling in tok if fill is
+ * true. Returns the number of items which belong to the tag. */
+SRL_STATIC_INLINE UV
+srl_rdr_read_tag(srl_rdr_t *rdr, srl_rdr_token_t *tok, const int fill)
+{
+    srl_reader_buffer_t *buf = &rdr->buf;
+    UV len, children = 0;
+    U8 tag;
+
+    while (SRL_RDR_NOT_DONE(buf) && (*buf->pos & ~SRL_HDR_TRACK_FLAG) == SRL_HDR_PAD)
+        buf->pos++;
+
+    if (expect_false(SRL_RDR_DONE(buf))) {
+        SRL_RDR_ERROR_EOF(buf, "a tag");
+    }
+
+    if (fill) {
+        tok->offset = (size_t) SRL_RDR_BODY_POS_OFS(buf);
+        tok->tracked = (*buf->pos & SRL_HDR_TRACK_FLAG) ? 1 : 0;
+        tok->depth = rdr->depth;
+        tok->uv = 0;
+        tok->iv = 0;
+        tok->nv = 0;
+        tok->str = NULL;
+        tok->len = 0;
+    }
+
+    tag = *buf->pos++ & ~SRL_HDR_TRACK_FLAG;
+    if (fill)
+        tok->tag = tag;
+
+    if (tag <= SRL_HDR_NEG_HIGH) {
+        if (fill) {
+            if (tag <= SRL_HDR_POS_HIGH) tok->uv = tag;
+            tok->iv = tag <= SRL_HDR_POS_HIGH ? (IV) tag : (IV) tag - 32;
+        }
+    } else if (tag >= SRL_HDR_SHORT_BINARY_LOW) {
+        len = SRL_HDR_SHORT_BINARY_LEN_FROM_TAG(tag);
+        SRL_RDR_ASSERT_SPACE(buf, len, " while reading SHORT_BINARY");
+        if (fill) {
+            tok->str = buf->pos;
+            tok->len = (size_t) len;
+        }
+        buf->pos += len;
+    } else if (tag >= SRL_HDR_HASHREF_LOW) {
+        len = SRL_HDR_HASHREF_LEN_FROM_TAG(tag);
+        if (fill) tok->uv = len;
+        children = 2 * len;
+    } else if (tag >= SRL_HDR_ARRAYREF_LOW) {
+        len = SRL_HDR_ARRAYREF_LEN_FROM_TAG(tag);
+        if (fill) tok->uv = len;
+        children = len;
+    } else {
+        switch (tag) {
+            case SRL_HDR_VARINT:
+                len = srl_rdr_read_varint(buf);
+                if (fill) tok->uv = len;
+                break;
+
+            case SRL_HDR_ZIGZAG:
+                len = srl_rdr_read_varint(buf);
+                if (fill) tok->iv = (IV) (len >> 1) ^ -(IV) (len & 1);
+                break;
+
+            case SRL_HDR_FLOAT:
+                SRL_RDR_ASSERT_SPACE(buf, 4, " while reading FLOAT");
+                if (fill) {
+                    float f;
+                    memcpy(&f, buf->pos, 4);
+                    tok->nv = f;
+                }
+                buf->pos += 4;
+                break;
+
+            case SRL_HDR_DOUBLE:
+                SRL_RDR_ASSERT_SPACE(buf, 8, " while reading DOUBLE");
+                if (fill) memcpy(&tok->nv, buf->pos, 8);
+                buf->pos += 8;
+                break;
+
+            case SRL_HDR_LONG_DOUBLE:
+                SRL_RDR_ASSERT_SPACE(buf, 16, " while reading LONG_DOUBLE");
+                if (fill) {
+                    tok->str = buf->pos;
+                    tok->len = 16;
+                }
+                buf->pos += 16;
+                break;
+
+            case SRL_HDR_UNDEF:
+            case SRL_HDR_CANONICAL_UNDEF:
+            case SRL_HDR_TRUE:
+            case SRL_HDR_FALSE:
+                break;
+
+            case SRL_HDR_BINARY:
+            case SRL_HDR_STR_UTF8:
+                len = srl_rdr_read_varint_length(buf, " while reading BINARY or STR_UTF8");
+                if (fill) {
+                    tok->str = buf->pos;
+                    tok->len = (size_t) len;
+                    if (tag == SRL_HDR_STR_UTF8 && (rdr->config.flags & SRL_RDR_F_VALIDATE_UTF8)
+                        && !srl_rdr_utf8_valid_inline(buf->pos, (size_t) len))
+                    {
+                        SRL_RDR_ERROR(buf, "Invalid UTF-8 in STR_UTF8 string");
+                    }
+                }
+                buf->pos += len;
+                break;
+
+            case SRL_HDR_REFP:
+            case SRL_HDR_ALIAS:
+            case SRL_HDR_COPY:
+                len = srl_rdr_read_varint_offset(buf, " while reading REFP, ALIAS or COPY");
+                if (fill) tok->uv = len;
+                break;
+
+            case SRL_HDR_OBJECTV:
+            case SRL_HDR_OBJECTV_FREEZE:
+                len = srl_rdr_read_varint_offset(buf, " while reading OBJECTV");
+                if (fill) tok->uv = len;
+                children = 1;
+                break;
+
+            case SRL_HDR_REFN:
+            case SRL_HDR_WEAKEN:
+                children = 1;
+                break;
+
+            case SRL_HDR_OBJECT:
+            case SRL_HDR_OBJECT_FREEZE:
+            case SRL_HDR_REGEXP:
+                children = 2;
+                break;
+
+            case SRL_HDR_HASH:
+                len = srl_rdr_read_varint_count(buf, " while reading HASH");
+                if (fill) tok->uv = len;
+                children = 2 * len;
+                break;
+
+            case SRL_HDR_ARRAY:
+                len = srl_rdr_read_varint_count(buf, " while reading ARRAY");
+                if (fill) tok->uv = len;
+                children = len;
+                break;
+
+            default:
+                buf->pos--;
+                SRL_RDR_ERROR_UNEXPECTED(buf, tag, "a valid tag");
+        }
+    }
+
+    return children;
+}
+
+/* Account for an item with children items, close the items it completes */
+SRL_STATIC_INLINE void
+srl_rdr_item_read(srl_rdr_t *rdr, UV children)
+{
+    if (children) {
+        if (expect_false(rdr->depth >= rdr->config.max_depth))
+            SRL_RDR_ERRORf1(&rdr->buf, "Reached recursion limit (%u) during deserialization", (unsigned int) rdr->config.max_depth);
+
+        if (expect_false(rdr->depth == rdr->stack_size)) {
+            const U32 size = rdr->stack_size ? rdr->stack_size * 2 : 32;
+            rdr->items_left = (UV *) srl_rdr_realloc(rdr, rdr->items_left, size * sizeof(UV));
+            rdr->stack_size = size;
+        }
+
+        rdr->items_left[rdr->depth++] = children;
+        rdr->opened = 1;
+        return;
+    }
+
+    rdr->opened = 0;
+    while (rdr->depth > 0 && --rdr->items_left[rdr->depth - 1] == 0)
+        rdr->depth--;
+
+    if (rdr->depth == 0) {
+        rdr->state = SRL_RDR_S_DONE;
+        if (rdr->encoding == SRL_PROTOCOL_ENCODING_RAW)
+            rdr->document_length = (size_t) SRL_RDR_POS_OFS(&rdr->buf);
+    }
+}
+
+static int
+srl_rdr_not_reading(srl_rdr_t *rdr)
+{
+    if (rdr->state == SRL_RDR_S_DONE)
+        return SRL_RDR_END;
+    if (rdr->state == SRL_RDR_S_CLOSED) {
+        snprintf(rdr->err.message, sizeof(rdr->err.message), "Sereal: Error: no document is open");
+        return srl_rdr_failed(rdr);
+    }
+    return SRL_RDR_ERR;
+}
+
+int
+srl_rdr_next(srl_rdr_t *rdr, srl_rdr_token_t *tok)
+{
+    if (expect_false(rdr->state != SRL_RDR_S_BODY))
+        return srl_rdr_not_reading(rdr);
+
+    if (setjmp(rdr->err.env) != 0)
+        return srl_rdr_failed(rdr);
+
+    srl_rdr_item_read(rdr, srl_rdr_read_tag(rdr, tok, 1));
+    return SRL_RDR_TOKEN;
+}
+
+int
+srl_rdr_skip(srl_rdr_t *rdr)
+{
+    srl_rdr_token_t unused;
+    U32 depth;
+
+    if (!rdr->opened)
+        return rdr->state == SRL_RDR_S_FAILED ? SRL_RDR_ERR : SRL_RDR_OK;
+
+    if (setjmp(rdr->err.env) != 0)
+        return srl_rdr_failed(rdr);
+
+    depth = rdr->depth - 1;
+    do {
+        srl_rdr_item_read(rdr, srl_rdr_read_tag(rdr, &unused, 0));
+    } while (rdr->depth > depth);
+
+    rdr->opened = 0;
+    return SRL_RDR_OK;
+}
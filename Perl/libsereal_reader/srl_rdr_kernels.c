@@ -0,0 +1,40 @@
+/* Exported versions of the kernels in srl_rdr_kernels.h */
+
+#define SRL_READER_STANDALONE
+
+#include "srl_rdr_kernels.h"
+#include "sereal_reader.h"
+
+size_t
+srl_rdr_varint_decode(const unsigned char *p, const unsigned char *end, uint64_t *value)
+{
+    return srl_rdr_varint_decode_inline(p, end, value);
+}
+
+size_t
+srl_rdr_varint_decode_scalar(const unsigned char *p, const unsigned char *end, uint64_t *value)
+{
+    return srl_rdr_varint_decode_scalar_inline(p, end, value);
+}
+
+int
+srl_rdr_utf8_valid(const unsigned char *s, size_t len)
+{
+    return srl_rdr_utf8_valid_inline(s, len);
+}
+
+int
+srl_rdr_utf8_valid_scalar(const unsigned char *s, size_t len)
+{
+    return srl_rdr_utf8_valid_scalar_inline(s, len);
+}
+
+const char *
+srl_rdr_kernels(void)
+{
+#ifdef SRL_RDR_BMI2
+    return SRL_RDR_KERNELS_NAME "+bmi2";
+#else
+    return SRL_RDR_KERNELS_NAME;
+#endif
+}
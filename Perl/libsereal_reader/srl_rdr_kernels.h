@@ -0,0 +1,184 @@
+#ifndef SRL_RDR_KERNELS_H_
+#define SRL_RDR_KERNELS_H_
+
+/* Varint decoding and UTF-8 validation. The scalar versions handle one
+ * byte at a time. Where 64-bit little endian words can be used, varints
+ * of up to 8 bytes are decoded from a single load (with BMI2's pext if
+ * available) and UTF-8 validation skips ASCII runs 8 bytes at a time, or
+ * 16 at a time with SSE2. Define SRL_RDR_NO_SIMD to build only the
+ * scalar versions. */
+
+#include "srl_common.h"
+
+#if !defined(SRL_RDR_NO_SIMD) && defined(__GNUC__) && defined(__LP64__) \
+    && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#   define SRL_RDR_SWAR 1
+#   if defined(__SSE2__)
+#       define SRL_RDR_SSE2 1
+#       include <emmintrin.h>
+#   endif
+#   if defined(__BMI2__)
+#       define SRL_RDR_BMI2 1
+#       include <immintrin.h>
+#   endif
+#endif
+
+#if defined(SRL_RDR_SSE2)
+#   define SRL_RDR_KERNELS_NAME "sse2"
+#elif defined(SRL_RDR_SWAR)
+#   define SRL_RDR_KERNELS_NAME "swar"
+#else
+#   define SRL_RDR_KERNELS_NAME "scalar"
+#endif
+
+#define SRL_RDR_HIGH_BITS UINT64_C(0x8080808080808080)
+
+/* Returns the length of the varint at p, 0 if it is truncated or
+ * doesn't fit 64 bits */
+SRL_STATIC_INLINE size_t
+srl_rdr_varint_decode_scalar_inline(const U8 *p, const U8 *end, UV *value)
+{
+    UV uv = 0;
+    size_t i;
+    const size_t max = end - p < 10 ? (size_t) (end - p) : 10;
+
+    for (i = 0; i < max; i++) {
+        const U8 b = p[i];
+        if (expect_false(i == 9 && b > 1))
+            return 0;
+
+        uv |= (UV) (b & 0x7f) << (7 * i);
+        if (!(b & 0x80)) {
+            *value = uv;
+            return i + 1;
+        }
+    }
+
+    return 0;
+}
+
+SRL_STATIC_INLINE size_t
+srl_rdr_varint_decode_inline(const U8 *p, const U8 *end, UV *value)
+{
+    if (expect_true(p < end && !(*p & 0x80))) {
+        *value = *p;
+        return 1;
+    }
+
+#ifdef SRL_RDR_SWAR
+    if (expect_true(end - p >= 8)) {
+        uint64_t w, stop;
+
+        memcpy(&w, p, 8);
+        stop = ~w & SRL_RDR_HIGH_BITS;
+        if (expect_true(stop != 0)) {
+            const unsigned int n = (__builtin_ctzll(stop) >> 3) + 1;
+
+            w &= UINT64_MAX >> (64 - 8 * n);
+#   ifdef SRL_RDR_BMI2
+            *value = _pext_u64(w, UINT64_C(0x7f7f7f7f7f7f7f7f));
+#   else
+            /* squeeze the 7 bit groups together: pairs, then quads, then all */
+            w &= UINT64_C(0x7f7f7f7f7f7f7f7f);
+            w = ((w & UINT64_C(0x7f007f007f007f00)) >> 1) | (w & UINT64_C(0x007f007f007f007f));
+            w = ((w & UINT64_C(0x3fff00003fff0000)) >> 2) | (w & UINT64_C(0x00003fff00003fff));
+            w = ((w & UINT64_C(0x0fffffff00000000)) >> 4) | (w & UINT64_C(0x000000000fffffff));
+            *value = w;
+#   endif
+            return n;
+        }
+    }
+#endif
+
+    return srl_rdr_varint_decode_scalar_inline(p, end, value);
+}
+
+/* Length of the well-formed UTF-8 sequence which starts with the
+ * non-ASCII byte at s, 0 if it is malformed */
+SRL_STATIC_INLINE size_t
+srl_rdr_utf8_sequence(const U8 *s, const U8 *end)
+{
+    const U8 c = s[0];
+    const size_t left = end - s;
+    U8 lo = 0x80, hi = 0xbf;
+
+    if (c >= 0xc2 && c <= 0xdf)
+        return left >= 2 && (s[1] & 0xc0) == 0x80 ? 2 : 0;
+
+    if (c >= 0xe0 && c <= 0xef) {
+        if (c == 0xe0) lo = 0xa0;       /* overlong */
+        if (c == 0xed) hi = 0x9f;       /* surrogates */
+        return left >= 3 && s[1] >= lo && s[1] <= hi
+            && (s[2] & 0xc0) == 0x80 ? 3 : 0;
+    }
+
+    if (c >= 0xf0 && c <= 0xf4) {
+        if (c == 0xf0) lo = 0x90;       /* overlong */
+        if (c == 0xf4) hi = 0x8f;       /* above 0x10ffff */
+        return left >= 4 && s[1] >= lo && s[1] <= hi
+            && (s[2] & 0xc0) == 0x80 && (s[3] & 0xc0) == 0x80 ? 4 : 0;
+    }
+
+    return 0;
+}
+
+SRL_STATIC_INLINE int
+srl_rdr_utf8_valid_scalar_inline(const U8 *s, size_t len)
+{
+    const U8 *end = s + len;
+
+    while (s < end) {
+        if (*s < 0x80) {
+            s++;
+        } else {
+            const size_t n = srl_rdr_utf8_sequence(s, end);
+            if (n == 0) return 0;
+            s += n;
+        }
+    }
+
+    return 1;
+}
+
+SRL_STATIC_INLINE int
+srl_rdr_utf8_valid_inline(const U8 *s, size_t len)
+{
+    const U8 *end = s + len;
+
+    while (s < end) {
+        size_t n;
+
+#ifdef SRL_RDR_SSE2
+        while (end - s >= 16 && !_mm_movemask_epi8(_mm_loadu_si128((const __m128i *) s)))
+            s += 16;
+#endif
+#ifdef SRL_RDR_SWAR
+        while (end - s >= 8) {
+            uint64_t w;
+            memcpy(&w, s, 8);
+            if (w & SRL_RDR_HIGH_BITS) break;
+            s += 8;
+        }
+
+        /* the last word overlaps bytes which were checked already */
+        if (end - s < 8 && len >= 8) {
+            uint64_t w;
+            memcpy(&w, end - 8, 8);
+            if (!(w & SRL_RDR_HIGH_BITS)) break;
+        }
+#endif
+
+        while (s < end && *s < 0x80)
+            s++;
+        if (s == end)
+            break;
+
+        n = srl_rdr_utf8_sequence(s, end);
+        if (n == 0) return 0;
+        s += n;
+    }
+
+    return 1;
+}
+
+#endif
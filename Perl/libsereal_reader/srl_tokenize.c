@@ -0,0 +1,156 @@
+/* Prints the tokens of Sereal documents, one per line, using
+ * libsereal_reader. Files may hold several documents in a row.
+ *
+ * Usage:
+ *   ./srl_tokenize file.srl ...        # print tokens
+ *   ./srl_tokenize -q file.srl ...     # only count them
+ */
+
+#define SRL_READER_STANDALONE
+
+#include "srl_common.h"
+#include "srl_protocol.h"
+#include "srl_taginfo.h"
+
+#include "sereal_reader.h"
+
+static void
+print_token(const srl_rdr_token_t *tok)
+{
+    const U8 tag = tok->tag;
+
+    printf("%8lu %*s%s%s", (unsigned long) tok->offset, (int) (2 * tok->depth), "",
+           tok->tracked ? "*" : "", SRL_TAG_NAME(tag));
+
+    if (tag <= SRL_HDR_NEG_HIGH || tag == SRL_HDR_ZIGZAG) {
+        printf(" %" PRId64, tok->iv);
+    } else if (tag == SRL_HDR_FLOAT || tag == SRL_HDR_DOUBLE) {
+        printf(" %.17g", tok->nv);
+    } else if (tag == SRL_HDR_LONG_DOUBLE) {
+        /* no portable way to print it */
+    } else if (tag >= SRL_HDR_SHORT_BINARY_LOW || tag == SRL_HDR_BINARY || tag == SRL_HDR_STR_UTF8) {
+        printf(" \"%.*s%s\"", tok->len > 60 ? 60 : (int) tok->len, (const char *) tok->str,
+               tok->len > 60 ? "..." : "");
+    } else if (tag == SRL_HDR_VARINT || tag == SRL_HDR_ARRAY || tag == SRL_HDR_HASH
+               || (tag >= SRL_HDR_ARRAYREF_LOW && tag <= SRL_HDR_HASHREF_HIGH))
+    {
+        printf(" %" PRIu64, tok->uv);
+    } else if (tag == SRL_HDR_REFP || tag == SRL_HDR_ALIAS || tag == SRL_HDR_COPY
+               || tag == SRL_HDR_OBJECTV || tag == SRL_HDR_OBJECTV_FREEZE)
+    {
+        printf(" -> %" PRIu64, tok->uv);
+    }
+
+    printf("\n");
+}
+
+static unsigned char *
+read_file(const char *name, size_t *len)
+{
+    long size;
+    unsigned char *data;
+    FILE *fh = fopen(name, "rb");
+    if (fh == NULL) return NULL;
+
+    if (fseek(fh, 0, SEEK_END) != 0 || (size = ftell(fh)) < 0 || fseek(fh, 0, SEEK_SET) != 0) {
+        fclose(fh);
+        return NULL;
+    }
+
+    data = (unsigned char *) malloc(size ? size : 1);
+    if (data != NULL && fread(data, 1, size, fh) != (size_t) size) {
+        free(data);
+        data = NULL;
+    }
+
+    fclose(fh);
+    *len = (size_t) size;
+    return data;
+}
+
+/* Print the documents in data, returns 0 on errors */
+static int
+tokenize(srl_rdr_t *rdr, const char *name, const unsigned char *data, size_t len, int quiet)
+{
+    size_t pos = 0;
+    srl_rdr_token_t tok;
+
+    while (pos < len) {
+        unsigned long ntokens = 0;
+        size_t header_len;
+        int rc;
+
+        if (srl_rdr_open(rdr, data + pos, len - pos) != SRL_RDR_OK) {
+            fprintf(stderr, "%s: %s\n", name, srl_rdr_error(rdr));
+            return 0;
+        }
+
+        if (!quiet) {
+            printf("document at %lu: version %d, encoding %d", (unsigned long) pos,
+                   srl_rdr_version(rdr), srl_rdr_encoding(rdr) >> SRL_PROTOCOL_VERSION_BITS);
+            if (srl_rdr_user_header(rdr, &header_len) != NULL)
+                printf(", %lu bytes of user header", (unsigned long) header_len);
+            printf("\n");
+        }
+
+        while ((rc = srl_rdr_next(rdr, &tok)) == SRL_RDR_TOKEN) {
+            ntokens++;
+            if (!quiet)
+                print_token(&tok);
+        }
+
+        if (rc == SRL_RDR_ERR) {
+            fprintf(stderr, "%s: %s\n", name, srl_rdr_error(rdr));
+            return 0;
+        }
+
+        printf("%s: document at %lu, %lu bytes, %lu tokens\n", name, (unsigned long) pos,
+               (unsigned long) srl_rdr_document_length(rdr), ntokens);
+        pos += srl_rdr_document_length(rdr);
+    }
+
+    return 1;
+}
+
+int
+main(int argc, char **argv)
+{
+    int i, quiet = 0, status = 0;
+    srl_rdr_config_t config;
+    srl_rdr_t *rdr;
+
+    for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+        if (strcmp(argv[i], "-q") == 0) {
+            quiet = 1;
+        } else {
+            fprintf(stderr, "Usage: %s [-q] file.srl ...\n", argv[0]);
+            return 2;
+        }
+    }
+
+    memset(&config, 0, sizeof(config));
+    config.flags = SRL_RDR_F_VALIDATE_UTF8;
+    rdr = srl_rdr_new(&config);
+    if (rdr == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return 2;
+    }
+
+    for (; i < argc; i++) {
+        size_t len;
+        unsigned char *data = read_file(argv[i], &len);
+
+        if (data == NULL) {
+            fprintf(stderr, "%s: can't read file\n", argv[i]);
+            status = 1;
+            continue;
+        }
+
+        if (!tokenize(rdr, argv[i], data, len, quiet))
+            status = 1;
+        free(data);
+    }
+
+    srl_rdr_free(rdr);
+    return status;
+}
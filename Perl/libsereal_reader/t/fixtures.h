@@ -0,0 +1,694 @@
+/* Generated by t/make_fixtures.pl, do not edit */
+
+static const unsigned char fixture_aliased_v4[] = {
+    0x3d, 0xf3, 0x72, 0x6c, 0x04, 0x00, 0x28, 0x2a, 0x0a, 0x64, 0x68, 0x61,
+    0x73, 0x68, 0x28, 0x2a, 0x14, 0x64, 0x6b, 0x65, 0x79, 0x31, 0x01, 0x64,
+    0x6b, 0x65, 0x79, 0x32, 0x02, 0x64, 0x6b, 0x65, 0x79, 0x33, 0x03, 0x64,
+    0x6b, 0x65, 0x79, 0x34, 0x04, 0x64, 0x6b, 0x65, 0x79, 0x35, 0x05, 0x64,
+    0x6b, 0x65, 0x79, 0x36, 0x06, 0x64, 0x6b, 0x65, 0x79, 0x37, 0x07, 0x64,
+    0x6b, 0x65, 0x79, 0x38, 0x08, 0x64, 0x6b, 0x65, 0x79, 0x39, 0x09, 0x65,
+    0x6b, 0x65, 0x79, 0x31, 0x30, 0x0a, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x31,
+    0x0b, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x32, 0x0c, 0x65, 0x6b, 0x65, 0x79,
+    0x31, 0x33, 0x0d, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x34, 0x0e, 0x65, 0x6b,
+    0x65, 0x79, 0x31, 0x35, 0x0f, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x36, 0x20,
+    0x10, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x37, 0x20, 0x11, 0x65, 0x6b, 0x65,
+    0x79, 0x31, 0x38, 0x20, 0x12, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x39, 0x20,
+    0x13, 0x65, 0x6b, 0x65, 0x79, 0x32, 0x30, 0x20, 0x14, 0x64, 0x69, 0x6e,
+    0x74, 0x73, 0x28, 0x2b, 0x0f, 0x00, 0x01, 0x0f, 0x20, 0x10, 0x1f, 0x10,
+    0x21, 0x21, 0x20, 0x7f, 0x20, 0x80, 0x01, 0x20, 0xac, 0x02, 0x21, 0xd7,
+    0x04, 0x22, 0x00, 0x00, 0x00, 0x4f, 0x22, 0x00, 0x00, 0x00, 0xcf, 0x22,
+    0x00, 0x00, 0x80, 0x53, 0x20, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0x01, 0x64, 0x72, 0x65, 0x66, 0x73, 0x28, 0x2b, 0x03, 0x28,
+    0xab, 0x01, 0xe6, 0x73, 0x68, 0x61, 0x72, 0x65, 0x64, 0x29, 0xd3, 0x01,
+    0x29, 0xd5, 0x01, 0x64, 0x73, 0x65, 0x6c, 0x66, 0x28, 0xaa, 0x02, 0x64,
+    0x6e, 0x61, 0x6d, 0x65, 0x64, 0x73, 0x65, 0x6c, 0x66, 0x2f, 0xe2, 0x01,
+    0x30, 0x29, 0xe8, 0x01, 0x65, 0x61, 0x72, 0x72, 0x61, 0x79, 0x28, 0x2b,
+    0x28, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b,
+    0x0c, 0x0d, 0x0e, 0x0f, 0x20, 0x10, 0x20, 0x11, 0x20, 0x12, 0x20, 0x13,
+    0x20, 0x14, 0x20, 0x15, 0x20, 0x16, 0x20, 0x17, 0x20, 0x18, 0x20, 0x19,
+    0x20, 0x1a, 0x20, 0x1b, 0x20, 0x1c, 0x20, 0x1d, 0x20, 0x1e, 0x20, 0x1f,
+    0x20, 0x20, 0x20, 0x21, 0x20, 0x22, 0x20, 0x23, 0x20, 0x24, 0x20, 0x25,
+    0x20, 0x26, 0x20, 0x27, 0x20, 0x28, 0x65, 0x75, 0x6e, 0x64, 0x65, 0x66,
+    0x25, 0x66, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x73, 0x28, 0x2b, 0x03, 0x22,
+    0x00, 0x00, 0x00, 0x3f, 0x23, 0x5c, 0xf4, 0xf9, 0x6e, 0x18, 0xdc, 0xb6,
+    0x54, 0x22, 0x00, 0x00, 0x30, 0xc0, 0x66, 0x72, 0x65, 0x67, 0x65, 0x78,
+    0x70, 0x2c, 0x66, 0x52, 0x65, 0x67, 0x65, 0x78, 0x70, 0x28, 0x31, 0x66,
+    0x5e, 0x61, 0x2e, 0x2a, 0x62, 0x24, 0x61, 0x69, 0x67, 0x6f, 0x62, 0x6a,
+    0x65, 0x63, 0x74, 0x73, 0x28, 0x2b, 0x03, 0x2c, 0x6b, 0x53, 0x6f, 0x6d,
+    0x65, 0x3a, 0x3a, 0x43, 0x6c, 0x61, 0x73, 0x73, 0x28, 0x2a, 0x01, 0x61,
+    0x61, 0x01, 0x2d, 0x8f, 0x03, 0x28, 0x2b, 0x00, 0x2c, 0x6c, 0x4f, 0x74,
+    0x68, 0x65, 0x72, 0x3a, 0x3a, 0x43, 0x6c, 0x61, 0x73, 0x73, 0x28, 0x2b,
+    0x00, 0x67, 0x73, 0x74, 0x72, 0x69, 0x6e, 0x67, 0x73, 0x28, 0x2b, 0x0a,
+    0x60, 0x63, 0x61, 0x62, 0x63, 0x26, 0x28, 0x78, 0x78, 0x78, 0x78, 0x78,
+    0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78,
+    0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78,
+    0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x64,
+    0x63, 0x61, 0x66, 0xe9, 0x27, 0x09, 0xe2, 0x98, 0xba, 0x20, 0x73, 0x6d,
+    0x69, 0x6c, 0x65, 0xa6, 0x30, 0x61, 0x20, 0x73, 0x74, 0x72, 0x69, 0x6e,
+    0x67, 0x20, 0x77, 0x68, 0x69, 0x63, 0x68, 0x20, 0x69, 0x73, 0x20, 0x6c,
+    0x6f, 0x6e, 0x67, 0x20, 0x65, 0x6e, 0x6f, 0x75, 0x67, 0x68, 0x20, 0x74,
+    0x6f, 0x20, 0x62, 0x65, 0x20, 0x64, 0x65, 0x64, 0x75, 0x70, 0x6c, 0x69,
+    0x63, 0x61, 0x74, 0x65, 0x64, 0x2e, 0x82, 0x04, 0xa6, 0x3c, 0x72, 0x65,
+    0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65,
+    0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65,
+    0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65,
+    0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65,
+    0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x2e, 0xb7,
+    0x04, 0x2e, 0xb7, 0x04,
+};
+
+static const unsigned char fixture_dedupe_v4[] = {
+    0x3d, 0xf3, 0x72, 0x6c, 0x04, 0x00, 0x28, 0x2a, 0x0a, 0x64, 0x68, 0x61,
+    0x73, 0x68, 0x28, 0x2a, 0x14, 0x64, 0x6b, 0x65, 0x79, 0x31, 0x01, 0x64,
+    0x6b, 0x65, 0x79, 0x32, 0x02, 0x64, 0x6b, 0x65, 0x79, 0x33, 0x03, 0x64,
+    0x6b, 0x65, 0x79, 0x34, 0x04, 0x64, 0x6b, 0x65, 0x79, 0x35, 0x05, 0x64,
+    0x6b, 0x65, 0x79, 0x36, 0x06, 0x64, 0x6b, 0x65, 0x79, 0x37, 0x07, 0x64,
+    0x6b, 0x65, 0x79, 0x38, 0x08, 0x64, 0x6b, 0x65, 0x79, 0x39, 0x09, 0x65,
+    0x6b, 0x65, 0x79, 0x31, 0x30, 0x0a, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x31,
+    0x0b, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x32, 0x0c, 0x65, 0x6b, 0x65, 0x79,
+    0x31, 0x33, 0x0d, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x34, 0x0e, 0x65, 0x6b,
+    0x65, 0x79, 0x31, 0x35, 0x0f, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x36, 0x20,
+    0x10, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x37, 0x20, 0x11, 0x65, 0x6b, 0x65,
+    0x79, 0x31, 0x38, 0x20, 0x12, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x39, 0x20,
+    0x13, 0x65, 0x6b, 0x65, 0x79, 0x32, 0x30, 0x20, 0x14, 0x64, 0x69, 0x6e,
+    0x74, 0x73, 0x28, 0x2b, 0x0f, 0x00, 0x01, 0x0f, 0x20, 0x10, 0x1f, 0x10,
+    0x21, 0x21, 0x20, 0x7f, 0x20, 0x80, 0x01, 0x20, 0xac, 0x02, 0x21, 0xd7,
+    0x04, 0x22, 0x00, 0x00, 0x00, 0x4f, 0x22, 0x00, 0x00, 0x00, 0xcf, 0x22,
+    0x00, 0x00, 0x80, 0x53, 0x20, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0x01, 0x64, 0x72, 0x65, 0x66, 0x73, 0x28, 0x2b, 0x03, 0x28,
+    0xab, 0x01, 0xe6, 0x73, 0x68, 0x61, 0x72, 0x65, 0x64, 0x29, 0xd3, 0x01,
+    0x29, 0xd5, 0x01, 0x64, 0x73, 0x65, 0x6c, 0x66, 0x28, 0xaa, 0x02, 0x64,
+    0x6e, 0x61, 0x6d, 0x65, 0x64, 0x73, 0x65, 0x6c, 0x66, 0x2f, 0xe2, 0x01,
+    0x30, 0x29, 0xe8, 0x01, 0x65, 0x61, 0x72, 0x72, 0x61, 0x79, 0x28, 0x2b,
+    0x28, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b,
+    0x0c, 0x0d, 0x0e, 0x0f, 0x20, 0x10, 0x20, 0x11, 0x20, 0x12, 0x20, 0x13,
+    0x20, 0x14, 0x20, 0x15, 0x20, 0x16, 0x20, 0x17, 0x20, 0x18, 0x20, 0x19,
+    0x20, 0x1a, 0x20, 0x1b, 0x20, 0x1c, 0x20, 0x1d, 0x20, 0x1e, 0x20, 0x1f,
+    0x20, 0x20, 0x20, 0x21, 0x20, 0x22, 0x20, 0x23, 0x20, 0x24, 0x20, 0x25,
+    0x20, 0x26, 0x20, 0x27, 0x20, 0x28, 0x65, 0x75, 0x6e, 0x64, 0x65, 0x66,
+    0x25, 0x66, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x73, 0x28, 0x2b, 0x03, 0x22,
+    0x00, 0x00, 0x00, 0x3f, 0x23, 0x5c, 0xf4, 0xf9, 0x6e, 0x18, 0xdc, 0xb6,
+    0x54, 0x22, 0x00, 0x00, 0x30, 0xc0, 0x66, 0x72, 0x65, 0x67, 0x65, 0x78,
+    0x70, 0x2c, 0x66, 0x52, 0x65, 0x67, 0x65, 0x78, 0x70, 0x28, 0x31, 0x66,
+    0x5e, 0x61, 0x2e, 0x2a, 0x62, 0x24, 0x61, 0x69, 0x67, 0x6f, 0x62, 0x6a,
+    0x65, 0x63, 0x74, 0x73, 0x28, 0x2b, 0x03, 0x2c, 0x6b, 0x53, 0x6f, 0x6d,
+    0x65, 0x3a, 0x3a, 0x43, 0x6c, 0x61, 0x73, 0x73, 0x28, 0x2a, 0x01, 0x61,
+    0x61, 0x01, 0x2d, 0x8f, 0x03, 0x28, 0x2b, 0x00, 0x2c, 0x6c, 0x4f, 0x74,
+    0x68, 0x65, 0x72, 0x3a, 0x3a, 0x43, 0x6c, 0x61, 0x73, 0x73, 0x28, 0x2b,
+    0x00, 0x67, 0x73, 0x74, 0x72, 0x69, 0x6e, 0x67, 0x73, 0x28, 0x2b, 0x0a,
+    0x60, 0x63, 0x61, 0x62, 0x63, 0x26, 0x28, 0x78, 0x78, 0x78, 0x78, 0x78,
+    0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78,
+    0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78,
+    0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x64,
+    0x63, 0x61, 0x66, 0xe9, 0x27, 0x09, 0xe2, 0x98, 0xba, 0x20, 0x73, 0x6d,
+    0x69, 0x6c, 0x65, 0x26, 0x30, 0x61, 0x20, 0x73, 0x74, 0x72, 0x69, 0x6e,
+    0x67, 0x20, 0x77, 0x68, 0x69, 0x63, 0x68, 0x20, 0x69, 0x73, 0x20, 0x6c,
+    0x6f, 0x6e, 0x67, 0x20, 0x65, 0x6e, 0x6f, 0x75, 0x67, 0x68, 0x20, 0x74,
+    0x6f, 0x20, 0x62, 0x65, 0x20, 0x64, 0x65, 0x64, 0x75, 0x70, 0x6c, 0x69,
+    0x63, 0x61, 0x74, 0x65, 0x64, 0x2f, 0x82, 0x04, 0x26, 0x3c, 0x72, 0x65,
+    0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65,
+    0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65,
+    0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65,
+    0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65,
+    0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x2f, 0xb7,
+    0x04, 0x2f, 0xb7, 0x04,
+};
+
+static const unsigned char fixture_raw_v1[] = {
+    0x3d, 0x73, 0x72, 0x6c, 0x01, 0x00, 0x28, 0x2a, 0x0a, 0x64, 0x68, 0x61,
+    0x73, 0x68, 0x28, 0x2a, 0x14, 0x64, 0x6b, 0x65, 0x79, 0x31, 0x01, 0x64,
+    0x6b, 0x65, 0x79, 0x32, 0x02, 0x64, 0x6b, 0x65, 0x79, 0x33, 0x03, 0x64,
+    0x6b, 0x65, 0x79, 0x34, 0x04, 0x64, 0x6b, 0x65, 0x79, 0x35, 0x05, 0x64,
+    0x6b, 0x65, 0x79, 0x36, 0x06, 0x64, 0x6b, 0x65, 0x79, 0x37, 0x07, 0x64,
+    0x6b, 0x65, 0x79, 0x38, 0x08, 0x64, 0x6b, 0x65, 0x79, 0x39, 0x09, 0x65,
+    0x6b, 0x65, 0x79, 0x31, 0x30, 0x0a, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x31,
+    0x0b, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x32, 0x0c, 0x65, 0x6b, 0x65, 0x79,
+    0x31, 0x33, 0x0d, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x34, 0x0e, 0x65, 0x6b,
+    0x65, 0x79, 0x31, 0x35, 0x0f, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x36, 0x20,
+    0x10, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x37, 0x20, 0x11, 0x65, 0x6b, 0x65,
+    0x79, 0x31, 0x38, 0x20, 0x12, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x39, 0x20,
+    0x13, 0x65, 0x6b, 0x65, 0x79, 0x32, 0x30, 0x20, 0x14, 0x64, 0x69, 0x6e,
+    0x74, 0x73, 0x28, 0x2b, 0x0f, 0x00, 0x01, 0x0f, 0x20, 0x10, 0x1f, 0x10,
+    0x21, 0x21, 0x20, 0x7f, 0x20, 0x80, 0x01, 0x20, 0xac, 0x02, 0x21, 0xd7,
+    0x04, 0x22, 0x00, 0x00, 0x00, 0x4f, 0x22, 0x00, 0x00, 0x00, 0xcf, 0x22,
+    0x00, 0x00, 0x80, 0x53, 0x20, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0x01, 0x64, 0x72, 0x65, 0x66, 0x73, 0x28, 0x2b, 0x03, 0x28,
+    0xab, 0x01, 0xe6, 0x73, 0x68, 0x61, 0x72, 0x65, 0x64, 0x29, 0xd8, 0x01,
+    0x29, 0xda, 0x01, 0x64, 0x73, 0x65, 0x6c, 0x66, 0x28, 0xaa, 0x02, 0x64,
+    0x6e, 0x61, 0x6d, 0x65, 0x64, 0x73, 0x65, 0x6c, 0x66, 0x2f, 0xe7, 0x01,
+    0x30, 0x29, 0xed, 0x01, 0x65, 0x61, 0x72, 0x72, 0x61, 0x79, 0x28, 0x2b,
+    0x28, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b,
+    0x0c, 0x0d, 0x0e, 0x0f, 0x20, 0x10, 0x20, 0x11, 0x20, 0x12, 0x20, 0x13,
+    0x20, 0x14, 0x20, 0x15, 0x20, 0x16, 0x20, 0x17, 0x20, 0x18, 0x20, 0x19,
+    0x20, 0x1a, 0x20, 0x1b, 0x20, 0x1c, 0x20, 0x1d, 0x20, 0x1e, 0x20, 0x1f,
+    0x20, 0x20, 0x20, 0x21, 0x20, 0x22, 0x20, 0x23, 0x20, 0x24, 0x20, 0x25,
+    0x20, 0x26, 0x20, 0x27, 0x20, 0x28, 0x65, 0x75, 0x6e, 0x64, 0x65, 0x66,
+    0x25, 0x66, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x73, 0x28, 0x2b, 0x03, 0x22,
+    0x00, 0x00, 0x00, 0x3f, 0x23, 0x5c, 0xf4, 0xf9, 0x6e, 0x18, 0xdc, 0xb6,
+    0x54, 0x22, 0x00, 0x00, 0x30, 0xc0, 0x66, 0x72, 0x65, 0x67, 0x65, 0x78,
+    0x70, 0x2c, 0x66, 0x52, 0x65, 0x67, 0x65, 0x78, 0x70, 0x28, 0x31, 0x66,
+    0x5e, 0x61, 0x2e, 0x2a, 0x62, 0x24, 0x61, 0x69, 0x67, 0x6f, 0x62, 0x6a,
+    0x65, 0x63, 0x74, 0x73, 0x28, 0x2b, 0x03, 0x2c, 0x6b, 0x53, 0x6f, 0x6d,
+    0x65, 0x3a, 0x3a, 0x43, 0x6c, 0x61, 0x73, 0x73, 0x28, 0x2a, 0x01, 0x61,
+    0x61, 0x01, 0x2d, 0x94, 0x03, 0x28, 0x2b, 0x00, 0x2c, 0x6c, 0x4f, 0x74,
+    0x68, 0x65, 0x72, 0x3a, 0x3a, 0x43, 0x6c, 0x61, 0x73, 0x73, 0x28, 0x2b,
+    0x00, 0x67, 0x73, 0x74, 0x72, 0x69, 0x6e, 0x67, 0x73, 0x28, 0x2b, 0x0a,
+    0x60, 0x63, 0x61, 0x62, 0x63, 0x26, 0x28, 0x78, 0x78, 0x78, 0x78, 0x78,
+    0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78,
+    0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78,
+    0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x64,
+    0x63, 0x61, 0x66, 0xe9, 0x27, 0x09, 0xe2, 0x98, 0xba, 0x20, 0x73, 0x6d,
+    0x69, 0x6c, 0x65, 0x26, 0x30, 0x61, 0x20, 0x73, 0x74, 0x72, 0x69, 0x6e,
+    0x67, 0x20, 0x77, 0x68, 0x69, 0x63, 0x68, 0x20, 0x69, 0x73, 0x20, 0x6c,
+    0x6f, 0x6e, 0x67, 0x20, 0x65, 0x6e, 0x6f, 0x75, 0x67, 0x68, 0x20, 0x74,
+    0x6f, 0x20, 0x62, 0x65, 0x20, 0x64, 0x65, 0x64, 0x75, 0x70, 0x6c, 0x69,
+    0x63, 0x61, 0x74, 0x65, 0x64, 0x26, 0x30, 0x61, 0x20, 0x73, 0x74, 0x72,
+    0x69, 0x6e, 0x67, 0x20, 0x77, 0x68, 0x69, 0x63, 0x68, 0x20, 0x69, 0x73,
+    0x20, 0x6c, 0x6f, 0x6e, 0x67, 0x20, 0x65, 0x6e, 0x6f, 0x75, 0x67, 0x68,
+    0x20, 0x74, 0x6f, 0x20, 0x62, 0x65, 0x20, 0x64, 0x65, 0x64, 0x75, 0x70,
+    0x6c, 0x69, 0x63, 0x61, 0x74, 0x65, 0x64, 0x26, 0x3c, 0x72, 0x65, 0x70,
+    0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70,
+    0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70,
+    0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70,
+    0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70,
+    0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x26, 0x3c, 0x72,
+    0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72,
+    0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72,
+    0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72,
+    0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72,
+    0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x26,
+    0x3c, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61,
+    0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61,
+    0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61,
+    0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61,
+    0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61,
+    0x74,
+};
+
+static const unsigned char fixture_raw_v2[] = {
+    0x3d, 0x73, 0x72, 0x6c, 0x02, 0x00, 0x28, 0x2a, 0x0a, 0x64, 0x68, 0x61,
+    0x73, 0x68, 0x28, 0x2a, 0x14, 0x64, 0x6b, 0x65, 0x79, 0x31, 0x01, 0x64,
+    0x6b, 0x65, 0x79, 0x32, 0x02, 0x64, 0x6b, 0x65, 0x79, 0x33, 0x03, 0x64,
+    0x6b, 0x65, 0x79, 0x34, 0x04, 0x64, 0x6b, 0x65, 0x79, 0x35, 0x05, 0x64,
+    0x6b, 0x65, 0x79, 0x36, 0x06, 0x64, 0x6b, 0x65, 0x79, 0x37, 0x07, 0x64,
+    0x6b, 0x65, 0x79, 0x38, 0x08, 0x64, 0x6b, 0x65, 0x79, 0x39, 0x09, 0x65,
+    0x6b, 0x65, 0x79, 0x31, 0x30, 0x0a, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x31,
+    0x0b, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x32, 0x0c, 0x65, 0x6b, 0x65, 0x79,
+    0x31, 0x33, 0x0d, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x34, 0x0e, 0x65, 0x6b,
+    0x65, 0x79, 0x31, 0x35, 0x0f, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x36, 0x20,
+    0x10, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x37, 0x20, 0x11, 0x65, 0x6b, 0x65,
+    0x79, 0x31, 0x38, 0x20, 0x12, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x39, 0x20,
+    0x13, 0x65, 0x6b, 0x65, 0x79, 0x32, 0x30, 0x20, 0x14, 0x64, 0x69, 0x6e,
+    0x74, 0x73, 0x28, 0x2b, 0x0f, 0x00, 0x01, 0x0f, 0x20, 0x10, 0x1f, 0x10,
+    0x21, 0x21, 0x20, 0x7f, 0x20, 0x80, 0x01, 0x20, 0xac, 0x02, 0x21, 0xd7,
+    0x04, 0x22, 0x00, 0x00, 0x00, 0x4f, 0x22, 0x00, 0x00, 0x00, 0xcf, 0x22,
+    0x00, 0x00, 0x80, 0x53, 0x20, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0x01, 0x64, 0x72, 0x65, 0x66, 0x73, 0x28, 0x2b, 0x03, 0x28,
+    0xab, 0x01, 0xe6, 0x73, 0x68, 0x61, 0x72, 0x65, 0x64, 0x29, 0xd3, 0x01,
+    0x29, 0xd5, 0x01, 0x64, 0x73, 0x65, 0x6c, 0x66, 0x28, 0xaa, 0x02, 0x64,
+    0x6e, 0x61, 0x6d, 0x65, 0x64, 0x73, 0x65, 0x6c, 0x66, 0x2f, 0xe2, 0x01,
+    0x30, 0x29, 0xe8, 0x01, 0x65, 0x61, 0x72, 0x72, 0x61, 0x79, 0x28, 0x2b,
+    0x28, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b,
+    0x0c, 0x0d, 0x0e, 0x0f, 0x20, 0x10, 0x20, 0x11, 0x20, 0x12, 0x20, 0x13,
+    0x20, 0x14, 0x20, 0x15, 0x20, 0x16, 0x20, 0x17, 0x20, 0x18, 0x20, 0x19,
+    0x20, 0x1a, 0x20, 0x1b, 0x20, 0x1c, 0x20, 0x1d, 0x20, 0x1e, 0x20, 0x1f,
+    0x20, 0x20, 0x20, 0x21, 0x20, 0x22, 0x20, 0x23, 0x20, 0x24, 0x20, 0x25,
+    0x20, 0x26, 0x20, 0x27, 0x20, 0x28, 0x65, 0x75, 0x6e, 0x64, 0x65, 0x66,
+    0x25, 0x66, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x73, 0x28, 0x2b, 0x03, 0x22,
+    0x00, 0x00, 0x00, 0x3f, 0x23, 0x5c, 0xf4, 0xf9, 0x6e, 0x18, 0xdc, 0xb6,
+    0x54, 0x22, 0x00, 0x00, 0x30, 0xc0, 0x66, 0x72, 0x65, 0x67, 0x65, 0x78,
+    0x70, 0x2c, 0x66, 0x52, 0x65, 0x67, 0x65, 0x78, 0x70, 0x28, 0x31, 0x66,
+    0x5e, 0x61, 0x2e, 0x2a, 0x62, 0x24, 0x61, 0x69, 0x67, 0x6f, 0x62, 0x6a,
+    0x65, 0x63, 0x74, 0x73, 0x28, 0x2b, 0x03, 0x2c, 0x6b, 0x53, 0x6f, 0x6d,
+    0x65, 0x3a, 0x3a, 0x43, 0x6c, 0x61, 0x73, 0x73, 0x28, 0x2a, 0x01, 0x61,
+    0x61, 0x01, 0x2d, 0x8f, 0x03, 0x28, 0x2b, 0x00, 0x2c, 0x6c, 0x4f, 0x74,
+    0x68, 0x65, 0x72, 0x3a, 0x3a, 0x43, 0x6c, 0x61, 0x73, 0x73, 0x28, 0x2b,
+    0x00, 0x67, 0x73, 0x74, 0x72, 0x69, 0x6e, 0x67, 0x73, 0x28, 0x2b, 0x0a,
+    0x60, 0x63, 0x61, 0x62, 0x63, 0x26, 0x28, 0x78, 0x78, 0x78, 0x78, 0x78,
+    0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78,
+    0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78,
+    0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x64,
+    0x63, 0x61, 0x66, 0xe9, 0x27, 0x09, 0xe2, 0x98, 0xba, 0x20, 0x73, 0x6d,
+    0x69, 0x6c, 0x65, 0x26, 0x30, 0x61, 0x20, 0x73, 0x74, 0x72, 0x69, 0x6e,
+    0x67, 0x20, 0x77, 0x68, 0x69, 0x63, 0x68, 0x20, 0x69, 0x73, 0x20, 0x6c,
+    0x6f, 0x6e, 0x67, 0x20, 0x65, 0x6e, 0x6f, 0x75, 0x67, 0x68, 0x20, 0x74,
+    0x6f, 0x20, 0x62, 0x65, 0x20, 0x64, 0x65, 0x64, 0x75, 0x70, 0x6c, 0x69,
+    0x63, 0x61, 0x74, 0x65, 0x64, 0x26, 0x30, 0x61, 0x20, 0x73, 0x74, 0x72,
+    0x69, 0x6e, 0x67, 0x20, 0x77, 0x68, 0x69, 0x63, 0x68, 0x20, 0x69, 0x73,
+    0x20, 0x6c, 0x6f, 0x6e, 0x67, 0x20, 0x65, 0x6e, 0x6f, 0x75, 0x67, 0x68,
+    0x20, 0x74, 0x6f, 0x20, 0x62, 0x65, 0x20, 0x64, 0x65, 0x64, 0x75, 0x70,
+    0x6c, 0x69, 0x63, 0x61, 0x74, 0x65, 0x64, 0x26, 0x3c, 0x72, 0x65, 0x70,
+    0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70,
+    0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70,
+    0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70,
+    0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70,
+    0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x26, 0x3c, 0x72,
+    0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72,
+    0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72,
+    0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72,
+    0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72,
+    0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x26,
+    0x3c, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61,
+    0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61,
+    0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61,
+    0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61,
+    0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61,
+    0x74,
+};
+
+static const unsigned char fixture_raw_v3[] = {
+    0x3d, 0xf3, 0x72, 0x6c, 0x03, 0x00, 0x28, 0x2a, 0x0a, 0x64, 0x68, 0x61,
+    0x73, 0x68, 0x28, 0x2a, 0x14, 0x64, 0x6b, 0x65, 0x79, 0x31, 0x01, 0x64,
+    0x6b, 0x65, 0x79, 0x32, 0x02, 0x64, 0x6b, 0x65, 0x79, 0x33, 0x03, 0x64,
+    0x6b, 0x65, 0x79, 0x34, 0x04, 0x64, 0x6b, 0x65, 0x79, 0x35, 0x05, 0x64,
+    0x6b, 0x65, 0x79, 0x36, 0x06, 0x64, 0x6b, 0x65, 0x79, 0x37, 0x07, 0x64,
+    0x6b, 0x65, 0x79, 0x38, 0x08, 0x64, 0x6b, 0x65, 0x79, 0x39, 0x09, 0x65,
+    0x6b, 0x65, 0x79, 0x31, 0x30, 0x0a, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x31,
+    0x0b, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x32, 0x0c, 0x65, 0x6b, 0x65, 0x79,
+    0x31, 0x33, 0x0d, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x34, 0x0e, 0x65, 0x6b,
+    0x65, 0x79, 0x31, 0x35, 0x0f, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x36, 0x20,
+    0x10, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x37, 0x20, 0x11, 0x65, 0x6b, 0x65,
+    0x79, 0x31, 0x38, 0x20, 0x12, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x39, 0x20,
+    0x13, 0x65, 0x6b, 0x65, 0x79, 0x32, 0x30, 0x20, 0x14, 0x64, 0x69, 0x6e,
+    0x74, 0x73, 0x28, 0x2b, 0x0f, 0x00, 0x01, 0x0f, 0x20, 0x10, 0x1f, 0x10,
+    0x21, 0x21, 0x20, 0x7f, 0x20, 0x80, 0x01, 0x20, 0xac, 0x02, 0x21, 0xd7,
+    0x04, 0x22, 0x00, 0x00, 0x00, 0x4f, 0x22, 0x00, 0x00, 0x00, 0xcf, 0x22,
+    0x00, 0x00, 0x80, 0x53, 0x20, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0x01, 0x64, 0x72, 0x65, 0x66, 0x73, 0x28, 0x2b, 0x03, 0x28,
+    0xab, 0x01, 0xe6, 0x73, 0x68, 0x61, 0x72, 0x65, 0x64, 0x29, 0xd3, 0x01,
+    0x29, 0xd5, 0x01, 0x64, 0x73, 0x65, 0x6c, 0x66, 0x28, 0xaa, 0x02, 0x64,
+    0x6e, 0x61, 0x6d, 0x65, 0x64, 0x73, 0x65, 0x6c, 0x66, 0x2f, 0xe2, 0x01,
+    0x30, 0x29, 0xe8, 0x01, 0x65, 0x61, 0x72, 0x72, 0x61, 0x79, 0x28, 0x2b,
+    0x28, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b,
+    0x0c, 0x0d, 0x0e, 0x0f, 0x20, 0x10, 0x20, 0x11, 0x20, 0x12, 0x20, 0x13,
+    0x20, 0x14, 0x20, 0x15, 0x20, 0x16, 0x20, 0x17, 0x20, 0x18, 0x20, 0x19,
+    0x20, 0x1a, 0x20, 0x1b, 0x20, 0x1c, 0x20, 0x1d, 0x20, 0x1e, 0x20, 0x1f,
+    0x20, 0x20, 0x20, 0x21, 0x20, 0x22, 0x20, 0x23, 0x20, 0x24, 0x20, 0x25,
+    0x20, 0x26, 0x20, 0x27, 0x20, 0x28, 0x65, 0x75, 0x6e, 0x64, 0x65, 0x66,
+    0x25, 0x66, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x73, 0x28, 0x2b, 0x03, 0x22,
+    0x00, 0x00, 0x00, 0x3f, 0x23, 0x5c, 0xf4, 0xf9, 0x6e, 0x18, 0xdc, 0xb6,
+    0x54, 0x22, 0x00, 0x00, 0x30, 0xc0, 0x66, 0x72, 0x65, 0x67, 0x65, 0x78,
+    0x70, 0x2c, 0x66, 0x52, 0x65, 0x67, 0x65, 0x78, 0x70, 0x28, 0x31, 0x66,
+    0x5e, 0x61, 0x2e, 0x2a, 0x62, 0x24, 0x61, 0x69, 0x67, 0x6f, 0x62, 0x6a,
+    0x65, 0x63, 0x74, 0x73, 0x28, 0x2b, 0x03, 0x2c, 0x6b, 0x53, 0x6f, 0x6d,
+    0x65, 0x3a, 0x3a, 0x43, 0x6c, 0x61, 0x73, 0x73, 0x28, 0x2a, 0x01, 0x61,
+    0x61, 0x01, 0x2d, 0x8f, 0x03, 0x28, 0x2b, 0x00, 0x2c, 0x6c, 0x4f, 0x74,
+    0x68, 0x65, 0x72, 0x3a, 0x3a, 0x43, 0x6c, 0x61, 0x73, 0x73, 0x28, 0x2b,
+    0x00, 0x67, 0x73, 0x74, 0x72, 0x69, 0x6e, 0x67, 0x73, 0x28, 0x2b, 0x0a,
+    0x60, 0x63, 0x61, 0x62, 0x63, 0x26, 0x28, 0x78, 0x78, 0x78, 0x78, 0x78,
+    0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78,
+    0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78,
+    0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x64,
+    0x63, 0x61, 0x66, 0xe9, 0x27, 0x09, 0xe2, 0x98, 0xba, 0x20, 0x73, 0x6d,
+    0x69, 0x6c, 0x65, 0x26, 0x30, 0x61, 0x20, 0x73, 0x74, 0x72, 0x69, 0x6e,
+    0x67, 0x20, 0x77, 0x68, 0x69, 0x63, 0x68, 0x20, 0x69, 0x73, 0x20, 0x6c,
+    0x6f, 0x6e, 0x67, 0x20, 0x65, 0x6e, 0x6f, 0x75, 0x67, 0x68, 0x20, 0x74,
+    0x6f, 0x20, 0x62, 0x65, 0x20, 0x64, 0x65, 0x64, 0x75, 0x70, 0x6c, 0x69,
+    0x63, 0x61, 0x74, 0x65, 0x64, 0x26, 0x30, 0x61, 0x20, 0x73, 0x74, 0x72,
+    0x69, 0x6e, 0x67, 0x20, 0x77, 0x68, 0x69, 0x63, 0x68, 0x20, 0x69, 0x73,
+    0x20, 0x6c, 0x6f, 0x6e, 0x67, 0x20, 0x65, 0x6e, 0x6f, 0x75, 0x67, 0x68,
+    0x20, 0x74, 0x6f, 0x20, 0x62, 0x65, 0x20, 0x64, 0x65, 0x64, 0x75, 0x70,
+    0x6c, 0x69, 0x63, 0x61, 0x74, 0x65, 0x64, 0x26, 0x3c, 0x72, 0x65, 0x70,
+    0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70,
+    0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70,
+    0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70,
+    0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70,
+    0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x26, 0x3c, 0x72,
+    0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72,
+    0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72,
+    0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72,
+    0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72,
+    0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x26,
+    0x3c, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61,
+    0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61,
+    0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61,
+    0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61,
+    0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61,
+    0x74,
+};
+
+static const unsigned char fixture_raw_v4[] = {
+    0x3d, 0xf3, 0x72, 0x6c, 0x04, 0x00, 0x28, 0x2a, 0x0a, 0x64, 0x68, 0x61,
+    0x73, 0x68, 0x28, 0x2a, 0x14, 0x64, 0x6b, 0x65, 0x79, 0x31, 0x01, 0x64,
+    0x6b, 0x65, 0x79, 0x32, 0x02, 0x64, 0x6b, 0x65, 0x79, 0x33, 0x03, 0x64,
+    0x6b, 0x65, 0x79, 0x34, 0x04, 0x64, 0x6b, 0x65, 0x79, 0x35, 0x05, 0x64,
+    0x6b, 0x65, 0x79, 0x36, 0x06, 0x64, 0x6b, 0x65, 0x79, 0x37, 0x07, 0x64,
+    0x6b, 0x65, 0x79, 0x38, 0x08, 0x64, 0x6b, 0x65, 0x79, 0x39, 0x09, 0x65,
+    0x6b, 0x65, 0x79, 0x31, 0x30, 0x0a, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x31,
+    0x0b, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x32, 0x0c, 0x65, 0x6b, 0x65, 0x79,
+    0x31, 0x33, 0x0d, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x34, 0x0e, 0x65, 0x6b,
+    0x65, 0x79, 0x31, 0x35, 0x0f, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x36, 0x20,
+    0x10, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x37, 0x20, 0x11, 0x65, 0x6b, 0x65,
+    0x79, 0x31, 0x38, 0x20, 0x12, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x39, 0x20,
+    0x13, 0x65, 0x6b, 0x65, 0x79, 0x32, 0x30, 0x20, 0x14, 0x64, 0x69, 0x6e,
+    0x74, 0x73, 0x28, 0x2b, 0x0f, 0x00, 0x01, 0x0f, 0x20, 0x10, 0x1f, 0x10,
+    0x21, 0x21, 0x20, 0x7f, 0x20, 0x80, 0x01, 0x20, 0xac, 0x02, 0x21, 0xd7,
+    0x04, 0x22, 0x00, 0x00, 0x00, 0x4f, 0x22, 0x00, 0x00, 0x00, 0xcf, 0x22,
+    0x00, 0x00, 0x80, 0x53, 0x20, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0x01, 0x64, 0x72, 0x65, 0x66, 0x73, 0x28, 0x2b, 0x03, 0x28,
+    0xab, 0x01, 0xe6, 0x73, 0x68, 0x61, 0x72, 0x65, 0x64, 0x29, 0xd3, 0x01,
+    0x29, 0xd5, 0x01, 0x64, 0x73, 0x65, 0x6c, 0x66, 0x28, 0xaa, 0x02, 0x64,
+    0x6e, 0x61, 0x6d, 0x65, 0x64, 0x73, 0x65, 0x6c, 0x66, 0x2f, 0xe2, 0x01,
+    0x30, 0x29, 0xe8, 0x01, 0x65, 0x61, 0x72, 0x72, 0x61, 0x79, 0x28, 0x2b,
+    0x28, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b,
+    0x0c, 0x0d, 0x0e, 0x0f, 0x20, 0x10, 0x20, 0x11, 0x20, 0x12, 0x20, 0x13,
+    0x20, 0x14, 0x20, 0x15, 0x20, 0x16, 0x20, 0x17, 0x20, 0x18, 0x20, 0x19,
+    0x20, 0x1a, 0x20, 0x1b, 0x20, 0x1c, 0x20, 0x1d, 0x20, 0x1e, 0x20, 0x1f,
+    0x20, 0x20, 0x20, 0x21, 0x20, 0x22, 0x20, 0x23, 0x20, 0x24, 0x20, 0x25,
+    0x20, 0x26, 0x20, 0x27, 0x20, 0x28, 0x65, 0x75, 0x6e, 0x64, 0x65, 0x66,
+    0x25, 0x66, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x73, 0x28, 0x2b, 0x03, 0x22,
+    0x00, 0x00, 0x00, 0x3f, 0x23, 0x5c, 0xf4, 0xf9, 0x6e, 0x18, 0xdc, 0xb6,
+    0x54, 0x22, 0x00, 0x00, 0x30, 0xc0, 0x66, 0x72, 0x65, 0x67, 0x65, 0x78,
+    0x70, 0x2c, 0x66, 0x52, 0x65, 0x67, 0x65, 0x78, 0x70, 0x28, 0x31, 0x66,
+    0x5e, 0x61, 0x2e, 0x2a, 0x62, 0x24, 0x61, 0x69, 0x67, 0x6f, 0x62, 0x6a,
+    0x65, 0x63, 0x74, 0x73, 0x28, 0x2b, 0x03, 0x2c, 0x6b, 0x53, 0x6f, 0x6d,
+    0x65, 0x3a, 0x3a, 0x43, 0x6c, 0x61, 0x73, 0x73, 0x28, 0x2a, 0x01, 0x61,
+    0x61, 0x01, 0x2d, 0x8f, 0x03, 0x28, 0x2b, 0x00, 0x2c, 0x6c, 0x4f, 0x74,
+    0x68, 0x65, 0x72, 0x3a, 0x3a, 0x43, 0x6c, 0x61, 0x73, 0x73, 0x28, 0x2b,
+    0x00, 0x67, 0x73, 0x74, 0x72, 0x69, 0x6e, 0x67, 0x73, 0x28, 0x2b, 0x0a,
+    0x60, 0x63, 0x61, 0x62, 0x63, 0x26, 0x28, 0x78, 0x78, 0x78, 0x78, 0x78,
+    0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78,
+    0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78,
+    0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x64,
+    0x63, 0x61, 0x66, 0xe9, 0x27, 0x09, 0xe2, 0x98, 0xba, 0x20, 0x73, 0x6d,
+    0x69, 0x6c, 0x65, 0x26, 0x30, 0x61, 0x20, 0x73, 0x74, 0x72, 0x69, 0x6e,
+    0x67, 0x20, 0x77, 0x68, 0x69, 0x63, 0x68, 0x20, 0x69, 0x73, 0x20, 0x6c,
+    0x6f, 0x6e, 0x67, 0x20, 0x65, 0x6e, 0x6f, 0x75, 0x67, 0x68, 0x20, 0x74,
+    0x6f, 0x20, 0x62, 0x65, 0x20, 0x64, 0x65, 0x64, 0x75, 0x70, 0x6c, 0x69,
+    0x63, 0x61, 0x74, 0x65, 0x64, 0x26, 0x30, 0x61, 0x20, 0x73, 0x74, 0x72,
+    0x69, 0x6e, 0x67, 0x20, 0x77, 0x68, 0x69, 0x63, 0x68, 0x20, 0x69, 0x73,
+    0x20, 0x6c, 0x6f, 0x6e, 0x67, 0x20, 0x65, 0x6e, 0x6f, 0x75, 0x67, 0x68,
+    0x20, 0x74, 0x6f, 0x20, 0x62, 0x65, 0x20, 0x64, 0x65, 0x64, 0x75, 0x70,
+    0x6c, 0x69, 0x63, 0x61, 0x74, 0x65, 0x64, 0x26, 0x3c, 0x72, 0x65, 0x70,
+    0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70,
+    0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70,
+    0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70,
+    0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70,
+    0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x26, 0x3c, 0x72,
+    0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72,
+    0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72,
+    0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72,
+    0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72,
+    0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x26,
+    0x3c, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61,
+    0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61,
+    0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61,
+    0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61,
+    0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61,
+    0x74,
+};
+
+static const unsigned char fixture_snappy_incr_v1[] = {
+    0x3d, 0x73, 0x72, 0x6c, 0x21, 0x00, 0xfa, 0x03, 0x9f, 0x06, 0x40, 0x28,
+    0x2a, 0x0a, 0x64, 0x68, 0x61, 0x73, 0x68, 0x28, 0x2a, 0x14, 0x64, 0x6b,
+    0x65, 0x79, 0x31, 0x01, 0x01, 0x06, 0x04, 0x32, 0x02, 0x01, 0x06, 0x04,
+    0x33, 0x03, 0x01, 0x06, 0x04, 0x34, 0x04, 0x01, 0x06, 0x04, 0x35, 0x05,
+    0x01, 0x06, 0x04, 0x36, 0x06, 0x01, 0x06, 0x04, 0x37, 0x07, 0x01, 0x06,
+    0x04, 0x38, 0x08, 0x01, 0x06, 0x08, 0x39, 0x09, 0x65, 0x01, 0x36, 0x04,
+    0x30, 0x0a, 0x05, 0x07, 0x04, 0x31, 0x0b, 0x05, 0x07, 0x04, 0x32, 0x0c,
+    0x05, 0x07, 0x04, 0x33, 0x0d, 0x05, 0x07, 0x04, 0x34, 0x0e, 0x05, 0x07,
+    0x04, 0x35, 0x0f, 0x05, 0x07, 0x08, 0x36, 0x20, 0x10, 0x05, 0x08, 0x08,
+    0x37, 0x20, 0x11, 0x05, 0x08, 0x08, 0x38, 0x20, 0x12, 0x05, 0x08, 0x08,
+    0x39, 0x20, 0x13, 0x01, 0x08, 0x90, 0x32, 0x30, 0x20, 0x14, 0x64, 0x69,
+    0x6e, 0x74, 0x73, 0x28, 0x2b, 0x0f, 0x00, 0x01, 0x0f, 0x20, 0x10, 0x1f,
+    0x10, 0x21, 0x21, 0x20, 0x7f, 0x20, 0x80, 0x01, 0x20, 0xac, 0x02, 0x21,
+    0xd7, 0x04, 0x22, 0x00, 0x00, 0x00, 0x4f, 0x01, 0x05, 0x1c, 0xcf, 0x22,
+    0x00, 0x00, 0x80, 0x53, 0x20, 0xff, 0x11, 0x01, 0x98, 0x01, 0x64, 0x72,
+    0x65, 0x66, 0x73, 0x28, 0x2b, 0x03, 0x28, 0xab, 0x01, 0xe6, 0x73, 0x68,
+    0x61, 0x72, 0x65, 0x64, 0x29, 0xd8, 0x01, 0x29, 0xda, 0x01, 0x64, 0x73,
+    0x65, 0x6c, 0x66, 0x28, 0xaa, 0x02, 0x64, 0x6e, 0x61, 0x6d, 0x65, 0x64,
+    0x01, 0x0d, 0xf0, 0x5c, 0x2f, 0xe7, 0x01, 0x30, 0x29, 0xed, 0x01, 0x65,
+    0x61, 0x72, 0x72, 0x61, 0x79, 0x28, 0x2b, 0x28, 0x01, 0x02, 0x03, 0x04,
+    0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x20,
+    0x10, 0x20, 0x11, 0x20, 0x12, 0x20, 0x13, 0x20, 0x14, 0x20, 0x15, 0x20,
+    0x16, 0x20, 0x17, 0x20, 0x18, 0x20, 0x19, 0x20, 0x1a, 0x20, 0x1b, 0x20,
+    0x1c, 0x20, 0x1d, 0x20, 0x1e, 0x20, 0x1f, 0x20, 0x20, 0x20, 0x21, 0x20,
+    0x22, 0x20, 0x23, 0x20, 0x24, 0x20, 0x25, 0x20, 0x26, 0x20, 0x27, 0x20,
+    0x28, 0x65, 0x75, 0x6e, 0x64, 0x65, 0x66, 0x25, 0x66, 0x66, 0x6c, 0x6f,
+    0x61, 0x01, 0xba, 0x74, 0x03, 0x22, 0x00, 0x00, 0x00, 0x3f, 0x23, 0x5c,
+    0xf4, 0xf9, 0x6e, 0x18, 0xdc, 0xb6, 0x54, 0x22, 0x00, 0x00, 0x30, 0xc0,
+    0x66, 0x72, 0x65, 0x67, 0x65, 0x78, 0x70, 0x2c, 0x66, 0x52, 0x05, 0x08,
+    0x40, 0x28, 0x31, 0x66, 0x5e, 0x61, 0x2e, 0x2a, 0x62, 0x24, 0x61, 0x69,
+    0x67, 0x6f, 0x62, 0x6a, 0x65, 0x63, 0x05, 0x38, 0x80, 0x2c, 0x6b, 0x53,
+    0x6f, 0x6d, 0x65, 0x3a, 0x3a, 0x43, 0x6c, 0x61, 0x73, 0x73, 0x28, 0x2a,
+    0x01, 0x61, 0x61, 0x01, 0x2d, 0x94, 0x03, 0x28, 0x2b, 0x00, 0x2c, 0x6c,
+    0x4f, 0x74, 0x68, 0x65, 0x72, 0x3a, 0x0d, 0x1a, 0x50, 0x2b, 0x00, 0x67,
+    0x73, 0x74, 0x72, 0x69, 0x6e, 0x67, 0x73, 0x28, 0x2b, 0x0a, 0x60, 0x63,
+    0x61, 0x62, 0x63, 0x26, 0x28, 0x78, 0x9a, 0x01, 0x00, 0x4c, 0x64, 0x63,
+    0x61, 0x66, 0xe9, 0x27, 0x09, 0xe2, 0x98, 0xba, 0x20, 0x73, 0x6d, 0x69,
+    0x6c, 0x65, 0x26, 0x30, 0x61, 0x20, 0x09, 0x4d, 0xa0, 0x20, 0x77, 0x68,
+    0x69, 0x63, 0x68, 0x20, 0x69, 0x73, 0x20, 0x6c, 0x6f, 0x6e, 0x67, 0x20,
+    0x65, 0x6e, 0x6f, 0x75, 0x67, 0x68, 0x20, 0x74, 0x6f, 0x20, 0x62, 0x65,
+    0x20, 0x64, 0x65, 0x64, 0x75, 0x70, 0x6c, 0x69, 0x63, 0x61, 0x74, 0x65,
+    0x64, 0x26, 0xc6, 0x32, 0x00, 0x18, 0x3c, 0x72, 0x65, 0x70, 0x65, 0x61,
+    0x74, 0xd6, 0x06, 0x00, 0xfe, 0x3e, 0x00, 0xee, 0x3e, 0x00,
+};
+
+static const unsigned char fixture_snappy_incr_v4[] = {
+    0x3d, 0xf3, 0x72, 0x6c, 0x24, 0x00, 0xf9, 0x03, 0x9f, 0x06, 0x40, 0x28,
+    0x2a, 0x0a, 0x64, 0x68, 0x61, 0x73, 0x68, 0x28, 0x2a, 0x14, 0x64, 0x6b,
+    0x65, 0x79, 0x31, 0x01, 0x01, 0x06, 0x04, 0x32, 0x02, 0x01, 0x06, 0x04,
+    0x33, 0x03, 0x01, 0x06, 0x04, 0x34, 0x04, 0x01, 0x06, 0x04, 0x35, 0x05,
+    0x01, 0x06, 0x04, 0x36, 0x06, 0x01, 0x06, 0x04, 0x37, 0x07, 0x01, 0x06,
+    0x04, 0x38, 0x08, 0x01, 0x06, 0x08, 0x39, 0x09, 0x65, 0x01, 0x36, 0x04,
+    0x30, 0x0a, 0x05, 0x07, 0x04, 0x31, 0x0b, 0x05, 0x07, 0x04, 0x32, 0x0c,
+    0x05, 0x07, 0x04, 0x33, 0x0d, 0x05, 0x07, 0x04, 0x34, 0x0e, 0x05, 0x07,
+    0x04, 0x35, 0x0f, 0x05, 0x07, 0x08, 0x36, 0x20, 0x10, 0x05, 0x08, 0x08,
+    0x37, 0x20, 0x11, 0x05, 0x08, 0x08, 0x38, 0x20, 0x12, 0x05, 0x08, 0x08,
+    0x39, 0x20, 0x13, 0x01, 0x08, 0x90, 0x32, 0x30, 0x20, 0x14, 0x64, 0x69,
+    0x6e, 0x74, 0x73, 0x28, 0x2b, 0x0f, 0x00, 0x01, 0x0f, 0x20, 0x10, 0x1f,
+    0x10, 0x21, 0x21, 0x20, 0x7f, 0x20, 0x80, 0x01, 0x20, 0xac, 0x02, 0x21,
+    0xd7, 0x04, 0x22, 0x00, 0x00, 0x00, 0x4f, 0x01, 0x05, 0x1c, 0xcf, 0x22,
+    0x00, 0x00, 0x80, 0x53, 0x20, 0xff, 0x11, 0x01, 0x98, 0x01, 0x64, 0x72,
+    0x65, 0x66, 0x73, 0x28, 0x2b, 0x03, 0x28, 0xab, 0x01, 0xe6, 0x73, 0x68,
+    0x61, 0x72, 0x65, 0x64, 0x29, 0xd3, 0x01, 0x29, 0xd5, 0x01, 0x64, 0x73,
+    0x65, 0x6c, 0x66, 0x28, 0xaa, 0x02, 0x64, 0x6e, 0x61, 0x6d, 0x65, 0x64,
+    0x01, 0x0d, 0xf0, 0x5c, 0x2f, 0xe2, 0x01, 0x30, 0x29, 0xe8, 0x01, 0x65,
+    0x61, 0x72, 0x72, 0x61, 0x79, 0x28, 0x2b, 0x28, 0x01, 0x02, 0x03, 0x04,
+    0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x20,
+    0x10, 0x20, 0x11, 0x20, 0x12, 0x20, 0x13, 0x20, 0x14, 0x20, 0x15, 0x20,
+    0x16, 0x20, 0x17, 0x20, 0x18, 0x20, 0x19, 0x20, 0x1a, 0x20, 0x1b, 0x20,
+    0x1c, 0x20, 0x1d, 0x20, 0x1e, 0x20, 0x1f, 0x20, 0x20, 0x20, 0x21, 0x20,
+    0x22, 0x20, 0x23, 0x20, 0x24, 0x20, 0x25, 0x20, 0x26, 0x20, 0x27, 0x20,
+    0x28, 0x65, 0x75, 0x6e, 0x64, 0x65, 0x66, 0x25, 0x66, 0x66, 0x6c, 0x6f,
+    0x61, 0x01, 0xba, 0x00, 0x03, 0x01, 0xa1, 0x60, 0x3f, 0x23, 0x5c, 0xf4,
+    0xf9, 0x6e, 0x18, 0xdc, 0xb6, 0x54, 0x22, 0x00, 0x00, 0x30, 0xc0, 0x66,
+    0x72, 0x65, 0x67, 0x65, 0x78, 0x70, 0x2c, 0x66, 0x52, 0x05, 0x08, 0x40,
+    0x28, 0x31, 0x66, 0x5e, 0x61, 0x2e, 0x2a, 0x62, 0x24, 0x61, 0x69, 0x67,
+    0x6f, 0x62, 0x6a, 0x65, 0x63, 0x05, 0x38, 0x80, 0x2c, 0x6b, 0x53, 0x6f,
+    0x6d, 0x65, 0x3a, 0x3a, 0x43, 0x6c, 0x61, 0x73, 0x73, 0x28, 0x2a, 0x01,
+    0x61, 0x61, 0x01, 0x2d, 0x8f, 0x03, 0x28, 0x2b, 0x00, 0x2c, 0x6c, 0x4f,
+    0x74, 0x68, 0x65, 0x72, 0x3a, 0x0d, 0x1a, 0x50, 0x2b, 0x00, 0x67, 0x73,
+    0x74, 0x72, 0x69, 0x6e, 0x67, 0x73, 0x28, 0x2b, 0x0a, 0x60, 0x63, 0x61,
+    0x62, 0x63, 0x26, 0x28, 0x78, 0x9a, 0x01, 0x00, 0x4c, 0x64, 0x63, 0x61,
+    0x66, 0xe9, 0x27, 0x09, 0xe2, 0x98, 0xba, 0x20, 0x73, 0x6d, 0x69, 0x6c,
+    0x65, 0x26, 0x30, 0x61, 0x20, 0x09, 0x4d, 0xa0, 0x20, 0x77, 0x68, 0x69,
+    0x63, 0x68, 0x20, 0x69, 0x73, 0x20, 0x6c, 0x6f, 0x6e, 0x67, 0x20, 0x65,
+    0x6e, 0x6f, 0x75, 0x67, 0x68, 0x20, 0x74, 0x6f, 0x20, 0x62, 0x65, 0x20,
+    0x64, 0x65, 0x64, 0x75, 0x70, 0x6c, 0x69, 0x63, 0x61, 0x74, 0x65, 0x64,
+    0x26, 0xc6, 0x32, 0x00, 0x18, 0x3c, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74,
+    0xd6, 0x06, 0x00, 0xfe, 0x3e, 0x00, 0xee, 0x3e, 0x00,
+};
+
+static const unsigned char fixture_snappy_v1[] = {
+    0x3d, 0x73, 0x72, 0x6c, 0x11, 0x00, 0x9f, 0x06, 0x40, 0x28, 0x2a, 0x0a,
+    0x64, 0x68, 0x61, 0x73, 0x68, 0x28, 0x2a, 0x14, 0x64, 0x6b, 0x65, 0x79,
+    0x31, 0x01, 0x01, 0x06, 0x04, 0x32, 0x02, 0x01, 0x06, 0x04, 0x33, 0x03,
+    0x01, 0x06, 0x04, 0x34, 0x04, 0x01, 0x06, 0x04, 0x35, 0x05, 0x01, 0x06,
+    0x04, 0x36, 0x06, 0x01, 0x06, 0x04, 0x37, 0x07, 0x01, 0x06, 0x04, 0x38,
+    0x08, 0x01, 0x06, 0x08, 0x39, 0x09, 0x65, 0x01, 0x36, 0x04, 0x30, 0x0a,
+    0x05, 0x07, 0x04, 0x31, 0x0b, 0x05, 0x07, 0x04, 0x32, 0x0c, 0x05, 0x07,
+    0x04, 0x33, 0x0d, 0x05, 0x07, 0x04, 0x34, 0x0e, 0x05, 0x07, 0x04, 0x35,
+    0x0f, 0x05, 0x07, 0x08, 0x36, 0x20, 0x10, 0x05, 0x08, 0x08, 0x37, 0x20,
+    0x11, 0x05, 0x08, 0x08, 0x38, 0x20, 0x12, 0x05, 0x08, 0x08, 0x39, 0x20,
+    0x13, 0x01, 0x08, 0x90, 0x32, 0x30, 0x20, 0x14, 0x64, 0x69, 0x6e, 0x74,
+    0x73, 0x28, 0x2b, 0x0f, 0x00, 0x01, 0x0f, 0x20, 0x10, 0x1f, 0x10, 0x21,
+    0x21, 0x20, 0x7f, 0x20, 0x80, 0x01, 0x20, 0xac, 0x02, 0x21, 0xd7, 0x04,
+    0x22, 0x00, 0x00, 0x00, 0x4f, 0x01, 0x05, 0x1c, 0xcf, 0x22, 0x00, 0x00,
+    0x80, 0x53, 0x20, 0xff, 0x11, 0x01, 0x98, 0x01, 0x64, 0x72, 0x65, 0x66,
+    0x73, 0x28, 0x2b, 0x03, 0x28, 0xab, 0x01, 0xe6, 0x73, 0x68, 0x61, 0x72,
+    0x65, 0x64, 0x29, 0xd8, 0x01, 0x29, 0xda, 0x01, 0x64, 0x73, 0x65, 0x6c,
+    0x66, 0x28, 0xaa, 0x02, 0x64, 0x6e, 0x61, 0x6d, 0x65, 0x64, 0x01, 0x0d,
+    0xf0, 0x5c, 0x2f, 0xe7, 0x01, 0x30, 0x29, 0xed, 0x01, 0x65, 0x61, 0x72,
+    0x72, 0x61, 0x79, 0x28, 0x2b, 0x28, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+    0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x20, 0x10, 0x20,
+    0x11, 0x20, 0x12, 0x20, 0x13, 0x20, 0x14, 0x20, 0x15, 0x20, 0x16, 0x20,
+    0x17, 0x20, 0x18, 0x20, 0x19, 0x20, 0x1a, 0x20, 0x1b, 0x20, 0x1c, 0x20,
+    0x1d, 0x20, 0x1e, 0x20, 0x1f, 0x20, 0x20, 0x20, 0x21, 0x20, 0x22, 0x20,
+    0x23, 0x20, 0x24, 0x20, 0x25, 0x20, 0x26, 0x20, 0x27, 0x20, 0x28, 0x65,
+    0x75, 0x6e, 0x64, 0x65, 0x66, 0x25, 0x66, 0x66, 0x6c, 0x6f, 0x61, 0x01,
+    0xba, 0x74, 0x03, 0x22, 0x00, 0x00, 0x00, 0x3f, 0x23, 0x5c, 0xf4, 0xf9,
+    0x6e, 0x18, 0xdc, 0xb6, 0x54, 0x22, 0x00, 0x00, 0x30, 0xc0, 0x66, 0x72,
+    0x65, 0x67, 0x65, 0x78, 0x70, 0x2c, 0x66, 0x52, 0x05, 0x08, 0x40, 0x28,
+    0x31, 0x66, 0x5e, 0x61, 0x2e, 0x2a, 0x62, 0x24, 0x61, 0x69, 0x67, 0x6f,
+    0x62, 0x6a, 0x65, 0x63, 0x05, 0x38, 0x80, 0x2c, 0x6b, 0x53, 0x6f, 0x6d,
+    0x65, 0x3a, 0x3a, 0x43, 0x6c, 0x61, 0x73, 0x73, 0x28, 0x2a, 0x01, 0x61,
+    0x61, 0x01, 0x2d, 0x94, 0x03, 0x28, 0x2b, 0x00, 0x2c, 0x6c, 0x4f, 0x74,
+    0x68, 0x65, 0x72, 0x3a, 0x0d, 0x1a, 0x50, 0x2b, 0x00, 0x67, 0x73, 0x74,
+    0x72, 0x69, 0x6e, 0x67, 0x73, 0x28, 0x2b, 0x0a, 0x60, 0x63, 0x61, 0x62,
+    0x63, 0x26, 0x28, 0x78, 0x9a, 0x01, 0x00, 0x4c, 0x64, 0x63, 0x61, 0x66,
+    0xe9, 0x27, 0x09, 0xe2, 0x98, 0xba, 0x20, 0x73, 0x6d, 0x69, 0x6c, 0x65,
+    0x26, 0x30, 0x61, 0x20, 0x09, 0x4d, 0xa0, 0x20, 0x77, 0x68, 0x69, 0x63,
+    0x68, 0x20, 0x69, 0x73, 0x20, 0x6c, 0x6f, 0x6e, 0x67, 0x20, 0x65, 0x6e,
+    0x6f, 0x75, 0x67, 0x68, 0x20, 0x74, 0x6f, 0x20, 0x62, 0x65, 0x20, 0x64,
+    0x65, 0x64, 0x75, 0x70, 0x6c, 0x69, 0x63, 0x61, 0x74, 0x65, 0x64, 0x26,
+    0xc6, 0x32, 0x00, 0x18, 0x3c, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0xd6,
+    0x06, 0x00, 0xfe, 0x3e, 0x00, 0xee, 0x3e, 0x00,
+};
+
+static const unsigned char fixture_user_header_v4[] = {
+    0x3d, 0xf3, 0x72, 0x6c, 0x04, 0x0d, 0x01, 0x6b, 0x75, 0x73, 0x65, 0x72,
+    0x20, 0x68, 0x65, 0x61, 0x64, 0x65, 0x72, 0x28, 0x2a, 0x0a, 0x64, 0x68,
+    0x61, 0x73, 0x68, 0x28, 0x2a, 0x14, 0x64, 0x6b, 0x65, 0x79, 0x31, 0x01,
+    0x64, 0x6b, 0x65, 0x79, 0x32, 0x02, 0x64, 0x6b, 0x65, 0x79, 0x33, 0x03,
+    0x64, 0x6b, 0x65, 0x79, 0x34, 0x04, 0x64, 0x6b, 0x65, 0x79, 0x35, 0x05,
+    0x64, 0x6b, 0x65, 0x79, 0x36, 0x06, 0x64, 0x6b, 0x65, 0x79, 0x37, 0x07,
+    0x64, 0x6b, 0x65, 0x79, 0x38, 0x08, 0x64, 0x6b, 0x65, 0x79, 0x39, 0x09,
+    0x65, 0x6b, 0x65, 0x79, 0x31, 0x30, 0x0a, 0x65, 0x6b, 0x65, 0x79, 0x31,
+    0x31, 0x0b, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x32, 0x0c, 0x65, 0x6b, 0x65,
+    0x79, 0x31, 0x33, 0x0d, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x34, 0x0e, 0x65,
+    0x6b, 0x65, 0x79, 0x31, 0x35, 0x0f, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x36,
+    0x20, 0x10, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x37, 0x20, 0x11, 0x65, 0x6b,
+    0x65, 0x79, 0x31, 0x38, 0x20, 0x12, 0x65, 0x6b, 0x65, 0x79, 0x31, 0x39,
+    0x20, 0x13, 0x65, 0x6b, 0x65, 0x79, 0x32, 0x30, 0x20, 0x14, 0x64, 0x69,
+    0x6e, 0x74, 0x73, 0x28, 0x2b, 0x0f, 0x00, 0x01, 0x0f, 0x20, 0x10, 0x1f,
+    0x10, 0x21, 0x21, 0x20, 0x7f, 0x20, 0x80, 0x01, 0x20, 0xac, 0x02, 0x21,
+    0xd7, 0x04, 0x22, 0x00, 0x00, 0x00, 0x4f, 0x22, 0x00, 0x00, 0x00, 0xcf,
+    0x22, 0x00, 0x00, 0x80, 0x53, 0x20, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0x01, 0x64, 0x72, 0x65, 0x66, 0x73, 0x28, 0x2b, 0x03,
+    0x28, 0xab, 0x01, 0xe6, 0x73, 0x68, 0x61, 0x72, 0x65, 0x64, 0x29, 0xd3,
+    0x01, 0x29, 0xd5, 0x01, 0x64, 0x73, 0x65, 0x6c, 0x66, 0x28, 0xaa, 0x02,
+    0x64, 0x6e, 0x61, 0x6d, 0x65, 0x64, 0x73, 0x65, 0x6c, 0x66, 0x2f, 0xe2,
+    0x01, 0x30, 0x29, 0xe8, 0x01, 0x65, 0x61, 0x72, 0x72, 0x61, 0x79, 0x28,
+    0x2b, 0x28, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a,
+    0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x20, 0x10, 0x20, 0x11, 0x20, 0x12, 0x20,
+    0x13, 0x20, 0x14, 0x20, 0x15, 0x20, 0x16, 0x20, 0x17, 0x20, 0x18, 0x20,
+    0x19, 0x20, 0x1a, 0x20, 0x1b, 0x20, 0x1c, 0x20, 0x1d, 0x20, 0x1e, 0x20,
+    0x1f, 0x20, 0x20, 0x20, 0x21, 0x20, 0x22, 0x20, 0x23, 0x20, 0x24, 0x20,
+    0x25, 0x20, 0x26, 0x20, 0x27, 0x20, 0x28, 0x65, 0x75, 0x6e, 0x64, 0x65,
+    0x66, 0x25, 0x66, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x73, 0x28, 0x2b, 0x03,
+    0x22, 0x00, 0x00, 0x00, 0x3f, 0x23, 0x5c, 0xf4, 0xf9, 0x6e, 0x18, 0xdc,
+    0xb6, 0x54, 0x22, 0x00, 0x00, 0x30, 0xc0, 0x66, 0x72, 0x65, 0x67, 0x65,
+    0x78, 0x70, 0x2c, 0x66, 0x52, 0x65, 0x67, 0x65, 0x78, 0x70, 0x28, 0x31,
+    0x66, 0x5e, 0x61, 0x2e, 0x2a, 0x62, 0x24, 0x61, 0x69, 0x67, 0x6f, 0x62,
+    0x6a, 0x65, 0x63, 0x74, 0x73, 0x28, 0x2b, 0x03, 0x2c, 0x6b, 0x53, 0x6f,
+    0x6d, 0x65, 0x3a, 0x3a, 0x43, 0x6c, 0x61, 0x73, 0x73, 0x28, 0x2a, 0x01,
+    0x61, 0x61, 0x01, 0x2d, 0x8f, 0x03, 0x28, 0x2b, 0x00, 0x2c, 0x6c, 0x4f,
+    0x74, 0x68, 0x65, 0x72, 0x3a, 0x3a, 0x43, 0x6c, 0x61, 0x73, 0x73, 0x28,
+    0x2b, 0x00, 0x67, 0x73, 0x74, 0x72, 0x69, 0x6e, 0x67, 0x73, 0x28, 0x2b,
+    0x0a, 0x60, 0x63, 0x61, 0x62, 0x63, 0x26, 0x28, 0x78, 0x78, 0x78, 0x78,
+    0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78,
+    0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78,
+    0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78, 0x78,
+    0x64, 0x63, 0x61, 0x66, 0xe9, 0x27, 0x09, 0xe2, 0x98, 0xba, 0x20, 0x73,
+    0x6d, 0x69, 0x6c, 0x65, 0x26, 0x30, 0x61, 0x20, 0x73, 0x74, 0x72, 0x69,
+    0x6e, 0x67, 0x20, 0x77, 0x68, 0x69, 0x63, 0x68, 0x20, 0x69, 0x73, 0x20,
+    0x6c, 0x6f, 0x6e, 0x67, 0x20, 0x65, 0x6e, 0x6f, 0x75, 0x67, 0x68, 0x20,
+    0x74, 0x6f, 0x20, 0x62, 0x65, 0x20, 0x64, 0x65, 0x64, 0x75, 0x70, 0x6c,
+    0x69, 0x63, 0x61, 0x74, 0x65, 0x64, 0x26, 0x30, 0x61, 0x20, 0x73, 0x74,
+    0x72, 0x69, 0x6e, 0x67, 0x20, 0x77, 0x68, 0x69, 0x63, 0x68, 0x20, 0x69,
+    0x73, 0x20, 0x6c, 0x6f, 0x6e, 0x67, 0x20, 0x65, 0x6e, 0x6f, 0x75, 0x67,
+    0x68, 0x20, 0x74, 0x6f, 0x20, 0x62, 0x65, 0x20, 0x64, 0x65, 0x64, 0x75,
+    0x70, 0x6c, 0x69, 0x63, 0x61, 0x74, 0x65, 0x64, 0x26, 0x3c, 0x72, 0x65,
+    0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65,
+    0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65,
+    0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65,
+    0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65,
+    0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x26, 0x3c,
+    0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74,
+    0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74,
+    0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74,
+    0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74,
+    0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74,
+    0x26, 0x3c, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65,
+    0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65,
+    0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65,
+    0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65,
+    0x61, 0x74, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x72, 0x65, 0x70, 0x65,
+    0x61, 0x74,
+};
+
+static const unsigned char fixture_zlib_v4[] = {
+    0x3d, 0xf3, 0x72, 0x6c, 0x34, 0x00, 0x9f, 0x06, 0xb2, 0x03, 0x78, 0x01,
+    0xc5, 0x8e, 0xbb, 0x6e, 0x13, 0x41, 0x14, 0x86, 0x77, 0xbc, 0xce, 0xc5,
+    0xce, 0xc5, 0x4e, 0x62, 0x20, 0x5c, 0xf3, 0x3b, 0x17, 0x67, 0x7c, 0x01,
+    0xd6, 0xce, 0x3d, 0x42, 0xa2, 0xe0, 0x01, 0x22, 0x11, 0x4a, 0x84, 0x18,
+    0xef, 0x9c, 0xbd, 0x90, 0xf5, 0xae, 0xb5, 0xb3, 0x16, 0x49, 0x45, 0xde,
+    0x80, 0x96, 0x67, 0x00, 0x6a, 0x0a, 0x2a, 0xde, 0x80, 0x02, 0x21, 0x1a,
+    0xaa, 0x14, 0x08, 0x7a, 0x1a, 0x2a, 0xd8, 0x19, 0x94, 0x1e, 0xa5, 0xe1,
+    0x14, 0xdf, 0x37, 0xbf, 0x46, 0xff, 0xcc, 0xe1, 0xad, 0xb2, 0x0c, 0x84,
+    0x0a, 0x78, 0xab, 0x26, 0x8f, 0xe8, 0xa4, 0xcb, 0x34, 0x7b, 0x05, 0xcd,
+    0x0d, 0x5b, 0x73, 0xb3, 0xa8, 0xb9, 0x35, 0xa6, 0xb9, 0x3d, 0xae, 0xb9,
+    0x33, 0xa1, 0xb9, 0x3b, 0xa9, 0xb9, 0x57, 0x22, 0xdd, 0x72, 0xca, 0x46,
+    0xdd, 0x29, 0xa3, 0xde, 0xb4, 0xd1, 0xc6, 0x8c, 0xd1, 0xe6, 0xac, 0xd1,
+    0x56, 0xc5, 0x68, 0x1b, 0x55, 0xe3, 0x1d, 0xcc, 0x19, 0xef, 0x62, 0xde,
+    0x78, 0x0f, 0x0b, 0xda, 0x3d, 0x07, 0x35, 0x19, 0xc6, 0x99, 0xe2, 0xed,
+    0x8a, 0xc5, 0x2a, 0xa8, 0x2e, 0x55, 0xeb, 0x75, 0xbc, 0xc0, 0x29, 0xc3,
+    0xdb, 0x42, 0xfd, 0x4b, 0x71, 0xd9, 0xb2, 0xac, 0x03, 0x8d, 0x8f, 0x39,
+    0x4e, 0x0f, 0xf1, 0xfb, 0x7c, 0x98, 0x4c, 0xc9, 0xcb, 0x5b, 0x36, 0x7f,
+    0xc3, 0xbe, 0xa9, 0x40, 0xa4, 0x24, 0x9b, 0x9f, 0x58, 0xf3, 0x33, 0x93,
+    0x8a, 0x22, 0x8f, 0xbf, 0x2e, 0xc8, 0x58, 0x0c, 0xc8, 0x84, 0xbb, 0x67,
+    0xcc, 0x69, 0x7e, 0x67, 0x24, 0xd2, 0x54, 0x9c, 0xf0, 0x36, 0x67, 0x05,
+    0xbb, 0x38, 0x36, 0x3e, 0x31, 0x59, 0x2a, 0x4f, 0x4d, 0xcf, 0xcc, 0xe6,
+    0x7f, 0x62, 0x0e, 0xf3, 0x58, 0x40, 0x0d, 0x97, 0x70, 0x19, 0x57, 0xb0,
+    0x88, 0xab, 0xb8, 0x86, 0xeb, 0xb8, 0x81, 0x9b, 0xb8, 0x85, 0x25, 0x00,
+    0x75, 0x2c, 0x63, 0x05, 0xab, 0x58, 0x43, 0x03, 0xeb, 0xe0, 0x34, 0x8a,
+    0x25, 0x79, 0x6b, 0x9e, 0x17, 0x25, 0x42, 0x6f, 0x6e, 0xeb, 0x05, 0xef,
+    0xaf, 0x3c, 0xfe, 0xf9, 0x2b, 0x5e, 0xfc, 0xfa, 0xee, 0x51, 0x9e, 0x9c,
+    0x0f, 0x5e, 0x4a, 0x3e, 0x1d, 0x0f, 0x3b, 0xde, 0x43, 0x63, 0xde, 0xf5,
+    0x9e, 0x88, 0x3b, 0xad, 0xfe, 0xaa, 0x08, 0xfd, 0xa4, 0xff, 0x8c, 0x5c,
+    0xd3, 0xeb, 0x1c, 0x1d, 0x26, 0x03, 0xda, 0xdf, 0x7f, 0x10, 0x09, 0xa5,
+    0x78, 0x8b, 0x09, 0xc1, 0x6e, 0xbf, 0xb4, 0x79, 0xdb, 0xea, 0x44, 0x07,
+    0x59, 0x40, 0xe9, 0xf9, 0x4d, 0xdb, 0xf2, 0x55, 0x96, 0x86, 0xb1, 0x9f,
+    0x1f, 0xcb, 0x4f, 0x5d, 0xd1, 0x77, 0x1b, 0xfc, 0xf8, 0x1f, 0x47, 0xba,
+    0xc2, 0xfb, 0xb1, 0x5e, 0x3a, 0x7b, 0xf5, 0x1e, 0x6a, 0x10, 0x46, 0xd4,
+    0x70, 0x04, 0xfe, 0x3e, 0x86, 0xe7, 0x41, 0xe8, 0x06, 0x08, 0x15, 0xa2,
+    0x24, 0x4f, 0x14, 0x27, 0x23, 0x3f, 0x40, 0x96, 0xa0, 0x4f, 0x90, 0x24,
+    0x47, 0xc3, 0x28, 0x74, 0x45, 0x46, 0xf2, 0x02, 0x8d, 0x7b, 0x29, 0x0d,
+    0x49, 0x64, 0x17, 0xe3, 0xff, 0x6c, 0xff, 0x01, 0x54, 0xde, 0x0e, 0x15,
+};
+
+static const unsigned char fixture_zstd_v4[] = {
+    0x3d, 0xf3, 0x72, 0x6c, 0x44, 0x00, 0xcf, 0x03, 0x28, 0xb5, 0x2f, 0xfd,
+    0x60, 0x1f, 0x02, 0x2d, 0x0e, 0x00, 0xd6, 0x58, 0x5f, 0x46, 0x10, 0xad,
+    0x28, 0x00, 0x40, 0x71, 0xc4, 0xfe, 0xa6, 0xac, 0xa8, 0x01, 0x04, 0x00,
+    0x05, 0x05, 0x62, 0xba, 0x44, 0x84, 0x15, 0x50, 0x04, 0x60, 0x0d, 0xc1,
+    0x8c, 0x4c, 0x9f, 0x93, 0xa4, 0xc5, 0x8e, 0x94, 0xd2, 0xf7, 0x9f, 0x20,
+    0x7c, 0x82, 0xfe, 0x0d, 0x48, 0xc9, 0x22, 0x49, 0x92, 0x08, 0x42, 0x34,
+    0x26, 0x21, 0x7b, 0x33, 0x88, 0xcd, 0x82, 0xdf, 0x1e, 0x9d, 0x6a, 0x94,
+    0x83, 0x1b, 0xa3, 0x11, 0x9b, 0x49, 0xfe, 0x1f, 0x52, 0x00, 0x4c, 0x00,
+    0x4d, 0x00, 0x32, 0x31, 0x8e, 0x3e, 0xb4, 0xc4, 0x18, 0x47, 0x1b, 0x11,
+    0x22, 0xcd, 0x86, 0x4b, 0x99, 0x5b, 0xb8, 0x48, 0x04, 0x02, 0x01, 0xfd,
+    0x23, 0xe3, 0x07, 0x9b, 0x37, 0xfc, 0x3a, 0x1a, 0x7a, 0x96, 0xf2, 0xf8,
+    0x4a, 0xc7, 0x55, 0x38, 0x9e, 0x02, 0x3a, 0xca, 0xe7, 0x64, 0xc3, 0x44,
+    0xa3, 0x24, 0x23, 0x85, 0x81, 0xf2, 0x64, 0xdd, 0x59, 0xb9, 0x50, 0xb1,
+    0x48, 0xa9, 0x40, 0xe1, 0x9c, 0x6c, 0x4c, 0xae, 0x12, 0x4d, 0x4a, 0xa2,
+    0x62, 0xfa, 0x85, 0x86, 0x4c, 0x93, 0xbb, 0xcc, 0x51, 0x8f, 0x69, 0x06,
+    0x07, 0x6e, 0xe0, 0x05, 0x4e, 0xe0, 0x03, 0xfe, 0x71, 0x01, 0x0f, 0x70,
+    0x00, 0x0f, 0xdd, 0xe3, 0x1d, 0xe7, 0x38, 0xe8, 0x9f, 0x0d, 0x8d, 0x0c,
+    0x0c, 0x4f, 0xe7, 0xc2, 0xa2, 0x82, 0xb3, 0xb9, 0x34, 0x72, 0x62, 0x33,
+    0x86, 0xad, 0xe5, 0x96, 0x25, 0x4a, 0x99, 0x9c, 0x59, 0xd0, 0x2b, 0xfe,
+    0xa8, 0x26, 0xc3, 0xac, 0x5e, 0x5f, 0x2a, 0x43, 0x94, 0x24, 0x88, 0x12,
+    0x6d, 0xcb, 0xdc, 0x25, 0x21, 0x35, 0xcc, 0x0b, 0x9b, 0xb7, 0xb6, 0xa5,
+    0x32, 0xc5, 0x5d, 0x02, 0xf3, 0xba, 0x90, 0x40, 0x32, 0x4b, 0xd3, 0xbc,
+    0x97, 0x3d, 0x07, 0x2c, 0x2c, 0xbd, 0x02, 0x5d, 0x5e, 0x4e, 0x5a, 0x53,
+    0x50, 0x81, 0x5b, 0xc7, 0x22, 0x2a, 0x93, 0x02, 0x96, 0x50, 0x51, 0xf3,
+    0x41, 0x3d, 0xb1, 0x60, 0x7a, 0x6b, 0x5b, 0x3d, 0x64, 0x31, 0x8e, 0x20,
+    0x70, 0x18, 0xf1, 0xf1, 0xa1, 0x38, 0x11, 0x21, 0xa4, 0xc1, 0xc5, 0xa0,
+    0x57, 0xeb, 0x48, 0x6d, 0xfa, 0xb5, 0x7a, 0x9e, 0xe4, 0xa4, 0x8f, 0x5c,
+    0xe4, 0x21, 0x1f, 0x5d, 0xf4, 0x1f, 0xe4, 0x08, 0x1e, 0x21, 0x37, 0xab,
+    0x2d, 0x03, 0xda, 0x21, 0x6b, 0x9d, 0xc7, 0x6a, 0xd1, 0xa6, 0x6f, 0xd5,
+    0xc1, 0xf0, 0xdc, 0xd6, 0x02, 0xbf, 0xfe, 0xf6, 0x81, 0xde, 0x6f, 0x77,
+    0x4e, 0xeb, 0xb8, 0x0a, 0x3f, 0x67, 0xa4, 0xf6, 0xba, 0xd5, 0x7d, 0x07,
+    0x0c, 0x33, 0x1d, 0x12, 0x13, 0x95, 0x35, 0x0a, 0x33, 0x49, 0x9a, 0x8a,
+    0xb5, 0x09, 0x1e, 0x6c, 0xde, 0xed, 0xeb, 0x6c, 0x78, 0xb7, 0x88, 0xd9,
+    0xe6, 0xc2, 0x16, 0xef, 0x14, 0xb1, 0x20, 0x20, 0x00, 0x83, 0xb9, 0xd5,
+    0x01, 0x39, 0x58, 0x0a, 0x96, 0x9f, 0x06, 0xa8, 0xe4, 0x14, 0xd0, 0x62,
+    0x37, 0xb2, 0x5c, 0x74, 0x1e, 0xb9, 0x2d, 0xa0, 0xcd, 0x61, 0x52, 0x9a,
+    0x74, 0xbd, 0x34, 0x63, 0xc0, 0x46, 0xc0, 0xc7, 0xe2, 0x12, 0xcb, 0x29,
+    0x6e, 0x3c, 0xe7, 0x36, 0x47, 0xda, 0x6b, 0x5b, 0x2b, 0xed, 0x6b, 0x72,
+    0xb7, 0xfc, 0x3a, 0xdb, 0x6e, 0xbb, 0xed, 0xb6, 0xdb, 0x6e, 0x6b, 0xdb,
+    0xac, 0x0c, 0x0c,
+};
+
+#define FIXTURE(name) { #name, fixture_##name, sizeof(fixture_##name) }
@@ -0,0 +1,71 @@
+#!perl
+# Writes t/fixtures.h: one data structure encoded with every protocol
+# version and compression, for t/test_reader.c. Run from
+# Perl/libsereal_reader after building Perl/Encoder:
+#
+#   perl -I../Encoder/blib/lib -I../Encoder/blib/arch t/make_fixtures.pl > t/fixtures.h
+use strict;
+use warnings;
+use Scalar::Util qw(weaken);
+use Sereal::Encoder qw(:all);
+
+my $shared = [ "shared" ];
+my $long = "a string which is long enough to be deduplicated";
+my $self = { name => "self" };
+$self->{self} = $self;
+weaken($self->{self});
+
+my $data = {
+    ints    => [ 0, 1, 15, 16, -1, -16, -17, 127, 128, 300, -300, 2**31, -2**31, 2**40, 18446744073709551615 ],
+    floats  => [ 0.5, 1.25e100, -2.75 ],
+    strings => [ "", "abc", "x" x 40, "caf\xe9", "\x{263a} smile", $long, $long, ("repeat" x 10) x 3 ],
+    refs    => [ $shared, $shared, \$shared->[0] ],
+    objects => [ bless({ a => 1 }, "Some::Class"), bless([], "Some::Class"), bless([], "Other::Class") ],
+    regexp  => qr/^a.*b$/i,
+    undef   => undef,
+    array   => [ 1 .. 40 ],
+    hash    => { map { ("key$_" => $_) } 1 .. 20 },
+    self    => $self,
+};
+
+my @fixtures = (
+    [ raw_v1          => { protocol_version => 1 } ],
+    [ raw_v2          => { protocol_version => 2 } ],
+    [ raw_v3          => { protocol_version => 3 } ],
+    [ raw_v4          => {} ],
+    [ dedupe_v4       => { dedupe_strings => 1 } ],
+    [ aliased_v4      => { aliased_dedupe_strings => 1 } ],
+    [ snappy_incr_v1  => { protocol_version => 1, compress => SRL_SNAPPY } ],
+    [ snappy_incr_v4  => { compress => SRL_SNAPPY } ],
+    [ zlib_v4         => { compress => SRL_ZLIB } ],
+    [ zstd_v4         => { compress => SRL_ZSTD } ],
+    [ user_header_v4  => {}, "user header" ],
+);
+
+my %docs;
+print "/* Generated by t/make_fixtures.pl, do not edit */\n\n";
+foreach my $f (@fixtures) {
+    my ($name, $opt, $header) = @$f;
+    my $enc = Sereal::Encoder->new({ %$opt, canonical => 1, compress_threshold => 0 });
+    $docs{$name} = defined $header ? $enc->encode($data, $header) : $enc->encode($data);
+}
+
+# Snappy without the length prefix is only written by old encoders:
+# version 1, encoding 1 and the Snappy stream up to the end of the document
+{
+    my $doc = $docs{snappy_incr_v1};
+    my $pos = 6;
+    $pos++ while ord(substr($doc, $pos, 1)) & 0x80;
+    $docs{snappy_v1} = "=srl\x11\x00" . substr($doc, $pos + 1);
+}
+
+foreach my $name (sort keys %docs) {
+    my @bytes = map { sprintf "0x%02x", $_ } unpack "C*", $docs{$name};
+    print "static const unsigned char fixture_${name}[] = {\n";
+    while (my @line = splice @bytes, 0, 12) {
+        print "    ", join(", ", @line), ",\n";
+    }
+    print "};\n\n";
+}
+
+print "#define FIXTURE(name) { #name, fixture_##name, sizeof(fixture_##name) }\n";
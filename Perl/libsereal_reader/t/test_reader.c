@@ -0,0 +1,748 @@
+/* Tests of libsereal_reader, run by "make test". Prints TAP.
+ * fixtures.h is generated by make_fixtures.pl. */
+
+#define SRL_READER_STANDALONE
+
+#include "srl_common.h"
+#include "srl_protocol.h"
+
+#include "sereal_reader.h"
+#include "fixtures.h"
+
+typedef struct {
+    const char *name;
+    const unsigned char *data;
+    size_t len;
+} fixture_t;
+
+static const fixture_t fixtures[] = {
+    FIXTURE(raw_v1),
+    FIXTURE(raw_v2),
+    FIXTURE(raw_v3),
+    FIXTURE(raw_v4),
+    FIXTURE(dedupe_v4),
+    FIXTURE(aliased_v4),
+    FIXTURE(snappy_v1),
+    FIXTURE(snappy_incr_v1),
+    FIXTURE(snappy_incr_v4),
+    FIXTURE(zlib_v4),
+    FIXTURE(zstd_v4),
+    FIXTURE(user_header_v4),
+};
+
+#define N_FIXTURES (sizeof(fixtures) / sizeof(fixtures[0]))
+
+static int tests = 0;
+static int failures = 0;
+
+#define CHECK(cond, name) STMT_START {                                     \
+    tests++;                                                                \
+    if (cond) printf("ok %d - %s\n", tests, (name));                        \
+    else { printf("not ok %d - %s\n", tests, (name)); failures++; }         \
+} STMT_END
+
+static const fixture_t *
+fixture(const char *name)
+{
+    size_t i;
+    for (i = 0; i < N_FIXTURES; i++) {
+        if (strcmp(fixtures[i].name, name) == 0)
+            return &fixtures[i];
+    }
+    abort();
+}
+
+/* allocator which counts blocks and can fail */
+
+typedef struct {
+    long live;
+    long total;
+    long fail_at;   /* fail the allocation with this number, 0: never */
+} alloc_stats_t;
+
+static void *
+counting_alloc(void *ud, size_t size)
+{
+    alloc_stats_t *stats = (alloc_stats_t *) ud;
+    if (stats->fail_at && stats->total + 1 >= stats->fail_at)
+        return NULL;
+    stats->total++;
+    stats->live++;
+    return malloc(size);
+}
+
+static void *
+counting_realloc(void *ud, void *ptr, size_t size)
+{
+    alloc_stats_t *stats = (alloc_stats_t *) ud;
+    if (stats->fail_at && stats->total + 1 >= stats->fail_at)
+        return NULL;
+    stats->total++;
+    return realloc(ptr, size);
+}
+
+static void
+counting_free(void *ud, void *ptr)
+{
+    alloc_stats_t *stats = (alloc_stats_t *) ud;
+    stats->live--;
+    free(ptr);
+}
+
+static srl_rdr_config_t
+counting_config(alloc_stats_t *stats)
+{
+    srl_rdr_config_t config;
+    memset(&config, 0, sizeof(config));
+    memset(stats, 0, sizeof(*stats));
+    config.allocator.alloc = counting_alloc;
+    config.allocator.realloc = counting_realloc;
+    config.allocator.free = counting_free;
+    config.allocator.ud = stats;
+    return config;
+}
+
+/* error handler which keeps the last message */
+
+typedef struct {
+    int calls;
+    char message[512];
+} error_seen_t;
+
+static void
+on_error(void *ud, const char *message)
+{
+    error_seen_t *seen = (error_seen_t *) ud;
+    seen->calls++;
+    snprintf(seen->message, sizeof(seen->message), "%s", message);
+}
+
+/* read a whole document, returns the number of tokens or -1 */
+static long
+count_tokens(srl_rdr_t *rdr, const unsigned char *data, size_t len)
+{
+    srl_rdr_token_t tok;
+    long n = 0;
+    int rc;
+
+    if (srl_rdr_open(rdr, data, len) != SRL_RDR_OK)
+        return -1;
+    while ((rc = srl_rdr_next(rdr, &tok)) == SRL_RDR_TOKEN)
+        n++;
+    return rc == SRL_RDR_END ? n : -1;
+}
+
+static int
+has_error(srl_rdr_t *rdr, const unsigned char *data, size_t len, const char *error)
+{
+    int ok = count_tokens(rdr, data, len) == -1 && strstr(srl_rdr_error(rdr), error) != NULL;
+    if (!ok) printf("# got '%s', expected '%s'\n", srl_rdr_error(rdr), error);
+    return ok;
+}
+
+/* kernels */
+
+static void
+test_varint(void)
+{
+    static const struct {
+        const char *bytes;
+        size_t len;
+        size_t used;    /* 0: error */
+        uint64_t value;
+    } cases[] = {
+        { "\x00", 1, 1, 0 },
+        { "\x7f", 1, 1, 127 },
+        { "\x80\x01", 2, 2, 128 },
+        { "\xac\x02", 2, 2, 300 },
+        { "\xff\xff\xff\xff\x0f", 5, 5, 0xffffffffULL },
+        { "\xff\xff\xff\xff\xff\xff\xff\x7f", 8, 8, 0xffffffffffffffULL },
+        { "\x80\x80\x80\x80\x80\x80\x80\x80\x01", 9, 9, 1ULL << 56 },
+        { "\xff\xff\xff\xff\xff\xff\xff\xff\xff\x01", 10, 10, UINT64_MAX },
+        { "\xff\xff\xff\xff\xff\xff\xff\xff\xff\x02", 10, 0, 0 },
+        { "\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\x01", 11, 0, 0 },
+        { "\x80", 1, 0, 0 },
+        { "\xff\xff\xff", 3, 0, 0 },
+        { "", 0, 0, 0 },
+    };
+    unsigned char padded[32];
+    size_t i, n;
+    long j, mismatches = 0;
+    int ok = 1, ok_scalar = 1, ok_padded = 1;
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const unsigned char *p = (const unsigned char *) cases[i].bytes;
+        uint64_t v = 0, vs = 0, vp = 0;
+        size_t np;
+
+        n = srl_rdr_varint_decode(p, p + cases[i].len, &v);
+        if (n != cases[i].used || (n && v != cases[i].value)) {
+            printf("# varint case %lu: got %lu bytes, %" PRIu64 "\n", (unsigned long) i, (unsigned long) n, v);
+            ok = 0;
+        }
+
+        n = srl_rdr_varint_decode_scalar(p, p + cases[i].len, &vs);
+        if (n != cases[i].used || (n && vs != cases[i].value))
+            ok_scalar = 0;
+
+        /* with bytes after it the wide loads are used */
+        memset(padded, 0x80, sizeof(padded));
+        memcpy(padded, p, cases[i].len);
+        np = srl_rdr_varint_decode(padded, padded + sizeof(padded), &vp);
+        if (cases[i].used && (np != cases[i].used || vp != cases[i].value))
+            ok_padded = 0;
+        if (!cases[i].used && cases[i].len >= 10 && np != 0)
+            ok_padded = 0;
+    }
+
+    CHECK(ok, "varint decoding");
+    CHECK(ok_scalar, "scalar varint decoding");
+    CHECK(ok_padded, "varint decoding with bytes after it");
+
+    srand(42);
+    for (j = 0; j < 200000; j++) {
+        unsigned char buf[16];
+        uint64_t v = 0, vs = 0;
+        size_t ns, len = 1 + rand() % 16, k;
+        const int cont = rand() % 11;
+
+        for (k = 0; k < len; k++)
+            buf[k] = (unsigned char) ((rand() & 0x7f) | ((int) k < cont ? 0x80 : 0));
+
+        n = srl_rdr_varint_decode(buf, buf + len, &v);
+        ns = srl_rdr_varint_decode_scalar(buf, buf + len, &vs);
+        if (n != ns || (n && v != vs))
+            mismatches++;
+    }
+    CHECK(mismatches == 0, "varint kernel agrees with the scalar version on random input");
+}
+
+static void
+test_utf8(void)
+{
+    static const struct {
+        const char *bytes;
+        int valid;
+    } cases[] = {
+        { "", 1 },
+        { "plain ascii", 1 },
+        { "caf\xc3\xa9", 1 },
+        { "\xe2\x98\xba smile", 1 },
+        { "\xf0\x9f\x98\x80", 1 },
+        { "\xf4\x8f\xbf\xbf", 1 },
+        { "\xed\x9f\xbf", 1 },
+        { "\xc3", 0 },
+        { "caf\xe9", 0 },
+        { "\xc0\xaf", 0 },                  /* overlong */
+        { "\xe0\x80\xaf", 0 },              /* overlong */
+        { "\xf0\x80\x80\xaf", 0 },          /* overlong */
+        { "\xed\xa0\x80", 0 },              /* surrogate */
+        { "\xf4\x90\x80\x80", 0 },          /* above 0x10ffff */
+        { "\xf5\x80\x80\x80", 0 },
+        { "\x80", 0 },
+        { "\xe2\x98", 0 },
+    };
+    unsigned char buf[96];
+    size_t i, pos;
+    long j, mismatches = 0;
+    int ok = 1, ok_scalar = 1, ok_shifted = 1;
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const unsigned char *s = (const unsigned char *) cases[i].bytes;
+        const size_t len = strlen(cases[i].bytes);
+
+        if (srl_rdr_utf8_valid(s, len) != cases[i].valid) {
+            printf("# utf8 case %lu\n", (unsigned long) i);
+            ok = 0;
+        }
+        if (srl_rdr_utf8_valid_scalar(s, len) != cases[i].valid)
+            ok_scalar = 0;
+
+        /* at every position of ASCII text, across word boundaries */
+        for (pos = 0; pos < 40; pos++) {
+            memset(buf, 'a', sizeof(buf));
+            memcpy(buf + pos, s, len);
+            if (srl_rdr_utf8_valid(buf, pos + len + 20) != cases[i].valid
+                || srl_rdr_utf8_valid(buf, pos + len) != cases[i].valid)
+            {
+                ok_shifted = 0;
+            }
+        }
+    }
+
+    CHECK(ok, "UTF-8 validation");
+    CHECK(ok_scalar, "scalar UTF-8 validation");
+    CHECK(ok_shifted, "UTF-8 validation at every offset");
+
+    srand(43);
+    for (j = 0; j < 200000; j++) {
+        static const char *pieces[] = { "a", "abcdefgh", "\xc3\xa9", "\xe2\x98\xba", "\xf0\x9f\x98\x80", "\xc3", "\xed\xa0\x80", "\xff" };
+        size_t len = 0;
+
+        while (len < 64) {
+            const int k = rand() % 100;
+            const char *piece = pieces[k < 60 ? 1 : k < 75 ? 0 : k < 85 ? 2 : k < 92 ? 3 : k < 96 ? 4 : 5 + k % 3];
+            const size_t plen = strlen(piece);
+            memcpy(buf + len, piece, plen);
+            len += plen;
+        }
+
+        if (srl_rdr_utf8_valid(buf, len) != srl_rdr_utf8_valid_scalar(buf, len))
+            mismatches++;
+    }
+    CHECK(mismatches == 0, "UTF-8 kernel agrees with the scalar version on random input");
+}
+
+/* documents */
+
+static void
+test_tokens(void)
+{
+    /* [ 1, "abc", { a => -1 }, \undef, 300, 2.5, -3 ] */
+    static const unsigned char doc[] = "=\xF3rl\x04\x00"
+        "\x28\x2b\x07" "\x01" "\x63" "abc" "\x51" "\x61" "a" "\x1f" "\x28\x25" "\x20\xac\x02"
+        "\x22\x00\x00\x20\x40" "\x21\x05";
+    static const struct {
+        U8 tag;
+        uint32_t depth;
+        size_t offset;
+        uint64_t uv;
+        int64_t iv;
+    } expected[] = {
+        { SRL_HDR_REFN, 0, 1, 0, 0 },
+        { SRL_HDR_ARRAY, 1, 2, 7, 0 },
+        { SRL_HDR_POS + 1, 2, 4, 1, 1 },
+        { SRL_HDR_SHORT_BINARY + 3, 2, 5, 0, 0 },
+        { SRL_HDR_HASHREF + 1, 2, 9, 1, 0 },
+        { SRL_HDR_SHORT_BINARY + 1, 3, 10, 0, 0 },
+        { SRL_HDR_NEG + 15, 3, 12, 0, -1 },
+        { SRL_HDR_REFN, 2, 13, 0, 0 },
+        { SRL_HDR_UNDEF, 3, 14, 0, 0 },
+        { SRL_HDR_VARINT, 2, 15, 300, 0 },
+        { SRL_HDR_FLOAT, 2, 18, 0, 0 },
+        { SRL_HDR_ZIGZAG, 2, 23, 0, -3 },
+    };
+    srl_rdr_t *rdr = srl_rdr_new(NULL);
+    srl_rdr_token_t tok;
+    size_t i;
+    int ok = 1;
+
+    CHECK(srl_rdr_open(rdr, doc, sizeof(doc) - 1) == SRL_RDR_OK, "open");
+    CHECK(srl_rdr_version(rdr) == 4 && srl_rdr_encoding(rdr) == SRL_PROTOCOL_ENCODING_RAW, "version and encoding");
+    CHECK(srl_rdr_document_length(rdr) == 0, "length of uncompressed document is unknown before reading it");
+
+    for (i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+        memset(&tok, 0, sizeof(tok));
+        if (srl_rdr_next(rdr, &tok) != SRL_RDR_TOKEN
+            || tok.tag != expected[i].tag || tok.depth != expected[i].depth
+            || tok.offset != expected[i].offset || tok.uv != expected[i].uv
+            || tok.iv != expected[i].iv)
+        {
+            printf("# token %lu: tag %u depth %u offset %lu uv %" PRIu64 " iv %" PRId64 "\n", (unsigned long) i,
+                   tok.tag, tok.depth, (unsigned long) tok.offset, tok.uv, tok.iv);
+            ok = 0;
+        }
+        if (i == 3 && (tok.len != 3 || memcmp(tok.str, "abc", 3) != 0))
+            ok = 0;
+        if (i == 10 && tok.nv != 2.5)
+            ok = 0;
+    }
+
+    CHECK(ok, "tokens");
+    CHECK(srl_rdr_next(rdr, &tok) == SRL_RDR_END, "end of body");
+    CHECK(srl_rdr_next(rdr, &tok) == SRL_RDR_END, "end of body again");
+    CHECK(srl_rdr_document_length(rdr) == sizeof(doc) - 1, "document length");
+
+    srl_rdr_free(rdr);
+}
+
+static void
+test_errors(void)
+{
+    static const unsigned char doc[] = "=\xF3rl\x04\x00" "\x28\x2b\x03" "\x01" "\x63" "abc" "\x20\xac\x02";
+    static const unsigned char bad_utf8[] = "=\xF3rl\x04\x00" "\x27\x02\xc3\x28";
+    static const unsigned char deep[] = "=\xF3rl\x04\x00" "\x28\x28\x28\x28\x01";
+    static const unsigned char big_varint[] = "=\xF3rl\x04\x00" "\x20\xff\xff\xff\xff\xff\xff\xff\xff\xff\x7f";
+    static const unsigned char bad_offset[] = "=\xF3rl\x04\x00" "\x42\x01\x29\x05";
+    error_seen_t seen;
+    srl_rdr_config_t config;
+    srl_rdr_t *rdr, *other;
+    srl_rdr_token_t tok;
+
+    memset(&seen, 0, sizeof(seen));
+    memset(&config, 0, sizeof(config));
+    config.on_error = on_error;
+    config.error_ud = &seen;
+    rdr = srl_rdr_new(&config);
+    other = srl_rdr_new(NULL);
+
+    CHECK(srl_rdr_next(rdr, &tok) == SRL_RDR_ERR && strstr(srl_rdr_error(rdr), "no document") != NULL,
+          "reading without a document");
+    CHECK(has_error(rdr, doc, sizeof(doc) - 2, "end of packet reached before varint parsed"), "truncated varint");
+    CHECK(seen.calls == 2 && strcmp(seen.message, srl_rdr_error(rdr)) == 0, "error handler gets the messages");
+    CHECK(srl_rdr_next(rdr, &tok) == SRL_RDR_ERR, "reader stays failed");
+    CHECK(has_error(rdr, doc, sizeof(doc) - 4, "Premature end of document"), "truncated document");
+    CHECK(has_error(rdr, doc, 5, "Bad Sereal header"), "truncated header");
+    CHECK(has_error(rdr, (const unsigned char *) "=\xC3\xB3rl\x04\x00\x01", 8, "accidentally UTF-8 encoded"), "UTF-8 encoded header");
+    CHECK(count_tokens(other, (const unsigned char *) "=srl\x01\x00\x01", 7) == 1, "protocol version 1");
+    CHECK(has_error(rdr, (const unsigned char *) "=\xF3rl\x05\x00\x01", 7, "Unsupported Sereal protocol version 5"), "protocol version 5");
+    CHECK(has_error(rdr, (const unsigned char *) "=\xF3rl\x74\x00\x01", 7, "unknown format"), "unknown encoding");
+    CHECK(has_error(rdr, (const unsigned char *) "=\xF3rl\x04\x00\x3f\x34", 8, "Unexpected tag SRL_HDR_RESERVED_0"), "reserved tag after PAD");
+    CHECK(has_error(rdr, big_varint, sizeof(big_varint) - 1, "varint too big"), "varint too big");
+    CHECK(has_error(rdr, bad_offset, sizeof(bad_offset) - 1, "Offset 5 points past current position"), "REFP to the future");
+    CHECK(has_error(rdr, (const unsigned char *) "=\xF3rl\x04\x00\x26\x05" "ab", 10, "Unexpected termination of packet"), "string past the end");
+    CHECK(count_tokens(other, doc, sizeof(doc) - 1) == 5, "other readers are not affected");
+    CHECK(count_tokens(rdr, doc, sizeof(doc) - 1) == 5, "reader can be reused after an error");
+    CHECK(count_tokens(rdr, bad_utf8, sizeof(bad_utf8) - 1) == 1, "invalid UTF-8 is not checked by default");
+    srl_rdr_free(rdr);
+
+    config.flags = SRL_RDR_F_VALIDATE_UTF8;
+    config.max_depth = 3;
+    rdr = srl_rdr_new(&config);
+    CHECK(has_error(rdr, bad_utf8, sizeof(bad_utf8) - 1, "Invalid UTF-8 in STR_UTF8 string"), "invalid UTF-8");
+    CHECK(has_error(rdr, deep, sizeof(deep) - 1, "Reached recursion limit (3)"), "max_depth");
+    CHECK(count_tokens(rdr, deep, sizeof(deep) - 2) == -1, "truncated deep document");
+    srl_rdr_free(rdr);
+
+    config.flags = SRL_RDR_F_REFUSE_COMPRESSED;
+    config.max_depth = 0;
+    rdr = srl_rdr_new(&config);
+    CHECK(has_error(rdr, fixture("zstd_v4")->data, fixture("zstd_v4")->len, "refuse compressed input"), "refuse compressed documents");
+    CHECK(count_tokens(rdr, fixture("raw_v4")->data, fixture("raw_v4")->len) > 0, "uncompressed documents are fine");
+    srl_rdr_free(rdr);
+    srl_rdr_free(other);
+}
+
+static void
+test_pad_and_skip(void)
+{
+    /* [[1,2,3],[1,2,3]] as written by Sereal::Merger, with PADs after the array length */
+    static const unsigned char merged[] = "=\xF3rl\x04\x00" "\x28\x2b\x02\x3f\x3f\x3f\x3f\x43\x01\x02\x03\x43\x01\x02\x03";
+    srl_rdr_t *rdr = srl_rdr_new(NULL);
+    srl_rdr_token_t tok;
+
+    CHECK(count_tokens(rdr, merged, sizeof(merged) - 1) == 10, "PAD tags are not tokens");
+
+    srl_rdr_open(rdr, merged, sizeof(merged) - 1);
+    srl_rdr_next(rdr, &tok);
+    srl_rdr_next(rdr, &tok);
+    srl_rdr_next(rdr, &tok);
+    CHECK(tok.tag == SRL_HDR_ARRAYREF + 3 && tok.offset == 8, "first element after PADs");
+    CHECK(srl_rdr_skip(rdr) == SRL_RDR_OK, "skip first element");
+    CHECK(srl_rdr_next(rdr, &tok) == SRL_RDR_TOKEN && tok.tag == SRL_HDR_ARRAYREF + 3 && tok.offset == 12,
+          "second element after skip");
+    CHECK(srl_rdr_skip(rdr) == SRL_RDR_OK && srl_rdr_next(rdr, &tok) == SRL_RDR_END, "skip to the end");
+
+    srl_rdr_open(rdr, merged, sizeof(merged) - 1);
+    srl_rdr_next(rdr, &tok);
+    CHECK(srl_rdr_skip(rdr) == SRL_RDR_OK && srl_rdr_next(rdr, &tok) == SRL_RDR_END, "skip the root item");
+
+    srl_rdr_open(rdr, merged, sizeof(merged) - 1);
+    srl_rdr_next(rdr, &tok);
+    srl_rdr_next(rdr, &tok);
+    srl_rdr_next(rdr, &tok);
+    srl_rdr_next(rdr, &tok);
+    CHECK(tok.tag == SRL_HDR_POS + 1 && srl_rdr_skip(rdr) == SRL_RDR_OK
+          && srl_rdr_next(rdr, &tok) == SRL_RDR_TOKEN && tok.tag == SRL_HDR_POS + 2,
+          "skip does nothing after a scalar");
+
+    srl_rdr_free(rdr);
+}
+
+/* fixtures */
+
+#define MAX_TOKENS 4096
+
+typedef struct {
+    srl_rdr_token_t tok[MAX_TOKENS];
+    long n;
+} token_list_t;
+
+static int
+read_all(srl_rdr_t *rdr, const fixture_t *f, token_list_t *list)
+{
+    int rc;
+
+    list->n = 0;
+    if (srl_rdr_open(rdr, f->data, f->len) != SRL_RDR_OK)
+        return 0;
+
+    while (list->n < MAX_TOKENS && (rc = srl_rdr_next(rdr, &list->tok[list->n])) == SRL_RDR_TOKEN)
+        list->n++;
+
+    return rc == SRL_RDR_END;
+}
+
+static int
+same_tokens(const token_list_t *a, const token_list_t *b)
+{
+    long i;
+
+    if (a->n != b->n)
+        return 0;
+
+    for (i = 0; i < a->n; i++) {
+        const srl_rdr_token_t *x = &a->tok[i], *y = &b->tok[i];
+        const int has_str = x->tag >= SRL_HDR_SHORT_BINARY_LOW || x->tag == SRL_HDR_BINARY
+                         || x->tag == SRL_HDR_STR_UTF8 || x->tag == SRL_HDR_LONG_DOUBLE;
+
+        if (x->tag != y->tag || x->tracked != y->tracked || x->depth != y->depth || x->offset != y->offset)
+            return 0;
+        if (x->uv != y->uv || x->iv != y->iv || memcmp(&x->nv, &y->nv, sizeof(double)) != 0)
+            return 0;
+        if (has_str && (x->len != y->len || memcmp(x->str, y->str, x->len) != 0))
+            return 0;
+    }
+
+    return 1;
+}
+
+/* Offsets of REFP, ALIAS, COPY and OBJECTV point at tokens of the right kind */
+static int
+offsets_resolve(const token_list_t *list)
+{
+    long i, j;
+
+    for (i = 0; i < list->n; i++) {
+        const srl_rdr_token_t *t = &list->tok[i];
+        if (t->tag != SRL_HDR_REFP && t->tag != SRL_HDR_ALIAS && t->tag != SRL_HDR_COPY
+            && t->tag != SRL_HDR_OBJECTV && t->tag != SRL_HDR_OBJECTV_FREEZE)
+        {
+            continue;
+        }
+
+        for (j = 0; j < i && list->tok[j].offset != t->uv; j++)
+            ;
+        if (j == i)
+            return 0;
+        if ((t->tag == SRL_HDR_REFP || t->tag == SRL_HDR_ALIAS) && !list->tok[j].tracked)
+            return 0;
+        if ((t->tag == SRL_HDR_COPY || t->tag == SRL_HDR_OBJECTV)
+            && !(list->tok[j].tag >= SRL_HDR_SHORT_BINARY_LOW || list->tok[j].tag == SRL_HDR_BINARY
+                 || list->tok[j].tag == SRL_HDR_STR_UTF8))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static long
+count_tag(const token_list_t *list, U8 tag)
+{
+    long i, n = 0;
+    for (i = 0; i < list->n; i++)
+        n += list->tok[i].tag == tag;
+    return n;
+}
+
+static void
+test_fixtures(void)
+{
+    static token_list_t raw, list;
+    static const struct {
+        const char *name;
+        const char *same_as;
+        int encoding;
+    } compressed[] = {
+        { "snappy_v1", "raw_v1", SRL_PROTOCOL_ENCODING_SNAPPY },
+        { "snappy_incr_v1", "raw_v1", SRL_PROTOCOL_ENCODING_SNAPPY_INCREMENTAL },
+        { "snappy_incr_v4", "raw_v4", SRL_PROTOCOL_ENCODING_SNAPPY_INCREMENTAL },
+        { "zlib_v4", "raw_v4", SRL_PROTOCOL_ENCODING_ZLIB },
+        { "zstd_v4", "raw_v4", SRL_PROTOCOL_ENCODING_ZSTD },
+        { "raw_v2", "raw_v3", SRL_PROTOCOL_ENCODING_RAW },
+        { "user_header_v4", "raw_v4", SRL_PROTOCOL_ENCODING_RAW },
+    };
+    srl_rdr_config_t config;
+    srl_rdr_t *rdr;
+    size_t i;
+    char name[128];
+    const unsigned char *header;
+    size_t header_len;
+
+    memset(&config, 0, sizeof(config));
+    config.flags = SRL_RDR_F_VALIDATE_UTF8;
+    rdr = srl_rdr_new(&config);
+
+    for (i = 0; i < N_FIXTURES; i++) {
+        const fixture_t *f = &fixtures[i];
+        int ok = read_all(rdr, f, &list);
+
+        if (!ok) printf("# %s\n", srl_rdr_error(rdr));
+        snprintf(name, sizeof(name), "%s: read", f->name);
+        CHECK(ok, name);
+        snprintf(name, sizeof(name), "%s: document length", f->name);
+        CHECK(srl_rdr_document_length(rdr) == f->len, name);
+        snprintf(name, sizeof(name), "%s: offsets point at the right items", f->name);
+        CHECK(offsets_resolve(&list), name);
+    }
+
+    for (i = 0; i < sizeof(compressed) / sizeof(compressed[0]); i++) {
+        read_all(rdr, fixture(compressed[i].same_as), &raw);
+        read_all(rdr, fixture(compressed[i].name), &list);
+        snprintf(name, sizeof(name), "%s: encoding", compressed[i].name);
+        CHECK(srl_rdr_encoding(rdr) == compressed[i].encoding, name);
+        snprintf(name, sizeof(name), "%s: same tokens as %s", compressed[i].name, compressed[i].same_as);
+        CHECK(same_tokens(&raw, &list), name);
+    }
+
+    read_all(rdr, fixture("raw_v4"), &list);
+    CHECK(count_tag(&list, SRL_HDR_REFP) > 0 && count_tag(&list, SRL_HDR_WEAKEN) > 0
+          && count_tag(&list, SRL_HDR_OBJECTV) > 0 && count_tag(&list, SRL_HDR_REGEXP) > 0
+          && count_tag(&list, SRL_HDR_STR_UTF8) > 0 && count_tag(&list, SRL_HDR_DOUBLE) > 0
+          && count_tag(&list, SRL_HDR_ZIGZAG) > 0 && count_tag(&list, SRL_HDR_ARRAY) > 0,
+          "raw_v4 has the interesting tags");
+    read_all(rdr, fixture("dedupe_v4"), &list);
+    CHECK(count_tag(&list, SRL_HDR_COPY) > 0, "dedupe_v4 has COPY tags");
+    read_all(rdr, fixture("aliased_v4"), &list);
+    CHECK(count_tag(&list, SRL_HDR_ALIAS) > 0, "aliased_v4 has ALIAS tags");
+
+    srl_rdr_open(rdr, fixture("user_header_v4")->data, fixture("user_header_v4")->len);
+    header = srl_rdr_user_header(rdr, &header_len);
+    CHECK(header != NULL && header_len == 12 && memcmp(header, "\x6buser header", 12) == 0, "user header");
+    srl_rdr_open(rdr, fixture("raw_v4")->data, fixture("raw_v4")->len);
+    CHECK(srl_rdr_user_header(rdr, &header_len) == NULL && header_len == 0, "no user header");
+
+    srl_rdr_free(rdr);
+}
+
+/* Read the pairs of the top level hash, skipping their values */
+static long
+skip_values(srl_rdr_t *rdr, const fixture_t *f)
+{
+    srl_rdr_token_t tok;
+    uint32_t key_depth;
+    long pairs = 0;
+
+    /* REFN HASH in protocol version 1 and 2, HASHREF_N after it */
+    if (srl_rdr_open(rdr, f->data, f->len) != SRL_RDR_OK || srl_rdr_next(rdr, &tok) != SRL_RDR_TOKEN)
+        return -1;
+    if (tok.tag == SRL_HDR_REFN && srl_rdr_next(rdr, &tok) != SRL_RDR_TOKEN)
+        return -1;
+
+    key_depth = tok.depth + 1;
+    for (;;) {
+        int rc = srl_rdr_next(rdr, &tok);
+        if (rc == SRL_RDR_END) return pairs;
+        if (rc != SRL_RDR_TOKEN || tok.depth != key_depth) return -1;
+        if (srl_rdr_next(rdr, &tok) != SRL_RDR_TOKEN || srl_rdr_skip(rdr) != SRL_RDR_OK) return -1;
+        pairs++;
+    }
+}
+
+static void
+test_skip_fixtures(void)
+{
+    srl_rdr_t *rdr = srl_rdr_new(NULL);
+    size_t i;
+    char name[128];
+
+    for (i = 0; i < N_FIXTURES; i++) {
+        snprintf(name, sizeof(name), "%s: skip values of the top level hash", fixtures[i].name);
+        CHECK(skip_values(rdr, &fixtures[i]) == 10, name);
+    }
+
+    srl_rdr_free(rdr);
+}
+
+static void
+test_stream(void)
+{
+    const fixture_t *parts[3];
+    unsigned char *stream;
+    size_t len = 0, pos = 0, i;
+    srl_rdr_t *rdr = srl_rdr_new(NULL);
+    int docs = 0;
+
+    parts[0] = fixture("raw_v4");
+    parts[1] = fixture("zstd_v4");
+    parts[2] = fixture("raw_v1");
+    for (i = 0; i < 3; i++)
+        len += parts[i]->len;
+
+    stream = (unsigned char *) malloc(len);
+    for (i = 0; i < 3; i++) {
+        memcpy(stream + pos, parts[i]->data, parts[i]->len);
+        pos += parts[i]->len;
+    }
+
+    for (pos = 0; pos < len; docs++) {
+        if (count_tokens(rdr, stream + pos, len - pos) < 0 || srl_rdr_document_length(rdr) == 0)
+            break;
+        pos += srl_rdr_document_length(rdr);
+    }
+    CHECK(docs == 3 && pos == len, "stream of documents");
+
+    free(stream);
+    srl_rdr_free(rdr);
+}
+
+static void
+test_allocator(void)
+{
+    static const char *names[] = { "zstd_v4", "zlib_v4", "snappy_incr_v4", "raw_v4" };
+    alloc_stats_t stats;
+    srl_rdr_config_t config = counting_config(&stats);
+    srl_rdr_t *rdr = srl_rdr_new(&config);
+    size_t i;
+    long fail_at, failed = 0, leaked = 0;
+    int ok = 1;
+
+    for (i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (count_tokens(rdr, fixture(names[i])->data, fixture(names[i])->len) < 0)
+            ok = 0;
+    }
+    CHECK(ok && stats.total > 4, "allocations go through the allocator");
+    srl_rdr_free(rdr);
+    CHECK(stats.live == 0, "everything is freed");
+
+    /* fail each allocation in turn */
+    for (fail_at = 1; fail_at < 200; fail_at++) {
+        config = counting_config(&stats);
+        stats.fail_at = fail_at;
+        rdr = srl_rdr_new(&config);
+        if (rdr == NULL) {
+            failed++;
+            continue;
+        }
+
+        for (i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+            if (count_tokens(rdr, fixture(names[i])->data, fixture(names[i])->len) < 0) {
+                if (strstr(srl_rdr_error(rdr), "Out of memory") == NULL
+                    && strstr(srl_rdr_error(rdr), "zlib") == NULL
+                    && strstr(srl_rdr_error(rdr), "ZLIB") == NULL)
+                {
+                    printf("# unexpected error: %s\n", srl_rdr_error(rdr));
+                    ok = 0;
+                }
+                failed++;
+            }
+        }
+
+        srl_rdr_free(rdr);
+        if (stats.live != 0)
+            leaked++;
+    }
+    CHECK(ok && failed > 0, "failed allocations are reported");
+    CHECK(leaked == 0, "nothing leaks after failed allocations");
+}
+
+int
+main(void)
+{
+    printf("# kernels: %s\n", srl_rdr_kernels());
+
+    test_varint();
+    test_utf8();
+    test_tokens();
+    test_errors();
+    test_pad_and_skip();
+    test_fixtures();
+    test_skip_fixtures();
+    test_stream();
+    test_allocator();
+
+    printf("1..%d\n", tests);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,44 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use Sereal::Encoder;
+use Sereal::Decoder;
+
+use Benchmark::Dumb qw(cmpthese);
+
+# Measures the cost of blessing in object heavy documents by comparing a
+# normal decode with one that skips the blessing (no_bless_objects) and
+# with a decode of the same data without any objects in it.
+
+my $count= shift || 500_000;
+
+my $enc= Sereal::Encoder->new();
+my $dec= Sereal::Decoder->new();
+my $dec_nobless= Sereal::Decoder->new( { no_bless_objects => 1 } );
+
+my @classes= map { "Some::Class::$_" } 1 .. 10;
+my $one_class= [ map { bless( { id => $_ } => "Some::Class" ) } 1 .. $count ];
+my $ten_classes= [ map { bless( { id => $_ } => $classes[ $_ % 10 ] ) } 1 .. $count ];
+my $scalars= [ map { my $x= $_; bless( \$x => "Some::Class" ) } 1 .. $count ];
+my $plain= [ map { { id => $_ } } 1 .. $count ];
+
+my %docs= (
+    one_class   => $enc->encode($one_class),
+    ten_classes => $enc->encode($ten_classes),
+    scalars     => $enc->encode($scalars),
+    plain       => $enc->encode($plain),
+);
+
+my $timing= "50.01";
+
+for my $name (qw(one_class ten_classes scalars)) {
+    my $doc= $docs{$name};
+    print "Comparing decoding $count objects ($name)...\n";
+    cmpthese(
+        $timing,
+        {
+            bless    => sub { $dec->decode($doc) },
+            no_bless => sub { $dec_nobless->decode($doc) },
+            unblessed_data => sub { $dec->decode( $docs{plain} ) },
+        } );
+}
@@ -0,0 +1,42 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use Sereal::Encoder;
+use Sereal::Merger;
+
+use Benchmark::Dumb qw(timethese);
+
+# Measures Sereal::Merger throughput for a few typical document shapes.
+# Run it against two builds to compare merger changes.
+
+my $count= shift || 1_000;
+
+my $enc= Sereal::Encoder->new();
+my $enc_dedupe= Sereal::Encoder->new( { dedupe_strings => 1 } );
+
+my $shared= { name => "shared", list => [ 1 .. 10 ] };
+my %docs= (
+    scalars => [ map { $enc->encode( [ map { $_ * 1.5 } 1 .. 100 ] ) } 1 .. $count ],
+    strings => [ map { $enc->encode( { map { ( "key_$_" => "value " x $_ ) } 1 .. 20 } ) } 1 .. $count ],
+    copies  => [ map { $enc_dedupe->encode( [ map { { type => "event", source => "host_" . ( $_ % 3 ) } } 1 .. 50 ] ) } 1 .. $count ],
+    refs    => [ map { $enc->encode( [ ($shared) x 20, \$shared->{name} ] ) } 1 .. $count ],
+    objects => [ map { $enc->encode( [ map { bless( { id => $_ } => "Some::Class::" . ( $_ % 5 ) ) } 1 .. 50 ] ) } 1 .. $count ],
+);
+
+my $timing= "50.01";
+
+for my $dedupe (0, 1) {
+    print "Merging $count documents, dedupe_strings => $dedupe\n";
+    timethese(
+        $timing,
+        {
+            map {
+                my $docs= $docs{$_};
+                $_ => sub {
+                    my $mrg= Sereal::Merger->new( { dedupe_strings => $dedupe } );
+                    $mrg->append_all($docs);
+                    $mrg->finish;
+                }
+            } sort keys %docs
+        } );
+}
@@ -0,0 +1,39 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use Sereal::Splitter;
+
+use Benchmark::Dumb qw(timethese);
+
+# Measures Sereal::Splitter throughput on Perl/Splitter/big.srl, for a few
+# chunk sizes, sequential and with 4 threads. Run it against two builds to
+# compare splitter changes.
+
+my $file= shift || "big.srl";
+
+my $data= do {
+    open my $fh, '<', $file or die "Can't open $file: $!";
+    binmode $fh;
+    local $/;
+    <$fh>;
+};
+
+my $timing= "50.01";
+
+for my $compress (0, 1, 2, 3) {
+    for my $threads (1, 4) {
+        print "Splitting $file (" . length($data) . " bytes), compress => $compress, threads => $threads\n";
+        timethese(
+            $timing,
+            {
+                map {
+                    my $chunk_size= $_;
+                    "chunk_size_$chunk_size" => sub {
+                        my $o= Sereal::Splitter->new(
+                            { chunk_size => $chunk_size, input => $data, compress => $compress, threads => $threads } );
+                        while ( defined( my $chunk= $o->next_chunk() ) ) { }
+                    }
+                } 1024, 50 * 1024, 1024 * 1024
+            } );
+    }
+}
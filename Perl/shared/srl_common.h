@@ -1,6 +1,10 @@
 #ifndef SRL_COMMON_H_
 #define SRL_COMMON_H_
 
+#ifdef SRL_READER_STANDALONE
+#   include "srl_reader_standalone.h"
+#endif
+
 #include "srl_inline.h"
 
 /* inspired by JSON::XS code */
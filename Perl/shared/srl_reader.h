@@ -6,6 +6,10 @@
 #include "srl_common.h"
 #include "srl_reader_types.h"
 
+#ifndef SRL_RDR_WARN
+#   define SRL_RDR_WARN warn
+#endif
+
 /* reader buffer operations */
 #define SRL_RDR_SIZE(buf)           ((buf)->end -  (buf)->start)
 #define SRL_RDR_SPACE_LEFT(buf)     ((buf)->end -  (buf)->pos)
@@ -48,7 +52,7 @@
            (buf)->pos < (buf)->start                                           \
         || (buf)->pos > (buf)->end                                             \
     )) {                                                                       \
-        warn("failed sanity assertion check - pos: %"UVuf" [%p %p %p] %"UVuf,  \
+        SRL_RDR_WARN("failed sanity assertion check - pos: %"UVuf" [%p %p %p] %"UVuf,  \
              (UV)SRL_RDR_POS_OFS(buf), (buf)->start, (buf)->pos,               \
              (buf)->end, (UV)SRL_RDR_SPACE_LEFT(buf));                         \
     }                                                                          \
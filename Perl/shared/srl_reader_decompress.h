@@ -39,6 +39,140 @@
     #include "miniz.h"
 #endif
 
+/* The compressed body of a document as described by its framing, filled
+ * in by srl_read_compressed_body(). */
+typedef struct srl_compressed_body {
+    srl_reader_char_ptr data;   /* compressed data */
+    STRLEN data_len;
+    STRLEN body_len;            /* length of the uncompressed body */
+    UV bytes_consumed;          /* length of the document, header included */
+} srl_compressed_body_t;
+
+/* Read the framing of a compressed body which starts at buf->pos.
+ * encoding is one of the compressed SRL_PROTOCOL_ENCODING_* values.
+ * This and srl_decompress_body_into() don't depend on perl, the SV
+ * based functions below and libsereal_reader are built on them. */
+
+SRL_STATIC_INLINE void
+srl_read_compressed_body(pTHX_ srl_reader_buffer_t *buf, U8 encoding, srl_compressed_body_t *body)
+{
+    switch (encoding) {
+        case SRL_PROTOCOL_ENCODING_SNAPPY:
+        case SRL_PROTOCOL_ENCODING_SNAPPY_INCREMENTAL:
+        {
+            int header_len;
+            uint32_t dest_len;
+
+            body->data_len = encoding == SRL_PROTOCOL_ENCODING_SNAPPY_INCREMENTAL
+                ? (STRLEN) srl_read_varint_uv_length(aTHX_ buf, " while reading compressed packet size")
+                : (STRLEN) SRL_RDR_SPACE_LEFT(buf);
+            body->bytes_consumed = body->data_len + SRL_RDR_POS_OFS(buf);
+
+            header_len = csnappy_get_uncompressed_length((char *)buf->pos,
+                                                         body->data_len,
+                                                         &dest_len);
+            if (header_len == CSNAPPY_E_HEADER_BAD)
+                SRL_RDR_ERROR(buf, "Invalid Snappy header in Snappy-compressed Sereal packet");
+
+            body->data = buf->pos + header_len;
+            body->data_len -= header_len;
+            body->body_len = dest_len;
+            break;
+        }
+
+        case SRL_PROTOCOL_ENCODING_ZLIB:
+            body->body_len = (STRLEN) srl_read_varint_uv(aTHX_ buf);
+            body->data_len = (STRLEN) srl_read_varint_uv_length(aTHX_ buf, " while reading compressed packet size");
+            body->data = buf->pos;
+            body->bytes_consumed = body->data_len + SRL_RDR_POS_OFS(buf);
+            break;
+
+        case SRL_PROTOCOL_ENCODING_ZSTD:
+        {
+            unsigned long long uncompressed_packet_len;
+
+            body->data_len = (STRLEN) srl_read_varint_uv_length(aTHX_ buf, " while reading compressed packet size");
+            body->data = buf->pos;
+            body->bytes_consumed = body->data_len + SRL_RDR_POS_OFS(buf);
+
+            uncompressed_packet_len = ZSTD_getDecompressedSize((const void *)buf->pos, (size_t) body->data_len);
+            if (expect_false(uncompressed_packet_len == 0))
+                SRL_RDR_ERROR(buf, "Invalid zstd packet with unknown uncompressed size");
+
+            body->body_len = (STRLEN) uncompressed_packet_len;
+            break;
+        }
+
+        default:
+            SRL_RDR_ERRORf1(buf, "Document encoding %u is not a compressed encoding", (unsigned int) encoding);
+    }
+}
+
+/* Decompress body into dst, which has room for body->body_len bytes.
+ * For zlib, strm is used if not NULL; it has to be initialized by
+ * mz_inflateInit() and is reset here. For zstd, dctx is used if not NULL.
+ * Errors are reported at the position of buf. */
+
+SRL_STATIC_INLINE void
+srl_decompress_body_into(pTHX_ srl_reader_buffer_t *buf, U8 encoding, const srl_compressed_body_t *body,
+                         unsigned char *dst, mz_streamp strm, ZSTD_DCtx *dctx)
+{
+    if (encoding == SRL_PROTOCOL_ENCODING_ZLIB) {
+        int decompress_ok;
+        mz_ulong tmp = body->body_len;
+
+        if (strm == NULL) {
+            decompress_ok = mz_uncompress(dst, &tmp, body->data, body->data_len);
+        } else {
+            decompress_ok = mz_inflateReset(strm);
+            if (expect_true( decompress_ok == Z_OK )) {
+                strm->next_in = body->data;
+                strm->avail_in = (unsigned int) body->data_len;
+                strm->next_out = dst;
+                strm->avail_out = (unsigned int) body->body_len;
+
+                decompress_ok = mz_inflate(strm, Z_FINISH);
+                decompress_ok = decompress_ok == Z_STREAM_END ? Z_OK
+                              : decompress_ok == Z_OK ? Z_BUF_ERROR
+                              : decompress_ok;
+                tmp = body->body_len - strm->avail_out;
+            }
+        }
+
+        if (expect_false( decompress_ok != Z_OK )) {
+            SRL_RDR_ERRORf1(buf, "ZLIB decompression of Sereal packet payload failed with error %i!", decompress_ok);
+        }
+        if (expect_false( tmp != body->body_len ))
+            SRL_RDR_ERROR(buf, "ZLIB decompression of Sereal packet payload is shorter than its header says");
+    } else if (encoding == SRL_PROTOCOL_ENCODING_ZSTD) {
+        const size_t decompress_code = dctx
+            ? ZSTD_decompressDCtx(dctx, (void *)dst, (size_t) body->body_len,
+                                  (void *)body->data, (size_t) body->data_len)
+            : ZSTD_decompress((void *)dst, (size_t) body->body_len,
+                              (void *)body->data, (size_t) body->data_len);
+
+        if (expect_false( ZSTD_isError(decompress_code) )) {
+            SRL_RDR_ERRORf1(buf, "Zstd decompression of Sereal packet payload failed with error %s!",
+                            ZSTD_getErrorName(decompress_code));
+        }
+        if (expect_false( decompress_code != body->body_len ))
+            SRL_RDR_ERROR(buf, "Zstd decompression of Sereal packet payload is shorter than its header says");
+    } else {
+        uint32_t dest_len = (uint32_t) body->body_len;
+        const int decompress_ok = csnappy_decompress_noheader((char *)body->data,
+                                                              body->data_len,
+                                                              (char *)dst,
+                                                              &dest_len);
+
+        if (expect_false( decompress_ok != 0 )) {
+            SRL_RDR_ERRORf1(buf, "Snappy decompression of Sereal packet payload failed with error %i!",
+                            decompress_ok);
+        }
+    }
+}
+
+#ifndef SRL_READER_STANDALONE
+
 /* Creates a new buffer of size header_len + body_len + 1 and swaps it into place
  * of the current reader's buffer. Sets reader position to right after the
  * header and makes the reader state internally consistent. The buffer is
@@ -78,43 +212,17 @@ SRL_STATIC_INLINE UV
 srl_decompress_body_snappy(pTHX_ srl_reader_buffer_t *buf, U8 encoding_flags, SV** buf_owner)
 {
     SV *buf_sv;
-    int header_len;
-    int decompress_ok;
-    uint32_t dest_len;
-    UV bytes_consumed;
-
-    srl_reader_char_ptr old_pos;
+    srl_compressed_body_t body;
     const STRLEN sereal_header_len = (STRLEN) SRL_RDR_POS_OFS(buf);
-    const STRLEN compressed_packet_len =
-        encoding_flags == SRL_PROTOCOL_ENCODING_SNAPPY_INCREMENTAL
-        ? (STRLEN) srl_read_varint_uv_length(aTHX_ buf, " while reading compressed packet size")
-        : (STRLEN) SRL_RDR_SPACE_LEFT(buf);
 
-    /* All bufl's above here, or we break C89 compilers */
-    old_pos = buf->pos;
-    bytes_consumed = compressed_packet_len + SRL_RDR_POS_OFS(buf);
-    header_len = csnappy_get_uncompressed_length((char *)buf->pos,
-                                                 compressed_packet_len,
-                                                 &dest_len);
-
-    if (header_len == CSNAPPY_E_HEADER_BAD)
-        SRL_RDR_ERROR(buf, "Invalid Snappy header in Snappy-compressed Sereal packet");
+    srl_read_compressed_body(aTHX_ buf, encoding_flags, &body);
 
     /* Allocate output buffer and swap it into place within the bufoder. */
-    buf_sv = srl_realloc_empty_buffer(aTHX_ buf, sereal_header_len, dest_len);
+    buf_sv = srl_realloc_empty_buffer(aTHX_ buf, sereal_header_len, body.body_len);
     if (buf_owner) *buf_owner = buf_sv;
 
-    decompress_ok = csnappy_decompress_noheader((char *)(old_pos + header_len),
-                                                compressed_packet_len - header_len,
-                                                (char *)buf->pos,
-                                                &dest_len);
-
-    if (expect_false( decompress_ok != 0 )) {
-        SRL_RDR_ERRORf1(buf, "Snappy decompression of Sereal packet payload failed with error %i!",
-                        decompress_ok);
-    }
-
-    return bytes_consumed;
+    srl_decompress_body_into(aTHX_ buf, encoding_flags, &body, (unsigned char *)buf->pos, NULL, NULL);
+    return body.bytes_consumed;
 }
 
 /* Decompress a zlib-compressed document body and put the resulting
@@ -122,83 +230,62 @@ srl_decompress_body_snappy(pTHX_ srl_reader_buffer_t *buf, U8 encoding_flags, SV
  * internaly creates temporary buffer which is owned by mortal SV. If the
  * caller is interested in keeping the buffer around for longer time, it should
  * pass buf_owner parameter and unmortalize it.
+ * If strm is not NULL, it has to be initialized by mz_inflateInit() and is
+ * reset and used instead of allocating a new inflate state.
  * The caller *MUST* call SRL_RDR_UPDATE_BODY_POS right after existing from this function. */
 
 SRL_STATIC_INLINE UV
-srl_decompress_body_zlib(pTHX_ srl_reader_buffer_t *buf, SV** buf_owner)
+srl_decompress_body_zlib(pTHX_ srl_reader_buffer_t *buf, mz_streamp strm, SV** buf_owner)
 {
     SV *buf_sv;
-    mz_ulong tmp;
-    int decompress_ok;
-    UV bytes_consumed;
-    srl_reader_char_ptr old_pos;
-    const STRLEN sereal_header_len = (STRLEN)SRL_RDR_POS_OFS(buf);
-    const STRLEN uncompressed_packet_len = (STRLEN)srl_read_varint_uv(aTHX_ buf);
-    const STRLEN compressed_packet_len =
-        (STRLEN)srl_read_varint_uv_length(aTHX_ buf, " while reading compressed packet size");
-
-    SRL_RDR_ASSERT_SPACE(buf, compressed_packet_len, " while reading compressed packet");
+    srl_compressed_body_t body;
+    const STRLEN sereal_header_len = (STRLEN) SRL_RDR_POS_OFS(buf);
 
-    /* All decl's above here, or we break C89 compilers */
-    old_pos = buf->pos;
-    bytes_consumed = compressed_packet_len + SRL_RDR_POS_OFS(buf);
+    srl_read_compressed_body(aTHX_ buf, SRL_PROTOCOL_ENCODING_ZLIB, &body);
 
     /* Allocate output buffer and swap it into place within the decoder. */
-    buf_sv = srl_realloc_empty_buffer(aTHX_ buf, sereal_header_len, uncompressed_packet_len);
+    buf_sv = srl_realloc_empty_buffer(aTHX_ buf, sereal_header_len, body.body_len);
     if (buf_owner) *buf_owner = buf_sv;
 
-    tmp = uncompressed_packet_len;
-    decompress_ok = mz_uncompress((unsigned char *)buf->pos,
-                                  &tmp, old_pos, compressed_packet_len);
-
-    if (expect_false( decompress_ok != Z_OK )) {
-        SRL_RDR_ERRORf1(buf, "ZLIB decompression of Sereal packet payload failed with error %i!", decompress_ok);
-    }
-
-    return bytes_consumed;
+    srl_decompress_body_into(aTHX_ buf, SRL_PROTOCOL_ENCODING_ZLIB, &body, (unsigned char *)buf->pos, strm, NULL);
+    return body.bytes_consumed;
 }
 
 /* Decompress a zstd-compressed document body and put the resulting document
- * body back in the place of the old compressed blob. The function internaly
- * creates temporary buffer which is owned by mortal SV. If the caller is
- * interested in keeping the buffer around for longer time, it should pass
- * buf_owner parameter and unmortalize it.  The caller *MUST* call
- * SRL_RDR_UPDATE_BODY_POS right after existing from this function. */
+ * body back in the place of the old compressed blob. If dctx is not NULL,
+ * it's used instead of allocating a new decompression context. If buf_owner
+ * points to an SV, that SV's string buffer is grown as needed and reused,
+ * which suits consumers that process many documents in a row, like the
+ * merger. Otherwise the function creates a temporary buffer which is owned
+ * by a mortal SV. If the caller is interested in keeping that buffer around
+ * for longer time, it should pass buf_owner pointing to NULL and unmortalize
+ * the SV stored there.
+ * The caller *MUST* call SRL_RDR_UPDATE_BODY_POS right after existing from this function. */
 
 SRL_STATIC_INLINE UV
-srl_decompress_body_zstd(pTHX_ srl_reader_buffer_t *buf, SV** buf_owner)
+srl_decompress_body_zstd(pTHX_ srl_reader_buffer_t *buf, ZSTD_DCtx *dctx, SV** buf_owner)
 {
     SV *buf_sv;
-    UV bytes_consumed;
-    size_t decompress_code;
-
-    srl_reader_char_ptr old_pos;
-    unsigned long long uncompressed_packet_len;
+    srl_compressed_body_t body;
     const STRLEN sereal_header_len = (STRLEN) SRL_RDR_POS_OFS(buf);
-    const STRLEN compressed_packet_len = (STRLEN) srl_read_varint_uv_length(aTHX_ buf,
-            " while reading compressed packet size");
 
-    /* All bufl's above here, or we break C89 compilers */
-    old_pos = buf->pos;
-    bytes_consumed = compressed_packet_len + SRL_RDR_POS_OFS(buf);
-
-    uncompressed_packet_len = ZSTD_getDecompressedSize((const void *)buf->pos, (size_t) compressed_packet_len);
-    if (expect_false(uncompressed_packet_len == 0))
-        SRL_RDR_ERROR(buf, "Invalid zstd packet with unknown uncompressed size");
-
-    /* Allocate output buffer and swap it into place within the decoder. */
-    buf_sv = srl_realloc_empty_buffer(aTHX_ buf, sereal_header_len, (STRLEN) uncompressed_packet_len);
-    if (buf_owner) *buf_owner = buf_sv;
-
-    decompress_code = ZSTD_decompress((void *)buf->pos, (size_t) uncompressed_packet_len,
-                                      (void *)old_pos,  (size_t) compressed_packet_len);
-
-    if (expect_false( ZSTD_isError(decompress_code) )) {
-        SRL_RDR_ERRORf1(buf, "Zstd decompression of Sereal packet payload failed with error %s!",
-                        ZSTD_getErrorName(decompress_code));
+    srl_read_compressed_body(aTHX_ buf, SRL_PROTOCOL_ENCODING_ZSTD, &body);
+
+    /* Allocate output buffer (or reuse the caller's) and swap it into place within the decoder. */
+    if (buf_owner && *buf_owner) {
+        buf_sv = *buf_owner;
+        buf->start = (srl_reader_char_ptr) sv_grow(buf_sv, sereal_header_len + body.body_len + 1);
+        buf->pos = buf->start + sereal_header_len;
+        buf->end = buf->pos + body.body_len;
+    } else {
+        buf_sv = srl_realloc_empty_buffer(aTHX_ buf, sereal_header_len, body.body_len);
+        if (buf_owner) *buf_owner = buf_sv;
     }
 
-    return bytes_consumed;
+    srl_decompress_body_into(aTHX_ buf, SRL_PROTOCOL_ENCODING_ZSTD, &body, (unsigned char *)buf->pos, NULL, dctx);
+    return body.bytes_consumed;
 }
 
 #endif
+
+#endif
@@ -3,16 +3,26 @@
 
 #include "srl_taginfo.h"
 
+#ifndef SRL_RDR_CROAK
+#   define SRL_RDR_CROAK croak
+#endif
+
+/* Arguments SRL_RDR_CROAK gets ahead of the format: none for croak(),
+ * the buffer's error context in standalone builds */
+#ifndef SRL_RDR_CROAK_ARGS
+#   define SRL_RDR_CROAK_ARGS(buf)
+#endif
+
 #define SRL_RDR_BASE_ERROR_FORMAT_START  "Sereal: Error: "
 #define SRL_RDR_BASE_ERROR_FORMAT_END    " at offset %"UVuf" of input at %s line %u"
 #define SRL_RDR_BASE_ERROR_FORMAT(whatever) SRL_RDR_BASE_ERROR_FORMAT_START whatever SRL_RDR_BASE_ERROR_FORMAT_END
 #define SRL_RDR_BASE_ERROR_ARGS(buf)  (UV)(1 + (buf)->pos - (buf)->start), __FILE__, __LINE__
 
-#define SRL_RDR_ERROR(buf, msg)                              croak(SRL_RDR_BASE_ERROR_FORMAT("%s"),  (msg), SRL_RDR_BASE_ERROR_ARGS((buf)))
-#define SRL_RDR_ERRORf1(buf, fmt, var)                       croak(SRL_RDR_BASE_ERROR_FORMAT(fmt),  (var), SRL_RDR_BASE_ERROR_ARGS((buf)))
-#define SRL_RDR_ERRORf2(buf, fmt, var1, var2)                croak(SRL_RDR_BASE_ERROR_FORMAT(fmt),  (var1), (var2), SRL_RDR_BASE_ERROR_ARGS((buf)))
-#define SRL_RDR_ERRORf3(buf, fmt, var1, var2, var3)          croak(SRL_RDR_BASE_ERROR_FORMAT(fmt),  (var1), (var2), (var3), SRL_RDR_BASE_ERROR_ARGS((buf)))
-#define SRL_RDR_ERRORf4(buf, fmt, var1, var2, var3, var4)    croak(SRL_RDR_BASE_ERROR_FORMAT(fmt),  (var1), (var2), (var3), (var4), SRL_RDR_BASE_ERROR_ARGS((buf)))
+#define SRL_RDR_ERROR(buf, msg)                              SRL_RDR_CROAK(SRL_RDR_CROAK_ARGS((buf)) SRL_RDR_BASE_ERROR_FORMAT("%s"),  (msg), SRL_RDR_BASE_ERROR_ARGS((buf)))
+#define SRL_RDR_ERRORf1(buf, fmt, var)                       SRL_RDR_CROAK(SRL_RDR_CROAK_ARGS((buf)) SRL_RDR_BASE_ERROR_FORMAT(fmt),  (var), SRL_RDR_BASE_ERROR_ARGS((buf)))
+#define SRL_RDR_ERRORf2(buf, fmt, var1, var2)                SRL_RDR_CROAK(SRL_RDR_CROAK_ARGS((buf)) SRL_RDR_BASE_ERROR_FORMAT(fmt),  (var1), (var2), SRL_RDR_BASE_ERROR_ARGS((buf)))
+#define SRL_RDR_ERRORf3(buf, fmt, var1, var2, var3)          SRL_RDR_CROAK(SRL_RDR_CROAK_ARGS((buf)) SRL_RDR_BASE_ERROR_FORMAT(fmt),  (var1), (var2), (var3), SRL_RDR_BASE_ERROR_ARGS((buf)))
+#define SRL_RDR_ERRORf4(buf, fmt, var1, var2, var3, var4)    SRL_RDR_CROAK(SRL_RDR_CROAK_ARGS((buf)) SRL_RDR_BASE_ERROR_FORMAT(fmt),  (var1), (var2), (var3), (var4), SRL_RDR_BASE_ERROR_ARGS((buf)))
 
 #define SRL_RDR_ERROR_UNIMPLEMENTED(buf, tag, str)           SRL_RDR_ERRORf3((buf), "Tag %u (0x%x) '%s' is unimplemented", (tag), (tag), (str))
 #define SRL_RDR_ERROR_UNEXPECTED(buf, tag, msg)              SRL_RDR_ERRORf2((buf), "Unexpected tag SRL_HDR_%s while expecting %s", SRL_TAG_NAME((tag)), (msg))
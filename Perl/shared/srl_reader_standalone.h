@@ -0,0 +1,96 @@
+#ifndef SRL_READER_STANDALONE_H_
+#define SRL_READER_STANDALONE_H_
+
+/* Lets the reader headers (srl_reader.h, srl_reader_types.h,
+ * srl_reader_error.h, srl_reader_varint.h, srl_reader_misc.h and the
+ * SV-free part of srl_reader_decompress.h) compile without perl.h.
+ * Define SRL_READER_STANDALONE before including them:
+ *
+ *   #define SRL_READER_STANDALONE
+ *   #include "srl_reader_varint.h"
+ *
+ * It provides the few Perl types and macros these headers use. Errors
+ * don't croak(), they longjmp() to the srl_reader_error_ctx_t the reader
+ * buffer points to, with the formatted message stored in it:
+ *
+ *   srl_reader_error_ctx_t err;
+ *   buf.error_ctx = &err;
+ *   if (setjmp(err.env) != 0) { ... err.message ... }
+ *
+ * There is no global state, every buffer carries its own context.
+ * libsereal_reader (Perl/libsereal_reader) is built this way. */
+
+#include <inttypes.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint8_t     U8;
+typedef uint32_t    U32;
+typedef int32_t     I32;
+typedef uint64_t    UV;
+typedef int64_t     IV;
+typedef size_t      STRLEN;
+
+#ifndef STATIC
+#   define STATIC static
+#endif
+
+#ifndef STMT_START
+#   define STMT_START do
+#   define STMT_END while (0)
+#endif
+
+#define pTHX    void
+#define pTHX_
+#define aTHX
+#define aTHX_
+
+#define UVuf    PRIu64
+#define IVdf    PRId64
+
+#ifndef I32_MAX
+#   define I32_MAX INT32_MAX
+#endif
+
+#define memEQ(s1, s2, n) (memcmp((s1), (s2), (n)) == 0)
+
+#include "srl_inline.h"
+
+typedef struct srl_reader_error_ctx {
+    jmp_buf env;            /* set by the caller with setjmp() */
+    char message[512];      /* formatted error message */
+} srl_reader_error_ctx_t;
+
+#define SRL_RDR_CROAK               srl_reader_croak
+#define SRL_RDR_CROAK_ARGS(buf)     (buf)->error_ctx,
+#define SRL_RDR_WARN                srl_reader_warn
+
+SRL_STATIC_INLINE void
+srl_reader_croak(srl_reader_error_ctx_t *ctx, const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    vsnprintf(ctx->message, sizeof(ctx->message), fmt, args);
+    va_end(args);
+
+    longjmp(ctx->env, 1);
+}
+
+SRL_STATIC_INLINE void
+srl_reader_warn(const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+#endif
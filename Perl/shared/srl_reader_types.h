@@ -9,6 +9,9 @@ struct srl_reader_buffer {
     srl_reader_char_ptr end;      /* ptr to end of input buffer */
     srl_reader_char_ptr pos;      /* ptr to current possition */
     srl_reader_char_ptr body_pos; /* in Sereal V2, all offsets are relative to the body */
+#ifdef SRL_READER_STANDALONE
+    struct srl_reader_error_ctx *error_ctx; /* where errors go, see srl_reader_standalone.h */
+#endif
 };
 
 typedef struct srl_reader_buffer srl_reader_buffer_t;
@@ -0,0 +1,21 @@
+#ifndef SRL_XXHASH_H_
+#define SRL_XXHASH_H_
+
+/* Pull in the xxhash implementation that ships with the bundled zstd
+ * sources as a private, static copy. This way the hash is available
+ * whether we link against the bundled zstd or an installed libzstd
+ * (which does not export its namespaced XXH symbols). */
+#ifndef XXH_PRIVATE_API
+#   define XXH_PRIVATE_API
+#endif
+#include "zstd/common/xxhash.h"
+
+#define SRL_XXH64_SEED 0
+
+SRL_STATIC_INLINE XXH64_hash_t
+srl_xxh64(const void *data, size_t len)
+{
+    return XXH64(data, len, SRL_XXH64_SEED);
+}
+
+#endif
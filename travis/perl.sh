@@ -14,6 +14,8 @@ pushd Perl/Encoder; perl Makefile.PL && make ; popd
 pushd Perl/Decoder ; make test ; popd
 pushd Perl/Encoder ; make test ; popd
 
+make -C Perl/libsereal_reader test
+
 cpanm Sereal::Decoder
 cpanm Sereal::Encoder
 